@@ -0,0 +1,401 @@
+#pragma once
+#ifndef __BLAS_ATTENTION_HPP__
+#define __BLAS_ATTENTION_HPP__
+
+// ============================================================================
+// 分块精确注意力（flash-attention 风格，CPU）
+//
+//   out = softmax(Q K^T * scale + mask) V，不生成 [Lq, Lk] 的分数矩阵：
+//     * 每个任务负责一个 (batch, head, 64 行查询块)，按 64 个键为一块扫描 K / V；
+//       块内分数 [64, 64] 与输出累加器 [64, d_v] 留在缓存里，额外内存 O(L·d)
+//     * 每行用 OnlineSoftmax 保存 (max, sum)，新块的最大值变大时把已有的和与
+//       输出行按 exp(m_old - m_new) 缩放一次，最后统一除以 sum
+//     * K 预先按键块转置成 [d, 64]（每组 KV 头一次），块内两次乘法走 4 行寄存器分块内核
+//       （AVX2 下为 8 个 ymm 累加器）
+//     * GQA / MQA：K、V 的头数可以是 Q 的约数，相邻的 Hq / Hkv 个查询头共享一组
+//     * causal 按右下角对齐（查询 i 只看 j <= i + Lk - Lq），与 KV cache 解码一致；
+//       整块不可见的键块直接跳过
+//     * 任务数少于线程数（解码时 Lq 很小）时把键再切成若干段并行，
+//       各段的统计量与输出用 OnlineSoftmax::merge 的规则合并
+//   累加用 softmax_detail::acc_t<T>（half / bfloat16 按 float），float 的 exp 为多项式近似。
+// ============================================================================
+
+#include "blas_tensor.hpp"
+#include "../tile_gemm.hpp"
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace TensorN
+{
+    namespace blas
+    {
+        namespace attention_detail
+        {
+            constexpr size_t BQ = 64; // 查询块行数
+            constexpr size_t BK = 64; // 键块长度
+
+            template <typename T>
+            using acc_t = softmax_detail::acc_t<T>;
+
+            template <typename T>
+            struct Problem
+            {
+                using A = acc_t<T>;
+                const T* q = nullptr;
+                const A* kt = nullptr; // K 按键块转置：[Hkv 组, 键块, d, BK]，末块补零
+                const A* v = nullptr;  // V 的累加类型视图 [Hkv 组, Lk, dv]
+                const T* mask = nullptr;
+                size_t Hq = 1, Hkv = 1, group = 1, Lq = 0, Lk = 0, d = 0, dv = 0;
+                std::vector<size_t> mask_off; // 每个 (batch, head) 的 mask 起始偏移
+                size_t mask_row = 0, mask_col = 0; // mask 在 Lq / Lk 方向的步长（广播时为 0）
+                bool causal = false;
+                int64_t diag = 0; // causal：查询 i 只看 j <= i + diag
+                A scale = A(1);
+
+                size_t key_blocks() const { return (Lk + BK - 1) / BK; }
+
+                // 查询块 [i0, i0 + rows) 可见的键范围 [0, end)
+                size_t key_end(size_t i0, size_t rows) const
+                {
+                    if (!causal)
+                        return Lk;
+                    const int64_t last = static_cast<int64_t>(i0 + rows) + diag;
+                    return last <= 0 ? 0 : std::min(Lk, static_cast<size_t>(last));
+                }
+            };
+
+            // 每个线程一份的块缓冲区
+            template <typename T>
+            struct Workspace
+            {
+                using A = acc_t<T>;
+                std::vector<A> q, s;
+                std::vector<OnlineSoftmax<T>> st;
+
+                Workspace(size_t d) : q(BQ * d), s(BQ * BK), st(BQ) {}
+            };
+
+            // K 转置成键块 [d, BK]（每组 KV 头只做一次，GQA 的各查询头与所有查询块共用），
+            // 非 float / double 的 V 转成累加类型
+            template <typename T>
+            void pack_kv(Problem<T>& p, const T* k, const T* v, size_t groups,
+                         std::vector<acc_t<T>>& kt, std::vector<acc_t<T>>& vconv)
+            {
+                using A = acc_t<T>;
+                const size_t nblk = p.key_blocks(), d = p.d;
+                kt.assign(groups * nblk * d * BK, A(0));
+#pragma omp parallel for schedule(static) if (groups * nblk > 1 && p.Lk * d >= 4096)
+                for (int64_t u = 0; u < static_cast<int64_t>(groups * nblk); ++u)
+                {
+                    const size_t g = static_cast<size_t>(u) / nblk, jb = static_cast<size_t>(u) % nblk * BK;
+                    const size_t cols = std::min(BK, p.Lk - jb);
+                    A* dst = kt.data() + static_cast<size_t>(u) * d * BK;
+                    const T* src = k + (g * p.Lk + jb) * d;
+                    for (size_t j = 0; j < cols; ++j)
+                        for (size_t c = 0; c < d; ++c)
+                            dst[c * BK + j] = static_cast<A>(src[j * d + c]);
+                }
+                p.kt = kt.data();
+                if constexpr (std::is_same_v<T, A>)
+                    p.v = v;
+                else
+                {
+                    vconv.resize(groups * p.Lk * p.dv);
+                    std::transform(v, v + vconv.size(), vconv.begin(), [](T x) { return static_cast<A>(x); });
+                    p.v = vconv.data();
+                }
+            }
+
+            // 查询块 [i0, i0 + rows) 对键 [j0, j1) 的未归一化输出写入 o [rows, dv]，统计量写入 st；
+            // j0 是 BK 的倍数
+            template <typename T>
+            void attend(const Problem<T>& p, size_t bh, size_t i0, size_t rows, size_t j0, size_t j1,
+                        Workspace<T>& w, acc_t<T>* o, OnlineSoftmax<T>* st)
+            {
+                using A = acc_t<T>;
+                constexpr A neg_inf = -std::numeric_limits<A>::infinity();
+                const size_t d = p.d, dv = p.dv;
+                const size_t kvh = bh / p.Hq * p.Hkv + bh % p.Hq / p.group;
+                const T* q = p.q + (bh * p.Lq + i0) * d;
+                const A* kt = p.kt + kvh * p.key_blocks() * d * BK;
+                const A* v = p.v + kvh * p.Lk * dv;
+                const T* mask = p.mask ? p.mask + p.mask_off[bh] + i0 * p.mask_row : nullptr;
+
+                A* qs = w.q.data();
+                for (size_t i = 0; i < rows * d; ++i)
+                    qs[i] = static_cast<A>(q[i]) * p.scale;
+                std::fill_n(o, rows * dv, A(0));
+                std::fill_n(st, rows, OnlineSoftmax<T>{});
+
+                for (size_t jb = j0; jb < j1; jb += BK)
+                {
+                    const size_t cols = std::min(BK, j1 - jb);
+                    A* s = w.s.data();
+                    // 末块的补零列一并算掉，内核始终走定长路径；这些列之后不会被读取
+                    tile_detail::tile_gemm(rows, BK, d, qs, d, kt + jb * d, BK, s, BK, false);
+
+                    if (mask)
+                        for (size_t r = 0; r < rows; ++r)
+                        {
+                            const T* mr = mask + r * p.mask_row + jb * p.mask_col;
+                            A* sr = s + r * BK;
+                            for (size_t j = 0; j < cols; ++j)
+                                sr[j] += static_cast<A>(mr[j * p.mask_col]);
+                        }
+                    if (p.causal && static_cast<int64_t>(jb + cols) > static_cast<int64_t>(i0 + 1) + p.diag)
+                        for (size_t r = 0; r < rows; ++r)
+                        {
+                            // 本行可见的键数（相对 jb）
+                            const int64_t lim = static_cast<int64_t>(i0 + r + 1) + p.diag - static_cast<int64_t>(jb);
+                            const size_t from = lim <= 0 ? 0 : std::min(cols, static_cast<size_t>(lim));
+                            std::fill(s + r * BK + from, s + r * BK + cols, neg_inf);
+                        }
+
+                    // 在线 softmax：s 就地换成 exp(s - m_new)，已有的和与输出行按 exp(m_old - m_new) 缩放
+                    for (size_t r = 0; r < rows; ++r)
+                    {
+                        A* sr = s + r * BK;
+                        A bm = neg_inf;
+#pragma omp simd reduction(max : bm)
+                        for (size_t j = 0; j < cols; ++j)
+                            bm = sr[j] > bm ? sr[j] : bm;
+                        OnlineSoftmax<T>& state = st[r];
+                        const A mn = std::max(state.max_value, bm);
+                        if (mn == neg_inf)
+                        {
+                            std::fill_n(sr, cols, A(0)); // 到目前为止全被屏蔽
+                            continue;
+                        }
+                        const A corr = softmax_detail::vexp<A>(state.max_value - mn);
+                        A bs = 0;
+#pragma omp simd reduction(+ : bs)
+                        for (size_t j = 0; j < cols; ++j)
+                        {
+                            sr[j] = softmax_detail::vexp<A>(sr[j] - mn);
+                            bs += sr[j];
+                        }
+                        state.sum = state.sum * corr + bs;
+                        state.max_value = mn;
+                        if (corr != A(1))
+                        {
+                            A* orow = o + r * dv;
+#pragma omp simd
+                            for (size_t x = 0; x < dv; ++x)
+                                orow[x] *= corr;
+                        }
+                    }
+                    tile_detail::tile_gemm(rows, dv, cols, s, BK, v + jb * dv, dv, o, dv, true);
+                }
+            }
+
+            // 归一化后写出；没有任何可见键的行输出 0
+            template <typename T>
+            void finish(const acc_t<T>* o, const OnlineSoftmax<T>* st, size_t rows, size_t dv, T* out)
+            {
+                using A = acc_t<T>;
+                for (size_t r = 0; r < rows; ++r)
+                {
+                    const A inv = st[r].sum > A(0) ? A(1) / st[r].sum : A(0);
+#pragma omp simd
+                    for (size_t x = 0; x < dv; ++x)
+                        out[r * dv + x] = static_cast<T>(o[r * dv + x] * inv);
+                }
+            }
+
+            // 检查形状，填好 Problem 并返回输出形状
+            template <typename T>
+            std::vector<size_t> setup(const Tensor<T>& Q, const Tensor<T>& K, const Tensor<T>& V,
+                                      const Tensor<T>& mask, Problem<T>& p)
+            {
+                const auto& qs = Q.shape();
+                const auto& ks = K.shape();
+                const auto& vs = V.shape();
+                const size_t nd = qs.size();
+                if (nd < 2)
+                    TENSOR_THROW("scaled_dot_product_attention: tensors must have at least 2 dimensions");
+                if (ks.size() != nd || vs.size() != nd)
+                    TENSOR_THROW("scaled_dot_product_attention: Q, K and V must have the same number of dimensions");
+                for (size_t i = 0; i + 3 < nd; ++i)
+                    if (ks[i] != qs[i] || vs[i] != qs[i])
+                        TENSOR_THROW("scaled_dot_product_attention: batch dimensions of Q, K and V must match");
+                if (nd >= 3 && vs[nd - 3] != ks[nd - 3])
+                    TENSOR_THROW("scaled_dot_product_attention: K and V must have the same number of heads");
+                if (ks[nd - 1] != qs[nd - 1])
+                    TENSOR_THROW("scaled_dot_product_attention: Q and K must have the same head dimension");
+                if (vs[nd - 2] != ks[nd - 2])
+                    TENSOR_THROW("scaled_dot_product_attention: K and V must have the same sequence length");
+
+                p.Hq = nd >= 3 ? qs[nd - 3] : 1;
+                p.Hkv = nd >= 3 ? ks[nd - 3] : 1;
+                if (p.Hkv == 0 || p.Hq % p.Hkv != 0)
+                    TENSOR_THROW("scaled_dot_product_attention: number of query heads must be a multiple of K/V heads");
+                p.group = p.Hq / p.Hkv;
+                p.Lq = qs[nd - 2];
+                p.Lk = ks[nd - 2];
+                p.d = qs[nd - 1];
+                p.dv = vs[nd - 1];
+                p.diag = static_cast<int64_t>(p.Lk) - static_cast<int64_t>(p.Lq);
+                p.q = Q.data ? Q.data->data() : nullptr;
+
+                std::vector<size_t> out_shape(qs.begin(), qs.end() - 1);
+                out_shape.push_back(p.dv);
+
+                if (mask.size() == 0)
+                    return out_shape;
+
+                // mask 右对齐广播到分数形状 [..., Hq, Lq, Lk]
+                std::vector<size_t> score(qs.begin(), qs.end() - 1);
+                score.push_back(p.Lk);
+                const auto& ms = mask.shape();
+                if (ms.size() > score.size())
+                    TENSOR_THROW("scaled_dot_product_attention: mask has more dimensions than the scores");
+                std::vector<size_t> stride(score.size(), 0);
+                size_t step = 1;
+                for (size_t i = 0; i < ms.size(); ++i)
+                {
+                    const size_t md = ms.size() - 1 - i, sd = score.size() - 1 - i;
+                    if (ms[md] != score[sd] && ms[md] != 1)
+                        TENSOR_THROW("scaled_dot_product_attention: mask is not broadcastable to [..., Lq, Lk]");
+                    stride[sd] = ms[md] == 1 ? 0 : step;
+                    step *= ms[md];
+                }
+                const size_t lead = score.size() - 2;
+                size_t BH = 1;
+                for (size_t i = 0; i < lead; ++i)
+                    BH *= score[i];
+                p.mask = mask.data->data();
+                p.mask_row = stride[lead];
+                p.mask_col = stride[lead + 1];
+                p.mask_off.assign(BH, 0);
+                for (size_t bh = 0; bh < BH; ++bh)
+                {
+                    size_t rem = bh, off = 0;
+                    for (size_t i = lead; i-- > 0;)
+                    {
+                        off += rem % score[i] * stride[i];
+                        rem /= score[i];
+                    }
+                    p.mask_off[bh] = off;
+                }
+                return out_shape;
+            }
+        }
+
+        // ================================================================
+        // Scaled Dot-Product Attention
+        // Q: (..., Hq, Lq, d)   K: (..., Hkv, Lk, d)   V: (..., Hkv, Lk, d_v)
+        // mask: 加性，可广播到 (..., Hq, Lq, Lk)，-inf 表示屏蔽
+        // scale <= 0 时取 1 / sqrt(d)
+        // Returns: (..., Hq, Lq, d_v)
+        // ================================================================
+
+        template <typename T>
+        Tensor<T> scaled_dot_product_attention(const Tensor<T>& Q, const Tensor<T>& K, const Tensor<T>& V,
+                                               const Tensor<T>& mask, bool causal = false, double scale = 0)
+        {
+            using namespace attention_detail;
+            using A = acc_t<T>;
+            Problem<T> p;
+            Tensor<T> out(setup(Q, K, V, mask, p));
+            p.causal = causal;
+            p.scale = static_cast<A>(scale > 0 ? scale : (p.d ? 1.0 / std::sqrt(static_cast<double>(p.d)) : 1.0));
+            if (out.size() == 0)
+                return out;
+
+            const size_t BH = out.size() / (p.Lq * p.dv);
+            std::vector<A> kt, vconv;
+            pack_kv(p, K.data->data(), V.data->data(), BH / p.group, kt, vconv);
+
+            const size_t qblocks = (p.Lq + BQ - 1) / BQ;
+            const size_t tasks = BH * qblocks;
+            const size_t threads = static_cast<size_t>(detail::get_num_threads());
+            T* dst = out.data->data();
+
+            // 查询块太少时把键切段，让所有线程都有活
+            size_t splits = 1;
+            if (tasks < threads && p.Lk >= 2 * BK)
+                splits = std::min((threads + tasks - 1) / tasks, (p.Lk + BK - 1) / BK);
+
+            if (splits == 1)
+            {
+#pragma omp parallel if (tasks > 1)
+                {
+                    Workspace<T> w(p.d);
+                    std::vector<A> o(BQ * p.dv);
+#pragma omp for schedule(dynamic)
+                    for (int64_t t = 0; t < static_cast<int64_t>(tasks); ++t)
+                    {
+                        const size_t bh = static_cast<size_t>(t) / qblocks;
+                        const size_t i0 = static_cast<size_t>(t) % qblocks * BQ;
+                        const size_t rows = std::min(BQ, p.Lq - i0);
+                        attend(p, bh, i0, rows, 0, p.key_end(i0, rows), w, o.data(), w.st.data());
+                        finish(o.data(), w.st.data(), rows, p.dv, dst + (bh * p.Lq + i0) * p.dv);
+                    }
+                }
+                return out;
+            }
+
+            // 键切段：各段写出未归一化的部分结果，再按 (max, sum) 合并
+            std::vector<A> part_o(tasks * splits * BQ * p.dv);
+            std::vector<OnlineSoftmax<T>> part_st(tasks * splits * BQ);
+#pragma omp parallel
+            {
+                Workspace<T> w(p.d);
+#pragma omp for schedule(dynamic)
+                for (int64_t u = 0; u < static_cast<int64_t>(tasks * splits); ++u)
+                {
+                    const size_t t = static_cast<size_t>(u) / splits, sp = static_cast<size_t>(u) % splits;
+                    const size_t bh = t / qblocks, i0 = t % qblocks * BQ;
+                    const size_t rows = std::min(BQ, p.Lq - i0);
+                    const size_t end = p.key_end(i0, rows);
+                    const size_t per = ((end + BK - 1) / BK + splits - 1) / splits * BK;
+                    const size_t j0 = std::min(end, sp * per), j1 = std::min(end, j0 + per);
+                    attend(p, bh, i0, rows, j0, j1, w, part_o.data() + static_cast<size_t>(u) * BQ * p.dv,
+                           part_st.data() + static_cast<size_t>(u) * BQ);
+                }
+            }
+#pragma omp parallel for schedule(static) if (tasks > 1)
+            for (int64_t t = 0; t < static_cast<int64_t>(tasks); ++t)
+            {
+                const size_t bh = static_cast<size_t>(t) / qblocks, i0 = static_cast<size_t>(t) % qblocks * BQ;
+                const size_t rows = std::min(BQ, p.Lq - i0);
+                A* o = part_o.data() + static_cast<size_t>(t) * splits * BQ * p.dv; // 合并到第 0 段
+                OnlineSoftmax<T>* st = part_st.data() + static_cast<size_t>(t) * splits * BQ;
+                for (size_t r = 0; r < rows; ++r)
+                {
+                    A m = st[r].max_value;
+                    for (size_t sp = 1; sp < splits; ++sp)
+                        m = std::max(m, st[sp * BQ + r].max_value);
+                    if (m == -std::numeric_limits<A>::infinity())
+                        continue; // 各段都没有可见键，sum 保持 0
+                    A* orow = o + r * p.dv;
+                    const A c0 = softmax_detail::vexp<A>(st[r].max_value - m);
+                    for (size_t x = 0; x < p.dv; ++x)
+                        orow[x] *= c0;
+                    for (size_t sp = 1; sp < splits; ++sp)
+                    {
+                        const A c = softmax_detail::vexp<A>(st[sp * BQ + r].max_value - m);
+                        const A* os = o + (sp * BQ + r) * p.dv;
+#pragma omp simd
+                        for (size_t x = 0; x < p.dv; ++x)
+                            orow[x] += c * os[x];
+                        st[r].merge(st[sp * BQ + r]);
+                    }
+                }
+                finish(o, st, rows, p.dv, dst + (bh * p.Lq + i0) * p.dv);
+            }
+            return out;
+        }
+
+        template <typename T>
+        Tensor<T> scaled_dot_product_attention(const Tensor<T>& Q, const Tensor<T>& K, const Tensor<T>& V,
+                                               bool causal = false, double scale = 0)
+        {
+            return scaled_dot_product_attention(Q, K, V, Tensor<T>(), causal, scale);
+        }
+
+    } // namespace blas
+} // namespace TensorN
+
+#endif // __BLAS_ATTENTION_HPP__
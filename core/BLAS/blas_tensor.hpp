@@ -4,6 +4,8 @@
 
 #include "../tensor.hpp"
 #include "../einsum.hpp"
+#include "../softmax.hpp"
+#include "../reduce.hpp"
 
 #ifndef TENSORN_HAS_OPENBLAS
 #if __has_include(<cblas.h>)
@@ -103,6 +105,262 @@ namespace TensorN
             }
         }
 
+        // ================================================================
+        // Epilogue
+        //
+        //   GEMM / 卷积写出一块输出后，趁它还在缓存里就地完成
+        //   v = act(v + bias + residual)，省去单独的激活 / 加法遍历
+        // ================================================================
+
+        enum class ActivationType
+        {
+            None,
+            ReLU,
+            Sigmoid,
+            Tanh,
+            GELU,
+            LeakyReLU,
+            ELU
+        };
+
+        namespace detail
+        {
+            template <typename T, typename F>
+            void activation_loop(T* __restrict o, size_t n, F f)
+            {
+#pragma omp simd
+                for (size_t i = 0; i < n; ++i)
+                    o[i] = f(o[i]);
+            }
+
+            template <typename T>
+            void apply_activation(T* o, size_t n, ActivationType act, T alpha)
+            {
+                switch (act)
+                {
+                case ActivationType::ReLU:
+                    activation_loop(o, n, [](T x) { return x > T(0) ? x : T(0); });
+                    break;
+                case ActivationType::Sigmoid:
+                    activation_loop(o, n, [](T x) { return T(1) / (T(1) + std::exp(-x)); });
+                    break;
+                case ActivationType::Tanh:
+                    activation_loop(o, n, [](T x) { return std::tanh(x); });
+                    break;
+                case ActivationType::GELU:
+                    activation_loop(o, n, [](T x) {
+                        T a = T(0.7978845608028654) * (x + T(0.044715) * x * x * x);
+                        return T(0.5) * x * (T(1) + std::tanh(a));
+                    });
+                    break;
+                case ActivationType::LeakyReLU:
+                    activation_loop(o, n, [alpha](T x) { return x > T(0) ? x : alpha * x; });
+                    break;
+                case ActivationType::ELU:
+                    activation_loop(o, n, [alpha](T x) { return x > T(0) ? x : alpha * (std::exp(x) - T(1)); });
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+
+        // bias 按输出通道（GEMM 的列、NCHW 的平面、NHWC 的最后一维）索引，
+        // residual 与输出同形状、同布局；两者为空表示不加
+        template <typename T>
+        struct Epilogue
+        {
+            const T* bias = nullptr;
+            const T* residual = nullptr;
+            ActivationType act = ActivationType::None;
+            T alpha = T(0);
+
+            bool empty() const { return !bias && !residual && act == ActivationType::None; }
+
+            // 一行 n 个不同通道的输出：o[j] 的通道为 ch0 + j，off 为 o 在整个输出中的偏移
+            void row(T* o, size_t n, size_t off, size_t ch0) const
+            {
+                if (bias)
+                {
+                    const T* b = bias + ch0;
+#pragma omp simd
+                    for (size_t j = 0; j < n; ++j)
+                        o[j] += b[j];
+                }
+                finish(o, n, off);
+            }
+
+            // 同一通道 ch 的 n 个连续输出
+            void span(T* o, size_t n, size_t off, size_t ch) const
+            {
+                if (bias)
+                {
+                    const T b = bias[ch];
+#pragma omp simd
+                    for (size_t j = 0; j < n; ++j)
+                        o[j] += b;
+                }
+                finish(o, n, off);
+            }
+
+            // 不加 bias 的版本（bias 已由内核写入）
+            Epilogue without_bias() const
+            {
+                Epilogue e = *this;
+                e.bias = nullptr;
+                return e;
+            }
+
+        private:
+            void finish(T* o, size_t n, size_t off) const
+            {
+                if (residual)
+                {
+                    const T* r = residual + off;
+#pragma omp simd
+                    for (size_t j = 0; j < n; ++j)
+                        o[j] += r[j];
+                }
+                detail::apply_activation(o, n, act, alpha);
+            }
+        };
+
+        namespace detail
+        {
+            // 连续输出 [count, plane]，第 p 个平面的通道为 (first + p) % K
+            template <typename T>
+            void epilogue_planes(T* out, const Epilogue<T>& ep, size_t first, size_t count, size_t plane, size_t K)
+            {
+                if (ep.empty())
+                    return;
+                #pragma omp parallel for schedule(static)
+                for (int64_t p = 0; p < static_cast<int64_t>(count); ++p)
+                {
+                    const size_t q = first + static_cast<size_t>(p);
+                    ep.span(out + static_cast<size_t>(p) * plane, plane, q * plane, q % K);
+                }
+            }
+
+            // [rows, N] 输出（行距 ldc），第 i 行偏移 (first + i) * ldc
+            template <typename T>
+            void epilogue_rows(T* out, const Epilogue<T>& ep, size_t first, size_t rows, size_t N, size_t ldc)
+            {
+                if (ep.empty())
+                    return;
+                #pragma omp parallel for schedule(static)
+                for (int64_t i = 0; i < static_cast<int64_t>(rows); ++i)
+                {
+                    const size_t r = first + static_cast<size_t>(i);
+                    ep.row(out + static_cast<size_t>(i) * ldc, N, r * ldc, 0);
+                }
+            }
+
+#if TENSORN_HAS_OPENBLAS
+            // C[M, N] = A[M, K] * op(B)，op(B) = trans ? B^T ([N, K]) : B ([K, N])；
+            // 按行块调用 GEMM，每块写完立刻做 epilogue（块约 256 KB，仍在 L2 中）
+            template <typename T>
+            void gemm_epilogue(size_t M, size_t N, size_t K, const T* A, const T* B, bool trans,
+                               T* C, const Epilogue<T>& ep)
+            {
+                const size_t rows = ep.empty() ? M
+                                  : std::max<size_t>(32, (size_t(256) << 10) / (sizeof(T) * std::max<size_t>(N, 1)));
+                const auto tb = trans ? CblasTrans : CblasNoTrans;
+                const int ldb = static_cast<int>(trans ? K : N);
+                for (size_t m0 = 0; m0 < M; m0 += rows)
+                {
+                    const size_t mb = std::min(rows, M - m0);
+                    const T* a = A + m0 * K;
+                    T* c = C + m0 * N;
+                    if constexpr (std::is_same_v<T, float>)
+                        cblas_sgemm(CblasRowMajor, CblasNoTrans, tb, static_cast<int>(mb), static_cast<int>(N),
+                            static_cast<int>(K), 1.0f, a, static_cast<int>(K), B, ldb, 0.0f, c, static_cast<int>(N));
+                    else
+                        cblas_dgemm(CblasRowMajor, CblasNoTrans, tb, static_cast<int>(mb), static_cast<int>(N),
+                            static_cast<int>(K), 1.0, a, static_cast<int>(K), B, ldb, 0.0, c, static_cast<int>(N));
+                    epilogue_rows(c, ep, m0, mb, N, N);
+                }
+            }
+#endif
+        }
+
+        // ================================================================
+        // Linear
+        //
+        //   y = x * W^T + bias，W 为 [N, K]（与 PyTorch nn.Linear 相同），
+        //   x 为 [..., K]，前导维展平成行，输出 [..., N]；bias 为空表示无偏置
+        // ================================================================
+
+        namespace detail
+        {
+            template <typename T>
+            size_t linear_rows(const Tensor<T>& x, const Tensor<T>& bias, size_t K, size_t N)
+            {
+                if (x.shape().empty() || x.shape().back() != K)
+                    TENSOR_THROW("linear: last dimension of input must match in_features");
+                if (bias.size() != 0 && (bias.shape().size() != 1 || bias.shape()[0] != N))
+                    TENSOR_THROW("linear: bias must be [out_features]");
+                size_t M = 1;
+                for (size_t i = 0; i + 1 < x.shape().size(); ++i)
+                    M *= x.shape()[i];
+                return M;
+            }
+
+            template <typename T>
+            std::vector<size_t> linear_shape(const Tensor<T>& x, size_t N)
+            {
+                std::vector<size_t> shape = x.shape();
+                shape.back() = N;
+                return shape;
+            }
+
+            // post 提供 residual / 激活，bias 取自 bias 张量
+            template <typename T>
+            Tensor<T> linear_impl(const Tensor<T>& x, const Tensor<T>& weight, const Tensor<T>& bias,
+                                  Epilogue<T> post)
+            {
+                if (weight.shape().size() != 2)
+                    TENSOR_THROW("linear: weight must be [out_features, in_features]");
+                const size_t N = weight.shape()[0], K = weight.shape()[1];
+                const size_t M = linear_rows(x, bias, K, N);
+                post.bias = bias.size() != 0 ? bias.data->data() : nullptr;
+                Tensor<T> y(linear_shape(x, N));
+                if (M == 0 || N == 0)
+                    return y;
+                if (K == 0)
+                {
+                    epilogue_rows(y.data->data(), post, 0, M, N, N);
+                    return y;
+                }
+
+#if TENSORN_HAS_OPENBLAS
+                if constexpr (is_blas_type<T>::value)
+                {
+                    gemm_epilogue(M, N, K, x.data->data(), weight.data->data(), true, y.data->data(), post);
+                    return y;
+                }
+                else
+#endif
+                {
+                    Tensor<T> x2 = x.reshape({M, K});
+                    Tensor<T> r = einsum<T>("ij,kj->ik", x2, weight).tensor;
+                    epilogue_rows(r.data->data(), post, 0, M, N, N);
+                    return r.reshape(linear_shape(x, N));
+                }
+            }
+        }
+
+        template <typename T>
+        Tensor<T> linear(const Tensor<T>& x, const Tensor<T>& weight, const Tensor<T>& bias)
+        {
+            return detail::linear_impl(x, weight, bias, Epilogue<T>{});
+        }
+
+        template <typename T>
+        Tensor<T> linear(const Tensor<T>& x, const Tensor<T>& weight)
+        {
+            return linear(x, weight, Tensor<T>());
+        }
+
         // ================================================================
         // Batched Matrix Multiplication
         // ================================================================
@@ -299,9 +557,12 @@ namespace TensorN
                 return C;
             }
 #endif
+            const T* a = A.data->data();
+            const T* b = B.data->data();
+            T* c = C.data->data();
             for (size_t i = 0; i < m; ++i)
                 for (size_t j = 0; j < n; ++j)
-                    C[{i, j}] = A[i] * B[j];
+                    c[i * n + j] = a[i] * b[j];
             return C;
         }
 
@@ -338,50 +599,20 @@ namespace TensorN
         // Sum / Mean
         // ================================================================
 
+        // 规约统一走 reduce.hpp：宽类型累加，按数据布局选择连续 / 跨步策略
+        template <typename T>
+        T sum(const Tensor<T>& A) { return reduce(A, {}, false, reducers::Sum{})[0]; }
+
         template <typename T>
-        T sum(const Tensor<T>& A)
+        Tensor<T> sum(const Tensor<T>& A, int axis)
         {
-            T result = T(0);
-            const T* __restrict src = A.data->data();
-            size_t n = A.size();
-            #pragma omp parallel for reduction(+:result) schedule(static)
-            for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) result += src[i];
-            return result;
+            return reduce(A, {axis}, false, reducers::Sum{});
         }
 
         template <typename T>
-        Tensor<T> sum(const Tensor<T>& A, size_t axis)
+        Tensor<T> sum(const Tensor<T>& A, const std::vector<int>& axes, bool keepdims = false)
         {
-            const auto& shape = A.shape();
-            if (axis >= shape.size())
-                TENSOR_THROW("Axis out of range");
-
-            std::vector<size_t> out_shape;
-            for (size_t d = 0; d < shape.size(); ++d)
-                if (d != axis) out_shape.push_back(shape[d]);
-
-            Tensor<T> result(out_shape);
-            std::fill(result.data->begin(), result.data->end(), T(0));
-
-            size_t outer = 1, reduce_dim = shape[axis], inner = 1;
-            for (size_t d = 0; d < axis; ++d) outer *= shape[d];
-            for (size_t d = axis + 1; d < shape.size(); ++d) inner *= shape[d];
-
-            const T* __restrict src = A.data->data();
-            T* __restrict dst = result.data->data();
-
-            #pragma omp parallel for schedule(static)
-            for (int64_t oi = 0; oi < static_cast<int64_t>(outer * inner); ++oi)
-            {
-                size_t o = static_cast<size_t>(oi) / inner;
-                size_t i = static_cast<size_t>(oi) % inner;
-                T s = T(0);
-                for (size_t r = 0; r < reduce_dim; ++r)
-                    s += src[o * reduce_dim * inner + r * inner + i];
-                dst[o * inner + i] = s;
-            }
-
-            return result;
+            return reduce(A, axes, keepdims, reducers::Sum{});
         }
 
         template <typename T>
@@ -420,11 +651,36 @@ namespace TensorN
         T mean(const Tensor<T>& A) { return blas::sum(A) / static_cast<T>(A.size()); }
 
         template <typename T>
-        Tensor<T> mean(const Tensor<T>& A, size_t axis)
+        Tensor<T> mean(const Tensor<T>& A, int axis)
+        {
+            return reduce(A, {axis}, false, reducers::Mean{});
+        }
+
+        template <typename T>
+        Tensor<T> mean(const Tensor<T>& A, const std::vector<int>& axes, bool keepdims = false)
+        {
+            return reduce(A, axes, keepdims, reducers::Mean{});
+        }
+
+        template <typename T>
+        T prod(const Tensor<T>& A) { return reduce(A, {}, false, reducers::Prod{})[0]; }
+
+        template <typename T>
+        Tensor<T> prod(const Tensor<T>& A, const std::vector<int>& axes, bool keepdims = false)
+        {
+            return reduce(A, axes, keepdims, reducers::Prod{});
+        }
+
+        template <typename T>
+        Tensor<T> logsumexp(const Tensor<T>& A, const std::vector<int>& axes, bool keepdims = false)
+        {
+            return reduce(A, axes, keepdims, reducers::LogSumExp{});
+        }
+
+        template <typename T>
+        Tensor<T> norm(const Tensor<T>& A, const std::vector<int>& axes, bool keepdims = false, double p = 2)
         {
-            Tensor<T> s = blas::sum(A, axis);
-            scal(T(1) / static_cast<T>(A.shape()[axis]), s);
-            return s;
+            return reduce_norm(A, axes, keepdims, p);
         }
 
         // ================================================================
@@ -437,6 +693,18 @@ namespace TensorN
         template <typename T>
         T min(const Tensor<T>& A) { return *std::min_element(A.data->begin(), A.data->end()); }
 
+        template <typename T>
+        Tensor<T> max(const Tensor<T>& A, const std::vector<int>& axes, bool keepdims = false)
+        {
+            return reduce(A, axes, keepdims, reducers::Max{});
+        }
+
+        template <typename T>
+        Tensor<T> min(const Tensor<T>& A, const std::vector<int>& axes, bool keepdims = false)
+        {
+            return reduce(A, axes, keepdims, reducers::Min{});
+        }
+
         // ================================================================
         // Trace
         // ================================================================
@@ -446,8 +714,10 @@ namespace TensorN
         {
             if (A.shape().size() != 2 || A.shape()[0] != A.shape()[1])
                 TENSOR_THROW("trace requires a square matrix");
+            const size_t n = A.shape()[0];
+            const T* a = A.data->data();
             T result = T(0);
-            for (size_t i = 0; i < A.shape()[0]; ++i) result += A[{i, i}];
+            for (size_t i = 0; i < n; ++i) result += a[i * n + i];
             return result;
         }
 
@@ -474,21 +744,25 @@ namespace TensorN
         // Variance / Stddev
         // ================================================================
 
+        // 单遍 Welford / Chan 合并（见 reduce.hpp）
+        template <typename T>
+        T var(const Tensor<T>& A) { return reduce(A, {}, false, reducers::Variance{})[0]; }
+
         template <typename T>
-        T var(const Tensor<T>& A)
+        Tensor<T> var(const Tensor<T>& A, const std::vector<int>& axes, bool keepdims = false, double ddof = 0)
         {
-            T m = blas::mean(A);
-            T sum_sq = T(0);
-            const T* __restrict src = A.data->data();
-            size_t n = A.size();
-            #pragma omp parallel for reduction(+:sum_sq) schedule(static)
-            for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) { T d = src[i] - m; sum_sq += d * d; }
-            return sum_sq / static_cast<T>(A.size());
+            return reduce(A, axes, keepdims, reducers::Variance(ddof));
         }
 
         template <typename T>
         T stddev(const Tensor<T>& A) { return std::sqrt(var(A)); }
 
+        template <typename T>
+        Tensor<T> stddev(const Tensor<T>& A, const std::vector<int>& axes, bool keepdims = false, double ddof = 0)
+        {
+            return reduce(A, axes, keepdims, reducers::StdDev(ddof));
+        }
+
         // ================================================================
         // Diag / DiagMatrix
         // ================================================================
@@ -500,7 +774,9 @@ namespace TensorN
                 TENSOR_THROW("diag requires a square matrix");
             size_t n = A.shape()[0];
             Tensor<T> result({n});
-            for (size_t i = 0; i < n; ++i) result[i] = A[{i, i}];
+            const T* a = A.data->data();
+            T* r = result.data->data();
+            for (size_t i = 0; i < n; ++i) r[i] = a[i * n + i];
             return result;
         }
 
@@ -511,7 +787,9 @@ namespace TensorN
                 TENSOR_THROW("diag_matrix requires a 1D tensor");
             size_t n = v.shape()[0];
             Tensor<T> result({n, n});
-            for (size_t i = 0; i < n; ++i) result[{i, i}] = v[i];
+            const T* src = v.data->data();
+            T* r = result.data->data();
+            for (size_t i = 0; i < n; ++i) r[i * n + i] = src[i];
             return result;
         }
 
@@ -581,9 +859,13 @@ namespace TensorN
             else
 #endif
             {
-                for (size_t i = 0; i < A.shape()[0]; ++i) {
+                const size_t m = A.shape()[0], n = A.shape()[1];
+                const T* a = A.data->data();
+                const T* yp = y.data->data();
+                for (size_t i = 0; i < m; ++i) {
+                    const T* row = a + i * n;
                     T s = T(0);
-                    for (size_t j = 0; j < A.shape()[1]; ++j) s += A[{i, j}] * y[j];
+                    for (size_t j = 0; j < n; ++j) s += row[j] * yp[j];
                     temp[i] = s;
                 }
             }
@@ -599,6 +881,7 @@ namespace TensorN
         Tensor<T> apply(const Tensor<T>& A, Func func)
         {
             Tensor<T> result(A.shape());
+            result.set_layout(A.layout());
             const T* __restrict src = A.data->data();
             T* __restrict dst = result.data->data();
             size_t n = A.size();
@@ -689,67 +972,17 @@ namespace TensorN
         template <typename T>
         Tensor<T> softmax(const Tensor<T>& A, int axis = -1)
         {
-            size_t ndim = A.shape().size();
-            if (axis < 0) axis = static_cast<int>(ndim) + axis;
-            if (axis < 0 || static_cast<size_t>(axis) >= ndim)
-                TENSOR_THROW("Softmax axis out of range");
-
             Tensor<T> result(A.shape());
+            softmax_detail::softmax_nd(A, axis, false, result);
+            return result;
+        }
 
-            if (ndim == 1) {
-                T max_val = blas::max(A);
-                T sum = T(0);
-                T* __restrict dst = result.data->data();
-                const T* __restrict src = A.data->data();
-                size_t n = A.size();
-                for (size_t i = 0; i < n; ++i) {
-                    dst[i] = std::exp(src[i] - max_val);
-                    sum += dst[i];
-                }
-                #pragma omp parallel for schedule(static)
-                for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) dst[i] /= sum;
-                return result;
-            }
-
-            if (ndim == 2) {
-                size_t rows = A.shape()[0], cols = A.shape()[1];
-                const T* __restrict src = A.data->data();
-                T* __restrict dst = result.data->data();
-                if (axis == 1) {
-                    #pragma omp parallel for schedule(static)
-                    for (int64_t r = 0; r < static_cast<int64_t>(rows); ++r) {
-                        T max_val = src[r * cols];
-                        for (size_t c = 1; c < cols; ++c)
-                            if (src[r * cols + c] > max_val) max_val = src[r * cols + c];
-                        T sum = T(0);
-                        for (size_t c = 0; c < cols; ++c) {
-                            dst[r * cols + c] = std::exp(src[r * cols + c] - max_val);
-                            sum += dst[r * cols + c];
-                        }
-                        for (size_t c = 0; c < cols; ++c)
-                            dst[r * cols + c] /= sum;
-                    }
-                    return result;
-                }
-                if (axis == 0) {
-                    #pragma omp parallel for schedule(static)
-                    for (int64_t c = 0; c < static_cast<int64_t>(cols); ++c) {
-                        T max_val = src[c];
-                        for (size_t r = 1; r < rows; ++r)
-                            if (src[r * cols + c] > max_val) max_val = src[r * cols + c];
-                        T sum = T(0);
-                        for (size_t r = 0; r < rows; ++r) {
-                            dst[r * cols + c] = std::exp(src[r * cols + c] - max_val);
-                            sum += dst[r * cols + c];
-                        }
-                        for (size_t r = 0; r < rows; ++r)
-                            dst[r * cols + c] /= sum;
-                    }
-                    return result;
-                }
-            }
-
-            TENSOR_THROW("Softmax: only 1D/2D supported");
+        template <typename T>
+        Tensor<T> log_softmax(const Tensor<T>& A, int axis = -1)
+        {
+            Tensor<T> result(A.shape());
+            softmax_detail::softmax_nd(A, axis, true, result);
+            return result;
         }
 
         // ================================================================
@@ -757,7 +990,7 @@ namespace TensorN
         // ================================================================
 
         template <typename T>
-        Tensor<int64_t> argmax(const Tensor<T>& A, int axis = -1)
+        Tensor<int64_t> argmax(const Tensor<T>& A, int axis = -1, bool keepdims = false)
         {
             const auto& shape = A.shape();
             size_t ndim = shape.size();
@@ -772,6 +1005,7 @@ namespace TensorN
             std::vector<size_t> out_shape;
             for (size_t d = 0; d < ndim; ++d)
                 if (d != static_cast<size_t>(axis)) out_shape.push_back(shape[d]);
+                else if (keepdims) out_shape.push_back(1);
 
             Tensor<int64_t> result(out_shape);
             const T* __restrict src = A.data->data();
@@ -793,7 +1027,7 @@ namespace TensorN
         }
 
         template <typename T>
-        Tensor<int64_t> argmin(const Tensor<T>& A, int axis = -1)
+        Tensor<int64_t> argmin(const Tensor<T>& A, int axis = -1, bool keepdims = false)
         {
             const auto& shape = A.shape();
             size_t ndim = shape.size();
@@ -808,6 +1042,7 @@ namespace TensorN
             std::vector<size_t> out_shape;
             for (size_t d = 0; d < ndim; ++d)
                 if (d != static_cast<size_t>(axis)) out_shape.push_back(shape[d]);
+                else if (keepdims) out_shape.push_back(1);
 
             Tensor<int64_t> result(out_shape);
             const T* __restrict src = A.data->data();
@@ -864,231 +1099,6 @@ namespace TensorN
             return result;
         }
 
-        // ================================================================
-        // 2D Convolution
-        // ================================================================
-
-        namespace detail
-        {
-            template <typename T>
-            void im2col(const T* input, size_t C, size_t H, size_t W,
-                        size_t kH, size_t kW, int stride, int padding,
-                        size_t oH, size_t oW, T* col)
-            {
-                size_t col_row_size = C * kH * kW;
-                #pragma omp parallel for schedule(static)
-                for (int64_t oh = 0; oh < static_cast<int64_t>(oH); ++oh)
-                {
-                    for (size_t ow = 0; ow < oW; ++ow)
-                    {
-                        T* col_row = col + (oh * oW + ow) * col_row_size;
-                        size_t col_idx = 0;
-                        for (size_t c = 0; c < C; ++c)
-                            for (size_t kh = 0; kh < kH; ++kh)
-                                for (size_t kw = 0; kw < kW; ++kw)
-                                {
-                                    int ih = static_cast<int>(oh * stride + kh) - padding;
-                                    int iw = static_cast<int>(ow * stride + kw) - padding;
-                                    if (ih >= 0 && ih < static_cast<int>(H) &&
-                                        iw >= 0 && iw < static_cast<int>(W))
-                                        col_row[col_idx] = input[(c * H + ih) * W + iw];
-                                    else
-                                        col_row[col_idx] = T(0);
-                                    ++col_idx;
-                                }
-                    }
-                }
-            }
-
-            template <typename T>
-            void col2im(const T* col, size_t C, size_t H, size_t W,
-                        size_t kH, size_t kW, int stride, int padding,
-                        size_t oH, size_t oW, T* input)
-            {
-                size_t input_size = C * H * W;
-                std::memset(input, 0, input_size * sizeof(T));
-                size_t col_row_size = C * kH * kW;
-
-                for (size_t oh = 0; oh < oH; ++oh)
-                    for (size_t ow = 0; ow < oW; ++ow)
-                    {
-                        const T* col_row = col + (oh * oW + ow) * col_row_size;
-                        size_t col_idx = 0;
-                        for (size_t c = 0; c < C; ++c)
-                            for (size_t kh = 0; kh < kH; ++kh)
-                                for (size_t kw = 0; kw < kW; ++kw)
-                                {
-                                    int ih = static_cast<int>(oh * stride + kh) - padding;
-                                    int iw = static_cast<int>(ow * stride + kw) - padding;
-                                    if (ih >= 0 && ih < static_cast<int>(H) &&
-                                        iw >= 0 && iw < static_cast<int>(W))
-                                        input[(c * H + ih) * W + iw] += col_row[col_idx];
-                                    ++col_idx;
-                                }
-                    }
-            }
-        }
-
-        template <typename T>
-        Tensor<T> conv2d(const Tensor<T>& input, const Tensor<T>& weight,
-                         const Tensor<T>& bias, int stride = 1, int padding = 0)
-        {
-            if (input.shape().size() != 4 || weight.shape().size() != 4)
-                TENSOR_THROW("conv2d: input and weight must be 4D");
-            if (bias.shape().size() != 1)
-                TENSOR_THROW("conv2d: bias must be 1D");
-
-            size_t N = input.shape()[0], C = input.shape()[1];
-            size_t H = input.shape()[2], W = input.shape()[3];
-            size_t K = weight.shape()[0];
-            size_t kH = weight.shape()[2], kW = weight.shape()[3];
-
-            int64_t oH = static_cast<int64_t>((H + 2 * padding - kH) / stride) + 1;
-            int64_t oW = static_cast<int64_t>((W + 2 * padding - kW) / stride) + 1;
-
-            if (oH <= 0 || oW <= 0)
-                TENSOR_THROW("conv2d: invalid output dimensions");
-
-            Tensor<T> output({N, K, static_cast<size_t>(oH), static_cast<size_t>(oW)});
-
-            size_t col_size = C * kH * kW * oH * oW;
-
-#if TENSORN_HAS_OPENBLAS
-            if constexpr (detail::is_blas_type<T>::value)
-            {
-                std::vector<T> col(col_size);
-                const T* weight_ptr = weight.data->data();
-                T* output_ptr = output.data->data();
-                const T* bias_ptr = bias.data->data();
-
-                int M = static_cast<int>(K);
-                int Nn = static_cast<int>(oH * oW);
-                int Kk = static_cast<int>(C * kH * kW);
-
-                for (size_t n = 0; n < N; ++n)
-                {
-                    const T* input_batch = input.data->data() + n * C * H * W;
-                    T* output_batch = output_ptr + n * K * oH * oW;
-
-                    detail::im2col(input_batch, C, H, W, kH, kW, stride, padding,
-                                   static_cast<size_t>(oH), static_cast<size_t>(oW), col.data());
-
-                    if constexpr (std::is_same_v<T, float>)
-                        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
-                            M, Nn, Kk, 1.0f, weight_ptr, Kk,
-                            col.data(), Nn, 0.0f, output_batch, Nn);
-                    else
-                        cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
-                            M, Nn, Kk, 1.0, weight_ptr, Kk,
-                            col.data(), Nn, 0.0, output_batch, Nn);
-
-                    #pragma omp parallel for schedule(static)
-                    for (int64_t k = 0; k < static_cast<int64_t>(K); ++k)
-                        for (int64_t hw = 0; hw < static_cast<int64_t>(oH * oW); ++hw)
-                            output_batch[k * oH * oW + hw] += bias_ptr[k];
-                }
-                return output;
-            }
-            else
-#endif
-            {
-                const T* __restrict input_ptr = input.data->data();
-                const T* __restrict weight_ptr = weight.data->data();
-                const T* __restrict bias_ptr = bias.data->data();
-                T* __restrict output_ptr = output.data->data();
-
-                #pragma omp parallel for schedule(static)
-                for (int64_t n = 0; n < static_cast<int64_t>(N); ++n)
-                    for (size_t k = 0; k < K; ++k)
-                        for (size_t oh = 0; oh < static_cast<size_t>(oH); ++oh)
-                            for (size_t ow = 0; ow < static_cast<size_t>(oW); ++ow) {
-                                T val = bias_ptr[k];
-                                for (size_t c = 0; c < C; ++c)
-                                    for (size_t kh = 0; kh < kH; ++kh)
-                                        for (size_t kw = 0; kw < kW; ++kw) {
-                                            int64_t ih = static_cast<int64_t>(oh * stride + kh) - padding;
-                                            int64_t iw = static_cast<int64_t>(ow * stride + kw) - padding;
-                                            if (ih >= 0 && ih < static_cast<int64_t>(H) &&
-                                                iw >= 0 && iw < static_cast<int64_t>(W))
-                                                val += input_ptr[((n * C + c) * H + ih) * W + iw]
-                                                     * weight_ptr[((k * C + c) * kH + kh) * kW + kw];
-                                        }
-                                output_ptr[((n * K + k) * oH + oh) * oW + ow] = val;
-                            }
-                return output;
-            }
-        }
-
-        template <typename T>
-        Tensor<T> conv2d(const Tensor<T>& input, const Tensor<T>& weight,
-                         int stride = 1, int padding = 0)
-        {
-            if (weight.shape().size() != 4)
-                TENSOR_THROW("conv2d: weight must be 4D");
-            Tensor<T> bias({weight.shape()[0]});
-            return conv2d(input, weight, bias, stride, padding);
-        }
-
-        // ================================================================
-        // Transposed 2D Convolution
-        // ================================================================
-
-        template <typename T>
-        Tensor<T> conv_transpose2d(const Tensor<T>& input, const Tensor<T>& weight,
-                                   const Tensor<T>& bias, int stride = 1, int padding = 0)
-        {
-            if (input.shape().size() != 4 || weight.shape().size() != 4)
-                TENSOR_THROW("conv_transpose2d: input and weight must be 4D");
-            if (bias.shape().size() != 1)
-                TENSOR_THROW("conv_transpose2d: bias must be 1D");
-
-            size_t N = input.shape()[0], C = input.shape()[1];
-            size_t H = input.shape()[2], W = input.shape()[3];
-            size_t K = weight.shape()[0];
-            size_t kH = weight.shape()[2], kW = weight.shape()[3];
-
-            size_t oH = (H - 1) * stride + kH - 2 * padding;
-            size_t oW = (W - 1) * stride + kW - 2 * padding;
-
-            if (oH == 0 || oW == 0)
-                TENSOR_THROW("conv_transpose2d: invalid output dimensions");
-
-            Tensor<T> output({N, K, oH, oW});
-            output.zero_();
-
-            const T* __restrict input_ptr = input.data->data();
-            const T* __restrict weight_ptr = weight.data->data();
-            T* __restrict output_ptr = output.data->data();
-
-            #pragma omp parallel for schedule(static)
-            for (int64_t n = 0; n < static_cast<int64_t>(N); ++n)
-                for (size_t c = 0; c < C; ++c)
-                    for (size_t h = 0; h < H; ++h)
-                        for (size_t w = 0; w < W; ++w) {
-                            T in_val = input_ptr[((n * C + c) * H + h) * W + w];
-                            for (size_t k = 0; k < K; ++k)
-                                for (size_t kh = 0; kh < kH; ++kh)
-                                    for (size_t kw = 0; kw < kW; ++kw) {
-                                        int64_t oh = static_cast<int64_t>(h * stride + kh) - padding;
-                                        int64_t ow = static_cast<int64_t>(w * stride + kw) - padding;
-                                        if (oh >= 0 && oh < static_cast<int64_t>(oH) &&
-                                            ow >= 0 && ow < static_cast<int64_t>(oW))
-                                            output_ptr[((n * K + k) * oH + oh) * oW + ow]
-                                                += in_val * weight_ptr[((k * C + c) * kH + kh) * kW + kw];
-                                    }
-                        }
-
-            const T* __restrict bias_ptr = bias.data->data();
-            #pragma omp parallel for schedule(static)
-            for (int64_t n = 0; n < static_cast<int64_t>(N); ++n)
-                for (size_t k = 0; k < K; ++k)
-                    for (size_t oh = 0; oh < oH; ++oh)
-                        for (size_t ow = 0; ow < oW; ++ow)
-                            output_ptr[((n * K + k) * oH + oh) * oW + ow] += bias_ptr[k];
-
-            return output;
-        }
-
     } // namespace blas
 } // namespace TensorN
 
@@ -0,0 +1,1156 @@
+#pragma once
+#ifndef __BLAS_CONVOLUTION_HPP__
+#define __BLAS_CONVOLUTION_HPP__
+
+// ============================================================================
+// BLAS 后端卷积（NCHW）
+//
+//   blas::conv2d 按形状在以下算法中选择（ConvAlgo::Auto），也可以显式指定：
+//     * Direct       原生直接卷积（conv.hpp），通道很少或计算量很小时使用
+//     * Im2colGemm   im2col 展开为 [C*kH*kW, 列] 后与权重做 GEMM。小特征图把多张
+//                    图像拼进一次 GEMM，大特征图按输出行分块，使展开矩阵不超过
+//                    set_conv_workspace_limit() 设定的上限（默认 32 MB）；
+//                    1x1、步长 1、无填充时直接把输入当作展开矩阵
+//     * Winograd2x2  F(2x2, 3x3)，乘法次数为 im2col 的 1/2.25
+//     * Winograd4x4  F(4x4, 3x3)，乘法次数为 im2col 的 1/4（数值误差略大）
+//     * FFT          逐通道 2D FFT，在频域按通道累加后逆变换；适合大卷积核
+//   Winograd 只用于 3x3、步长 1。Winograd 把所有 tile 分块处理，每块的变换
+//   缓冲不超过 WORKSPACE_BYTES，块内按 (alpha^2) 个频点各做一次 GEMM。
+//
+//   分组、膨胀与非对称填充通过 ConvParams 给出：im2col 逐组展开，Winograd / FFT
+//   要求 groups == 1 且 dilation == 1；深度卷积（groups == C）在 Auto 下使用
+//   conv.hpp 中的原生深度卷积内核。
+//
+//   ConvAlgo::Autotune（或 set_conv_autotune(true) 之后的 Auto）对每种形状
+//   把可用的算法各运行一次，记录最快者，同形状的后续调用直接使用。
+//   float / double 以外的类型始终使用 Direct。
+// ============================================================================
+
+#include "blas_tensor.hpp"
+#include "../operations.hpp"
+#include "../memory_pool.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace TensorN
+{
+    namespace blas
+    {
+        enum class ConvAlgo
+        {
+            Auto,
+            Direct,
+            Im2colGemm,
+            Winograd2x2,
+            Winograd4x4,
+            FFT,
+            Autotune
+        };
+
+        inline const char* conv_algo_name(ConvAlgo algo)
+        {
+            switch (algo)
+            {
+            case ConvAlgo::Auto: return "auto";
+            case ConvAlgo::Direct: return "direct";
+            case ConvAlgo::Im2colGemm: return "im2col-gemm";
+            case ConvAlgo::Winograd2x2: return "winograd-2x2";
+            case ConvAlgo::Winograd4x4: return "winograd-4x4";
+            case ConvAlgo::FFT: return "fft";
+            case ConvAlgo::Autotune: return "autotune";
+            }
+            return "unknown";
+        }
+
+        namespace conv_detail
+        {
+            constexpr size_t WORKSPACE_BYTES = size_t(8) << 20;  // Winograd 每块变换缓冲上限
+            constexpr size_t DEFAULT_IM2COL_BYTES = size_t(32) << 20;
+            constexpr size_t FFT_MAX_BYTES = size_t(512) << 20;  // FFT 频域缓冲上限
+
+            // pad_h / pad_w 为起始侧填充，末尾侧填充已体现在 oH / oW 中
+            struct ConvShape
+            {
+                size_t N, C, H, W, K, kH, kW, oH, oW;
+                int stride_h, stride_w, pad_h, pad_w;
+                int dil_h = 1, dil_w = 1;
+                size_t groups = 1;
+            };
+
+            inline std::atomic<size_t>& workspace_bytes()
+            {
+                static std::atomic<size_t> bytes{DEFAULT_IM2COL_BYTES};
+                return bytes;
+            }
+
+            inline size_t workspace_limit() { return workspace_bytes(); }
+
+            inline std::atomic<bool>& autotune_flag()
+            {
+                static std::atomic<bool> flag{false};
+                return flag;
+            }
+
+            // C(MxN) = A(MxK) * B(KxN) + beta * C，行主序；beta 只取 0 或 1
+            template <typename T>
+            void gemm(size_t M, size_t N, size_t K, const T* A, size_t lda,
+                      const T* B, size_t ldb, T* C, size_t ldc, T beta = T(0))
+            {
+#if TENSORN_HAS_OPENBLAS
+                if constexpr (std::is_same_v<T, float>)
+                {
+                    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
+                        static_cast<int>(M), static_cast<int>(N), static_cast<int>(K),
+                        1.0f, A, static_cast<int>(lda), B, static_cast<int>(ldb),
+                        beta, C, static_cast<int>(ldc));
+                    return;
+                }
+                else if constexpr (std::is_same_v<T, double>)
+                {
+                    cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
+                        static_cast<int>(M), static_cast<int>(N), static_cast<int>(K),
+                        1.0, A, static_cast<int>(lda), B, static_cast<int>(ldb),
+                        beta, C, static_cast<int>(ldc));
+                    return;
+                }
+#endif
+                #pragma omp parallel for schedule(static)
+                for (int64_t i = 0; i < static_cast<int64_t>(M); ++i)
+                {
+                    T* c = C + i * ldc;
+                    if (beta == T(0))
+                        std::fill(c, c + N, T(0));
+                    for (size_t k = 0; k < K; ++k)
+                    {
+                        const T a = A[i * lda + k];
+                        const T* b = B + k * ldb;
+                        for (size_t j = 0; j < N; ++j)
+                            c[j] += a * b[j];
+                    }
+                }
+            }
+
+            // 展开 nb 张连续图像的输出行 [row_begin, row_end)：
+            //   col[(c*kH + kh)*kW + kw][i*tile + (oh - row_begin)*oW + ow]，tile = 行数 * oW
+            // 可直接与权重 [K, C*kH*kW] 相乘。整张图像时即 [C*kH*kW, oH*oW]
+            template <typename T>
+            void im2col(const T* input, const ConvShape& s, size_t nb, size_t row_begin, size_t row_end, T* col)
+            {
+                const size_t rows = s.C * s.kH * s.kW, tile = (row_end - row_begin) * s.oW;
+                #pragma omp parallel for schedule(static)
+                for (int64_t ri = 0; ri < static_cast<int64_t>(rows * nb); ++ri)
+                {
+                    const size_t r = static_cast<size_t>(ri) / nb, i = static_cast<size_t>(ri) % nb;
+                    const size_t c = r / (s.kH * s.kW), kh = r / s.kW % s.kH, kw = r % s.kW;
+                    const T* ip = input + (i * s.C + c) * s.H * s.W;
+                    T* dst = col + (r * nb + i) * tile - row_begin * s.oW;
+                    size_t oh0, oh1, ow0, ow1;
+                    TensorN::detail::valid_range(s.oH, s.H, kh * s.dil_h, s.stride_h, s.pad_h, oh0, oh1);
+                    TensorN::detail::valid_range(s.oW, s.W, kw * s.dil_w, s.stride_w, s.pad_w, ow0, ow1);
+                    oh0 = std::min(std::max(oh0, row_begin), row_end);
+                    oh1 = std::max(std::min(oh1, row_end), oh0);
+                    std::fill(dst + row_begin * s.oW, dst + oh0 * s.oW, T(0));
+                    for (size_t oh = oh0; oh < oh1; ++oh)
+                    {
+                        T* drow = dst + oh * s.oW;
+                        const T* irow = ip + (oh * s.stride_h + kh * s.dil_h - s.pad_h) * s.W
+                                        + kw * s.dil_w - s.pad_w;
+                        std::fill(drow, drow + ow0, T(0));
+                        for (size_t ow = ow0; ow < ow1; ++ow)
+                            drow[ow] = irow[ow * s.stride_w];
+                        std::fill(drow + ow1, drow + s.oW, T(0));
+                    }
+                    std::fill(dst + oh1 * s.oW, dst + row_end * s.oW, T(0));
+                }
+            }
+
+            // im2col 的伴随：把一张图像输出行 [row_begin, row_end) 的 col（布局同 im2col，
+            // nb = 1）累加回 image。每个通道平面只由一个线程写入，没有竞争
+            template <typename T>
+            void col2im(const T* col, const ConvShape& s, size_t row_begin, size_t row_end, T* image)
+            {
+                const size_t tile = (row_end - row_begin) * s.oW;
+                #pragma omp parallel for schedule(static)
+                for (int64_t c = 0; c < static_cast<int64_t>(s.C); ++c)
+                {
+                    T* ip = image + static_cast<size_t>(c) * s.H * s.W;
+                    for (size_t kh = 0; kh < s.kH; ++kh)
+                        for (size_t kw = 0; kw < s.kW; ++kw)
+                        {
+                            const T* src = col + ((static_cast<size_t>(c) * s.kH + kh) * s.kW + kw) * tile
+                                           - row_begin * s.oW;
+                            size_t oh0, oh1, ow0, ow1;
+                            TensorN::detail::valid_range(s.oH, s.H, kh * s.dil_h, s.stride_h, s.pad_h, oh0, oh1);
+                            TensorN::detail::valid_range(s.oW, s.W, kw * s.dil_w, s.stride_w, s.pad_w, ow0, ow1);
+                            oh0 = std::max(oh0, row_begin);
+                            oh1 = std::min(oh1, row_end);
+                            for (size_t oh = oh0; oh < oh1; ++oh)
+                            {
+                                T* irow = ip + (oh * s.stride_h + kh * s.dil_h - s.pad_h) * s.W
+                                          + kw * s.dil_w - s.pad_w;
+                                const T* srow = src + oh * s.oW;
+                                for (size_t ow = ow0; ow < ow1; ++ow)
+                                    irow[ow * s.stride_w] += srow[ow];
+                            }
+                        }
+                }
+            }
+
+            // 每次 GEMM 处理的列数由工作区上限决定（col 为 Kk 行，批处理时另需 K 行的
+            // 输出暂存）：
+            //   * 一张图像放得下时，把 nb 张图像拼成一次 [K, nb*oH*oW] 的 GEMM，
+            //     结果再分发回各图像（nb = 1 时直接写输出）；
+            //   * 一张图像放不下时，按输出行分块，GEMM 以 ldc = oH*oW 直接写入输出。
+            // 分组卷积逐 (图像, 组) 展开该组的 Cg 个输入通道，与该组的 [Kg, Cg*kH*kW] 权重相乘。
+            // 每次 GEMM 写出的输出块随即做 epilogue（bias、residual、激活）
+            template <typename T>
+            void conv_im2col(const T* in, const T* wt, const Epilogue<T>& ep, const ConvShape& s, T* out)
+            {
+                const size_t G = s.groups, Cg = s.C / G, Kg = s.K / G;
+                const size_t Kk = Cg * s.kH * s.kW, npix = s.oH * s.oW;
+                const size_t in_img = s.C * s.H * s.W, out_img = s.K * npix;
+                if (s.kH == 1 && s.kW == 1 && s.stride_h == 1 && s.stride_w == 1 && s.pad_h == 0 && s.pad_w == 0 &&
+                    s.oH == s.H && s.oW == s.W)
+                {
+                    // 1x1：输入本身就是 [C, H*W] 的展开矩阵
+                    for (size_t n = 0; n < s.N; ++n)
+                        for (size_t g = 0; g < G; ++g)
+                        {
+                            gemm(Kg, npix, Kk, wt + g * Kg * Kk, Kk, in + n * in_img + g * Cg * npix, npix,
+                                 out + n * out_img + g * Kg * npix, npix);
+                            detail::epilogue_planes(out + n * out_img + g * Kg * npix, ep, n * s.K + g * Kg,
+                                                    Kg, npix, s.K);
+                        }
+                    return;
+                }
+
+                const size_t budget = workspace_limit() / sizeof(T);
+                const size_t max_cols = std::max(s.oW, budget / (Kk + s.K));
+                if (G == 1 && npix <= max_cols)
+                {
+                    const size_t nb = std::min(s.N, max_cols / npix);
+                    PooledBuffer<T> col(Kk * nb * npix), tmp(nb > 1 ? s.K * nb * npix : 0);
+                    for (size_t n0 = 0; n0 < s.N; n0 += nb)
+                    {
+                        const size_t cnt = std::min(nb, s.N - n0), cols = cnt * npix;
+                        im2col(in + n0 * in_img, s, cnt, 0, s.oH, col.data());
+                        if (cnt == 1)
+                        {
+                            gemm(s.K, cols, Kk, wt, Kk, col.data(), cols, out + n0 * out_img, npix);
+                            detail::epilogue_planes(out + n0 * out_img, ep, n0 * s.K, s.K, npix, s.K);
+                            continue;
+                        }
+                        gemm(s.K, cols, Kk, wt, Kk, col.data(), cols, tmp.data(), cols);
+                        #pragma omp parallel for schedule(static)
+                        for (int64_t ik = 0; ik < static_cast<int64_t>(cnt * s.K); ++ik)
+                        {
+                            const size_t i = static_cast<size_t>(ik) / s.K, k = static_cast<size_t>(ik) % s.K;
+                            T* dst = out + (n0 + i) * out_img + k * npix;
+                            std::copy_n(tmp.data() + k * cols + i * npix, npix, dst);
+                            ep.span(dst, npix, (n0 + i) * out_img + k * npix, k);
+                        }
+                    }
+                }
+                else
+                {
+                    ConvShape sg = s; // 单个组：Cg 个输入通道
+                    sg.C = Cg;
+                    const size_t rows = std::max<size_t>(1, std::min(s.oH, max_cols / s.oW));
+                    PooledBuffer<T> col(Kk * rows * s.oW);
+                    for (size_t n = 0; n < s.N; ++n)
+                        for (size_t g = 0; g < G; ++g)
+                            for (size_t r0 = 0; r0 < s.oH; r0 += rows)
+                            {
+                                const size_t r1 = std::min(s.oH, r0 + rows), cols = (r1 - r0) * s.oW;
+                                im2col(in + n * in_img + g * Cg * s.H * s.W, sg, 1, r0, r1, col.data());
+                                T* dst = out + n * out_img + g * Kg * npix + r0 * s.oW;
+                                gemm(Kg, cols, Kk, wt + g * Kg * Kk, Kk, col.data(), cols, dst, npix);
+                                if (ep.empty())
+                                    continue;
+                                #pragma omp parallel for schedule(static)
+                                for (int64_t k = 0; k < static_cast<int64_t>(Kg); ++k)
+                                {
+                                    const size_t off = static_cast<size_t>(k) * npix;
+                                    ep.span(dst + off, cols, static_cast<size_t>(dst - out) + off, g * Kg + static_cast<size_t>(k));
+                                }
+                            }
+                }
+            }
+
+            // ------------------------------------------------------------
+            // Winograd F(m x m, 3 x 3)：Y = A^T [(G g G^T) ⊙ (B^T d B)] A
+            // ------------------------------------------------------------
+            template <int M>
+            struct Winograd;
+
+            template <>
+            struct Winograd<2>
+            {
+                static constexpr int alpha = 4;
+                static constexpr double BT[4][4] = {
+                    {1, 0, -1, 0}, {0, 1, 1, 0}, {0, -1, 1, 0}, {0, 1, 0, -1}};
+                static constexpr double G[4][3] = {
+                    {1, 0, 0}, {0.5, 0.5, 0.5}, {0.5, -0.5, 0.5}, {0, 0, 1}};
+                static constexpr double AT[2][4] = {
+                    {1, 1, 1, 0}, {0, 1, -1, -1}};
+            };
+
+            template <>
+            struct Winograd<4>
+            {
+                static constexpr int alpha = 6;
+                static constexpr double BT[6][6] = {
+                    {4, 0, -5, 0, 1, 0},
+                    {0, -4, -4, 1, 1, 0},
+                    {0, 4, -4, -1, 1, 0},
+                    {0, -2, -1, 2, 1, 0},
+                    {0, 2, -1, -2, 1, 0},
+                    {0, 4, 0, -5, 0, 1}};
+                static constexpr double G[6][3] = {
+                    {1.0 / 4, 0, 0},
+                    {-1.0 / 6, -1.0 / 6, -1.0 / 6},
+                    {-1.0 / 6, 1.0 / 6, -1.0 / 6},
+                    {1.0 / 24, 1.0 / 12, 1.0 / 6},
+                    {1.0 / 24, -1.0 / 12, 1.0 / 6},
+                    {0, 0, 1}};
+                static constexpr double AT[4][6] = {
+                    {1, 1, 1, 1, 1, 0},
+                    {0, 1, -1, 2, -2, 0},
+                    {0, 1, 1, 4, 4, 0},
+                    {0, 1, -1, 8, -8, 1}};
+            };
+
+            // out[i][j][:] = sum_q A[i][q] * in[q][j][:]，跳过零系数，沿最后一维向量化
+            template <int R, int AL, size_t L, typename T>
+            inline void tile_transform(const double (&A)[R][AL], const T (&in)[AL][AL][L], T (&out)[R][AL][L])
+            {
+                for (int i = 0; i < R; ++i)
+                    for (int j = 0; j < AL; ++j)
+                    {
+                        T* o = out[i][j];
+                        #pragma omp simd
+                        for (size_t l = 0; l < L; ++l)
+                            o[l] = T(0);
+                        for (int q = 0; q < AL; ++q)
+                        {
+                            const T coef = static_cast<T>(A[i][q]);
+                            if (coef == T(0))
+                                continue;
+                            const T* x = in[q][j];
+                            #pragma omp simd
+                            for (size_t l = 0; l < L; ++l)
+                                o[l] += coef * x[l];
+                        }
+                    }
+            }
+
+            // 滤波器变换 U[a] = (G g G^T)[a]：alpha^2 个频点，每个频点是 K x C 矩阵。
+            // 只与权重有关，PackedWeight 可以缓存它
+            template <int M, typename T>
+            std::vector<T> winograd_filter(const T* wt, size_t K, size_t C)
+            {
+                using WG = Winograd<M>;
+                constexpr int AL = WG::alpha;
+                std::vector<T> U(static_cast<size_t>(AL * AL) * K * C);
+                #pragma omp parallel for schedule(static)
+                for (int64_t kc = 0; kc < static_cast<int64_t>(K * C); ++kc)
+                {
+                    const T* g = wt + static_cast<size_t>(kc) * 9;
+                    T tmp[AL][3];
+                    for (int i = 0; i < AL; ++i)
+                        for (int j = 0; j < 3; ++j)
+                            tmp[i][j] = T(WG::G[i][0]) * g[j] + T(WG::G[i][1]) * g[3 + j] + T(WG::G[i][2]) * g[6 + j];
+                    for (int i = 0; i < AL; ++i)
+                        for (int j = 0; j < AL; ++j)
+                            U[(i * AL + j) * K * C + static_cast<size_t>(kc)] =
+                                tmp[i][0] * T(WG::G[j][0]) + tmp[i][1] * T(WG::G[j][1]) + tmp[i][2] * T(WG::G[j][2]);
+                }
+                return U;
+            }
+
+            // U 为 winograd_filter<M> 的结果；为空时现场计算。每个 tile 的输出行写出后做 epilogue
+            template <int M, typename T>
+            void conv_winograd(const T* in, const T* wt, const Epilogue<T>& ep, const ConvShape& s, T* out,
+                               const T* U = nullptr)
+            {
+                using WG = Winograd<M>;
+                constexpr int AL = WG::alpha;
+                constexpr size_t AA = static_cast<size_t>(AL * AL);
+                constexpr size_t L = 16;
+                const size_t C = s.C, K = s.K;
+                const size_t th = (s.oH + M - 1) / M, tw = (s.oW + M - 1) / M;
+                const size_t per_img = th * tw, P = s.N * per_img;
+
+                std::vector<T> local;
+                if (U == nullptr)
+                {
+                    local = winograd_filter<M>(wt, K, C);
+                    U = local.data();
+                }
+
+                const size_t per_tile = AA * (C + K) * sizeof(T);
+                const size_t TB = std::min(P, std::max<size_t>(16, WORKSPACE_BYTES / per_tile));
+                PooledBuffer<T> V(AA * C * TB), Mo(AA * K * TB);
+
+                for (size_t p0 = 0; p0 < P; p0 += TB)
+                {
+                    const size_t nb = std::min(TB, P - p0);
+
+                    // 输入变换 V[a] = (B^T d B)[a]，每个频点是 C x nb 矩阵；
+                    // 一次处理 L 个相邻 tile，最内层沿 tile 方向向量化
+                    const size_t nlane = (nb + L - 1) / L;
+                    #pragma omp parallel for schedule(static)
+                    for (int64_t cl = 0; cl < static_cast<int64_t>(C * nlane); ++cl)
+                    {
+                        const size_t c = static_cast<size_t>(cl) / nlane, t0 = static_cast<size_t>(cl) % nlane * L;
+                        const size_t cnt = std::min(L, nb - t0);
+                        T d[AL][AL][L], tmp[AL][AL][L];
+                        for (size_t l = 0; l < L; ++l)
+                        {
+                            const size_t p = p0 + t0 + (l < cnt ? l : 0);
+                            const size_t n = p / per_img, ty = p % per_img / tw, tx = p % tw;
+                            const T* ip = in + (n * C + c) * s.H * s.W;
+                            const int64_t ih0 = static_cast<int64_t>(ty * M) - s.pad_h;
+                            const int64_t iw0 = static_cast<int64_t>(tx * M) - s.pad_w;
+                            for (int i = 0; i < AL; ++i)
+                            {
+                                const int64_t ih = ih0 + i;
+                                const bool row_ok = ih >= 0 && ih < static_cast<int64_t>(s.H);
+                                for (int j = 0; j < AL; ++j)
+                                {
+                                    const int64_t iw = iw0 + j;
+                                    d[i][j][l] = row_ok && iw >= 0 && iw < static_cast<int64_t>(s.W)
+                                                     ? ip[static_cast<size_t>(ih) * s.W + static_cast<size_t>(iw)] : T(0);
+                                }
+                            }
+                        }
+                        tile_transform<AL, AL, L>(WG::BT, d, tmp);
+                        for (int i = 0; i < AL; ++i)
+                            for (int j = 0; j < AL; ++j)
+                            {
+                                T v[L];
+                                #pragma omp simd
+                                for (size_t l = 0; l < L; ++l)
+                                    v[l] = T(0);
+                                for (int q = 0; q < AL; ++q)
+                                {
+                                    const T coef = static_cast<T>(WG::BT[j][q]);
+                                    if (coef == T(0))
+                                        continue;
+                                    #pragma omp simd
+                                    for (size_t l = 0; l < L; ++l)
+                                        v[l] += tmp[i][q][l] * coef;
+                                }
+                                T* dst = V.data() + ((i * AL + j) * C + c) * nb + t0;
+                                for (size_t l = 0; l < cnt; ++l)
+                                    dst[l] = v[l];
+                            }
+                    }
+
+                    // 逐频点 GEMM：Mo[a] (K x nb) = U[a] (K x C) * V[a] (C x nb)
+                    for (size_t a = 0; a < AA; ++a)
+                        gemm(K, nb, C, U + a * K * C, C, V.data() + a * C * nb, nb, Mo.data() + a * K * nb, nb);
+
+                    // 输出变换 Y = A^T m A，同样按 L 个 tile 一组
+                    #pragma omp parallel for schedule(static)
+                    for (int64_t kl = 0; kl < static_cast<int64_t>(K * nlane); ++kl)
+                    {
+                        const size_t k = static_cast<size_t>(kl) / nlane, t0 = static_cast<size_t>(kl) % nlane * L;
+                        const size_t cnt = std::min(L, nb - t0);
+                        T m[AL][AL][L], tmp[M][AL][L];
+                        for (int i = 0; i < AL; ++i)
+                            for (int j = 0; j < AL; ++j)
+                            {
+                                const T* src = Mo.data() + ((i * AL + j) * K + k) * nb + t0;
+                                for (size_t l = 0; l < L; ++l)
+                                    m[i][j][l] = l < cnt ? src[l] : T(0);
+                            }
+                        tile_transform<M, AL, L>(WG::AT, m, tmp);
+                        for (size_t l = 0; l < cnt; ++l)
+                        {
+                            const size_t p = p0 + t0 + l, n = p / per_img, ty = p % per_img / tw, tx = p % tw;
+                            const size_t plane = (n * K + k) * s.oH * s.oW;
+                            const size_t oh0 = ty * M, ow0 = tx * M;
+                            const size_t jn = std::min<size_t>(M, s.oW - ow0);
+                            for (int i = 0; i < M && oh0 + i < s.oH; ++i)
+                            {
+                                const size_t off = plane + (oh0 + i) * s.oW + ow0;
+                                for (size_t j = 0; j < jn; ++j)
+                                {
+                                    T acc = T(0);
+                                    for (int q = 0; q < AL; ++q)
+                                        acc += tmp[i][q][l] * static_cast<T>(WG::AT[j][q]);
+                                    out[off + j] = acc;
+                                }
+                                ep.span(out + off, jn, off, k);
+                            }
+                        }
+                    }
+                }
+            }
+
+            // ------------------------------------------------------------
+            // FFT：互相关 y = IFFT(FFT(x) * conj(FFT(w)))，按步长取样
+            // ------------------------------------------------------------
+            inline size_t next_pow2(size_t n)
+            {
+                size_t p = 1;
+                while (p < n)
+                    p <<= 1;
+                return p;
+            }
+
+            template <typename T>
+            struct FFTPlan
+            {
+                size_t n = 1;
+                std::vector<size_t> rev;
+                std::vector<std::complex<T>> twiddle; // exp(-2*pi*i*k/n)，k < n/2，按 double 计算
+
+                explicit FFTPlan(size_t n_) : n(n_), rev(n_), twiddle(n_ / 2)
+                {
+                    size_t bits = 0;
+                    while ((size_t(1) << bits) < n)
+                        ++bits;
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        size_t r = 0;
+                        for (size_t b = 0; b < bits; ++b)
+                            r |= ((i >> b) & 1) << (bits - 1 - b);
+                        rev[i] = r;
+                    }
+                    const double pi = 3.14159265358979323846;
+                    for (size_t k = 0; k < n / 2; ++k)
+                        twiddle[k] = std::complex<T>(static_cast<T>(std::cos(2 * pi * k / n)),
+                                                     static_cast<T>(-std::sin(2 * pi * k / n)));
+                }
+
+                // 对 batch 个交错存放的序列同时做原地变换：第 b 个序列的第 i 个元素
+                // 位于 a[i * stride + b]。batch 维连续，蝶形运算沿它向量化。
+                // 逆变换不做 1/n 缩放
+                void run(std::complex<T>* a, size_t stride, size_t batch, bool inverse) const
+                {
+                    for (size_t i = 0; i < n; ++i)
+                        if (i < rev[i])
+                            std::swap_ranges(a + i * stride, a + i * stride + batch, a + rev[i] * stride);
+                    const T sign = inverse ? T(-1) : T(1);
+                    for (size_t len = 2; len <= n; len <<= 1)
+                    {
+                        const size_t half = len / 2, step = n / len;
+                        for (size_t i = 0; i < n; i += len)
+                            for (size_t j = 0; j < half; ++j)
+                            {
+                                const T wr = twiddle[j * step].real(), wi = sign * twiddle[j * step].imag();
+                                T* x = reinterpret_cast<T*>(a + (i + j) * stride);
+                                T* y = reinterpret_cast<T*>(a + (i + j + half) * stride);
+                                #pragma omp simd
+                                for (size_t b = 0; b < batch; ++b)
+                                {
+                                    const T yr = y[2 * b], yi = y[2 * b + 1];
+                                    const T vr = yr * wr - yi * wi, vi = yr * wi + yi * wr;
+                                    const T xr = x[2 * b], xi = x[2 * b + 1];
+                                    y[2 * b] = xr - vr;
+                                    y[2 * b + 1] = xi - vi;
+                                    x[2 * b] = xr + vr;
+                                    x[2 * b + 1] = xi + vi;
+                                }
+                            }
+                    }
+                }
+            };
+
+            // 先逐行变换，再把所有列作为一批同时变换；[row_begin, row_end) 以外的行
+            // 全为零，行变换可以跳过
+            template <typename T>
+            void fft2d(std::complex<T>* a, const FFTPlan<T>& rows, const FFTPlan<T>& cols, bool inverse,
+                       size_t row_begin = 0, size_t row_end = size_t(-1))
+            {
+                for (size_t i = row_begin; i < std::min(row_end, cols.n); ++i)
+                    rows.run(a + i * rows.n, 1, 1, inverse);
+                cols.run(a, rows.n, rows.n, inverse);
+            }
+
+            // 变换长度须容纳填充后的输入，且覆盖所有输出用到的窗口，循环相关才不会回绕
+            inline size_t fft_extent(size_t in, int pad, size_t out, int stride, size_t k)
+            {
+                return next_pow2(std::max(in + pad, (out - 1) * stride + k));
+            }
+
+            inline size_t fft_bytes(const ConvShape& s, size_t elem)
+            {
+                const size_t F = fft_extent(s.H, s.pad_h, s.oH, s.stride_h, s.kH) *
+                                 fft_extent(s.W, s.pad_w, s.oW, s.stride_w, s.kW);
+                return (s.N + s.K) * s.C * F * 2 * elem;
+            }
+
+            template <typename T>
+            void conv_fft(const T* in, const T* wt, const Epilogue<T>& ep, const ConvShape& s, T* out)
+            {
+                using cplx = std::complex<T>;
+                const size_t Fh = fft_extent(s.H, s.pad_h, s.oH, s.stride_h, s.kH);
+                const size_t Fw = fft_extent(s.W, s.pad_w, s.oW, s.stride_w, s.kW);
+                const size_t F = Fh * Fw, C = s.C;
+                const FFTPlan<T> prow(Fw), pcol(Fh);
+                std::vector<cplx> X(s.N * C * F), Wf(s.K * C * F);
+
+                #pragma omp parallel for schedule(static)
+                for (int64_t nc = 0; nc < static_cast<int64_t>(s.N * C); ++nc)
+                {
+                    cplx* x = X.data() + static_cast<size_t>(nc) * F;
+                    const T* ip = in + static_cast<size_t>(nc) * s.H * s.W;
+                    for (size_t h = 0; h < s.H; ++h)
+                        for (size_t w = 0; w < s.W; ++w)
+                            x[(h + s.pad_h) * Fw + w + s.pad_w] = cplx(ip[h * s.W + w], T(0));
+                    fft2d(x, prow, pcol, false, s.pad_h, s.pad_h + s.H);
+                }
+
+                #pragma omp parallel for schedule(static)
+                for (int64_t kc = 0; kc < static_cast<int64_t>(s.K * C); ++kc)
+                {
+                    cplx* f = Wf.data() + static_cast<size_t>(kc) * F;
+                    const T* g = wt + static_cast<size_t>(kc) * s.kH * s.kW;
+                    for (size_t h = 0; h < s.kH; ++h)
+                        for (size_t w = 0; w < s.kW; ++w)
+                            f[h * Fw + w] = cplx(g[h * s.kW + w], T(0));
+                    fft2d(f, prow, pcol, false, 0, s.kH);
+                }
+
+                const T scale = T(1) / static_cast<T>(F);
+                #pragma omp parallel for schedule(static)
+                for (int64_t nk = 0; nk < static_cast<int64_t>(s.N * s.K); ++nk)
+                {
+                    const size_t n = static_cast<size_t>(nk) / s.K, k = static_cast<size_t>(nk) % s.K;
+                    std::vector<cplx> acc(F);
+                    T* ac = reinterpret_cast<T*>(acc.data());
+                    for (size_t c = 0; c < C; ++c)
+                    {
+                        // acc += x * conj(f)
+                        const T* x = reinterpret_cast<const T*>(X.data() + (n * C + c) * F);
+                        const T* f = reinterpret_cast<const T*>(Wf.data() + (k * C + c) * F);
+                        #pragma omp simd
+                        for (size_t i = 0; i < F; ++i)
+                        {
+                            ac[2 * i] += x[2 * i] * f[2 * i] + x[2 * i + 1] * f[2 * i + 1];
+                            ac[2 * i + 1] += x[2 * i + 1] * f[2 * i] - x[2 * i] * f[2 * i + 1];
+                        }
+                    }
+                    fft2d(acc.data(), prow, pcol, true);
+                    T* o = out + static_cast<size_t>(nk) * s.oH * s.oW;
+                    for (size_t oh = 0; oh < s.oH; ++oh)
+                        for (size_t ow = 0; ow < s.oW; ++ow)
+                            o[oh * s.oW + ow] = acc[oh * s.stride_h * Fw + ow * s.stride_w].real() * scale;
+                    ep.span(o, s.oH * s.oW, static_cast<size_t>(nk) * s.oH * s.oW, k);
+                }
+            }
+
+            // ------------------------------------------------------------
+            // NHWC 隐式 GEMM：不展开 im2col。对每个输出行 (n, oh)、卷积核位置
+            // (kh, kw) 和分组 g，有效输出像素对应的输入像素在内存中等距（间隔 stride*C），
+            // 因而可直接作为 lda = stride*C 的 [ow, Cg] 矩阵与 [Cg, Kg] 权重相乘，
+            // 以 beta = 1 累加到输出 [ow, Kg]（ldc = K）。一个输出行累加完后做 epilogue
+            // ------------------------------------------------------------
+            template <typename T>
+            Tensor<T> conv_nhwc_implicit(const Tensor<T>& input, const Tensor<T>& weight,
+                                         const Epilogue<T>& ep, const TensorN::detail::ConvGeom& g,
+                                         const T* hwck = nullptr)
+            {
+                const size_t N = g.N, H = g.in[1], W = g.in[2], C = g.C, K = g.K;
+                const size_t kH = g.ker[1], kW = g.ker[2], oH = g.out[1], oW = g.out[2];
+                const size_t G = g.groups, Cg = g.Cg(), Kg = g.Kg();
+                const int sh = g.stride[1], sw = g.stride[2], dh = g.dilation[1], dw = g.dilation[2];
+                const int ph = g.pad[1], pw = g.pad[2];
+
+                Tensor<T> output({N, oH, oW, K});
+                output.set_layout(Layout::NHWC);
+                std::vector<T> local;
+                if (hwck == nullptr)
+                {
+                    local = TensorN::detail::pack_hwck(weight); // [kH, kW, Cg, K]
+                    hwck = local.data();
+                }
+                const T* in = input.data->data();
+                T* out = output.data->data();
+
+                if (kH == 1 && kW == 1 && sh == 1 && sw == 1 && ph == 0 && pw == 0 && oH == H && oW == W)
+                {
+                    // 1x1：每组就是一次 [N*H*W, Cg] x [Cg, Kg]
+                    for (size_t grp = 0; grp < G; ++grp)
+                        gemm(N * H * W, Kg, Cg, in + grp * Cg, C, hwck + grp * Kg, K, out + grp * Kg, K);
+                    detail::epilogue_rows(out, ep, 0, N * oH * oW, K, K);
+                    return output;
+                }
+
+                for (size_t n = 0; n < N; ++n)
+                    for (size_t oh = 0; oh < oH; ++oh)
+                    {
+                        const size_t row = (n * oH + oh) * oW * K;
+                        T* orow = out + row;
+                        for (size_t kh = 0; kh < kH; ++kh)
+                        {
+                            const int64_t ih = static_cast<int64_t>(oh * sh + kh * dh) - ph;
+                            if (ih < 0 || ih >= static_cast<int64_t>(H))
+                                continue;
+                            const T* irow = in + (n * H + static_cast<size_t>(ih)) * W * C;
+                            for (size_t kw = 0; kw < kW; ++kw)
+                            {
+                                size_t ow0, ow1;
+                                TensorN::detail::valid_range(oW, W, kw * dw, sw, pw, ow0, ow1);
+                                if (ow0 == ow1)
+                                    continue;
+                                const T* x = irow + (ow0 * sw + kw * dw - pw) * C;
+                                const T* wk = hwck + (kh * kW + kw) * Cg * K;
+                                for (size_t grp = 0; grp < G; ++grp)
+                                    gemm(ow1 - ow0, Kg, Cg, x + grp * Cg, sw * C, wk + grp * Kg, K,
+                                         orow + ow0 * K + grp * Kg, K, T(1));
+                            }
+                        }
+                        if (!ep.empty())
+                            for (size_t ow = 0; ow < oW; ++ow)
+                                ep.row(orow + ow * K, K, row + ow * K, 0);
+                    }
+                return output;
+            }
+
+            inline bool winograd_ok(const ConvShape& s)
+            {
+                return s.kH == 3 && s.kW == 3 && s.stride_h == 1 && s.stride_w == 1 &&
+                       s.dil_h == 1 && s.dil_w == 1 && s.groups == 1;
+            }
+
+            template <typename T>
+            bool fft_ok(const ConvShape& s)
+            {
+                return s.dil_h == 1 && s.dil_w == 1 && s.groups == 1 && fft_bytes(s, sizeof(T)) <= FFT_MAX_BYTES;
+            }
+
+            // 启发式选择（不计时）。Winograd 的权重变换与 tile 数无关，tile 太少时
+            // 摊不开；FFT 的代价约为 (N*C + K*C + N*K) 次 F*log2(F) 的变换，
+            // 与 im2col 的乘加次数比较，系数按实测取 4。深度卷积（每组一个输入通道）
+            // 展开后的 GEMM 只有 kH*kW 的内积长度，原生深度卷积内核更快
+            template <typename T>
+            ConvAlgo heuristic(const ConvShape& s)
+            {
+                if constexpr (!detail::is_blas_type<T>::value)
+                    return ConvAlgo::Direct;
+                const size_t macs = s.N * s.K * s.oH * s.oW * (s.C / s.groups) * s.kH * s.kW;
+                if (macs < 4096 || (s.groups > 1 && s.C == s.groups))
+                    return ConvAlgo::Direct;
+                if (winograd_ok(s) && s.C >= 16 && s.K >= 16)
+                {
+                    if (s.N * ((s.oH + 3) / 4) * ((s.oW + 3) / 4) >= 64)
+                        return ConvAlgo::Winograd4x4;
+                    if (s.N * ((s.oH + 1) / 2) * ((s.oW + 1) / 2) >= 64)
+                        return ConvAlgo::Winograd2x2;
+                }
+                if (s.stride_h == 1 && s.stride_w == 1 && s.kH * s.kW > 9 && fft_ok<T>(s))
+                {
+                    const size_t Fh = fft_extent(s.H, s.pad_h, s.oH, s.stride_h, s.kH);
+                    const size_t Fw = fft_extent(s.W, s.pad_w, s.oW, s.stride_w, s.kW);
+                    size_t lg = 0;
+                    while ((size_t(1) << lg) < Fh * Fw)
+                        ++lg;
+                    const double fft_cost = 4.0 * static_cast<double>((s.N + s.K) * s.C + s.N * s.K) *
+                                            static_cast<double>(Fh * Fw) * static_cast<double>(lg);
+                    if (fft_cost < static_cast<double>(macs))
+                        return ConvAlgo::FFT;
+                }
+                return ConvAlgo::Im2colGemm;
+            }
+
+            // 预处理过的滤波器（由 PackedWeight 提供）；为空的项由各算法现场计算
+            template <typename T>
+            struct PreparedFilters
+            {
+                const T* hwck = nullptr;     // [kH, kW, Cg, K]，NHWC 内核使用
+                const T* winograd = nullptr; // 所选 Winograd 变体的 U
+            };
+
+            template <typename T>
+            struct NoPreparedFilters
+            {
+                PreparedFilters<T> operator()(ConvAlgo) const { return {}; }
+            };
+
+            // post 给出 residual / 激活（其 bias 不使用），bias 取自 bias 张量。
+            // 原生直接卷积自己加 bias，其余 epilogue 在卷积完成后逐平面补上
+            template <typename T>
+            void run(ConvAlgo algo, const Tensor<T>& input, const Tensor<T>& weight, const Tensor<T>& bias,
+                     const ConvParams& params, const ConvShape& s, Tensor<T>& output,
+                     const PreparedFilters<T>& f = {}, const Epilogue<T>& post = {})
+            {
+                const T* in = input.data->data();
+                const T* wt = weight.data->data();
+                Epilogue<T> ep = post;
+                ep.bias = bias.data->data();
+                switch (algo)
+                {
+                case ConvAlgo::Im2colGemm:
+                    conv_im2col(in, wt, ep, s, output.data->data());
+                    break;
+                case ConvAlgo::Winograd2x2:
+                    conv_winograd<2>(in, wt, ep, s, output.data->data(), f.winograd);
+                    break;
+                case ConvAlgo::Winograd4x4:
+                    conv_winograd<4>(in, wt, ep, s, output.data->data(), f.winograd);
+                    break;
+                case ConvAlgo::FFT:
+                    conv_fft(in, wt, ep, s, output.data->data());
+                    break;
+                default:
+                    output = TensorN::conv2d(input, weight, bias, params);
+                    detail::epilogue_planes(output.data->data(), post.without_bias(), 0, s.N * s.K,
+                                            s.oH * s.oW, s.K);
+                    break;
+                }
+            }
+
+            using TuneKey = std::array<size_t, 17>;
+
+            inline TuneKey tune_key(const ConvShape& s, size_t elem)
+            {
+                return {s.N, s.C, s.H, s.W, s.K, s.kH, s.kW, s.oH, s.oW,
+                        static_cast<size_t>(s.stride_h), static_cast<size_t>(s.stride_w),
+                        static_cast<size_t>(s.pad_h), static_cast<size_t>(s.pad_w),
+                        static_cast<size_t>(s.dil_h), static_cast<size_t>(s.dil_w), s.groups, elem};
+            }
+
+            inline std::map<TuneKey, ConvAlgo>& tune_cache()
+            {
+                static std::map<TuneKey, ConvAlgo> cache;
+                return cache;
+            }
+
+            inline std::mutex& tune_mutex()
+            {
+                static std::mutex m;
+                return m;
+            }
+
+            // 每个可用算法运行一次，记录最快者；output 中保留最后一次的（相同）结果
+            template <typename T, typename Prepare>
+            ConvAlgo autotune(const Tensor<T>& input, const Tensor<T>& weight, const Tensor<T>& bias,
+                              const ConvParams& params, const ConvShape& s, Tensor<T>& output,
+                              const Prepare& prepare, const Epilogue<T>& post)
+            {
+                const TuneKey key = tune_key(s, sizeof(T));
+                {
+                    std::lock_guard<std::mutex> lock(tune_mutex());
+                    auto it = tune_cache().find(key);
+                    if (it != tune_cache().end())
+                        return it->second;
+                }
+                std::vector<ConvAlgo> candidates = {ConvAlgo::Direct, ConvAlgo::Im2colGemm};
+                if (winograd_ok(s))
+                {
+                    candidates.push_back(ConvAlgo::Winograd2x2);
+                    candidates.push_back(ConvAlgo::Winograd4x4);
+                }
+                if (fft_ok<T>(s))
+                    candidates.push_back(ConvAlgo::FFT);
+
+                ConvAlgo best = candidates.front();
+                double best_time = -1;
+                for (ConvAlgo algo : candidates)
+                {
+                    const auto t0 = std::chrono::steady_clock::now();
+                    run(algo, input, weight, bias, params, s, output, prepare(algo), post);
+                    const double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                    if (best_time < 0 || dt < best_time)
+                    {
+                        best_time = dt;
+                        best = algo;
+                    }
+                }
+                std::lock_guard<std::mutex> lock(tune_mutex());
+                tune_cache()[key] = best;
+                return best;
+            }
+
+            template <typename T>
+            ConvShape make_shape(const Tensor<T>& input, const Tensor<T>& weight, const Tensor<T>& bias,
+                                 const ConvParams& params)
+            {
+                const TensorN::detail::ConvGeom g =
+                    TensorN::detail::make_conv_geom(input, weight, bias, params, 2, "conv2d");
+                ConvShape s;
+                s.N = g.N;
+                s.C = g.C;
+                s.H = g.in[1];
+                s.W = g.in[2];
+                s.K = g.K;
+                s.kH = g.ker[1];
+                s.kW = g.ker[2];
+                s.oH = g.out[1];
+                s.oW = g.out[2];
+                s.stride_h = g.stride[1];
+                s.stride_w = g.stride[2];
+                s.pad_h = g.pad[1];
+                s.pad_w = g.pad[2];
+                s.dil_h = g.dilation[1];
+                s.dil_w = g.dilation[2];
+                s.groups = g.groups;
+                return s;
+            }
+        }
+
+        // im2col 工作区（展开矩阵 + 批处理输出暂存）的上限，单位字节，默认 32 MB。
+        // 工作区从 MemoryPool 借用，重复调用时复用
+        inline void set_conv_workspace_limit(size_t bytes) { conv_detail::workspace_bytes() = bytes; }
+        inline size_t conv_workspace_limit() { return conv_detail::workspace_bytes(); }
+
+        // 打开后 ConvAlgo::Auto 的行为与 ConvAlgo::Autotune 相同
+        inline void set_conv_autotune(bool enabled) { conv_detail::autotune_flag() = enabled; }
+        inline bool conv_autotune() { return conv_detail::autotune_flag(); }
+
+        // 清空调优缓存（例如切换线程数之后）
+        inline void clear_conv_autotune_cache()
+        {
+            std::lock_guard<std::mutex> lock(conv_detail::tune_mutex());
+            conv_detail::tune_cache().clear();
+        }
+
+        // Auto 会选择的算法；已调优的形状返回调优结果
+        template <typename T>
+        ConvAlgo select_conv_algo(const Tensor<T>& input, const Tensor<T>& weight, const ConvParams& params)
+        {
+            Tensor<T> bias({weight.shape().empty() ? size_t(0) : weight.shape()[0]});
+            const conv_detail::ConvShape s = conv_detail::make_shape(input, weight, bias, params);
+            if (detail::is_blas_type<T>::value)
+            {
+                std::lock_guard<std::mutex> lock(conv_detail::tune_mutex());
+                auto it = conv_detail::tune_cache().find(conv_detail::tune_key(s, sizeof(T)));
+                if (it != conv_detail::tune_cache().end())
+                    return it->second;
+            }
+            return conv_detail::heuristic<T>(s);
+        }
+
+        template <typename T>
+        ConvAlgo select_conv_algo(const Tensor<T>& input, const Tensor<T>& weight, int stride = 1, int padding = 0)
+        {
+            return select_conv_algo(input, weight, ConvParams::uniform(stride, padding));
+        }
+
+        // ================================================================
+        // 2D Convolution
+        //
+        //   ConvParams 给出每维的步长、膨胀、两侧填充和分组数。分组卷积的
+        //   im2col 逐组展开；Winograd 与 FFT 只支持 groups == 1、dilation == 1；
+        //   深度卷积（groups == C）在 Auto 下使用原生深度卷积内核
+        // ================================================================
+
+        namespace conv_detail
+        {
+            // prepare(algo) 返回所选算法可复用的预处理滤波器；post 为附加的 residual / 激活
+            template <typename T, typename Prepare>
+            Tensor<T> conv2d_impl(const Tensor<T>& input, const Tensor<T>& weight, const Tensor<T>& bias,
+                                  const ConvParams& params, ConvAlgo algo, const Prepare& prepare,
+                                  const Epilogue<T>& post = {})
+            {
+                if (input.layout() == Layout::NHWC)
+                {
+                    if (algo == ConvAlgo::Winograd2x2 || algo == ConvAlgo::Winograd4x4 || algo == ConvAlgo::FFT)
+                        TENSOR_THROW("conv2d: NHWC input supports Direct and Im2colGemm (implicit GEMM) only");
+                    const TensorN::detail::ConvGeom g =
+                        TensorN::detail::make_conv_geom(input, weight, bias, params, 2, "conv2d");
+                    if (!detail::is_blas_type<T>::value || algo == ConvAlgo::Direct ||
+                        (algo == ConvAlgo::Auto && g.groups > 1 && g.depthwise()))
+                    {
+                        Tensor<T> out = TensorN::detail::conv2d_nhwc(input, weight, bias, g,
+                                                                     prepare(ConvAlgo::Direct).hwck);
+                        detail::epilogue_rows(out.data->data(), post.without_bias(), 0,
+                                              out.size() / std::max<size_t>(g.K, 1), g.K, g.K);
+                        return out;
+                    }
+                    Epilogue<T> ep = post;
+                    ep.bias = bias.data->data();
+                    return conv_nhwc_implicit(input, weight, ep, g, prepare(ConvAlgo::Im2colGemm).hwck);
+                }
+                const ConvShape s = make_shape(input, weight, bias, params);
+                Tensor<T> output({s.N, s.K, s.oH, s.oW});
+                if (output.size() == 0)
+                    return output;
+
+                if constexpr (!detail::is_blas_type<T>::value)
+                    algo = ConvAlgo::Direct;
+                if ((algo == ConvAlgo::Winograd2x2 || algo == ConvAlgo::Winograd4x4) && !winograd_ok(s))
+                    TENSOR_THROW("conv2d: Winograd requires a 3x3 kernel, stride 1, dilation 1 and groups 1");
+                if (algo == ConvAlgo::FFT && (s.dil_h != 1 || s.dil_w != 1 || s.groups != 1))
+                    TENSOR_THROW("conv2d: FFT requires dilation 1 and groups 1");
+                if (algo == ConvAlgo::Auto && conv_autotune())
+                    algo = ConvAlgo::Autotune;
+
+                if (algo == ConvAlgo::Autotune)
+                {
+                    std::unique_lock<std::mutex> lock(tune_mutex());
+                    const bool tuned = tune_cache().count(tune_key(s, sizeof(T))) != 0;
+                    lock.unlock();
+                    const ConvAlgo best = autotune(input, weight, bias, params, s, output, prepare, post);
+                    if (!tuned)
+                        return output; // 调优时已经算出结果
+                    algo = best;
+                }
+                else if (algo == ConvAlgo::Auto)
+                    algo = select_conv_algo(input, weight, params);
+
+                run(algo, input, weight, bias, params, s, output, prepare(algo), post);
+                return output;
+            }
+        }
+
+        template <typename T>
+        Tensor<T> conv2d(const Tensor<T>& input, const Tensor<T>& weight,
+                         const Tensor<T>& bias, const ConvParams& params,
+                         ConvAlgo algo = ConvAlgo::Auto)
+        {
+            return conv_detail::conv2d_impl(input, weight, bias, params, algo,
+                                            conv_detail::NoPreparedFilters<T>{});
+        }
+
+        template <typename T>
+        Tensor<T> conv2d(const Tensor<T>& input, const Tensor<T>& weight,
+                         const Tensor<T>& bias, int stride = 1, int padding = 0,
+                         ConvAlgo algo = ConvAlgo::Auto)
+        {
+            return conv2d(input, weight, bias, ConvParams::uniform(stride, padding), algo);
+        }
+
+        template <typename T>
+        Tensor<T> conv2d(const Tensor<T>& input, const Tensor<T>& weight,
+                         int stride = 1, int padding = 0, ConvAlgo algo = ConvAlgo::Auto)
+        {
+            if (weight.shape().size() != 4)
+                TENSOR_THROW("conv2d: weight must be 4D");
+            Tensor<T> bias({weight.shape()[0]});
+            return conv2d(input, weight, bias, stride, padding, algo);
+        }
+
+        // ================================================================
+        // 1D / 3D Convolution
+        //
+        //   conv1d 把 [N, C, L] 视为高度为 1 的 [N, C, 1, L]，走 conv2d 的算法选择；
+        //   conv3d 使用原生内核（深度卷积同样走专门内核）
+        // ================================================================
+
+        template <typename T>
+        Tensor<T> conv1d(const Tensor<T>& input, const Tensor<T>& weight,
+                         const Tensor<T>& bias, const ConvParams& params,
+                         ConvAlgo algo = ConvAlgo::Auto)
+        {
+            TensorN::detail::make_conv_geom(input, weight, bias, params, 1, "conv1d");
+            ConvParams p2 = params;
+            p2.stride = {{1, params.stride[0], 1}};
+            p2.dilation = {{1, params.dilation[0], 1}};
+            p2.pad_begin = {{0, params.pad_begin[0], 0}};
+            p2.pad_end = {{0, params.pad_end[0], 0}};
+            const auto& is = input.shape();
+            const auto& ws = weight.shape();
+            Tensor<T> out = conv2d(input.reshape({is[0], is[1], 1, is[2]}),
+                                   weight.reshape({ws[0], ws[1], 1, ws[2]}), bias, p2, algo);
+            return out.reshape({out.shape()[0], out.shape()[1], out.shape()[3]});
+        }
+
+        template <typename T>
+        Tensor<T> conv1d(const Tensor<T>& input, const Tensor<T>& weight, const Tensor<T>& bias,
+                         int stride = 1, int padding = 0, int dilation = 1, int groups = 1)
+        {
+            return conv1d(input, weight, bias, ConvParams::uniform(stride, padding, dilation, groups));
+        }
+
+        template <typename T>
+        Tensor<T> conv3d(const Tensor<T>& input, const Tensor<T>& weight,
+                         const Tensor<T>& bias, const ConvParams& params)
+        {
+            return TensorN::conv3d(input, weight, bias, params);
+        }
+
+        template <typename T>
+        Tensor<T> conv3d(const Tensor<T>& input, const Tensor<T>& weight, const Tensor<T>& bias,
+                         int stride = 1, int padding = 0, int dilation = 1, int groups = 1)
+        {
+            return TensorN::conv3d(input, weight, bias, stride, padding, dilation, groups);
+        }
+
+        // ================================================================
+        // Transposed 2D Convolution
+        //
+        //   转置卷积是卷积的伴随：每个分组先做 col = W_g^T x X_g（W_g 重排为
+        //   [Kg*kH*kW, Cg]，X_g 为 [Cg, H*W]），再由 col2im 把 col 累加到输出。
+        //   col 受工作区上限约束，放不下时按输入行分块；col2im 按输出通道划分线程。
+        //   NHWC 输入使用 conv.hpp 中按输出行收集的内核
+        // ================================================================
+
+        template <typename T>
+        Tensor<T> conv_transpose2d(const Tensor<T>& input, const Tensor<T>& weight,
+                                   const Tensor<T>& bias, int stride = 1, int padding = 0,
+                                   int output_padding = 0, int dilation = 1, int groups = 1)
+        {
+            const TensorN::detail::TransposeConvShape ts = TensorN::detail::make_transpose_shape(
+                input, weight, bias, stride, padding, output_padding, dilation, groups);
+            if (input.layout() == Layout::NHWC || !detail::is_blas_type<T>::value)
+                return TensorN::conv_transpose2d(input, weight, bias, stride, padding, output_padding, dilation, groups);
+
+            const size_t G = static_cast<size_t>(groups), Cg = ts.C / G, Kg = ts.K / G;
+            const size_t kk = ts.kH * ts.kW, rows = Kg * kk, hw = ts.H * ts.W, ohw = ts.oH * ts.oW;
+
+            // 以输出为"图像"、输入为"卷积输出"描述 col2im
+            conv_detail::ConvShape s;
+            s.N = ts.N;
+            s.C = Kg;
+            s.H = ts.oH;
+            s.W = ts.oW;
+            s.K = Cg;
+            s.kH = ts.kH;
+            s.kW = ts.kW;
+            s.oH = ts.H;
+            s.oW = ts.W;
+            s.stride_h = s.stride_w = stride;
+            s.pad_h = s.pad_w = padding;
+            s.dil_h = s.dil_w = dilation;
+
+            // W[k][cg][kh][kw] -> Wt[g][(kl*kH + kh)*kW + kw][cg]，kl 为组内输出通道
+            std::vector<T> wt(G * rows * Cg);
+            const T* w = weight.data->data();
+            for (size_t k = 0; k < ts.K; ++k)
+                for (size_t cg = 0; cg < Cg; ++cg)
+                    for (size_t r = 0; r < kk; ++r)
+                        wt[(k * kk + r) * Cg + cg] = w[(k * Cg + cg) * kk + r];
+
+            Tensor<T> output({ts.N, ts.K, ts.oH, ts.oW});
+            const T* in = input.data->data();
+            T* out = output.data->data();
+            const T* b = bias.data->data();
+            #pragma omp parallel for schedule(static)
+            for (int64_t nk = 0; nk < static_cast<int64_t>(ts.N * ts.K); ++nk)
+                std::fill(out + static_cast<size_t>(nk) * ohw, out + static_cast<size_t>(nk + 1) * ohw,
+                          b[static_cast<size_t>(nk) % ts.K]);
+
+            const size_t max_cols = std::max(ts.W, conv_detail::workspace_limit() / sizeof(T) / rows);
+            const size_t tile_rows = std::max<size_t>(1, std::min(ts.H, max_cols / ts.W));
+            PooledBuffer<T> col(rows * tile_rows * ts.W);
+            for (size_t n = 0; n < ts.N; ++n)
+                for (size_t g = 0; g < G; ++g)
+                {
+                    const T* x = in + (n * ts.C + g * Cg) * hw;
+                    T* y = out + (n * ts.K + g * Kg) * ohw;
+                    for (size_t r0 = 0; r0 < ts.H; r0 += tile_rows)
+                    {
+                        const size_t r1 = std::min(ts.H, r0 + tile_rows), cols = (r1 - r0) * ts.W;
+                        conv_detail::gemm(rows, cols, Cg, wt.data() + g * rows * Cg, Cg,
+                                          x + r0 * ts.W, hw, col.data(), cols);
+                        conv_detail::col2im(col.data(), s, r0, r1, y);
+                    }
+                }
+            return output;
+        }
+
+    } // namespace blas
+} // namespace TensorN
+
+#endif // __BLAS_CONVOLUTION_HPP__
@@ -0,0 +1,417 @@
+#pragma once
+#ifndef __BLAS_FUSED_HPP__
+#define __BLAS_FUSED_HPP__
+
+// ============================================================================
+// CPU 融合运算（与 CUDA/fused_kernels.hpp 对应）
+//
+//   matmul / linear / conv2d 的 bias、residual 与激活作为 epilogue，在 GEMM
+//   写出每个输出块后就地完成（见 blas_tensor.hpp 中的 Epilogue）：
+//     * cblas 路径按约 256 KB 的行块调用 GEMM，每块写完立即处理
+//     * PackedWeight 的内置 GEMM 在每个 [64, NR] 块算完后处理
+//     * 卷积的 im2col / Winograd / FFT / NHWC 隐式 GEMM 在各自的输出块上处理；
+//       原生直接卷积在卷积完成后逐平面补做
+//   逐元素的 add_relu、mul_add 与推理批归一化各为一次遍历；fold_batchnorm 把
+//   批归一化直接折叠进前一层的权重和偏置。
+// ============================================================================
+
+#include "packed_weight.hpp"
+#include <type_traits>
+
+namespace TensorN
+{
+    namespace blas
+    {
+        namespace fused_detail
+        {
+            // 让 alpha 不参与模板推导：matmul_activation(Af, Bf, act, 0.1) 可以直接写
+            template <typename T>
+            using scalar_t = typename std::enable_if<true, T>::type;
+
+            template <typename T>
+            Epilogue<T> make_post(ActivationType act, T alpha, const Tensor<T>* residual = nullptr)
+            {
+                Epilogue<T> e;
+                e.act = act;
+                e.alpha = alpha;
+                e.residual = residual ? residual->data->data() : nullptr;
+                return e;
+            }
+
+            template <typename T>
+            void check_residual(const Tensor<T>& residual, const std::vector<size_t>& shape, const char* name)
+            {
+                if (residual.shape() != shape)
+                    TENSOR_THROW(std::string(name) + ": residual must match the output shape");
+            }
+
+            // A [M, K] x B [K, N]（或 PackedWeight）后接 epilogue
+            template <typename T>
+            Tensor<T> matmul_impl(const Tensor<T>& A, const Tensor<T>& B, const Tensor<T>& bias, Epilogue<T> post)
+            {
+                if (A.shape().size() != 2 || B.shape().size() != 2)
+                    TENSOR_THROW("matmul requires 2D tensors");
+                const size_t M = A.shape()[0], K = A.shape()[1], N = B.shape()[1];
+                if (B.shape()[0] != K)
+                    TENSOR_THROW("Inner dimensions must match");
+                if (bias.size() != 0 && (bias.shape().size() != 1 || bias.shape()[0] != N))
+                    TENSOR_THROW("matmul: bias must be [N]");
+                post.bias = bias.size() != 0 ? bias.data->data() : nullptr;
+                Tensor<T> C({M, N});
+                if (M == 0 || N == 0)
+                    return C;
+                if (K == 0)
+                {
+                    detail::epilogue_rows(C.data->data(), post, 0, M, N, N);
+                    return C;
+                }
+#if TENSORN_HAS_OPENBLAS
+                if constexpr (detail::is_blas_type<T>::value)
+                {
+                    detail::gemm_epilogue(M, N, K, A.data->data(), B.data->data(), false, C.data->data(), post);
+                    return C;
+                }
+                else
+#endif
+                {
+                    C = einsum<T>("ij,jk->ik", A, B).tensor;
+                    detail::epilogue_rows(C.data->data(), post, 0, M, N, N);
+                    return C;
+                }
+            }
+
+            template <typename T>
+            Tensor<T> matmul_impl(const Tensor<T>& A, const PackedWeight<T>& B, const Tensor<T>& bias,
+                                  Epilogue<T> post)
+            {
+                packed_detail::require(B, false, "matmul");
+                if (A.shape().size() != 2)
+                    TENSOR_THROW("matmul requires 2D tensors");
+                return packed_detail::linear_impl(A, B, bias, post);
+            }
+
+            template <typename T>
+            std::vector<size_t> conv_output_shape(const Tensor<T>& input, const Tensor<T>& weight,
+                                                  const Tensor<T>& bias, const ConvParams& params)
+            {
+                const TensorN::detail::ConvGeom g =
+                    TensorN::detail::make_conv_geom(input, weight, bias, params, 2, "conv2d");
+                if (input.layout() == Layout::NHWC)
+                    return {g.N, g.out[1], g.out[2], g.K};
+                return {g.N, g.K, g.out[1], g.out[2]};
+            }
+
+            // 通道轴：NHWC 为最后一维，其余为第 1 维（1D 张量视为只有通道）
+            template <typename T>
+            size_t channel_axis(const Tensor<T>& x)
+            {
+                if (x.shape().size() <= 1)
+                    return 0;
+                return x.layout() == Layout::NHWC ? x.shape().size() - 1 : 1;
+            }
+        }
+
+        // ================================================================
+        // matmul / linear + bias + 激活
+        // ================================================================
+
+        template <typename T>
+        Tensor<T> matmul_activation(const Tensor<T>& A, const Tensor<T>& B, ActivationType act,
+                                    fused_detail::scalar_t<T> alpha = T(0))
+        {
+            return fused_detail::matmul_impl(A, B, Tensor<T>(), fused_detail::make_post(act, alpha));
+        }
+
+        // bias 为 [N]，加在每一行上
+        template <typename T>
+        Tensor<T> matmul_activation(const Tensor<T>& A, const Tensor<T>& B, const Tensor<T>& bias,
+                                    ActivationType act, fused_detail::scalar_t<T> alpha = T(0))
+        {
+            return fused_detail::matmul_impl(A, B, bias, fused_detail::make_post(act, alpha));
+        }
+
+        template <typename T>
+        Tensor<T> matmul_activation(const Tensor<T>& A, const PackedWeight<T>& B, const Tensor<T>& bias,
+                                    ActivationType act, fused_detail::scalar_t<T> alpha = T(0))
+        {
+            return fused_detail::matmul_impl(A, B, bias, fused_detail::make_post(act, alpha));
+        }
+
+        template <typename T>
+        Tensor<T> linear_activation(const Tensor<T>& x, const Tensor<T>& weight, const Tensor<T>& bias,
+                                    ActivationType act, fused_detail::scalar_t<T> alpha = T(0))
+        {
+            return detail::linear_impl(x, weight, bias, fused_detail::make_post(act, alpha));
+        }
+
+        template <typename T>
+        Tensor<T> linear_activation(const Tensor<T>& x, const PackedWeight<T>& weight, const Tensor<T>& bias,
+                                    ActivationType act, fused_detail::scalar_t<T> alpha = T(0))
+        {
+            return packed_detail::linear_impl(x, weight, bias, fused_detail::make_post(act, alpha));
+        }
+
+        // y = act(x * W^T + bias + residual)，residual 与输出同形状
+        template <typename T>
+        Tensor<T> linear_residual(const Tensor<T>& x, const Tensor<T>& weight, const Tensor<T>& bias,
+                                  const Tensor<T>& residual, ActivationType act = ActivationType::None,
+                                  fused_detail::scalar_t<T> alpha = T(0))
+        {
+            if (weight.shape().size() != 2 || x.shape().empty())
+                TENSOR_THROW("linear: weight must be [out_features, in_features]");
+            fused_detail::check_residual(residual, detail::linear_shape(x, weight.shape()[0]), "linear_residual");
+            return detail::linear_impl(x, weight, bias, fused_detail::make_post(act, alpha, &residual));
+        }
+
+        template <typename T>
+        Tensor<T> linear_residual(const Tensor<T>& x, const PackedWeight<T>& weight, const Tensor<T>& bias,
+                                  const Tensor<T>& residual, ActivationType act = ActivationType::None,
+                                  fused_detail::scalar_t<T> alpha = T(0))
+        {
+            if (x.shape().empty())
+                TENSOR_THROW("linear: last dimension of input must match in_features");
+            fused_detail::check_residual(residual, detail::linear_shape(x, weight.out_features()), "linear_residual");
+            return packed_detail::linear_impl(x, weight, bias, fused_detail::make_post(act, alpha, &residual));
+        }
+
+        // ================================================================
+        // conv2d + bias + 激活（+ residual）
+        // ================================================================
+
+        template <typename T>
+        Tensor<T> conv2d_activation(const Tensor<T>& input, const Tensor<T>& weight, const Tensor<T>& bias,
+                                    const ConvParams& params, ActivationType act,
+                                    fused_detail::scalar_t<T> alpha = T(0), ConvAlgo algo = ConvAlgo::Auto)
+        {
+            return conv_detail::conv2d_impl(input, weight, bias, params, algo,
+                                            conv_detail::NoPreparedFilters<T>{},
+                                            fused_detail::make_post(act, alpha));
+        }
+
+        template <typename T>
+        Tensor<T> conv2d_activation(const Tensor<T>& input, const Tensor<T>& weight, const Tensor<T>& bias,
+                                    int stride, int padding, ActivationType act,
+                                    fused_detail::scalar_t<T> alpha = T(0), ConvAlgo algo = ConvAlgo::Auto)
+        {
+            return conv2d_activation(input, weight, bias, ConvParams::uniform(stride, padding), act, alpha, algo);
+        }
+
+        template <typename T>
+        Tensor<T> conv2d_activation(const Tensor<T>& input, const PackedWeight<T>& weight, const Tensor<T>& bias,
+                                    const ConvParams& params, ActivationType act,
+                                    fused_detail::scalar_t<T> alpha = T(0), ConvAlgo algo = ConvAlgo::Auto)
+        {
+            packed_detail::require(weight, true, "conv2d");
+            return conv_detail::conv2d_impl(input, weight.weight(), bias, params, algo,
+                                            packed_detail::conv_filters(weight),
+                                            fused_detail::make_post(act, alpha));
+        }
+
+        template <typename T>
+        Tensor<T> conv2d_activation(const Tensor<T>& input, const PackedWeight<T>& weight, const Tensor<T>& bias,
+                                    int stride, int padding, ActivationType act,
+                                    fused_detail::scalar_t<T> alpha = T(0), ConvAlgo algo = ConvAlgo::Auto)
+        {
+            return conv2d_activation(input, weight, bias, ConvParams::uniform(stride, padding), act, alpha, algo);
+        }
+
+        // y = act(conv2d(input) + bias + residual)，residual 与输出同形状、同布局
+        template <typename T>
+        Tensor<T> conv2d_residual(const Tensor<T>& input, const Tensor<T>& weight, const Tensor<T>& bias,
+                                  const ConvParams& params, const Tensor<T>& residual,
+                                  ActivationType act = ActivationType::ReLU,
+                                  fused_detail::scalar_t<T> alpha = T(0), ConvAlgo algo = ConvAlgo::Auto)
+        {
+            fused_detail::check_residual(residual, fused_detail::conv_output_shape(input, weight, bias, params),
+                                         "conv2d_residual");
+            if (residual.layout() != input.layout())
+                TENSOR_THROW("conv2d_residual: residual must have the same layout as the input");
+            return conv_detail::conv2d_impl(input, weight, bias, params, algo,
+                                            conv_detail::NoPreparedFilters<T>{},
+                                            fused_detail::make_post(act, alpha, &residual));
+        }
+
+        template <typename T>
+        Tensor<T> conv2d_residual(const Tensor<T>& input, const PackedWeight<T>& weight, const Tensor<T>& bias,
+                                  const ConvParams& params, const Tensor<T>& residual,
+                                  ActivationType act = ActivationType::ReLU,
+                                  fused_detail::scalar_t<T> alpha = T(0), ConvAlgo algo = ConvAlgo::Auto)
+        {
+            packed_detail::require(weight, true, "conv2d");
+            fused_detail::check_residual(residual,
+                                         fused_detail::conv_output_shape(input, weight.weight(), bias, params),
+                                         "conv2d_residual");
+            if (residual.layout() != input.layout())
+                TENSOR_THROW("conv2d_residual: residual must have the same layout as the input");
+            return conv_detail::conv2d_impl(input, weight.weight(), bias, params, algo,
+                                            packed_detail::conv_filters(weight),
+                                            fused_detail::make_post(act, alpha, &residual));
+        }
+
+        // relu(conv2(relu(conv1(x))) + x)；输出形状与 x 不同时不加残差（与 CUDA 版本一致）
+        template <typename T>
+        Tensor<T> residual_block(const Tensor<T>& input, const Tensor<T>& weight1, const Tensor<T>& bias1,
+                                 const Tensor<T>& weight2, const Tensor<T>& bias2,
+                                 int stride = 1, int padding = 1)
+        {
+            const ConvParams p = ConvParams::uniform(stride, padding);
+            Tensor<T> mid = conv2d_activation(input, weight1, bias1, p, ActivationType::ReLU);
+            if (fused_detail::conv_output_shape(mid, weight2, bias2, p) == input.shape())
+                return conv2d_residual(mid, weight2, bias2, p, input, ActivationType::ReLU);
+            return blas::conv2d(mid, weight2, bias2, p);
+        }
+
+        // ================================================================
+        // 逐元素融合
+        // ================================================================
+
+        // relu(A + B)
+        template <typename T>
+        Tensor<T> add_relu(const Tensor<T>& A, const Tensor<T>& B)
+        {
+            if (!A.is_isomorphic(B))
+                TENSOR_THROW("add_relu: tensors must have the same shape");
+            Tensor<T> result(A.shape());
+            result.set_layout(A.layout());
+            const T* __restrict a = A.data->data();
+            const T* __restrict b = B.data->data();
+            T* __restrict c = result.data->data();
+            const size_t n = A.size();
+            #pragma omp parallel for simd schedule(static)
+            for (int64_t i = 0; i < static_cast<int64_t>(n); ++i)
+            {
+                const T v = a[i] + b[i];
+                c[i] = v > T(0) ? v : T(0);
+            }
+            return result;
+        }
+
+        // A * B + C
+        template <typename T>
+        Tensor<T> mul_add(const Tensor<T>& A, const Tensor<T>& B, const Tensor<T>& C)
+        {
+            if (!A.is_isomorphic(B) || !A.is_isomorphic(C))
+                TENSOR_THROW("mul_add: tensors must have the same shape");
+            Tensor<T> result(A.shape());
+            result.set_layout(A.layout());
+            const T* __restrict a = A.data->data();
+            const T* __restrict b = B.data->data();
+            const T* __restrict c = C.data->data();
+            T* __restrict d = result.data->data();
+            const size_t n = A.size();
+            #pragma omp parallel for simd schedule(static)
+            for (int64_t i = 0; i < static_cast<int64_t>(n); ++i)
+                d[i] = a[i] * b[i] + c[i];
+            return result;
+        }
+
+        // ================================================================
+        // 推理批归一化
+        //
+        //   y = act((x - mean) / sqrt(var + eps) * gamma + beta)，先折算成每通道的
+        //   scale / shift 再一次遍历。通道轴：NHWC 张量为最后一维，其余为第 1 维
+        // ================================================================
+
+        template <typename T>
+        Tensor<T> batchnorm_inference(const Tensor<T>& x, const Tensor<T>& mean, const Tensor<T>& var,
+                                      const Tensor<T>& gamma, const Tensor<T>& beta,
+                                      fused_detail::scalar_t<T> eps = T(1e-5),
+                                      ActivationType act = ActivationType::None,
+                                      fused_detail::scalar_t<T> alpha = T(0))
+        {
+            if (x.shape().empty())
+                TENSOR_THROW("batchnorm_inference: input must have a channel dimension");
+            const size_t axis = fused_detail::channel_axis(x), C = x.shape()[axis];
+            for (const Tensor<T>* t : {&mean, &var, &gamma, &beta})
+                if (t->size() != C)
+                    TENSOR_THROW("batchnorm_inference: statistics must have one value per channel");
+            size_t outer = 1, inner = 1;
+            for (size_t i = 0; i < axis; ++i)
+                outer *= x.shape()[i];
+            for (size_t i = axis + 1; i < x.shape().size(); ++i)
+                inner *= x.shape()[i];
+
+            std::vector<T> scale(C), shift(C);
+            for (size_t c = 0; c < C; ++c)
+            {
+                scale[c] = (*gamma.data)[c] / std::sqrt((*var.data)[c] + eps);
+                shift[c] = (*beta.data)[c] - (*mean.data)[c] * scale[c];
+            }
+            Tensor<T> y(x.shape());
+            y.set_layout(x.layout());
+            const T* src = x.data->data();
+            T* dst = y.data->data();
+            if (inner == 1)
+            {
+                // 通道在最内层：逐行 [C]
+                #pragma omp parallel for schedule(static)
+                for (int64_t r = 0; r < static_cast<int64_t>(outer); ++r)
+                {
+                    const T* xi = src + static_cast<size_t>(r) * C;
+                    T* yi = dst + static_cast<size_t>(r) * C;
+                    #pragma omp simd
+                    for (size_t c = 0; c < C; ++c)
+                        yi[c] = xi[c] * scale[c] + shift[c];
+                    detail::apply_activation(yi, C, act, T(alpha));
+                }
+            }
+            else
+            {
+                #pragma omp parallel for schedule(static)
+                for (int64_t p = 0; p < static_cast<int64_t>(outer * C); ++p)
+                {
+                    const size_t c = static_cast<size_t>(p) % C;
+                    const T* xi = src + static_cast<size_t>(p) * inner;
+                    T* yi = dst + static_cast<size_t>(p) * inner;
+                    const T s = scale[c], b = shift[c];
+                    #pragma omp simd
+                    for (size_t i = 0; i < inner; ++i)
+                        yi[i] = xi[i] * s + b;
+                    detail::apply_activation(yi, inner, act, T(alpha));
+                }
+            }
+            return y;
+        }
+
+        // 折叠后的权重与偏置
+        template <typename T>
+        struct FoldedWeight
+        {
+            Tensor<T> weight;
+            Tensor<T> bias;
+        };
+
+        // 把紧随其后的推理批归一化折叠进卷积 / linear 的权重：weight 的第 0 维为
+        // 输出通道（[K, C, kH, kW] 或 [out, in]），bias 为空时视为 0
+        template <typename T>
+        FoldedWeight<T> fold_batchnorm(const Tensor<T>& weight, const Tensor<T>& bias,
+                                       const Tensor<T>& mean, const Tensor<T>& var,
+                                       const Tensor<T>& gamma, const Tensor<T>& beta,
+                                       fused_detail::scalar_t<T> eps = T(1e-5))
+        {
+            if (weight.shape().empty())
+                TENSOR_THROW("fold_batchnorm: weight must have an output-channel dimension");
+            const size_t K = weight.shape()[0];
+            if (bias.size() != 0 && bias.size() != K)
+                TENSOR_THROW("fold_batchnorm: bias must have one value per output channel");
+            for (const Tensor<T>* t : {&mean, &var, &gamma, &beta})
+                if (t->size() != K)
+                    TENSOR_THROW("fold_batchnorm: statistics must have one value per output channel");
+
+            FoldedWeight<T> f{weight.clone(), Tensor<T>({K})};
+            const size_t per = K == 0 ? 0 : weight.size() / K;
+            T* w = f.weight.data->data();
+            for (size_t k = 0; k < K; ++k)
+            {
+                const T s = (*gamma.data)[k] / std::sqrt((*var.data)[k] + eps);
+                const T b0 = bias.size() != 0 ? (*bias.data)[k] : T(0);
+                for (size_t i = 0; i < per; ++i)
+                    w[k * per + i] *= s;
+                (*f.bias.data)[k] = (b0 - (*mean.data)[k]) * s + (*beta.data)[k];
+            }
+            return f;
+        }
+    }
+}
+
+#endif // __BLAS_FUSED_HPP__
@@ -0,0 +1,330 @@
+#pragma once
+#ifndef __BLAS_PACKED_WEIGHT_HPP__
+#define __BLAS_PACKED_WEIGHT_HPP__
+
+// ============================================================================
+// 预打包权重（推理时反复使用的常量权重）
+//
+//   cblas 每次调用都会把传入的行主序权重重新打包成内部面板格式；小批量推理时
+//   这部分开销占单次延迟的可观比例。PackedWeight 在构造时一次性完成：
+//     * matmul / linear：把 K x N 的权重按 NR 列切成面板 [N/NR][K][NR]，
+//       由内置 GEMM 直接读取；M <= SMALL_M 时使用内置 GEMM，
+//       更大的 M 交给 cblas（保留原始权重）
+//     * conv：预排好 NHWC 内核使用的 [kH, kW, Cg, K] 滤波器；Winograd 滤波器
+//       变换 U 在第一次使用对应算法时计算并缓存（线程安全）
+//   FFT 的滤波器频谱依赖输入尺寸，不做缓存。
+//
+//   PackedWeight 的拷贝共享同一份打包数据。
+// ============================================================================
+
+#include "convolution.hpp"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace TensorN
+{
+    namespace blas
+    {
+        namespace packed_detail
+        {
+            // 面板宽度：一行面板占 64 字节
+            template <typename T>
+            constexpr size_t panel_width() { return sizeof(T) >= 16 ? 4 : 64 / sizeof(T); }
+
+            constexpr size_t SMALL_M = 64; // 内置 GEMM 处理的最大行数
+            constexpr size_t MC = 64;      // 每个任务的行数
+            constexpr size_t KC = 256;     // K 方向分块
+
+            // 逻辑矩阵 B 为 K x N，元素 (k, n) 位于 src[k * sk + n * sn]；
+            // 输出 [ceil(N/NR)][K][NR]，末尾面板补零
+            template <typename T>
+            std::vector<T> pack_panels(const T* src, size_t K, size_t N, size_t sk, size_t sn)
+            {
+                constexpr size_t NR = panel_width<T>();
+                const size_t np = (N + NR - 1) / NR;
+                std::vector<T> out(np * K * NR, T(0));
+                #pragma omp parallel for schedule(static)
+                for (int64_t p = 0; p < static_cast<int64_t>(np); ++p)
+                {
+                    const size_t n0 = static_cast<size_t>(p) * NR, nc = std::min(NR, N - n0);
+                    T* dst = out.data() + static_cast<size_t>(p) * K * NR;
+                    for (size_t k = 0; k < K; ++k)
+                        for (size_t j = 0; j < nc; ++j)
+                            dst[k * NR + j] = src[k * sk + (n0 + j) * sn];
+                }
+                return out;
+            }
+
+            // MR 行 x 一个面板：acc += A[MR, kc] * B[kc, NR]。first 时从零开始，
+            // 否则累加到 C 上
+            template <size_t MR, typename T>
+            inline void micro(size_t kc, const T* __restrict A, size_t lda, const T* __restrict B,
+                              T* __restrict C, size_t ldc, size_t nc, bool first)
+            {
+                constexpr size_t NR = panel_width<T>();
+                T acc[MR][NR];
+                for (size_t r = 0; r < MR; ++r)
+                    for (size_t j = 0; j < NR; ++j)
+                        acc[r][j] = (first || j >= nc) ? T(0) : C[r * ldc + j];
+                for (size_t k = 0; k < kc; ++k)
+                {
+                    const T* b = B + k * NR;
+                    for (size_t r = 0; r < MR; ++r)
+                    {
+                        const T a = A[r * lda + k];
+                        #pragma omp simd
+                        for (size_t j = 0; j < NR; ++j)
+                            acc[r][j] += a * b[j];
+                    }
+                }
+                for (size_t r = 0; r < MR; ++r)
+                    for (size_t j = 0; j < nc; ++j)
+                        C[r * ldc + j] = acc[r][j];
+            }
+
+            // C[M, N] = A[M, K] * B，B 为 pack_panels 的结果；每个 [MC, NR] 块算完后
+            // 立即做 epilogue（residual 与 C 同行距）
+            template <typename T>
+            void gemm_packed(size_t M, size_t N, size_t K, const T* A, size_t lda,
+                             const T* Bp, T* C, size_t ldc, const Epilogue<T>& ep)
+            {
+                constexpr size_t NR = panel_width<T>();
+                const size_t np = (N + NR - 1) / NR, mb = (M + MC - 1) / MC;
+                if (K == 0)
+                {
+                    for (size_t i = 0; i < M; ++i)
+                        std::fill(C + i * ldc, C + i * ldc + N, T(0));
+                    detail::epilogue_rows(C, ep, 0, M, N, ldc);
+                    return;
+                }
+                #pragma omp parallel for schedule(static)
+                for (int64_t t = 0; t < static_cast<int64_t>(mb * np); ++t)
+                {
+                    const size_t m0 = static_cast<size_t>(t) / np * MC, m1 = std::min(M, m0 + MC);
+                    const size_t p = static_cast<size_t>(t) % np;
+                    const size_t n0 = p * NR, nc = std::min(NR, N - n0);
+                    for (size_t k0 = 0; k0 < K; k0 += KC)
+                    {
+                        const size_t kc = std::min(KC, K - k0);
+                        const T* panel = Bp + p * K * NR + k0 * NR;
+                        size_t i = m0;
+                        for (; i + 4 <= m1; i += 4)
+                            micro<4>(kc, A + i * lda + k0, lda, panel, C + i * ldc + n0, ldc, nc, k0 == 0);
+                        for (; i < m1; ++i)
+                            micro<1>(kc, A + i * lda + k0, lda, panel, C + i * ldc + n0, ldc, nc, k0 == 0);
+                    }
+                    if (!ep.empty())
+                        for (size_t i = m0; i < m1; ++i)
+                            ep.row(C + i * ldc + n0, nc, i * ldc + n0, n0);
+                }
+            }
+        }
+
+        // ================================================================
+        // PackedWeight
+        // ================================================================
+
+        template <typename T>
+        class PackedWeight
+        {
+        public:
+            enum class Kind { Matmul, Linear, Conv };
+
+            PackedWeight() = default;
+
+            // B 为 [K, N]，用于 matmul(A, B)
+            static PackedWeight matmul(const Tensor<T>& B)
+            {
+                if (B.shape().size() != 2)
+                    TENSOR_THROW("PackedWeight::matmul: weight must be 2D [K, N]");
+                const size_t K = B.shape()[0], N = B.shape()[1];
+                return PackedWeight(Kind::Matmul, B, K, N, N, 1);
+            }
+
+            // W 为 [N, K]（nn.Linear 布局），用于 linear(x, W)
+            static PackedWeight linear(const Tensor<T>& W)
+            {
+                if (W.shape().size() != 2)
+                    TENSOR_THROW("PackedWeight::linear: weight must be 2D [out_features, in_features]");
+                const size_t N = W.shape()[0], K = W.shape()[1];
+                return PackedWeight(Kind::Linear, W, K, N, 1, K);
+            }
+
+            // weight 为 [K, C/groups, kH, kW]，用于 conv2d
+            static PackedWeight conv(const Tensor<T>& weight)
+            {
+                if (weight.shape().size() != 4)
+                    TENSOR_THROW("PackedWeight::conv: weight must be 4D [K, C/groups, kH, kW]");
+                PackedWeight pw;
+                pw.kind_ = Kind::Conv;
+                pw.weight_ = std::make_shared<const Tensor<T>>(weight);
+                pw.in_ = weight.shape()[1] * weight.shape()[2] * weight.shape()[3];
+                pw.out_ = weight.shape()[0];
+                pw.packed_ = std::make_shared<const std::vector<T>>(TensorN::detail::pack_hwck(weight));
+                pw.cache_ = std::make_shared<Cache>();
+                return pw;
+            }
+
+            bool empty() const { return !weight_; }
+            Kind kind() const { return kind_; }
+            const Tensor<T>& weight() const { return *weight_; }
+            size_t in_features() const { return in_; }
+            size_t out_features() const { return out_; }
+
+            // matmul / linear：[ceil(N/NR)][K][NR] 面板；conv：[kH, kW, Cg, K]
+            const T* packed() const { return packed_->data(); }
+
+            // F(m x m, 3x3) 的 Winograd 滤波器变换，第一次调用时计算
+            const T* winograd_filter(int m) const
+            {
+                if (kind_ != Kind::Conv || (m != 2 && m != 4))
+                    TENSOR_THROW("PackedWeight::winograd_filter: requires a conv weight and m = 2 or 4");
+                const size_t K = weight_->shape()[0], C = weight_->shape()[1];
+                if (m == 2)
+                {
+                    std::call_once(cache_->once2, [&] {
+                        cache_->u2 = conv_detail::winograd_filter<2>(weight_->data->data(), K, C);
+                    });
+                    return cache_->u2.data();
+                }
+                std::call_once(cache_->once4, [&] {
+                    cache_->u4 = conv_detail::winograd_filter<4>(weight_->data->data(), K, C);
+                });
+                return cache_->u4.data();
+            }
+
+        private:
+            struct Cache
+            {
+                std::once_flag once2, once4;
+                std::vector<T> u2, u4;
+            };
+
+            PackedWeight(Kind kind, const Tensor<T>& w, size_t K, size_t N, size_t sk, size_t sn)
+                : kind_(kind), weight_(std::make_shared<const Tensor<T>>(w)), in_(K), out_(N)
+            {
+                packed_ = std::make_shared<const std::vector<T>>(
+                    packed_detail::pack_panels(weight_->data->data(), K, N, sk, sn));
+            }
+
+            Kind kind_ = Kind::Matmul;
+            std::shared_ptr<const Tensor<T>> weight_;
+            size_t in_ = 0, out_ = 0;
+            std::shared_ptr<const std::vector<T>> packed_;
+            std::shared_ptr<Cache> cache_;
+        };
+
+        namespace packed_detail
+        {
+            // y[M, N] = x[M, K] * B，随后做 epilogue
+            template <typename T>
+            void gemm(const PackedWeight<T>& w, const T* x, size_t M, T* y, const Epilogue<T>& ep)
+            {
+                const size_t K = w.in_features(), N = w.out_features();
+                if (M == 0 || N == 0)
+                    return;
+#if TENSORN_HAS_OPENBLAS
+                if constexpr (detail::is_blas_type<T>::value)
+                {
+                    if (M > SMALL_M && K > 0)
+                    {
+                        detail::gemm_epilogue(M, N, K, x, w.weight().data->data(),
+                                              w.kind() == PackedWeight<T>::Kind::Linear, y, ep);
+                        return;
+                    }
+                }
+#endif
+                gemm_packed(M, N, K, x, K, w.packed(), y, N, ep);
+            }
+
+            template <typename T>
+            void require(const PackedWeight<T>& w, bool conv, const char* name)
+            {
+                if (w.empty())
+                    TENSOR_THROW(std::string(name) + ": empty PackedWeight");
+                if ((w.kind() == PackedWeight<T>::Kind::Conv) != conv)
+                    TENSOR_THROW(std::string(name) + (conv ? ": PackedWeight was not packed for conv"
+                                                           : ": PackedWeight was packed for conv"));
+            }
+
+            template <typename T>
+            Tensor<T> linear_impl(const Tensor<T>& x, const PackedWeight<T>& weight, const Tensor<T>& bias,
+                                  Epilogue<T> post)
+            {
+                require(weight, false, "linear");
+                const size_t K = weight.in_features(), N = weight.out_features();
+                const size_t M = detail::linear_rows(x, bias, K, N);
+                post.bias = bias.size() != 0 ? bias.data->data() : nullptr;
+                Tensor<T> y(detail::linear_shape(x, N));
+                gemm(weight, x.data->data(), M, y.data->data(), post);
+                return y;
+            }
+
+            // conv2d_impl 的 prepare：NHWC 滤波器与按需计算的 Winograd 变换
+            template <typename T>
+            auto conv_filters(const PackedWeight<T>& weight)
+            {
+                return [&weight](ConvAlgo a) {
+                    conv_detail::PreparedFilters<T> f;
+                    f.hwck = weight.packed();
+                    if (a == ConvAlgo::Winograd2x2)
+                        f.winograd = weight.winograd_filter(2);
+                    else if (a == ConvAlgo::Winograd4x4)
+                        f.winograd = weight.winograd_filter(4);
+                    return f;
+                };
+            }
+        }
+
+        // ================================================================
+        // matmul / linear / conv2d 的预打包版本
+        // ================================================================
+
+        template <typename T>
+        Tensor<T> matmul(const Tensor<T>& A, const PackedWeight<T>& B)
+        {
+            packed_detail::require(B, false, "matmul");
+            if (A.shape().size() != 2)
+                TENSOR_THROW("matmul requires 2D tensors");
+            if (A.shape()[1] != B.in_features())
+                TENSOR_THROW("Inner dimensions must match");
+            const size_t M = A.shape()[0];
+            Tensor<T> C({M, B.out_features()});
+            packed_detail::gemm(B, A.data->data(), M, C.data->data(), Epilogue<T>{});
+            return C;
+        }
+
+        template <typename T>
+        Tensor<T> linear(const Tensor<T>& x, const PackedWeight<T>& weight, const Tensor<T>& bias)
+        {
+            return packed_detail::linear_impl(x, weight, bias, Epilogue<T>{});
+        }
+
+        template <typename T>
+        Tensor<T> linear(const Tensor<T>& x, const PackedWeight<T>& weight)
+        {
+            return linear(x, weight, Tensor<T>());
+        }
+
+        template <typename T>
+        Tensor<T> conv2d(const Tensor<T>& input, const PackedWeight<T>& weight,
+                         const Tensor<T>& bias, const ConvParams& params,
+                         ConvAlgo algo = ConvAlgo::Auto)
+        {
+            packed_detail::require(weight, true, "conv2d");
+            return conv_detail::conv2d_impl(input, weight.weight(), bias, params, algo,
+                                            packed_detail::conv_filters(weight));
+        }
+
+        template <typename T>
+        Tensor<T> conv2d(const Tensor<T>& input, const PackedWeight<T>& weight,
+                         const Tensor<T>& bias, int stride = 1, int padding = 0,
+                         ConvAlgo algo = ConvAlgo::Auto)
+        {
+            return conv2d(input, weight, bias, ConvParams::uniform(stride, padding), algo);
+        }
+    }
+}
+
+#endif // __BLAS_PACKED_WEIGHT_HPP__
@@ -0,0 +1,372 @@
+#pragma once
+#ifndef __CSV__H__
+#define __CSV__H__
+
+// ============================================================================
+// 数值 CSV 并行读写
+//
+//   读：mmap 整个文件，按换行边界切块；第一遍并行统计每块的行数并检查列数，
+//       前缀和得到每块在结果中的起始行，第二遍用 from_chars 并行解析，
+//       直接写入最终张量缓冲区（没有中间的 vector<vector<T>>）。
+//   写：按行主序的连续值区间切块（每块 CHUNK_VALUES 个值，长行会跨块切开，
+//       单行的宽张量同样并行）并行格式化（to_chars 最短可往返表示），按顺序写出；
+//       每批只缓存 线程数 x 2 个块，输出大小不受内存限制。
+//
+// 空行（含仅有空白 / '\r' 的行）被跳过，字段两侧允许空格和制表符。
+// 形状规则与旧实现一致：1x1 -> 标量，1xN -> 一维，MxN -> 二维。
+// ============================================================================
+
+#include "../tensor.hpp"
+#include "../mapped_file.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace TensorN
+{
+    namespace csv_detail
+    {
+        constexpr size_t CHUNK_BYTES = size_t(1) << 20;     // 读：每块约 1 MB
+        constexpr size_t CHUNK_VALUES = size_t(1) << 16;    // 写：每块约 64K 个值
+        constexpr size_t MAX_VALUE_CHARS = 32;              // 最短表示的上界（double 为 24）
+
+        inline int num_threads()
+        {
+#ifdef _OPENMP
+            return omp_get_max_threads();
+#else
+            return 1;
+#endif
+        }
+
+        struct Chunk
+        {
+            const char *begin = nullptr;
+            const char *end = nullptr;
+            size_t rows = 0;         // 非空行数
+            size_t cols = 0;         // 第一行的列数
+            size_t bad_row = SIZE_MAX; // 列数与首行不一致的行（块内编号）
+            size_t row0 = 0;         // 在结果中的起始行
+            std::string error;
+        };
+
+        inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+        inline const char *line_end(const char *p, const char *end)
+        {
+            const void *nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+            return nl ? static_cast<const char *>(nl) : end;
+        }
+
+        inline bool blank_line(const char *p, const char *e)
+        {
+            for (; p < e; ++p)
+                if (!is_blank(*p))
+                    return false;
+            return true;
+        }
+
+        // 把 [data, data + size) 切成若干块，每块都从行首开始
+        inline std::vector<Chunk> split(const char *data, size_t size)
+        {
+            const size_t want = std::max<size_t>(1, std::min<size_t>(size / CHUNK_BYTES,
+                                                                     static_cast<size_t>(num_threads()) * 8));
+            std::vector<Chunk> chunks;
+            const char *end = data + size;
+            const char *p = data;
+            for (size_t k = 1; k <= want && p < end; ++k)
+            {
+                const char *q = k == want ? end : data + size / want * k;
+                if (q < p)
+                    q = p;
+                if (q < end)
+                {
+                    q = line_end(q, end);
+                    if (q < end)
+                        ++q;
+                }
+                Chunk c;
+                c.begin = p;
+                c.end = q;
+                chunks.push_back(c);
+                p = q;
+            }
+            return chunks;
+        }
+
+        // 第一遍：统计非空行并检查列数
+        inline void scan(Chunk &c, char delim)
+        {
+            for (const char *p = c.begin; p < c.end;)
+            {
+                const char *e = line_end(p, c.end);
+                if (!blank_line(p, e))
+                {
+                    const size_t cols = static_cast<size_t>(std::count(p, e, delim)) + 1;
+                    if (c.rows == 0)
+                        c.cols = cols;
+                    else if (cols != c.cols && c.bad_row == SIZE_MAX)
+                        c.bad_row = c.rows;
+                    ++c.rows;
+                }
+                p = e + 1;
+            }
+        }
+
+        template <typename F>
+        const char *parse_float(const char *p, const char *e, F &v)
+        {
+#if defined(__cpp_lib_to_chars)
+            auto r = std::from_chars(p, e, v);
+            return r.ec == std::errc() ? r.ptr : nullptr;
+#else
+            char buf[64];
+            const size_t n = std::min<size_t>(static_cast<size_t>(e - p), sizeof(buf) - 1);
+            std::memcpy(buf, p, n);
+            buf[n] = '\0';
+            char *stop = nullptr;
+            v = static_cast<F>(std::strtod(buf, &stop));
+            return stop == buf ? nullptr : p + (stop - buf);
+#endif
+        }
+
+        // 解析一个字段；整数类型遇到小数 / 指数时按 double 解析后截断（与旧实现一致）
+        template <typename T>
+        const char *parse_value(const char *p, const char *e, T &out)
+        {
+            if (p < e && *p == '+')
+                ++p;
+            if constexpr (std::is_integral_v<T>)
+            {
+                using W = std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>;
+                W w = 0;
+                auto r = std::from_chars(p, e, w);
+                if (r.ec == std::errc() && (r.ptr == e || (*r.ptr != '.' && *r.ptr != 'e' && *r.ptr != 'E')))
+                {
+                    out = static_cast<T>(w);
+                    return r.ptr;
+                }
+                double d = 0.0;
+                const char *q = parse_float(p, e, d);
+                if (q)
+                    out = static_cast<T>(d);
+                return q;
+            }
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                return parse_float(p, e, out);
+            }
+            else
+            {
+                float f = 0.0f;
+                const char *q = parse_float(p, e, f);
+                if (q)
+                    out = static_cast<T>(f);
+                return q;
+            }
+        }
+
+        // 第二遍：解析到 out + row0 * cols
+        template <typename T>
+        void parse(Chunk &c, size_t cols, char delim, T *out)
+        {
+            T *dst = out + c.row0 * cols;
+            size_t row = c.row0;
+            for (const char *p = c.begin; p < c.end;)
+            {
+                const char *e = line_end(p, c.end);
+                if (!blank_line(p, e))
+                {
+                    for (size_t j = 0; j < cols; ++j)
+                    {
+                        while (p < e && is_blank(*p) && *p != delim)
+                            ++p;
+                        const char *q = parse_value(p, e, *dst++);
+                        if (q)
+                        {
+                            while (q < e && is_blank(*q) && *q != delim)
+                                ++q;
+                            if (q < e && *q != (j + 1 < cols ? delim : '\n'))
+                                q = nullptr;
+                        }
+                        if (!q)
+                        {
+                            const char *f = p;
+                            while (f < e && *f != delim && *f != '\r')
+                                ++f;
+                            c.error = "Invalid number '" + std::string(p, f) + "' at row " +
+                                      std::to_string(row + 1) + ", column " + std::to_string(j + 1);
+                            return;
+                        }
+                        p = q + 1;
+                    }
+                    ++row;
+                }
+                p = e + 1;
+            }
+        }
+
+        // 写出一个值，返回结束位置；buf 至少 MAX_VALUE_CHARS 字节
+        template <typename T>
+        char *format_value(char *buf, T v)
+        {
+            if constexpr (std::is_integral_v<T>)
+            {
+                using W = std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>;
+                return std::to_chars(buf, buf + MAX_VALUE_CHARS, static_cast<W>(v)).ptr;
+            }
+            else
+            {
+                using F = std::conditional_t<std::is_same_v<T, double> || std::is_same_v<T, long double>, double, float>;
+                const F f = static_cast<F>(v);
+#if defined(__cpp_lib_to_chars)
+                return std::to_chars(buf, buf + MAX_VALUE_CHARS, f).ptr;
+#else
+                const int n = std::snprintf(buf, MAX_VALUE_CHARS, std::is_same_v<F, double> ? "%.17g" : "%.9g",
+                                            static_cast<double>(f));
+                return buf + n;
+#endif
+            }
+        }
+
+        // 把 csv 的行列映射回张量形状
+        inline void rows_cols(const std::vector<size_t> &shape, size_t &rows, size_t &cols)
+        {
+            rows = shape.size() == 2 ? shape[0] : 1;
+            cols = shape.empty() ? 1 : shape.back();
+        }
+    }
+
+    // 解析内存中的 CSV 文本
+    template <typename T>
+    Tensor<T> parse_csv(const char *data, size_t size, char delimiter = ',')
+    {
+        using namespace csv_detail;
+        if (delimiter == '\n' || delimiter == '\r' || delimiter == ' ')
+            TENSOR_THROW("Invalid CSV delimiter");
+        std::vector<Chunk> chunks = split(data, size);
+        const int64_t n = static_cast<int64_t>(chunks.size());
+
+#pragma omp parallel for schedule(dynamic) if (n > 1)
+        for (int64_t k = 0; k < n; ++k)
+            scan(chunks[k], delimiter);
+
+        size_t rows = 0, cols = 0;
+        for (auto &c : chunks)
+        {
+            if (c.rows == 0)
+                continue;
+            if (rows == 0)
+                cols = c.cols;
+            if (c.bad_row != SIZE_MAX || c.cols != cols)
+                TENSOR_THROW("Inconsistent CSV columns at row " +
+                             std::to_string(rows + (c.cols != cols ? 0 : c.bad_row) + 1));
+            c.row0 = rows;
+            rows += c.rows;
+        }
+        if (rows == 0)
+            return Tensor<T>();
+
+        std::vector<size_t> shape;
+        if (rows == 1 && cols == 1)
+            shape = {};
+        else if (rows == 1)
+            shape = {cols};
+        else
+            shape = {rows, cols};
+
+        Tensor<T> result(shape);
+        T *out = result.data->data();
+#pragma omp parallel for schedule(dynamic) if (n > 1)
+        for (int64_t k = 0; k < n; ++k)
+            parse(chunks[k], cols, delimiter, out);
+
+        for (const auto &c : chunks)
+            if (!c.error.empty())
+                TENSOR_THROW("CSV parse error: " + c.error);
+        return result;
+    }
+
+    template <typename T>
+    Tensor<T> read_csv(const std::string &filename, char delimiter = ',')
+    {
+        std::error_code ec;
+        const auto bytes = std::filesystem::file_size(filename, ec);
+        if (ec)
+            TENSOR_THROW("Cannot open file: " + filename);
+        if (bytes == 0)
+            return Tensor<T>();
+        MappedFile file(filename);
+        file.prefetch(0, file.size());
+        return parse_csv<T>(reinterpret_cast<const char *>(file.data()), file.size(), delimiter);
+    }
+
+    template <typename T>
+    void write_csv(const Tensor<T> &A, const std::string &filename, char delimiter = ',')
+    {
+        using namespace csv_detail;
+        if (A.shape().size() > 2)
+            TENSOR_THROW("CSV only supports 1D or 2D tensors");
+        std::ofstream file(filename, std::ios::binary);
+        if (!file)
+            TENSOR_THROW("Cannot open file for writing: " + filename);
+
+        size_t rows = 0, cols = 0;
+        rows_cols(A.shape(), rows, cols);
+        if (A.size() == 0)
+            return;
+
+        const T *src = A.data->data();
+        const size_t total = rows * cols;
+        const size_t n_chunks = (total + CHUNK_VALUES - 1) / CHUNK_VALUES;
+        const size_t batch = static_cast<size_t>(num_threads()) * 2;
+        std::vector<std::string> bufs(std::min(batch, n_chunks));
+
+        for (size_t c0 = 0; c0 < n_chunks; c0 += batch)
+        {
+            const int64_t nb = static_cast<int64_t>(std::min(batch, n_chunks - c0));
+#pragma omp parallel for schedule(dynamic) if (nb > 1)
+            for (int64_t b = 0; b < nb; ++b)
+            {
+                // 块为值区间 [v0, v1)，可以从行中间开始或结束
+                const size_t v0 = (c0 + static_cast<size_t>(b)) * CHUNK_VALUES;
+                const size_t v1 = std::min(total, v0 + CHUNK_VALUES);
+                std::string &s = bufs[b];
+                s.resize((v1 - v0) * (MAX_VALUE_CHARS + 1));
+                char *p = s.data();
+                size_t j = v0 % cols;
+                for (size_t v = v0; v < v1; ++v)
+                {
+                    p = format_value(p, src[v]);
+                    if (++j == cols)
+                    {
+                        *p++ = '\n';
+                        j = 0;
+                    }
+                    else
+                        *p++ = delimiter;
+                }
+                s.resize(static_cast<size_t>(p - s.data()));
+            }
+            for (int64_t b = 0; b < nb; ++b)
+                file.write(bufs[b].data(), static_cast<std::streamsize>(bufs[b].size()));
+        }
+        if (!file)
+            TENSOR_THROW("Error writing CSV file: " + filename);
+    }
+
+} // namespace TensorN
+
+#endif // __CSV__H__
@@ -3,6 +3,8 @@
 #define __GGUF__H__
 
 #include "../tensor.hpp"
+#include "../mapped_file.hpp"
+#include "gguf_quant.hpp"
 #include <cstring>
 #include <fstream>
 #include <string>
@@ -11,6 +13,9 @@
 #include <variant>
 #include <cstdint>
 #include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <functional>
 
 namespace TensorN
 {
@@ -101,6 +106,10 @@ namespace TensorN
             return GGMLType::F32;
         if constexpr (std::is_same_v<T, double>)
             return GGMLType::F64;
+        if constexpr (std::is_same_v<T, TensorN::half>)
+            return GGMLType::F16;
+        if constexpr (std::is_same_v<T, TensorN::bfloat16>)
+            return GGMLType::BF16;
         if constexpr (std::is_same_v<T, int8_t>)
             return GGMLType::I8;
         if constexpr (std::is_same_v<T, int16_t>)
@@ -119,6 +128,8 @@ namespace TensorN
     {
         return std::is_same_v<T, float> ||
                std::is_same_v<T, double> ||
+               std::is_same_v<T, TensorN::half> ||
+               std::is_same_v<T, TensorN::bfloat16> ||
                std::is_same_v<T, int8_t> ||
                std::is_same_v<T, int16_t> ||
                std::is_same_v<T, int32_t> ||
@@ -158,6 +169,30 @@ namespace TensorN
             return 210;
         case GGMLType::Q8_K:
             return 292;
+        case GGMLType::IQ2_XXS:
+            return 66;
+        case GGMLType::IQ2_XS:
+            return 74;
+        case GGMLType::IQ3_XXS:
+            return 98;
+        case GGMLType::IQ1_S:
+            return 50;
+        case GGMLType::IQ4_NL:
+            return 18;
+        case GGMLType::IQ3_S:
+            return 110;
+        case GGMLType::IQ2_S:
+            return 82;
+        case GGMLType::IQ4_XS:
+            return 136;
+        case GGMLType::IQ1_M:
+            return 56;
+        case GGMLType::TQ1_0:
+            return 54;
+        case GGMLType::TQ2_0:
+            return 66;
+        case GGMLType::MXFP4:
+            return 17;
         case GGMLType::I8:
             return 1;
         case GGMLType::I16:
@@ -176,6 +211,42 @@ namespace TensorN
         return 0;
     }
 
+    // 每个 block 包含的元素个数（非量化类型为 1）
+    inline size_t ggml_block_size(GGMLType type)
+    {
+        switch (type)
+        {
+        case GGMLType::Q4_0:
+        case GGMLType::Q4_1:
+        case GGMLType::Q5_0:
+        case GGMLType::Q5_1:
+        case GGMLType::Q8_0:
+        case GGMLType::Q8_1:
+        case GGMLType::IQ4_NL:
+        case GGMLType::MXFP4:
+            return 32;
+        case GGMLType::Q2_K:
+        case GGMLType::Q3_K:
+        case GGMLType::Q4_K:
+        case GGMLType::Q5_K:
+        case GGMLType::Q6_K:
+        case GGMLType::Q8_K:
+        case GGMLType::IQ2_XXS:
+        case GGMLType::IQ2_XS:
+        case GGMLType::IQ3_XXS:
+        case GGMLType::IQ1_S:
+        case GGMLType::IQ3_S:
+        case GGMLType::IQ2_S:
+        case GGMLType::IQ4_XS:
+        case GGMLType::IQ1_M:
+        case GGMLType::TQ1_0:
+        case GGMLType::TQ2_0:
+            return 256;
+        default:
+            return 1;
+        }
+    }
+
     inline size_t ggml_type_element_size(GGMLType type)
     {
         switch (type)
@@ -202,6 +273,263 @@ namespace TensorN
         return 0;
     }
 
+    // ------------------------------------------------------------
+    // 反量化：把 F16/BF16 与 ggml 量化 block 解码为浮点张量
+    // ------------------------------------------------------------
+
+    inline bool ggml_can_dequantize(GGMLType type)
+    {
+        switch (type)
+        {
+        case GGMLType::F32:
+        case GGMLType::F16:
+        case GGMLType::BF16:
+        case GGMLType::Q4_0:
+        case GGMLType::Q4_1:
+        case GGMLType::Q5_0:
+        case GGMLType::Q5_1:
+        case GGMLType::Q8_0:
+        case GGMLType::Q8_1:
+        case GGMLType::Q2_K:
+        case GGMLType::Q3_K:
+        case GGMLType::Q4_K:
+        case GGMLType::Q5_K:
+        case GGMLType::Q6_K:
+        case GGMLType::Q8_K:
+        case GGMLType::IQ4_NL:
+        case GGMLType::IQ4_XS:
+        case GGMLType::TQ1_0:
+        case GGMLType::TQ2_0:
+        case GGMLType::MXFP4:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // 可作为反量化目标的元素类型
+    template <typename T>
+    constexpr bool is_gguf_dequantize_target()
+    {
+        return std::is_same_v<T, float> ||
+               std::is_same_v<T, double> ||
+               std::is_same_v<T, TensorN::half> ||
+               std::is_same_v<T, TensorN::bfloat16>;
+    }
+
+    // 单线程解码 n 个元素（n 必须是 block 大小的整数倍）
+    inline void ggml_dequantize_row(GGMLType type, const void *src, float *dst, size_t n)
+    {
+        using namespace gguf_quant;
+        const size_t nb = n / ggml_block_size(type);
+        switch (type)
+        {
+        case GGMLType::F32:
+            std::memcpy(dst, src, n * sizeof(float));
+            break;
+        case GGMLType::F16:
+        {
+            const uint16_t *h = static_cast<const uint16_t *>(src);
+            for (size_t i = 0; i < n; ++i)
+                dst[i] = fp::half_bits_to_float(h[i]);
+            break;
+        }
+        case GGMLType::BF16:
+        {
+            const uint16_t *b = static_cast<const uint16_t *>(src);
+            for (size_t i = 0; i < n; ++i)
+                dst[i] = fp::bfloat16_bits_to_float(b[i]);
+            break;
+        }
+        case GGMLType::Q4_0:
+            dequantize_row_q4_0(static_cast<const BlockQ4_0 *>(src), dst, nb);
+            break;
+        case GGMLType::Q4_1:
+            dequantize_row_q4_1(static_cast<const BlockQ4_1 *>(src), dst, nb);
+            break;
+        case GGMLType::Q5_0:
+            dequantize_row_q5_0(static_cast<const BlockQ5_0 *>(src), dst, nb);
+            break;
+        case GGMLType::Q5_1:
+            dequantize_row_q5_1(static_cast<const BlockQ5_1 *>(src), dst, nb);
+            break;
+        case GGMLType::Q8_0:
+            dequantize_row_q8_0(static_cast<const BlockQ8_0 *>(src), dst, nb);
+            break;
+        case GGMLType::Q8_1:
+            dequantize_row_q8_1(static_cast<const BlockQ8_1 *>(src), dst, nb);
+            break;
+        case GGMLType::Q2_K:
+            dequantize_row_q2_K(static_cast<const BlockQ2_K *>(src), dst, nb);
+            break;
+        case GGMLType::Q3_K:
+            dequantize_row_q3_K(static_cast<const BlockQ3_K *>(src), dst, nb);
+            break;
+        case GGMLType::Q4_K:
+            dequantize_row_q4_K(static_cast<const BlockQ4_K *>(src), dst, nb);
+            break;
+        case GGMLType::Q5_K:
+            dequantize_row_q5_K(static_cast<const BlockQ5_K *>(src), dst, nb);
+            break;
+        case GGMLType::Q6_K:
+            dequantize_row_q6_K(static_cast<const BlockQ6_K *>(src), dst, nb);
+            break;
+        case GGMLType::Q8_K:
+            dequantize_row_q8_K(static_cast<const BlockQ8_K *>(src), dst, nb);
+            break;
+        case GGMLType::IQ4_NL:
+            dequantize_row_iq4_nl(static_cast<const BlockIQ4_NL *>(src), dst, nb);
+            break;
+        case GGMLType::IQ4_XS:
+            dequantize_row_iq4_xs(static_cast<const BlockIQ4_XS *>(src), dst, nb);
+            break;
+        case GGMLType::TQ1_0:
+            dequantize_row_tq1_0(static_cast<const BlockTQ1_0 *>(src), dst, nb);
+            break;
+        case GGMLType::TQ2_0:
+            dequantize_row_tq2_0(static_cast<const BlockTQ2_0 *>(src), dst, nb);
+            break;
+        case GGMLType::MXFP4:
+            dequantize_row_mxfp4(static_cast<const BlockMXFP4 *>(src), dst, nb);
+            break;
+        default:
+            TENSOR_THROW("Dequantization not supported for GGML type " +
+                         std::to_string(static_cast<uint32_t>(type)));
+        }
+    }
+
+    // 多线程反量化：按 block 分块并行，非 float 目标经由线程私有缓冲转换
+    template <typename T>
+    void ggml_dequantize(GGMLType type, const void *src, T *dst, size_t n)
+    {
+        static_assert(is_gguf_dequantize_target<T>(), "Dequantization target must be a floating-point type");
+        if (!ggml_can_dequantize(type))
+            TENSOR_THROW("Dequantization not supported for GGML type " +
+                         std::to_string(static_cast<uint32_t>(type)));
+
+        const size_t bs = ggml_block_size(type);
+        const size_t ts = ggml_type_size(type);
+        if (n % bs != 0)
+            TENSOR_THROW("Element count is not a multiple of the GGML block size");
+
+        constexpr size_t chunk_elems = 4096;
+        const size_t nb = n / bs;
+        const size_t blocks_per_chunk = std::max<size_t>(1, chunk_elems / bs);
+        const int64_t n_chunks = static_cast<int64_t>((nb + blocks_per_chunk - 1) / blocks_per_chunk);
+        const uint8_t *s = static_cast<const uint8_t *>(src);
+
+#pragma omp parallel for schedule(static) if (n_chunks > 1)
+        for (int64_t c = 0; c < n_chunks; ++c)
+        {
+            const size_t b0 = static_cast<size_t>(c) * blocks_per_chunk;
+            const size_t b1 = std::min(nb, b0 + blocks_per_chunk);
+            const size_t cn = (b1 - b0) * bs;
+            if constexpr (std::is_same_v<T, float>)
+            {
+                ggml_dequantize_row(type, s + b0 * ts, dst + b0 * bs, cn);
+            }
+            else
+            {
+                float buf[chunk_elems];
+                ggml_dequantize_row(type, s + b0 * ts, buf, cn);
+                T *out = dst + b0 * bs;
+                for (size_t k = 0; k < cn; ++k)
+                    out[k] = static_cast<T>(buf[k]);
+            }
+        }
+    }
+
+    // ------------------------------------------------------------
+    // 量化：把 float 行编码为 F16/BF16 或 ggml 量化 block
+    // ------------------------------------------------------------
+
+    inline bool ggml_can_quantize(GGMLType type)
+    {
+        switch (type)
+        {
+        case GGMLType::F32:
+        case GGMLType::F16:
+        case GGMLType::BF16:
+        case GGMLType::Q4_0:
+        case GGMLType::Q5_0:
+        case GGMLType::Q8_0:
+        case GGMLType::Q4_K:
+        case GGMLType::Q5_K:
+        case GGMLType::Q6_K:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // 编码一行 n 个元素（n 必须是 block 大小的整数倍）；imatrix 为该行各列的
+    // 重要性权重，可为空
+    inline void ggml_quantize_row(GGMLType type, const float *src, void *dst, size_t n,
+                                  const float *imatrix = nullptr)
+    {
+        using namespace gguf_quant;
+        switch (type)
+        {
+        case GGMLType::F32:
+            std::memcpy(dst, src, n * sizeof(float));
+            break;
+        case GGMLType::F16:
+        {
+            uint16_t *h = static_cast<uint16_t *>(dst);
+            for (size_t i = 0; i < n; ++i)
+                h[i] = fp::float_to_half_bits(src[i]);
+            break;
+        }
+        case GGMLType::BF16:
+        {
+            uint16_t *b = static_cast<uint16_t *>(dst);
+            for (size_t i = 0; i < n; ++i)
+                b[i] = fp::float_to_bfloat16_bits(src[i]);
+            break;
+        }
+        case GGMLType::Q4_0:
+            quantize_row_q4_0(src, static_cast<BlockQ4_0 *>(dst), n, imatrix);
+            break;
+        case GGMLType::Q5_0:
+            quantize_row_q5_0(src, static_cast<BlockQ5_0 *>(dst), n, imatrix);
+            break;
+        case GGMLType::Q8_0:
+            quantize_row_q8_0(src, static_cast<BlockQ8_0 *>(dst), n);
+            break;
+        case GGMLType::Q4_K:
+            quantize_row_q4_K(src, static_cast<BlockQ4_K *>(dst), n, imatrix);
+            break;
+        case GGMLType::Q5_K:
+            quantize_row_q5_K(src, static_cast<BlockQ5_K *>(dst), n, imatrix);
+            break;
+        case GGMLType::Q6_K:
+            quantize_row_q6_K(src, static_cast<BlockQ6_K *>(dst), n, imatrix);
+            break;
+        default:
+            TENSOR_THROW("Quantization not supported for GGML type " +
+                         std::to_string(static_cast<uint32_t>(type)));
+        }
+    }
+
+    // 量化 rows x cols 的行主序矩阵，按行多线程并行，返回打包后的字节
+    inline std::vector<uint8_t> ggml_quantize(GGMLType type, const float *src, size_t rows, size_t cols,
+                                              const float *imatrix = nullptr)
+    {
+        if (!ggml_can_quantize(type))
+            TENSOR_THROW("Quantization not supported for GGML type " +
+                         std::to_string(static_cast<uint32_t>(type)));
+        if (cols % ggml_block_size(type) != 0)
+            TENSOR_THROW("Row size is not a multiple of the GGML block size");
+
+        const size_t row_bytes = cols / ggml_block_size(type) * ggml_type_size(type);
+        std::vector<uint8_t> out(rows * row_bytes);
+        const int64_t n_rows = static_cast<int64_t>(rows);
+#pragma omp parallel for schedule(static) if (n_rows > 1)
+        for (int64_t r = 0; r < n_rows; ++r)
+            ggml_quantize_row(type, src + r * cols, out.data() + r * row_bytes, cols, imatrix);
+        return out;
+    }
+
     inline uint64_t align_offset(uint64_t offset, uint32_t alignment)
     {
         return offset + (alignment - (offset % alignment)) % alignment;
@@ -370,9 +698,10 @@ namespace TensorN
         write_gguf_string(file, tensor_name);
         uint32_t n_dims = static_cast<uint32_t>(shape.size());
         file.write(reinterpret_cast<const char *>(&n_dims), sizeof(n_dims));
-        for (auto dim : shape)
+        // ggml 约定：dims[0] 为最内层维度，因此按行主序形状的逆序写入
+        for (auto it = shape.rbegin(); it != shape.rend(); ++it)
         {
-            uint64_t dim64 = static_cast<uint64_t>(dim);
+            uint64_t dim64 = static_cast<uint64_t>(*it);
             file.write(reinterpret_cast<const char *>(&dim64), sizeof(dim64));
         }
         uint32_t type_u32 = static_cast<uint32_t>(gguf_type);
@@ -398,539 +727,427 @@ namespace TensorN
             TENSOR_THROW("Error writing GGUF file: " + filename);
     }
 
-    template <typename T>
-    Tensor<T> load_gguf(const std::string &filename,
-                        const std::string &tensor_name = "")
+    using GGUFMetadataMap = std::unordered_map<std::string, GGUFMetadataValue>;
+
+    // ------------------------------------------------------------
+    // GGUFFile —— 一次 mmap + 一次解析，建立张量索引后零拷贝取用
+    // ------------------------------------------------------------
+
+    // 张量信息；dims 按 GGUF/ggml 约定存储（dims[0] 为最内层、连续的维度）
+    struct GGUFTensorInfo
     {
-        if (!is_supported_gguf_type<T>())
+        std::string name;
+        std::vector<uint64_t> dims;
+        GGMLType type;
+        uint64_t offset; // 相对数据区起始位置
+
+        // 行主序形状（dims 的逆序），与 Tensor<T>::shape() 一致
+        std::vector<size_t> shape() const
         {
-            TENSOR_THROW("Type not supported for .gguf format");
+            return std::vector<size_t>(dims.rbegin(), dims.rend());
         }
 
-        std::ifstream file(filename, std::ios::binary);
-        if (!file)
-            TENSOR_THROW("Cannot open file: " + filename);
+        size_t numel() const
+        {
+            size_t n = 1;
+            for (auto d : dims)
+                n *= static_cast<size_t>(d);
+            return n;
+        }
 
-        uint32_t magic;
-        file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
-        if (magic != GGUF_MAGIC)
-            TENSOR_THROW("Not a valid GGUF file (bad magic)");
+        size_t nbytes() const
+        {
+            return numel() / ggml_block_size(type) * ggml_type_size(type);
+        }
+    };
 
-        uint32_t version;
-        file.read(reinterpret_cast<char *>(&version), sizeof(version));
-        if (version != GGUF_VERSION)
-            TENSOR_THROW("Unsupported GGUF version: " + std::to_string(version));
+    // 元数据数组（如 tokenizer.ggml.tokens），只记录位置，按需解码
+    struct GGUFArrayView
+    {
+        GGUFMetadataValueType type;
+        uint64_t length;
+        const uint8_t *data;
+    };
 
-        uint64_t tensor_count;
-        file.read(reinterpret_cast<char *>(&tensor_count), sizeof(tensor_count));
+    // 原始字节视图：量化张量以 ggml block 的打包格式直接访问
+    struct GGUFTensorView
+    {
+        const GGUFTensorInfo *info;
+        const uint8_t *data;
+        size_t nbytes;
 
-        uint64_t metadata_kv_count;
-        file.read(reinterpret_cast<char *>(&metadata_kv_count), sizeof(metadata_kv_count));
+        size_t n_blocks() const { return info->numel() / ggml_block_size(info->type); }
 
-        for (uint64_t i = 0; i < metadata_kv_count; ++i)
+        template <typename Block>
+        const Block *blocks() const
         {
-            read_gguf_string(file);
-            uint32_t vtype_u32;
-            file.read(reinterpret_cast<char *>(&vtype_u32), sizeof(vtype_u32));
-            GGUFMetadataValueType vtype = static_cast<GGUFMetadataValueType>(vtype_u32);
-
-            switch (vtype)
-            {
-            case GGUFMetadataValueType::UINT8:
-            case GGUFMetadataValueType::INT8:
-            {
-                int8_t v;
-                file.read(reinterpret_cast<char *>(&v), 1);
-                break;
-            }
-            case GGUFMetadataValueType::UINT16:
-            case GGUFMetadataValueType::INT16:
-            {
-                int16_t v;
-                file.read(reinterpret_cast<char *>(&v), 2);
-                break;
-            }
-            case GGUFMetadataValueType::UINT32:
-            case GGUFMetadataValueType::INT32:
-            case GGUFMetadataValueType::FLOAT32:
-            case GGUFMetadataValueType::BOOL:
-            {
-                int32_t v;
-                file.read(reinterpret_cast<char *>(&v), 4);
-                break;
-            }
-            case GGUFMetadataValueType::UINT64:
-            case GGUFMetadataValueType::INT64:
-            case GGUFMetadataValueType::FLOAT64:
-            {
-                int64_t v;
-                file.read(reinterpret_cast<char *>(&v), 8);
-                break;
-            }
-            case GGUFMetadataValueType::STRING:
-            {
-                read_gguf_string(file);
-                break;
-            }
-            case GGUFMetadataValueType::ARRAY:
-            {
-                uint32_t arr_type;
-                file.read(reinterpret_cast<char *>(&arr_type), sizeof(arr_type));
-                uint64_t arr_len;
-                file.read(reinterpret_cast<char *>(&arr_len), sizeof(arr_len));
-                for (uint64_t j = 0; j < arr_len; ++j)
-                {
-                    GGUFMetadataValueType elem_type = static_cast<GGUFMetadataValueType>(arr_type);
-                    switch (elem_type)
-                    {
-                    case GGUFMetadataValueType::UINT8:
-                    case GGUFMetadataValueType::INT8:
-                    {
-                        int8_t v;
-                        file.read(reinterpret_cast<char *>(&v), 1);
-                        break;
-                    }
-                    case GGUFMetadataValueType::UINT16:
-                    case GGUFMetadataValueType::INT16:
-                    {
-                        int16_t v;
-                        file.read(reinterpret_cast<char *>(&v), 2);
-                        break;
-                    }
-                    case GGUFMetadataValueType::UINT32:
-                    case GGUFMetadataValueType::INT32:
-                    case GGUFMetadataValueType::FLOAT32:
-                    case GGUFMetadataValueType::BOOL:
-                    {
-                        int32_t v;
-                        file.read(reinterpret_cast<char *>(&v), 4);
-                        break;
-                    }
-                    case GGUFMetadataValueType::UINT64:
-                    case GGUFMetadataValueType::INT64:
-                    case GGUFMetadataValueType::FLOAT64:
-                    {
-                        int64_t v;
-                        file.read(reinterpret_cast<char *>(&v), 8);
-                        break;
-                    }
-                    case GGUFMetadataValueType::STRING:
-                    {
-                        read_gguf_string(file);
-                        break;
-                    }
-                    case GGUFMetadataValueType::ARRAY:
-                        TENSOR_THROW("Nested arrays not supported in GGUF metadata reader");
-                    }
-                }
-                break;
-            }
-            }
+            if (sizeof(Block) != ggml_type_size(info->type))
+                TENSOR_THROW("Block size mismatch for tensor '" + info->name + "'");
+            return reinterpret_cast<const Block *>(data);
         }
+    };
 
-        struct TensorInfo
+    namespace gguf_detail
+    {
+        // 映射区上的带边界检查的顺序读取器
+        class Cursor
         {
-            std::string name;
-            uint32_t n_dims;
-            std::vector<uint64_t> dims;
-            GGMLType type;
-            uint64_t offset;
-        };
+        public:
+            Cursor(const uint8_t *begin, const uint8_t *end) : _p(begin), _begin(begin), _end(end) {}
 
-        std::vector<TensorInfo> tensor_infos(tensor_count);
-        for (uint64_t i = 0; i < tensor_count; ++i)
-        {
-            tensor_infos[i].name = read_gguf_string(file);
-            file.read(reinterpret_cast<char *>(&tensor_infos[i].n_dims), sizeof(uint32_t));
-            tensor_infos[i].dims.resize(tensor_infos[i].n_dims);
-            for (uint32_t d = 0; d < tensor_infos[i].n_dims; ++d)
+            template <typename V>
+            V read()
             {
-                file.read(reinterpret_cast<char *>(&tensor_infos[i].dims[d]), sizeof(uint64_t));
+                require(sizeof(V));
+                V v;
+                std::memcpy(&v, _p, sizeof(V));
+                _p += sizeof(V);
+                return v;
             }
-            uint32_t type_u32;
-            file.read(reinterpret_cast<char *>(&type_u32), sizeof(uint32_t));
-            tensor_infos[i].type = static_cast<GGMLType>(type_u32);
-            file.read(reinterpret_cast<char *>(&tensor_infos[i].offset), sizeof(uint64_t));
-        }
 
-        if (tensor_count == 0)
-            TENSOR_THROW("No tensors found in GGUF file");
+            std::string read_string()
+            {
+                uint64_t len = read<uint64_t>();
+                require(len);
+                std::string str(reinterpret_cast<const char *>(_p), static_cast<size_t>(len));
+                _p += len;
+                return str;
+            }
 
-        uint64_t tensor_data_base = static_cast<uint64_t>(file.tellg());
-        tensor_data_base = align_offset(tensor_data_base, GGUF_DEFAULT_ALIGNMENT);
+            void skip(uint64_t n)
+            {
+                require(n);
+                _p += n;
+            }
 
-        size_t target_idx = 0;
-        if (!tensor_name.empty())
-        {
-            bool found = false;
-            for (size_t i = 0; i < tensor_infos.size(); ++i)
+            void skip_value(GGUFMetadataValueType vtype)
             {
-                if (tensor_infos[i].name == tensor_name)
+                switch (vtype)
                 {
-                    target_idx = i;
-                    found = true;
+                case GGUFMetadataValueType::UINT8:
+                case GGUFMetadataValueType::INT8:
+                case GGUFMetadataValueType::BOOL:
+                    skip(1);
+                    break;
+                case GGUFMetadataValueType::UINT16:
+                case GGUFMetadataValueType::INT16:
+                    skip(2);
+                    break;
+                case GGUFMetadataValueType::UINT32:
+                case GGUFMetadataValueType::INT32:
+                case GGUFMetadataValueType::FLOAT32:
+                    skip(4);
+                    break;
+                case GGUFMetadataValueType::UINT64:
+                case GGUFMetadataValueType::INT64:
+                case GGUFMetadataValueType::FLOAT64:
+                    skip(8);
+                    break;
+                case GGUFMetadataValueType::STRING:
+                    skip(read<uint64_t>());
                     break;
+                case GGUFMetadataValueType::ARRAY:
+                    TENSOR_THROW("Nested arrays not supported in GGUF metadata reader");
+                default:
+                    TENSOR_THROW("Unknown GGUF metadata value type");
                 }
             }
-            if (!found)
-                TENSOR_THROW("Tensor '" + tensor_name + "' not found in GGUF file");
-        }
-
-        const auto &info = tensor_infos[target_idx];
-        GGMLType expected_type = get_gguf_type<T>();
-
-        std::vector<size_t> shape(info.n_dims);
-        size_t total_elements = 1;
-        for (uint32_t d = 0; d < info.n_dims; ++d)
-        {
-            shape[d] = static_cast<size_t>(info.dims[d]);
-            total_elements *= shape[d];
-        }
-
-        if (info.type == expected_type ||
-            (info.type == GGMLType::F32 && expected_type == GGMLType::F32) ||
-            (info.type == GGMLType::F64 && expected_type == GGMLType::F64) ||
-            (info.type == GGMLType::I8 && expected_type == GGMLType::I8) ||
-            (info.type == GGMLType::I16 && expected_type == GGMLType::I16) ||
-            (info.type == GGMLType::I32 && expected_type == GGMLType::I32) ||
-            (info.type == GGMLType::I64 && expected_type == GGMLType::I64))
-        {
-            uint64_t abs_offset = tensor_data_base + info.offset;
-            file.seekg(static_cast<std::streamoff>(abs_offset));
 
-            std::vector<T> data_vec(total_elements);
-            file.read(reinterpret_cast<char *>(data_vec.data()),
-                      static_cast<std::streamsize>(total_elements * sizeof(T)));
+            const uint8_t *ptr() const { return _p; }
+            uint64_t position() const { return static_cast<uint64_t>(_p - _begin); }
 
-            if (!file)
-                TENSOR_THROW("Error reading tensor data from GGUF file");
-
-            return Tensor<T>(shape, data_vec);
-        }
-        else
-        {
-            TENSOR_THROW(
-                "Type mismatch in GGUF file. Expected GGML type " +
-                std::to_string(static_cast<uint32_t>(expected_type)) +
-                ", got " + std::to_string(static_cast<uint32_t>(info.type)));
-        }
-    }
-
-    inline std::vector<std::string> gguf_list_tensors(const std::string &filename)
-    {
-        std::ifstream file(filename, std::ios::binary);
-        if (!file)
-            TENSOR_THROW("Cannot open file: " + filename);
-
-        uint32_t magic;
-        file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
-        if (magic != GGUF_MAGIC)
-            TENSOR_THROW("Not a valid GGUF file (bad magic)");
-
-        uint32_t version;
-        file.read(reinterpret_cast<char *>(&version), sizeof(version));
-
-        uint64_t tensor_count;
-        file.read(reinterpret_cast<char *>(&tensor_count), sizeof(tensor_count));
+        private:
+            void require(uint64_t n) const
+            {
+                if (n > static_cast<uint64_t>(_end - _p))
+                    TENSOR_THROW("Unexpected end of GGUF file");
+            }
 
-        uint64_t metadata_kv_count;
-        file.read(reinterpret_cast<char *>(&metadata_kv_count), sizeof(metadata_kv_count));
+            const uint8_t *_p;
+            const uint8_t *_begin;
+            const uint8_t *_end;
+        };
 
-        for (uint64_t i = 0; i < metadata_kv_count; ++i)
+        inline GGUFMetadataValue read_scalar(Cursor &cur, GGUFMetadataValueType vtype)
         {
-            read_gguf_string(file);
-            uint32_t vtype_u32;
-            file.read(reinterpret_cast<char *>(&vtype_u32), sizeof(vtype_u32));
-            GGUFMetadataValueType vtype = static_cast<GGUFMetadataValueType>(vtype_u32);
-
             switch (vtype)
             {
             case GGUFMetadataValueType::UINT8:
+                return cur.read<uint8_t>();
             case GGUFMetadataValueType::INT8:
-            {
-                int8_t v;
-                file.read(reinterpret_cast<char *>(&v), 1);
-                break;
-            }
+                return cur.read<int8_t>();
             case GGUFMetadataValueType::UINT16:
+                return cur.read<uint16_t>();
             case GGUFMetadataValueType::INT16:
-            {
-                int16_t v;
-                file.read(reinterpret_cast<char *>(&v), 2);
-                break;
-            }
+                return cur.read<int16_t>();
             case GGUFMetadataValueType::UINT32:
+                return cur.read<uint32_t>();
             case GGUFMetadataValueType::INT32:
+                return cur.read<int32_t>();
             case GGUFMetadataValueType::FLOAT32:
+                return cur.read<float>();
             case GGUFMetadataValueType::BOOL:
-            {
-                int32_t v;
-                file.read(reinterpret_cast<char *>(&v), 4);
-                break;
-            }
+                return cur.read<uint8_t>() != 0;
+            case GGUFMetadataValueType::STRING:
+                return cur.read_string();
             case GGUFMetadataValueType::UINT64:
+                return cur.read<uint64_t>();
             case GGUFMetadataValueType::INT64:
+                return cur.read<int64_t>();
             case GGUFMetadataValueType::FLOAT64:
-            {
-                int64_t v;
-                file.read(reinterpret_cast<char *>(&v), 8);
-                break;
-            }
-            case GGUFMetadataValueType::STRING:
-            {
-                read_gguf_string(file);
-                break;
-            }
-            case GGUFMetadataValueType::ARRAY:
-            {
-                uint32_t arr_type;
-                file.read(reinterpret_cast<char *>(&arr_type), sizeof(arr_type));
-                uint64_t arr_len;
-                file.read(reinterpret_cast<char *>(&arr_len), sizeof(arr_len));
-                for (uint64_t j = 0; j < arr_len; ++j)
-                {
-                    GGUFMetadataValueType elem_type = static_cast<GGUFMetadataValueType>(arr_type);
-                    switch (elem_type)
-                    {
-                    case GGUFMetadataValueType::UINT8:
-                    case GGUFMetadataValueType::INT8:
-                    {
-                        int8_t v;
-                        file.read(reinterpret_cast<char *>(&v), 1);
-                        break;
-                    }
-                    case GGUFMetadataValueType::UINT16:
-                    case GGUFMetadataValueType::INT16:
-                    {
-                        int16_t v;
-                        file.read(reinterpret_cast<char *>(&v), 2);
-                        break;
-                    }
-                    case GGUFMetadataValueType::UINT32:
-                    case GGUFMetadataValueType::INT32:
-                    case GGUFMetadataValueType::FLOAT32:
-                    case GGUFMetadataValueType::BOOL:
-                    {
-                        int32_t v;
-                        file.read(reinterpret_cast<char *>(&v), 4);
-                        break;
-                    }
-                    case GGUFMetadataValueType::UINT64:
-                    case GGUFMetadataValueType::INT64:
-                    case GGUFMetadataValueType::FLOAT64:
-                    {
-                        int64_t v;
-                        file.read(reinterpret_cast<char *>(&v), 8);
-                        break;
-                    }
-                    case GGUFMetadataValueType::STRING:
-                    {
-                        read_gguf_string(file);
-                        break;
-                    }
-                    case GGUFMetadataValueType::ARRAY:
-                        TENSOR_THROW("Nested arrays not supported");
-                    }
-                }
-                break;
-            }
+                return cur.read<double>();
+            default:
+                TENSOR_THROW("Unknown GGUF metadata value type");
             }
         }
 
-        std::vector<std::string> names;
-        for (uint64_t i = 0; i < tensor_count; ++i)
+        inline uint64_t metadata_as_u64(const GGUFMetadataValue &v)
         {
-            std::string name = read_gguf_string(file);
-            names.push_back(name);
-
-            uint32_t n_dims;
-            file.read(reinterpret_cast<char *>(&n_dims), sizeof(n_dims));
-            for (uint32_t d = 0; d < n_dims; ++d)
-            {
-                uint64_t dim;
-                file.read(reinterpret_cast<char *>(&dim), sizeof(dim));
-            }
-            uint32_t type_u32;
-            file.read(reinterpret_cast<char *>(&type_u32), sizeof(type_u32));
-            uint64_t offset;
-            file.read(reinterpret_cast<char *>(&offset), sizeof(offset));
+            return std::visit([](const auto &x) -> uint64_t
+                              {
+                                  using V = std::decay_t<decltype(x)>;
+                                  if constexpr (std::is_same_v<V, std::string>)
+                                      TENSOR_THROW("Expected an integer GGUF metadata value");
+                                  else
+                                      return static_cast<uint64_t>(x); },
+                              v);
         }
-
-        return names;
     }
 
-    using GGUFMetadataMap = std::unordered_map<std::string, GGUFMetadataValue>;
-
-    inline GGUFMetadataMap gguf_read_metadata(const std::string &filename)
+    class GGUFFile
     {
-        std::ifstream file(filename, std::ios::binary);
-        if (!file)
-            TENSOR_THROW("Cannot open file: " + filename);
-
-        uint32_t magic;
-        file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
-        if (magic != GGUF_MAGIC)
-            TENSOR_THROW("Not a valid GGUF file (bad magic)");
-
-        uint32_t version;
-        file.read(reinterpret_cast<char *>(&version), sizeof(version));
-
-        uint64_t tensor_count;
-        file.read(reinterpret_cast<char *>(&tensor_count), sizeof(tensor_count));
+    private:
+        std::shared_ptr<MappedFile> _file;
+        uint32_t _version = 0;
+        uint32_t _alignment = GGUF_DEFAULT_ALIGNMENT;
+        uint64_t _data_offset = 0;
+        GGUFMetadataMap _metadata;
+        std::unordered_map<std::string, GGUFArrayView> _arrays;
+        std::vector<GGUFTensorInfo> _infos;
+        std::unordered_map<std::string, size_t> _index;
+
+    public:
+        explicit GGUFFile(const std::string &filename) : _file(MappedFile::open(filename))
+        {
+            gguf_detail::Cursor cur(_file->data(), _file->data() + _file->size());
 
-        uint64_t metadata_kv_count;
-        file.read(reinterpret_cast<char *>(&metadata_kv_count), sizeof(metadata_kv_count));
+            if (cur.read<uint32_t>() != GGUF_MAGIC)
+                TENSOR_THROW("Not a valid GGUF file (bad magic)");
+            _version = cur.read<uint32_t>();
+            if (_version != 2 && _version != GGUF_VERSION)
+                TENSOR_THROW("Unsupported GGUF version: " + std::to_string(_version));
 
-        GGUFMetadataMap result;
+            uint64_t tensor_count = cur.read<uint64_t>();
+            uint64_t metadata_kv_count = cur.read<uint64_t>();
 
-        for (uint64_t i = 0; i < metadata_kv_count; ++i)
-        {
-            std::string key = read_gguf_string(file);
-            uint32_t vtype_u32;
-            file.read(reinterpret_cast<char *>(&vtype_u32), sizeof(vtype_u32));
-            GGUFMetadataValueType vtype = static_cast<GGUFMetadataValueType>(vtype_u32);
-
-            switch (vtype)
-            {
-            case GGUFMetadataValueType::UINT8:
-            {
-                uint8_t v;
-                file.read(reinterpret_cast<char *>(&v), 1);
-                result[key] = v;
-                break;
-            }
-            case GGUFMetadataValueType::INT8:
-            {
-                int8_t v;
-                file.read(reinterpret_cast<char *>(&v), 1);
-                result[key] = v;
-                break;
-            }
-            case GGUFMetadataValueType::UINT16:
-            {
-                uint16_t v;
-                file.read(reinterpret_cast<char *>(&v), 2);
-                result[key] = v;
-                break;
-            }
-            case GGUFMetadataValueType::INT16:
-            {
-                int16_t v;
-                file.read(reinterpret_cast<char *>(&v), 2);
-                result[key] = v;
-                break;
-            }
-            case GGUFMetadataValueType::UINT32:
-            {
-                uint32_t v;
-                file.read(reinterpret_cast<char *>(&v), 4);
-                result[key] = v;
-                break;
-            }
-            case GGUFMetadataValueType::INT32:
+            for (uint64_t i = 0; i < metadata_kv_count; ++i)
             {
-                int32_t v;
-                file.read(reinterpret_cast<char *>(&v), 4);
-                result[key] = v;
-                break;
+                std::string key = cur.read_string();
+                auto vtype = static_cast<GGUFMetadataValueType>(cur.read<uint32_t>());
+                if (vtype == GGUFMetadataValueType::ARRAY)
+                {
+                    auto elem_type = static_cast<GGUFMetadataValueType>(cur.read<uint32_t>());
+                    uint64_t length = cur.read<uint64_t>();
+                    _arrays[key] = GGUFArrayView{elem_type, length, cur.ptr()};
+                    for (uint64_t j = 0; j < length; ++j)
+                        cur.skip_value(elem_type);
+                }
+                else
+                {
+                    _metadata[key] = gguf_detail::read_scalar(cur, vtype);
+                }
             }
-            case GGUFMetadataValueType::FLOAT32:
+
+            auto it_align = _metadata.find("general.alignment");
+            if (it_align != _metadata.end())
             {
-                float v;
-                file.read(reinterpret_cast<char *>(&v), 4);
-                result[key] = v;
-                break;
+                _alignment = static_cast<uint32_t>(gguf_detail::metadata_as_u64(it_align->second));
+                if (_alignment == 0 || (_alignment & (_alignment - 1)) != 0)
+                    TENSOR_THROW("Invalid general.alignment: " + std::to_string(_alignment));
             }
-            case GGUFMetadataValueType::BOOL:
+
+            _infos.resize(tensor_count);
+            _index.reserve(tensor_count);
+            for (uint64_t i = 0; i < tensor_count; ++i)
             {
-                uint8_t v;
-                file.read(reinterpret_cast<char *>(&v), 1);
-                result[key] = (v != 0);
-                break;
+                auto &info = _infos[i];
+                info.name = cur.read_string();
+                uint32_t n_dims = cur.read<uint32_t>();
+                info.dims.resize(n_dims);
+                for (uint32_t d = 0; d < n_dims; ++d)
+                    info.dims[d] = cur.read<uint64_t>();
+                info.type = static_cast<GGMLType>(cur.read<uint32_t>());
+                info.offset = cur.read<uint64_t>();
+                _index[info.name] = static_cast<size_t>(i);
             }
-            case GGUFMetadataValueType::STRING:
+
+            _data_offset = align_offset(cur.position(), _alignment);
+            for (const auto &info : _infos)
             {
-                result[key] = read_gguf_string(file);
-                break;
+                if (_data_offset + info.offset + info.nbytes() > _file->size())
+                    TENSOR_THROW("Tensor '" + info.name + "' exceeds GGUF file size");
             }
-            case GGUFMetadataValueType::UINT64:
+        }
+
+        uint32_t version() const { return _version; }
+        uint32_t alignment() const { return _alignment; }
+        uint64_t data_offset() const { return _data_offset; }
+        const GGUFMetadataMap &metadata() const { return _metadata; }
+        const std::unordered_map<std::string, GGUFArrayView> &arrays() const { return _arrays; }
+        const std::vector<GGUFTensorInfo> &tensor_infos() const { return _infos; }
+        const std::shared_ptr<MappedFile> &mapping() const { return _file; }
+        size_t size() const { return _infos.size(); }
+
+        std::vector<std::string> tensor_names() const
+        {
+            std::vector<std::string> names;
+            names.reserve(_infos.size());
+            for (const auto &info : _infos)
+                names.push_back(info.name);
+            return names;
+        }
+
+        bool contains(const std::string &name) const
+        {
+            return _index.find(name) != _index.end();
+        }
+
+        const GGUFTensorInfo &info(const std::string &name) const
+        {
+            auto it = _index.find(name);
+            if (it == _index.end())
+                TENSOR_THROW("Tensor '" + name + "' not found in GGUF file");
+            return _infos[it->second];
+        }
+
+        GGUFTensorView view(const std::string &name) const
+        {
+            const auto &ti = info(name);
+            return GGUFTensorView{&ti, _file->data() + _data_offset + ti.offset, ti.nbytes()};
+        }
+
+        // 零拷贝：返回直接指向映射区的 Tensor<T>（写时复制，不会改动文件）；
+        // 存储类型与 T 不同（如 Q4_K -> float）时退化为反量化拷贝
+        template <typename T>
+        Tensor<T> tensor(const std::string &name) const
+        {
+            const auto &ti = info(name);
+            check_type<T>(ti);
+            uint64_t offset = _data_offset + ti.offset;
+            if (ti.type != get_gguf_type<T>() ||
+                reinterpret_cast<uintptr_t>(_file->data() + offset) % alignof(T) != 0)
+                return load<T>(name);
+            return MappedFile::view<T>(_file, ti.shape(), static_cast<size_t>(offset));
+        }
+
+        // 拷贝到独立的 Tensor<T>（不再引用映射区），必要时反量化
+        template <typename T>
+        Tensor<T> load(const std::string &name) const
+        {
+            const auto &ti = info(name);
+            check_type<T>(ti);
+            Tensor<T> result(ti.shape());
+            if (result.size() == 0)
+                return result;
+            const uint8_t *src = _file->data() + _data_offset + ti.offset;
+            if (ti.type == get_gguf_type<T>())
             {
-                uint64_t v;
-                file.read(reinterpret_cast<char *>(&v), 8);
-                result[key] = v;
-                break;
+                std::memcpy(result.data->data(), src, result.size() * sizeof(T));
             }
-            case GGUFMetadataValueType::INT64:
+            else
             {
-                int64_t v;
-                file.read(reinterpret_cast<char *>(&v), 8);
-                result[key] = v;
-                break;
+                if constexpr (is_gguf_dequantize_target<T>())
+                    ggml_dequantize<T>(ti.type, src, result.data->data(), result.size());
             }
-            case GGUFMetadataValueType::FLOAT64:
+            return result;
+        }
+
+        std::vector<std::string> array_strings(const std::string &key) const
+        {
+            auto it = _arrays.find(key);
+            if (it == _arrays.end())
+                TENSOR_THROW("GGUF metadata array '" + key + "' not found");
+            if (it->second.type != GGUFMetadataValueType::STRING)
+                TENSOR_THROW("GGUF metadata array '" + key + "' is not a string array");
+            gguf_detail::Cursor cur(it->second.data, _file->data() + _file->size());
+            std::vector<std::string> result;
+            result.reserve(static_cast<size_t>(it->second.length));
+            for (uint64_t i = 0; i < it->second.length; ++i)
+                result.push_back(cur.read_string());
+            return result;
+        }
+
+        template <typename V>
+        std::vector<V> array_values(const std::string &key) const
+        {
+            auto it = _arrays.find(key);
+            if (it == _arrays.end())
+                TENSOR_THROW("GGUF metadata array '" + key + "' not found");
+            gguf_detail::Cursor cur(it->second.data, _file->data() + _file->size());
+            std::vector<V> result;
+            result.reserve(static_cast<size_t>(it->second.length));
+            for (uint64_t i = 0; i < it->second.length; ++i)
             {
-                double v;
-                file.read(reinterpret_cast<char *>(&v), 8);
-                result[key] = v;
-                break;
+                auto v = gguf_detail::read_scalar(cur, it->second.type);
+                result.push_back(std::visit([](const auto &x) -> V
+                                            {
+                                                using X = std::decay_t<decltype(x)>;
+                                                if constexpr (std::is_same_v<X, std::string>)
+                                                    TENSOR_THROW("String array requested as numeric values");
+                                                else
+                                                    return static_cast<V>(x); },
+                                            v));
             }
-            case GGUFMetadataValueType::ARRAY:
+            return result;
+        }
+
+    private:
+        template <typename T>
+        static void check_type(const GGUFTensorInfo &ti)
+        {
+            if (!is_supported_gguf_type<T>())
+                TENSOR_THROW("Type not supported for .gguf format");
+            GGMLType expected_type = get_gguf_type<T>();
+            if constexpr (is_gguf_dequantize_target<T>())
             {
-                uint32_t arr_type;
-                file.read(reinterpret_cast<char *>(&arr_type), sizeof(arr_type));
-                uint64_t arr_len;
-                file.read(reinterpret_cast<char *>(&arr_len), sizeof(arr_len));
-                for (uint64_t j = 0; j < arr_len; ++j)
+                if (ggml_can_dequantize(ti.type))
                 {
-                    GGUFMetadataValueType elem_type = static_cast<GGUFMetadataValueType>(arr_type);
-                    switch (elem_type)
-                    {
-                    case GGUFMetadataValueType::UINT8:
-                    case GGUFMetadataValueType::INT8:
-                    {
-                        int8_t v;
-                        file.read(reinterpret_cast<char *>(&v), 1);
-                        break;
-                    }
-                    case GGUFMetadataValueType::UINT16:
-                    case GGUFMetadataValueType::INT16:
-                    {
-                        int16_t v;
-                        file.read(reinterpret_cast<char *>(&v), 2);
-                        break;
-                    }
-                    case GGUFMetadataValueType::UINT32:
-                    case GGUFMetadataValueType::INT32:
-                    case GGUFMetadataValueType::FLOAT32:
-                    case GGUFMetadataValueType::BOOL:
-                    {
-                        int32_t v;
-                        file.read(reinterpret_cast<char *>(&v), 4);
-                        break;
-                    }
-                    case GGUFMetadataValueType::UINT64:
-                    case GGUFMetadataValueType::INT64:
-                    case GGUFMetadataValueType::FLOAT64:
-                    {
-                        int64_t v;
-                        file.read(reinterpret_cast<char *>(&v), 8);
-                        break;
-                    }
-                    case GGUFMetadataValueType::STRING:
-                    {
-                        read_gguf_string(file);
-                        break;
-                    }
-                    case GGUFMetadataValueType::ARRAY:
-                        TENSOR_THROW("Nested arrays not supported");
-                    }
+                    const size_t bs = ggml_block_size(ti.type);
+                    if (bs > 1 && (ti.dims.empty() || ti.dims[0] % bs != 0))
+                        TENSOR_THROW("Row size of tensor '" + ti.name + "' is not a multiple of its block size");
+                    return;
                 }
-                break;
             }
+            if (ti.type != expected_type)
+            {
+                TENSOR_THROW(
+                    "Type mismatch for tensor '" + ti.name +
+                    "'. Expected GGML type " +
+                    std::to_string(static_cast<uint32_t>(expected_type)) +
+                    ", got " + std::to_string(static_cast<uint32_t>(ti.type)));
             }
         }
+    };
 
-        return result;
+    template <typename T>
+    Tensor<T> load_gguf(const std::string &filename,
+                        const std::string &tensor_name = "")
+    {
+        GGUFFile file(filename);
+        if (file.size() == 0)
+            TENSOR_THROW("No tensors found in GGUF file");
+        const std::string &name = tensor_name.empty() ? file.tensor_infos()[0].name : tensor_name;
+        return file.load<T>(name);
+    }
+
+    inline std::vector<std::string> gguf_list_tensors(const std::string &filename)
+    {
+        return GGUFFile(filename).tensor_names();
+    }
+
+    inline GGUFMetadataMap gguf_read_metadata(const std::string &filename)
+    {
+        return GGUFFile(filename).metadata();
     }
 
     template <typename T>
@@ -993,9 +1210,9 @@ namespace TensorN
             const auto &shape = tensor.shape();
             uint32_t n_dims = static_cast<uint32_t>(shape.size());
             file.write(reinterpret_cast<const char *>(&n_dims), sizeof(n_dims));
-            for (auto dim : shape)
+            for (auto it = shape.rbegin(); it != shape.rend(); ++it)
             {
-                uint64_t dim64 = static_cast<uint64_t>(dim);
+                uint64_t dim64 = static_cast<uint64_t>(*it);
                 file.write(reinterpret_cast<const char *>(&dim64), sizeof(dim64));
             }
 
@@ -1006,7 +1223,8 @@ namespace TensorN
             file.write(reinterpret_cast<const char *>(&tensor_data_offsets[i]), sizeof(uint64_t));
 
             size_t raw_size = tensor.data->size() * sizeof(T);
-            current_data_offset += raw_size;
+            // 偏移量必须与写入时的对齐填充保持一致
+            current_data_offset = align_offset(current_data_offset + raw_size, alignment);
         }
 
         uint64_t current_pos = static_cast<uint64_t>(file.tellp());
@@ -1039,210 +1257,193 @@ namespace TensorN
             TENSOR_THROW("Error writing GGUF file: " + filename);
     }
 
-    template <typename T>
-    std::unordered_map<std::string, Tensor<T>> load_gguf_multi(
-        const std::string &filename)
-    {
-        if (!is_supported_gguf_type<T>())
-        {
-            TENSOR_THROW("Type not supported for .gguf format");
-        }
+    // ------------------------------------------------------------
+    // 量化写出：按张量选择 GGML 类型，张量与行一起并行量化
+    // ------------------------------------------------------------
 
-        std::ifstream file(filename, std::ios::binary);
-        if (!file)
-            TENSOR_THROW("Cannot open file: " + filename);
+    // 给定张量名与行主序形状，返回要写出的 GGML 类型
+    using GGUFQuantPolicy = std::function<GGMLType(const std::string &, const std::vector<size_t> &)>;
 
-        uint32_t magic;
-        file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
-        if (magic != GGUF_MAGIC)
-            TENSOR_THROW("Not a valid GGUF file (bad magic)");
+    // 常用策略：二维及以上且行长为 block 整数倍的权重量化为 type，其余（norm、
+    // bias、标量）保持 F32
+    inline GGUFQuantPolicy gguf_quant_policy(GGMLType type)
+    {
+        return [type](const std::string &, const std::vector<size_t> &shape)
+        {
+            if (shape.size() < 2 || shape.back() % ggml_block_size(type) != 0)
+                return GGMLType::F32;
+            return type;
+        };
+    }
 
-        uint32_t version;
-        file.read(reinterpret_cast<char *>(&version), sizeof(version));
-        if (version != GGUF_VERSION)
-            TENSOR_THROW("Unsupported GGUF version: " + std::to_string(version));
+    // imatrix：张量名 -> 每列（最内层维度）的重要性权重，长度等于行长
+    using GGUFImatrix = std::unordered_map<std::string, std::vector<float>>;
 
-        uint64_t tensor_count;
-        file.read(reinterpret_cast<char *>(&tensor_count), sizeof(tensor_count));
+    template <typename T>
+    void save_gguf_quantized(
+        const std::vector<std::pair<std::string, Tensor<T>>> &tensors,
+        const std::string &filename,
+        const GGUFQuantPolicy &policy,
+        const std::unordered_map<std::string, GGUFMetadataValue> &metadata = {},
+        const GGUFImatrix &imatrix = {})
+    {
+        static_assert(is_gguf_dequantize_target<T>(), "save_gguf_quantized requires a floating-point tensor type");
+        if (tensors.empty())
+            TENSOR_THROW("No tensors to save");
 
-        uint64_t metadata_kv_count;
-        file.read(reinterpret_cast<char *>(&metadata_kv_count), sizeof(metadata_kv_count));
+        std::ofstream file(filename, std::ios::binary);
+        if (!file)
+            TENSOR_THROW("Cannot open file for writing: " + filename);
 
-        for (uint64_t i = 0; i < metadata_kv_count; ++i)
+        uint32_t alignment = GGUF_DEFAULT_ALIGNMENT;
+        auto it_align = metadata.find("general.alignment");
+        if (it_align != metadata.end())
         {
-            read_gguf_string(file);
-            uint32_t vtype_u32;
-            file.read(reinterpret_cast<char *>(&vtype_u32), sizeof(vtype_u32));
-            GGUFMetadataValueType vtype = static_cast<GGUFMetadataValueType>(vtype_u32);
+            if (std::holds_alternative<uint32_t>(it_align->second))
+                alignment = std::get<uint32_t>(it_align->second);
+        }
 
-            switch (vtype)
-            {
-            case GGUFMetadataValueType::UINT8:
-            case GGUFMetadataValueType::INT8:
-            {
-                int8_t v;
-                file.read(reinterpret_cast<char *>(&v), 1);
-                break;
-            }
-            case GGUFMetadataValueType::UINT16:
-            case GGUFMetadataValueType::INT16:
-            {
-                int16_t v;
-                file.read(reinterpret_cast<char *>(&v), 2);
-                break;
-            }
-            case GGUFMetadataValueType::UINT32:
-            case GGUFMetadataValueType::INT32:
-            case GGUFMetadataValueType::FLOAT32:
-            case GGUFMetadataValueType::BOOL:
-            {
-                int32_t v;
-                file.read(reinterpret_cast<char *>(&v), 4);
-                break;
-            }
-            case GGUFMetadataValueType::UINT64:
-            case GGUFMetadataValueType::INT64:
-            case GGUFMetadataValueType::FLOAT64:
-            {
-                int64_t v;
-                file.read(reinterpret_cast<char *>(&v), 8);
-                break;
-            }
-            case GGUFMetadataValueType::STRING:
+        // 1. 确定每个张量的类型与行划分
+        struct Job
+        {
+            GGMLType type;
+            size_t rows;
+            size_t cols;
+            const float *imatrix;
+            std::vector<float> staging; // 非 float 输入的转换缓冲
+            std::vector<uint8_t> bytes;
+        };
+        std::vector<Job> jobs(tensors.size());
+        for (size_t i = 0; i < tensors.size(); ++i)
+        {
+            const auto &[name, tensor] = tensors[i];
+            auto &job = jobs[i];
+            job.type = tensor.shape().empty() ? GGMLType::F32 : policy(name, tensor.shape());
+            job.cols = tensor.shape().empty() ? 1 : tensor.shape().back();
+            job.rows = job.cols ? tensor.size() / job.cols : 0;
+            if (!ggml_can_quantize(job.type))
+                TENSOR_THROW("Quantization not supported for GGML type " +
+                             std::to_string(static_cast<uint32_t>(job.type)) + " (tensor '" + name + "')");
+            if (job.cols % ggml_block_size(job.type) != 0)
+                TENSOR_THROW("Row size of tensor '" + name + "' is not a multiple of its block size");
+
+            job.imatrix = nullptr;
+            auto it = imatrix.find(name);
+            if (it != imatrix.end())
             {
-                read_gguf_string(file);
-                break;
+                if (it->second.size() != job.cols)
+                    TENSOR_THROW("imatrix for tensor '" + name + "' does not match its row size");
+                job.imatrix = it->second.data();
             }
-            case GGUFMetadataValueType::ARRAY:
+            if constexpr (!std::is_same_v<T, float>)
             {
-                uint32_t arr_type;
-                file.read(reinterpret_cast<char *>(&arr_type), sizeof(arr_type));
-                uint64_t arr_len;
-                file.read(reinterpret_cast<char *>(&arr_len), sizeof(arr_len));
-                for (uint64_t j = 0; j < arr_len; ++j)
-                {
-                    GGUFMetadataValueType elem_type = static_cast<GGUFMetadataValueType>(arr_type);
-                    switch (elem_type)
-                    {
-                    case GGUFMetadataValueType::UINT8:
-                    case GGUFMetadataValueType::INT8:
-                    {
-                        int8_t v;
-                        file.read(reinterpret_cast<char *>(&v), 1);
-                        break;
-                    }
-                    case GGUFMetadataValueType::UINT16:
-                    case GGUFMetadataValueType::INT16:
-                    {
-                        int16_t v;
-                        file.read(reinterpret_cast<char *>(&v), 2);
-                        break;
-                    }
-                    case GGUFMetadataValueType::UINT32:
-                    case GGUFMetadataValueType::INT32:
-                    case GGUFMetadataValueType::FLOAT32:
-                    case GGUFMetadataValueType::BOOL:
-                    {
-                        int32_t v;
-                        file.read(reinterpret_cast<char *>(&v), 4);
-                        break;
-                    }
-                    case GGUFMetadataValueType::UINT64:
-                    case GGUFMetadataValueType::INT64:
-                    case GGUFMetadataValueType::FLOAT64:
-                    {
-                        int64_t v;
-                        file.read(reinterpret_cast<char *>(&v), 8);
-                        break;
-                    }
-                    case GGUFMetadataValueType::STRING:
-                    {
-                        read_gguf_string(file);
-                        break;
-                    }
-                    case GGUFMetadataValueType::ARRAY:
-                        TENSOR_THROW("Nested arrays not supported in GGUF metadata reader");
-                    }
-                }
-                break;
-            }
+                job.staging.resize(tensor.size());
+                for (size_t k = 0; k < tensor.size(); ++k)
+                    job.staging[k] = static_cast<float>((*tensor.data)[k]);
             }
+            job.bytes.resize(job.rows * (job.cols / ggml_block_size(job.type) * ggml_type_size(job.type)));
         }
 
-        struct TensorInfo
-        {
-            std::string name;
-            uint32_t n_dims;
-            std::vector<uint64_t> dims;
-            GGMLType type;
-            uint64_t offset;
-        };
+        // 2. 所有张量的所有行展平为一个任务列表，动态调度
+        std::vector<std::pair<size_t, size_t>> work; // (张量, 起始行)
+        constexpr size_t rows_per_task = 16;
+        for (size_t i = 0; i < jobs.size(); ++i)
+            for (size_t r = 0; r < jobs[i].rows; r += rows_per_task)
+                work.emplace_back(i, r);
 
-        std::vector<TensorInfo> tensor_infos(tensor_count);
-        for (uint64_t i = 0; i < tensor_count; ++i)
+        const int64_t n_work = static_cast<int64_t>(work.size());
+#pragma omp parallel for schedule(dynamic)
+        for (int64_t w = 0; w < n_work; ++w)
         {
-            tensor_infos[i].name = read_gguf_string(file);
-            file.read(reinterpret_cast<char *>(&tensor_infos[i].n_dims), sizeof(uint32_t));
-            tensor_infos[i].dims.resize(tensor_infos[i].n_dims);
-            for (uint32_t d = 0; d < tensor_infos[i].n_dims; ++d)
-            {
-                file.read(reinterpret_cast<char *>(&tensor_infos[i].dims[d]), sizeof(uint64_t));
-            }
-            uint32_t type_u32;
-            file.read(reinterpret_cast<char *>(&type_u32), sizeof(uint32_t));
-            tensor_infos[i].type = static_cast<GGMLType>(type_u32);
-            file.read(reinterpret_cast<char *>(&tensor_infos[i].offset), sizeof(uint64_t));
+            auto &job = jobs[work[w].first];
+            const float *src = job.staging.empty() ? reinterpret_cast<const float *>(tensors[work[w].first].second.data->data())
+                                                   : job.staging.data();
+            const size_t row_bytes = job.cols / ggml_block_size(job.type) * ggml_type_size(job.type);
+            const size_t r1 = std::min(job.rows, work[w].second + rows_per_task);
+            for (size_t r = work[w].second; r < r1; ++r)
+                ggml_quantize_row(job.type, src + r * job.cols, job.bytes.data() + r * row_bytes, job.cols, job.imatrix);
         }
 
-        if (tensor_count == 0)
-            TENSOR_THROW("No tensors found in GGUF file");
+        // 3. 写出头部、张量信息与对齐后的数据区
+        uint32_t magic = GGUF_MAGIC;
+        uint32_t version = GGUF_VERSION;
+        uint64_t tensor_count = static_cast<uint64_t>(tensors.size());
+        uint64_t metadata_kv_count = static_cast<uint64_t>(metadata.size());
 
-        uint64_t tensor_data_base = static_cast<uint64_t>(file.tellg());
-        tensor_data_base = align_offset(tensor_data_base, GGUF_DEFAULT_ALIGNMENT);
+        file.write(reinterpret_cast<const char *>(&magic), sizeof(magic));
+        file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+        file.write(reinterpret_cast<const char *>(&tensor_count), sizeof(tensor_count));
+        file.write(reinterpret_cast<const char *>(&metadata_kv_count), sizeof(metadata_kv_count));
 
-        GGMLType expected_type = get_gguf_type<T>();
-        std::unordered_map<std::string, Tensor<T>> result;
+        for (const auto &[key, value] : metadata)
+        {
+            write_gguf_string(file, key);
+            uint32_t vtype_u32 = static_cast<uint32_t>(get_metadata_value_type(value));
+            file.write(reinterpret_cast<const char *>(&vtype_u32), sizeof(vtype_u32));
+            write_metadata_value(file, value);
+        }
 
-        for (const auto &info : tensor_infos)
+        uint64_t current_data_offset = 0;
+        for (size_t i = 0; i < tensors.size(); ++i)
         {
-            std::vector<size_t> shape(info.n_dims);
-            size_t total_elements = 1;
-            for (uint32_t d = 0; d < info.n_dims; ++d)
-            {
-                shape[d] = static_cast<size_t>(info.dims[d]);
-                total_elements *= shape[d];
-            }
+            const auto &[name, tensor] = tensors[i];
+            write_gguf_string(file, name);
 
-            if (info.type == expected_type ||
-                (info.type == GGMLType::F32 && expected_type == GGMLType::F32) ||
-                (info.type == GGMLType::F64 && expected_type == GGMLType::F64) ||
-                (info.type == GGMLType::I8 && expected_type == GGMLType::I8) ||
-                (info.type == GGMLType::I16 && expected_type == GGMLType::I16) ||
-                (info.type == GGMLType::I32 && expected_type == GGMLType::I32) ||
-                (info.type == GGMLType::I64 && expected_type == GGMLType::I64))
+            const auto &shape = tensor.shape();
+            uint32_t n_dims = static_cast<uint32_t>(shape.size());
+            file.write(reinterpret_cast<const char *>(&n_dims), sizeof(n_dims));
+            for (auto it = shape.rbegin(); it != shape.rend(); ++it)
             {
-                uint64_t abs_offset = tensor_data_base + info.offset;
-                file.seekg(static_cast<std::streamoff>(abs_offset));
-
-                std::vector<T> data_vec(total_elements);
-                file.read(reinterpret_cast<char *>(data_vec.data()),
-                          static_cast<std::streamsize>(total_elements * sizeof(T)));
+                uint64_t dim64 = static_cast<uint64_t>(*it);
+                file.write(reinterpret_cast<const char *>(&dim64), sizeof(dim64));
+            }
 
-                if (!file)
-                    TENSOR_THROW("Error reading tensor data from GGUF file");
+            uint32_t type_u32 = static_cast<uint32_t>(jobs[i].type);
+            file.write(reinterpret_cast<const char *>(&type_u32), sizeof(type_u32));
+            file.write(reinterpret_cast<const char *>(&current_data_offset), sizeof(uint64_t));
+            current_data_offset = align_offset(current_data_offset + jobs[i].bytes.size(), alignment);
+        }
 
-                result[info.name] = Tensor<T>(shape, data_vec);
-            }
-            else
+        const char zeros[64] = {};
+        auto pad_to_alignment = [&]()
+        {
+            uint64_t pos = static_cast<uint64_t>(file.tellp());
+            uint64_t pad = align_offset(pos, alignment) - pos;
+            while (pad > 0)
             {
-                TENSOR_THROW(
-                    "Type mismatch for tensor '" + info.name +
-                    "'. Expected GGML type " +
-                    std::to_string(static_cast<uint32_t>(expected_type)) +
-                    ", got " + std::to_string(static_cast<uint32_t>(info.type)));
+                uint64_t chunk = std::min<uint64_t>(pad, sizeof(zeros));
+                file.write(zeros, static_cast<std::streamsize>(chunk));
+                pad -= chunk;
             }
+        };
+
+        pad_to_alignment();
+        for (const auto &job : jobs)
+        {
+            file.write(reinterpret_cast<const char *>(job.bytes.data()), static_cast<std::streamsize>(job.bytes.size()));
+            pad_to_alignment();
         }
 
+        if (!file)
+            TENSOR_THROW("Error writing GGUF file: " + filename);
+    }
+
+    // 读取全部张量并拷贝为独立的 Tensor<T>；需要零拷贝时请直接使用
+    // GGUFFile::tensor<T>()，映射只建立一次。
+    template <typename T>
+    std::unordered_map<std::string, Tensor<T>> load_gguf_multi(
+        const std::string &filename)
+    {
+        GGUFFile file(filename);
+        if (file.size() == 0)
+            TENSOR_THROW("No tensors found in GGUF file");
+
+        std::unordered_map<std::string, Tensor<T>> result;
+        result.reserve(file.size());
+        for (const auto &info : file.tensor_infos())
+        {
+            result[info.name] = file.load<T>(info.name);
+        }
         return result;
     }
 
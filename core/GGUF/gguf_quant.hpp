@@ -0,0 +1,1285 @@
+#pragma once
+#ifndef __GGUF_QUANT_HPP__
+#define __GGUF_QUANT_HPP__
+
+// ============================================================================
+// ggml 量化 block 格式与反量化内核。
+//
+// block 结构体与 ggml 的二进制布局逐字节一致，可直接 reinterpret_cast 到
+// 映射区（GGUFTensorView::blocks<Block>()）。每个 dequantize_row_* 将 nb 个
+// 连续 block 解码为 float，运算顺序与 ggml 参考实现相同，因此结果逐位一致；
+// AVX2 路径同样只使用乘法与加减（不做 FMA 融合），与标量路径逐位一致。
+// 带 AVX2 路径的类型另外提供 *_ref 标量版本（始终编译），供逐位对照
+// （example/exp12.cpp）。
+// ============================================================================
+
+#include "../dtypes.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace TensorN
+{
+    namespace gguf_quant
+    {
+        constexpr size_t QK4_0 = 32;
+        constexpr size_t QK4_1 = 32;
+        constexpr size_t QK5_0 = 32;
+        constexpr size_t QK5_1 = 32;
+        constexpr size_t QK8_0 = 32;
+        constexpr size_t QK8_1 = 32;
+        constexpr size_t QK4_NL = 32;
+        constexpr size_t QK_MXFP4 = 32;
+        constexpr size_t QK_K = 256;
+        constexpr size_t K_SCALE_SIZE = 12;
+
+        // ------------------------------------------------------------
+        // block 布局（fp16 字段以 uint16_t 位模式存储）
+        // ------------------------------------------------------------
+
+        struct BlockQ4_0
+        {
+            uint16_t d;
+            uint8_t qs[QK4_0 / 2];
+        };
+
+        struct BlockQ4_1
+        {
+            uint16_t d;
+            uint16_t m;
+            uint8_t qs[QK4_1 / 2];
+        };
+
+        struct BlockQ5_0
+        {
+            uint16_t d;
+            uint8_t qh[4];
+            uint8_t qs[QK5_0 / 2];
+        };
+
+        struct BlockQ5_1
+        {
+            uint16_t d;
+            uint16_t m;
+            uint8_t qh[4];
+            uint8_t qs[QK5_1 / 2];
+        };
+
+        struct BlockQ8_0
+        {
+            uint16_t d;
+            int8_t qs[QK8_0];
+        };
+
+        struct BlockQ8_1
+        {
+            uint16_t d;
+            uint16_t s;
+            int8_t qs[QK8_1];
+        };
+
+        struct BlockQ2_K
+        {
+            uint8_t scales[QK_K / 16];
+            uint8_t qs[QK_K / 4];
+            uint16_t d;
+            uint16_t dmin;
+        };
+
+        struct BlockQ3_K
+        {
+            uint8_t hmask[QK_K / 8];
+            uint8_t qs[QK_K / 4];
+            uint8_t scales[K_SCALE_SIZE];
+            uint16_t d;
+        };
+
+        struct BlockQ4_K
+        {
+            uint16_t d;
+            uint16_t dmin;
+            uint8_t scales[K_SCALE_SIZE];
+            uint8_t qs[QK_K / 2];
+        };
+
+        struct BlockQ5_K
+        {
+            uint16_t d;
+            uint16_t dmin;
+            uint8_t scales[K_SCALE_SIZE];
+            uint8_t qh[QK_K / 8];
+            uint8_t qs[QK_K / 2];
+        };
+
+        struct BlockQ6_K
+        {
+            uint8_t ql[QK_K / 2];
+            uint8_t qh[QK_K / 4];
+            int8_t scales[QK_K / 16];
+            uint16_t d;
+        };
+
+        struct BlockQ8_K
+        {
+            float d;
+            int8_t qs[QK_K];
+            int16_t bsums[QK_K / 16];
+        };
+
+        struct BlockIQ4_NL
+        {
+            uint16_t d;
+            uint8_t qs[QK4_NL / 2];
+        };
+
+        struct BlockIQ4_XS
+        {
+            uint16_t d;
+            uint16_t scales_h;
+            uint8_t scales_l[QK_K / 64];
+            uint8_t qs[QK_K / 2];
+        };
+
+        struct BlockTQ1_0
+        {
+            uint8_t qs[(QK_K - 4 * QK_K / 64) / 5];
+            uint8_t qh[QK_K / 64];
+            uint16_t d;
+        };
+
+        struct BlockTQ2_0
+        {
+            uint8_t qs[QK_K / 4];
+            uint16_t d;
+        };
+
+        struct BlockMXFP4
+        {
+            uint8_t e;
+            uint8_t qs[QK_MXFP4 / 2];
+        };
+
+        static_assert(sizeof(BlockQ4_0) == 18, "wrong q4_0 block size");
+        static_assert(sizeof(BlockQ4_1) == 20, "wrong q4_1 block size");
+        static_assert(sizeof(BlockQ5_0) == 22, "wrong q5_0 block size");
+        static_assert(sizeof(BlockQ5_1) == 24, "wrong q5_1 block size");
+        static_assert(sizeof(BlockQ8_0) == 34, "wrong q8_0 block size");
+        static_assert(sizeof(BlockQ8_1) == 36, "wrong q8_1 block size");
+        static_assert(sizeof(BlockQ2_K) == 84, "wrong q2_K block size");
+        static_assert(sizeof(BlockQ3_K) == 110, "wrong q3_K block size");
+        static_assert(sizeof(BlockQ4_K) == 144, "wrong q4_K block size");
+        static_assert(sizeof(BlockQ5_K) == 176, "wrong q5_K block size");
+        static_assert(sizeof(BlockQ6_K) == 210, "wrong q6_K block size");
+        static_assert(sizeof(BlockQ8_K) == 292, "wrong q8_K block size");
+        static_assert(sizeof(BlockIQ4_NL) == 18, "wrong iq4_nl block size");
+        static_assert(sizeof(BlockIQ4_XS) == 136, "wrong iq4_xs block size");
+        static_assert(sizeof(BlockTQ1_0) == 54, "wrong tq1_0 block size");
+        static_assert(sizeof(BlockTQ2_0) == 66, "wrong tq2_0 block size");
+        static_assert(sizeof(BlockMXFP4) == 17, "wrong mxfp4 block size");
+
+        // 非线性 4-bit 码表
+        constexpr int8_t kvalues_iq4nl[16] = {-127, -104, -83, -65, -49, -35, -22, -10,
+                                              1, 13, 25, 38, 53, 69, 89, 113};
+        // MXFP4 (E2M1) 码值的两倍，配合 e8m0_to_float_half 使用
+        constexpr int8_t kvalues_mxfp4[16] = {0, 1, 2, 3, 4, 6, 8, 12,
+                                              0, -1, -2, -3, -4, -6, -8, -12};
+
+        inline float fp16(uint16_t h) { return fp::half_bits_to_float(h); }
+
+        // E8M0 指数的一半：2^(e - 128)
+        inline float e8m0_to_float_half(uint8_t e)
+        {
+            uint32_t bits = e < 2 ? (0x00200000u << e) : (static_cast<uint32_t>(e - 1) << 23);
+            return fp::bits_to_float(bits);
+        }
+
+        // K-quant 的 6-bit scale/min 解包（12 字节存 8 组）
+        inline void get_scale_min_k4(int j, const uint8_t *q, uint8_t &d, uint8_t &m)
+        {
+            if (j < 4)
+            {
+                d = q[j] & 63;
+                m = q[j + 4] & 63;
+            }
+            else
+            {
+                d = (q[j + 4] & 0xF) | ((q[j - 4] >> 6) << 4);
+                m = (q[j + 4] >> 4) | ((q[j - 0] >> 6) << 4);
+            }
+        }
+
+#if defined(__AVX2__)
+        namespace simd
+        {
+            // 16 字节 -> 32 个 nibble（低半字节在前 16 个，高半字节在后 16 个）
+            inline __m256i unpack_nibbles(const uint8_t *qs)
+            {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(qs));
+                const __m128i lo = _mm_and_si128(bytes, _mm_set1_epi8(0x0F));
+                const __m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F));
+                return _mm256_set_m128i(hi, lo);
+            }
+
+            // 32 个 int8 -> 4 组 8 x float，分别乘以 d 后写出
+            inline void store_scaled(__m256i q, __m256 d, float *y)
+            {
+                const __m128i q_lo = _mm256_castsi256_si128(q);
+                const __m128i q_hi = _mm256_extracti128_si256(q, 1);
+                _mm256_storeu_ps(y + 0, _mm256_mul_ps(d, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(q_lo))));
+                _mm256_storeu_ps(y + 8, _mm256_mul_ps(d, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(q_lo, 8)))));
+                _mm256_storeu_ps(y + 16, _mm256_mul_ps(d, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(q_hi))));
+                _mm256_storeu_ps(y + 24, _mm256_mul_ps(d, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(q_hi, 8)))));
+            }
+
+            // 有符号 int8 逐对相乘并按 4 个一组累加为 int32（VNNI 可用时单指令完成）
+            inline __m256i mul_sum_i8(__m256i x, __m256i y)
+            {
+                const __m256i ax = _mm256_sign_epi8(x, x);
+                const __m256i sy = _mm256_sign_epi8(y, x);
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+                return _mm256_dpbusd_epi32(_mm256_setzero_si256(), ax, sy);
+#elif defined(__AVXVNNI__)
+                return _mm256_dpbusd_avx_epi32(_mm256_setzero_si256(), ax, sy);
+#else
+                return _mm256_madd_epi16(_mm256_maddubs_epi16(ax, sy), _mm256_set1_epi16(1));
+#endif
+            }
+
+            inline __m256 madd(__m256 a, __m256 b, __m256 c)
+            {
+#if defined(__FMA__)
+                return _mm256_fmadd_ps(a, b, c);
+#else
+                return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+            }
+
+            inline float hsum(__m256 v)
+            {
+                __m128 r = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+                r = _mm_add_ps(r, _mm_movehl_ps(r, r));
+                r = _mm_add_ss(r, _mm_movehdup_ps(r));
+                return _mm_cvtss_f32(r);
+            }
+
+            // y = d * q - m（先乘后减，与标量路径逐位一致）
+            inline void store_scaled_min(__m256i q, __m256 d, __m256 m, float *y)
+            {
+                const __m128i q_lo = _mm256_castsi256_si128(q);
+                const __m128i q_hi = _mm256_extracti128_si256(q, 1);
+                const __m128i parts[4] = {q_lo, _mm_srli_si128(q_lo, 8), q_hi, _mm_srli_si128(q_hi, 8)};
+                for (int p = 0; p < 4; ++p)
+                {
+                    __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(parts[p]));
+                    _mm256_storeu_ps(y + 8 * p, _mm256_sub_ps(_mm256_mul_ps(d, v), m));
+                }
+            }
+        }
+#endif
+
+        // ------------------------------------------------------------
+        // 32 元素 block
+        // ------------------------------------------------------------
+
+        inline void dequantize_row_q4_0_ref(const BlockQ4_0 *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i, y += QK4_0)
+            {
+                const float d = fp16(x[i].d);
+                for (size_t j = 0; j < QK4_0 / 2; ++j)
+                {
+                    const int x0 = (x[i].qs[j] & 0x0F) - 8;
+                    const int x1 = (x[i].qs[j] >> 4) - 8;
+                    y[j] = x0 * d;
+                    y[j + QK4_0 / 2] = x1 * d;
+                }
+            }
+        }
+
+        inline void dequantize_row_q4_0(const BlockQ4_0 *x, float *y, size_t nb)
+        {
+#if defined(__AVX2__)
+            for (size_t i = 0; i < nb; ++i, y += QK4_0)
+            {
+                __m256i q = _mm256_sub_epi8(simd::unpack_nibbles(x[i].qs), _mm256_set1_epi8(8));
+                simd::store_scaled(q, _mm256_set1_ps(fp16(x[i].d)), y);
+            }
+#else
+            dequantize_row_q4_0_ref(x, y, nb);
+#endif
+        }
+
+        inline void dequantize_row_q4_1(const BlockQ4_1 *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i, y += QK4_1)
+            {
+                const float d = fp16(x[i].d);
+                const float m = fp16(x[i].m);
+                for (size_t j = 0; j < QK4_1 / 2; ++j)
+                {
+                    const int x0 = x[i].qs[j] & 0x0F;
+                    const int x1 = x[i].qs[j] >> 4;
+                    y[j] = x0 * d + m;
+                    y[j + QK4_1 / 2] = x1 * d + m;
+                }
+            }
+        }
+
+        inline void dequantize_row_q5_0(const BlockQ5_0 *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i, y += QK5_0)
+            {
+                const float d = fp16(x[i].d);
+                uint32_t qh;
+                std::memcpy(&qh, x[i].qh, sizeof(qh));
+                for (size_t j = 0; j < QK5_0 / 2; ++j)
+                {
+                    const uint8_t xh_0 = ((qh >> (j + 0)) << 4) & 0x10;
+                    const uint8_t xh_1 = ((qh >> (j + 12))) & 0x10;
+                    const int32_t x0 = ((x[i].qs[j] & 0x0F) | xh_0) - 16;
+                    const int32_t x1 = ((x[i].qs[j] >> 4) | xh_1) - 16;
+                    y[j] = x0 * d;
+                    y[j + QK5_0 / 2] = x1 * d;
+                }
+            }
+        }
+
+        inline void dequantize_row_q5_1(const BlockQ5_1 *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i, y += QK5_1)
+            {
+                const float d = fp16(x[i].d);
+                const float m = fp16(x[i].m);
+                uint32_t qh;
+                std::memcpy(&qh, x[i].qh, sizeof(qh));
+                for (size_t j = 0; j < QK5_1 / 2; ++j)
+                {
+                    const uint8_t xh_0 = ((qh >> (j + 0)) << 4) & 0x10;
+                    const uint8_t xh_1 = ((qh >> (j + 12))) & 0x10;
+                    const int x0 = (x[i].qs[j] & 0x0F) | xh_0;
+                    const int x1 = (x[i].qs[j] >> 4) | xh_1;
+                    y[j] = x0 * d + m;
+                    y[j + QK5_1 / 2] = x1 * d + m;
+                }
+            }
+        }
+
+        inline void dequantize_row_q8_0_ref(const BlockQ8_0 *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i, y += QK8_0)
+            {
+                const float d = fp16(x[i].d);
+                for (size_t j = 0; j < QK8_0; ++j)
+                    y[j] = x[i].qs[j] * d;
+            }
+        }
+
+        inline void dequantize_row_q8_0(const BlockQ8_0 *x, float *y, size_t nb)
+        {
+#if defined(__AVX2__)
+            for (size_t i = 0; i < nb; ++i, y += QK8_0)
+            {
+                __m256i q = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x[i].qs));
+                simd::store_scaled(q, _mm256_set1_ps(fp16(x[i].d)), y);
+            }
+#else
+            dequantize_row_q8_0_ref(x, y, nb);
+#endif
+        }
+
+        inline void dequantize_row_q8_1(const BlockQ8_1 *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i, y += QK8_1)
+            {
+                const float d = fp16(x[i].d);
+                for (size_t j = 0; j < QK8_1; ++j)
+                    y[j] = x[i].qs[j] * d;
+            }
+        }
+
+        inline void dequantize_row_iq4_nl(const BlockIQ4_NL *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i, y += QK4_NL)
+            {
+                const float d = fp16(x[i].d);
+                for (size_t j = 0; j < QK4_NL / 2; ++j)
+                {
+                    y[j] = d * kvalues_iq4nl[x[i].qs[j] & 0x0F];
+                    y[j + QK4_NL / 2] = d * kvalues_iq4nl[x[i].qs[j] >> 4];
+                }
+            }
+        }
+
+        inline void dequantize_row_mxfp4(const BlockMXFP4 *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i, y += QK_MXFP4)
+            {
+                const float d = e8m0_to_float_half(x[i].e);
+                for (size_t j = 0; j < QK_MXFP4 / 2; ++j)
+                {
+                    y[j] = kvalues_mxfp4[x[i].qs[j] & 0x0F] * d;
+                    y[j + QK_MXFP4 / 2] = kvalues_mxfp4[x[i].qs[j] >> 4] * d;
+                }
+            }
+        }
+
+        // ------------------------------------------------------------
+        // K-quant（256 元素 super-block）
+        // ------------------------------------------------------------
+
+        inline void dequantize_row_q2_K(const BlockQ2_K *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i)
+            {
+                const float d = fp16(x[i].d);
+                const float min = fp16(x[i].dmin);
+                const uint8_t *q = x[i].qs;
+                int is = 0;
+                for (size_t n = 0; n < QK_K; n += 128)
+                {
+                    int shift = 0;
+                    for (int j = 0; j < 4; ++j)
+                    {
+                        uint8_t sc = x[i].scales[is++];
+                        float dl = d * (sc & 0xF), ml = min * (sc >> 4);
+                        for (int l = 0; l < 16; ++l)
+                            *y++ = dl * static_cast<int8_t>((q[l] >> shift) & 3) - ml;
+
+                        sc = x[i].scales[is++];
+                        dl = d * (sc & 0xF), ml = min * (sc >> 4);
+                        for (int l = 0; l < 16; ++l)
+                            *y++ = dl * static_cast<int8_t>((q[l + 16] >> shift) & 3) - ml;
+
+                        shift += 2;
+                    }
+                    q += 32;
+                }
+            }
+        }
+
+        inline void dequantize_row_q3_K(const BlockQ3_K *x, float *y, size_t nb)
+        {
+            constexpr uint32_t kmask1 = 0x03030303;
+            constexpr uint32_t kmask2 = 0x0f0f0f0f;
+            uint32_t aux[4];
+            const int8_t *scales = reinterpret_cast<const int8_t *>(aux);
+
+            for (size_t i = 0; i < nb; ++i)
+            {
+                const float d_all = fp16(x[i].d);
+                const uint8_t *q = x[i].qs;
+                const uint8_t *hm = x[i].hmask;
+                uint8_t m = 1;
+
+                std::memcpy(aux, x[i].scales, K_SCALE_SIZE);
+                const uint32_t tmp = aux[2];
+                aux[2] = ((aux[0] >> 4) & kmask2) | (((tmp >> 4) & kmask1) << 4);
+                aux[3] = ((aux[1] >> 4) & kmask2) | (((tmp >> 6) & kmask1) << 4);
+                aux[0] = (aux[0] & kmask2) | (((tmp >> 0) & kmask1) << 4);
+                aux[1] = (aux[1] & kmask2) | (((tmp >> 2) & kmask1) << 4);
+
+                int is = 0;
+                for (size_t n = 0; n < QK_K; n += 128)
+                {
+                    int shift = 0;
+                    for (int j = 0; j < 4; ++j)
+                    {
+                        float dl = d_all * (scales[is++] - 32);
+                        for (int l = 0; l < 16; ++l)
+                            *y++ = dl * (static_cast<int8_t>((q[l + 0] >> shift) & 3) - ((hm[l + 0] & m) ? 0 : 4));
+
+                        dl = d_all * (scales[is++] - 32);
+                        for (int l = 0; l < 16; ++l)
+                            *y++ = dl * (static_cast<int8_t>((q[l + 16] >> shift) & 3) - ((hm[l + 16] & m) ? 0 : 4));
+
+                        shift += 2;
+                        m <<= 1;
+                    }
+                    q += 32;
+                }
+            }
+        }
+
+        inline void dequantize_row_q4_K_ref(const BlockQ4_K *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i)
+            {
+                const uint8_t *q = x[i].qs;
+                const float d = fp16(x[i].d);
+                const float min = fp16(x[i].dmin);
+                int is = 0;
+                uint8_t sc, m;
+                for (size_t j = 0; j < QK_K; j += 64)
+                {
+                    get_scale_min_k4(is + 0, x[i].scales, sc, m);
+                    const float d1 = d * sc;
+                    const float m1 = min * m;
+                    get_scale_min_k4(is + 1, x[i].scales, sc, m);
+                    const float d2 = d * sc;
+                    const float m2 = min * m;
+                    for (int l = 0; l < 32; ++l)
+                        *y++ = d1 * (q[l] & 0xF) - m1;
+                    for (int l = 0; l < 32; ++l)
+                        *y++ = d2 * (q[l] >> 4) - m2;
+                    q += 32;
+                    is += 2;
+                }
+            }
+        }
+
+        inline void dequantize_row_q4_K(const BlockQ4_K *x, float *y, size_t nb)
+        {
+#if defined(__AVX2__)
+            for (size_t i = 0; i < nb; ++i)
+            {
+                const uint8_t *q = x[i].qs;
+                const float d = fp16(x[i].d);
+                const float min = fp16(x[i].dmin);
+                uint8_t sc, m;
+                for (int is = 0; is < static_cast<int>(QK_K / 32); is += 2, q += 32, y += 64)
+                {
+                    get_scale_min_k4(is + 0, x[i].scales, sc, m);
+                    const float d1 = d * sc;
+                    const float m1 = min * m;
+                    get_scale_min_k4(is + 1, x[i].scales, sc, m);
+                    const float d2 = d * sc;
+                    const float m2 = min * m;
+                    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(q));
+                    const __m256i lo = _mm256_and_si256(bytes, _mm256_set1_epi8(0x0F));
+                    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0F));
+                    simd::store_scaled_min(lo, _mm256_set1_ps(d1), _mm256_set1_ps(m1), y);
+                    simd::store_scaled_min(hi, _mm256_set1_ps(d2), _mm256_set1_ps(m2), y + 32);
+                }
+            }
+#else
+            dequantize_row_q4_K_ref(x, y, nb);
+#endif
+        }
+
+        inline void dequantize_row_q5_K(const BlockQ5_K *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i)
+            {
+                const uint8_t *ql = x[i].qs;
+                const uint8_t *qh = x[i].qh;
+                const float d = fp16(x[i].d);
+                const float min = fp16(x[i].dmin);
+                int is = 0;
+                uint8_t sc, m;
+                uint8_t u1 = 1, u2 = 2;
+                for (size_t j = 0; j < QK_K; j += 64)
+                {
+                    get_scale_min_k4(is + 0, x[i].scales, sc, m);
+                    const float d1 = d * sc;
+                    const float m1 = min * m;
+                    get_scale_min_k4(is + 1, x[i].scales, sc, m);
+                    const float d2 = d * sc;
+                    const float m2 = min * m;
+                    for (int l = 0; l < 32; ++l)
+                        *y++ = d1 * ((ql[l] & 0xF) + (qh[l] & u1 ? 16 : 0)) - m1;
+                    for (int l = 0; l < 32; ++l)
+                        *y++ = d2 * ((ql[l] >> 4) + (qh[l] & u2 ? 16 : 0)) - m2;
+                    ql += 32;
+                    is += 2;
+                    u1 <<= 2;
+                    u2 <<= 2;
+                }
+            }
+        }
+
+        inline void dequantize_row_q6_K(const BlockQ6_K *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i)
+            {
+                const float d = fp16(x[i].d);
+                const uint8_t *ql = x[i].ql;
+                const uint8_t *qh = x[i].qh;
+                const int8_t *sc = x[i].scales;
+                for (size_t n = 0; n < QK_K; n += 128)
+                {
+                    for (int l = 0; l < 32; ++l)
+                    {
+                        const int is = l / 16;
+                        const int8_t q1 = static_cast<int8_t>((ql[l + 0] & 0xF) | (((qh[l] >> 0) & 3) << 4)) - 32;
+                        const int8_t q2 = static_cast<int8_t>((ql[l + 32] & 0xF) | (((qh[l] >> 2) & 3) << 4)) - 32;
+                        const int8_t q3 = static_cast<int8_t>((ql[l + 0] >> 4) | (((qh[l] >> 4) & 3) << 4)) - 32;
+                        const int8_t q4 = static_cast<int8_t>((ql[l + 32] >> 4) | (((qh[l] >> 6) & 3) << 4)) - 32;
+                        y[l + 0] = d * sc[is + 0] * q1;
+                        y[l + 32] = d * sc[is + 2] * q2;
+                        y[l + 64] = d * sc[is + 4] * q3;
+                        y[l + 96] = d * sc[is + 6] * q4;
+                    }
+                    y += 128;
+                    ql += 64;
+                    qh += 32;
+                    sc += 8;
+                }
+            }
+        }
+
+        inline void dequantize_row_q8_K(const BlockQ8_K *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i)
+                for (size_t j = 0; j < QK_K; ++j)
+                    *y++ = x[i].d * x[i].qs[j];
+        }
+
+        inline void dequantize_row_iq4_xs(const BlockIQ4_XS *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i)
+            {
+                const uint8_t *qs = x[i].qs;
+                const float d = fp16(x[i].d);
+                for (size_t ib = 0; ib < QK_K / 32; ++ib)
+                {
+                    const int ls = ((x[i].scales_l[ib / 2] >> 4 * (ib % 2)) & 0xf) |
+                                   (((x[i].scales_h >> 2 * ib) & 3) << 4);
+                    const float dl = d * (ls - 32);
+                    for (int j = 0; j < 16; ++j)
+                    {
+                        y[j + 0] = dl * kvalues_iq4nl[qs[j] & 0xf];
+                        y[j + 16] = dl * kvalues_iq4nl[qs[j] >> 4];
+                    }
+                    y += 32;
+                    qs += 16;
+                }
+            }
+        }
+
+        inline void dequantize_row_tq1_0(const BlockTQ1_0 *x, float *y, size_t nb)
+        {
+            constexpr uint8_t pow3[6] = {1, 3, 9, 27, 81, 243};
+            constexpr size_t nqs = sizeof(BlockTQ1_0::qs);
+            for (size_t i = 0; i < nb; ++i)
+            {
+                const float d = fp16(x[i].d);
+                for (size_t j = 0; j < nqs - nqs % 32; j += 32)
+                    for (size_t n = 0; n < 5; ++n)
+                        for (size_t m = 0; m < 32; ++m)
+                        {
+                            const uint8_t q = static_cast<uint8_t>(x[i].qs[j + m] * pow3[n]);
+                            const int16_t xi = static_cast<int16_t>((static_cast<uint16_t>(q) * 3) >> 8);
+                            *y++ = static_cast<float>(xi - 1) * d;
+                        }
+                for (size_t j = nqs - nqs % 32; j < nqs; j += 16)
+                    for (size_t n = 0; n < 5; ++n)
+                        for (size_t m = 0; m < 16; ++m)
+                        {
+                            const uint8_t q = static_cast<uint8_t>(x[i].qs[j + m] * pow3[n]);
+                            const int16_t xi = static_cast<int16_t>((static_cast<uint16_t>(q) * 3) >> 8);
+                            *y++ = static_cast<float>(xi - 1) * d;
+                        }
+                for (size_t n = 0; n < 4; ++n)
+                    for (size_t j = 0; j < sizeof(BlockTQ1_0::qh); ++j)
+                    {
+                        const uint8_t q = static_cast<uint8_t>(x[i].qh[j] * pow3[n]);
+                        const int16_t xi = static_cast<int16_t>((static_cast<uint16_t>(q) * 3) >> 8);
+                        *y++ = static_cast<float>(xi - 1) * d;
+                    }
+            }
+        }
+
+        inline void dequantize_row_tq2_0(const BlockTQ2_0 *x, float *y, size_t nb)
+        {
+            for (size_t i = 0; i < nb; ++i)
+            {
+                const float d = fp16(x[i].d);
+                for (size_t j = 0; j < sizeof(BlockTQ2_0::qs); j += 32)
+                    for (size_t l = 0; l < 4; ++l)
+                        for (size_t m = 0; m < 32; ++m)
+                        {
+                            const int8_t q = (x[i].qs[j + m] >> (l * 2)) & 3;
+                            *y++ = static_cast<float>(q - 1) * d;
+                        }
+            }
+        }
+
+        // ------------------------------------------------------------
+        // Q8_0 量化与 block 点积（供量化 matmul 使用）
+        // ------------------------------------------------------------
+
+        // 与 ggml quantize_row_q8_0_ref 相同：每 32 个元素一个 fp16 缩放
+        inline void quantize_row_q8_0(const float *x, BlockQ8_0 *y, size_t k)
+        {
+            const size_t nb = k / QK8_0;
+            for (size_t i = 0; i < nb; ++i, x += QK8_0)
+            {
+                float amax = 0.0f;
+                for (size_t j = 0; j < QK8_0; ++j)
+                    amax = std::max(amax, std::fabs(x[j]));
+                const float d = amax / ((1 << 7) - 1);
+                const float id = d ? 1.0f / d : 0.0f;
+                y[i].d = fp::float_to_half_bits(d);
+                for (size_t j = 0; j < QK8_0; ++j)
+                    y[i].qs[j] = static_cast<int8_t>(std::round(x[j] * id));
+            }
+        }
+
+        inline float vec_dot_q8_0_q8_0(const BlockQ8_0 *x, const BlockQ8_0 *y, size_t nb)
+        {
+#if defined(__AVX2__)
+            __m256 acc = _mm256_setzero_ps();
+            for (size_t i = 0; i < nb; ++i)
+            {
+                const __m256i qx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x[i].qs));
+                const __m256i qy = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y[i].qs));
+                const __m256 d = _mm256_set1_ps(fp16(x[i].d) * fp16(y[i].d));
+                acc = simd::madd(d, _mm256_cvtepi32_ps(simd::mul_sum_i8(qx, qy)), acc);
+            }
+            return simd::hsum(acc);
+#else
+            float sumf = 0.0f;
+            for (size_t i = 0; i < nb; ++i)
+            {
+                int sumi = 0;
+                for (size_t j = 0; j < QK8_0; ++j)
+                    sumi += x[i].qs[j] * y[i].qs[j];
+                sumf += sumi * (fp16(x[i].d) * fp16(y[i].d));
+            }
+            return sumf;
+#endif
+        }
+
+        inline float vec_dot_q4_0_q8_0(const BlockQ4_0 *x, const BlockQ8_0 *y, size_t nb)
+        {
+#if defined(__AVX2__)
+            __m256 acc = _mm256_setzero_ps();
+            for (size_t i = 0; i < nb; ++i)
+            {
+                const __m256i qx = _mm256_sub_epi8(simd::unpack_nibbles(x[i].qs), _mm256_set1_epi8(8));
+                const __m256i qy = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y[i].qs));
+                const __m256 d = _mm256_set1_ps(fp16(x[i].d) * fp16(y[i].d));
+                acc = simd::madd(d, _mm256_cvtepi32_ps(simd::mul_sum_i8(qx, qy)), acc);
+            }
+            return simd::hsum(acc);
+#else
+            float sumf = 0.0f;
+            for (size_t i = 0; i < nb; ++i)
+            {
+                int sumi = 0;
+                for (size_t j = 0; j < QK4_0 / 2; ++j)
+                {
+                    const int v0 = (x[i].qs[j] & 0x0F) - 8;
+                    const int v1 = (x[i].qs[j] >> 4) - 8;
+                    sumi += v0 * y[i].qs[j] + v1 * y[i].qs[j + QK4_0 / 2];
+                }
+                sumf += sumi * (fp16(x[i].d) * fp16(y[i].d));
+            }
+            return sumf;
+#endif
+        }
+
+        inline float vec_dot_f32(const float *a, const float *b, size_t n)
+        {
+            size_t i = 0;
+            float sum = 0.0f;
+#if defined(__AVX2__)
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            for (; i + 16 <= n; i += 16)
+            {
+                acc0 = simd::madd(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+                acc1 = simd::madd(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+            }
+            sum = simd::hsum(_mm256_add_ps(acc0, acc1));
+#endif
+            for (; i < n; ++i)
+                sum += a[i] * b[i];
+            return sum;
+        }
+
+        // ------------------------------------------------------------
+        // 量化（GGUF 写出）：与 ggml 参考量化器一致；qw 为该行的重要性
+        // 权重（imatrix，长度等于行长），为空时使用无权重的参考算法
+        // ------------------------------------------------------------
+
+        constexpr float GROUP_MAX_EPS = 1e-15f;
+
+        inline int nearest_int(float fval)
+        {
+            float val = fval + 12582912.f;
+            int i;
+            std::memcpy(&i, &val, sizeof(int));
+            return (i & 0x007fffff) - 0x00400000;
+        }
+
+        // 对称量化的缩放搜索：L[i] ∈ [0, 2*nmax)，返回缩放 d（x ≈ d * (L - nmax)）
+        inline float make_qx_quants(int n, int nmax, const float *x, int8_t *L, int rmse_type, const float *qw)
+        {
+            float max = 0;
+            float amax = 0;
+            for (int i = 0; i < n; ++i)
+            {
+                float ax = std::fabs(x[i]);
+                if (ax > amax)
+                {
+                    amax = ax;
+                    max = x[i];
+                }
+            }
+            if (amax < GROUP_MAX_EPS)
+            {
+                for (int i = 0; i < n; ++i)
+                    L[i] = 0;
+                return 0.f;
+            }
+            float iscale = -nmax / max;
+            if (rmse_type == 0)
+            {
+                for (int i = 0; i < n; ++i)
+                {
+                    int l = nearest_int(iscale * x[i]);
+                    L[i] = static_cast<int8_t>(nmax + std::max(-nmax, std::min(nmax - 1, l)));
+                }
+                return 1 / iscale;
+            }
+            auto weight = [&](int i)
+            {
+                return qw ? qw[i] : rmse_type == 1 ? x[i] * x[i]
+                                : rmse_type == 2   ? 1.0f
+                                : rmse_type == 3   ? std::fabs(x[i])
+                                                   : std::sqrt(std::fabs(x[i]));
+            };
+            float sumlx = 0;
+            float suml2 = 0;
+            for (int i = 0; i < n; ++i)
+            {
+                int l = nearest_int(iscale * x[i]);
+                l = std::max(-nmax, std::min(nmax - 1, l));
+                L[i] = static_cast<int8_t>(l + nmax);
+                float w = weight(i);
+                sumlx += w * x[i] * l;
+                suml2 += w * l * l;
+            }
+            float scale = suml2 ? sumlx / suml2 : 0.0f;
+            float best = scale * sumlx;
+            for (int is = -9; is <= 9; ++is)
+            {
+                if (is == 0)
+                    continue;
+                iscale = -(nmax + 0.1f * is) / max;
+                sumlx = suml2 = 0;
+                for (int i = 0; i < n; ++i)
+                {
+                    int l = nearest_int(iscale * x[i]);
+                    l = std::max(-nmax, std::min(nmax - 1, l));
+                    float w = weight(i);
+                    sumlx += w * x[i] * l;
+                    suml2 += w * l * l;
+                }
+                if (suml2 > 0 && sumlx * sumlx > best * suml2)
+                {
+                    for (int i = 0; i < n; ++i)
+                    {
+                        int l = nearest_int(iscale * x[i]);
+                        L[i] = static_cast<int8_t>(nmax + std::max(-nmax, std::min(nmax - 1, l)));
+                    }
+                    scale = sumlx / suml2;
+                    best = scale * sumlx;
+                }
+            }
+            return scale;
+        }
+
+        // 非对称（scale + min）量化的加权搜索：x ≈ scale * L - the_min，L ∈ [0, nmax]
+        inline float make_qkx2_quants(int n, int nmax, const float *x, const float *weights,
+                                      uint8_t *L, float *the_min, uint8_t *Laux,
+                                      float rmin, float rdelta, int nstep, bool use_mad)
+        {
+            float min = x[0];
+            float max = x[0];
+            float sum_w = weights[0];
+            float sum_x = sum_w * x[0];
+            for (int i = 1; i < n; ++i)
+            {
+                if (x[i] < min)
+                    min = x[i];
+                if (x[i] > max)
+                    max = x[i];
+                float w = weights[i];
+                sum_w += w;
+                sum_x += w * x[i];
+            }
+            if (min > 0)
+                min = 0;
+            if (max == min)
+            {
+                for (int i = 0; i < n; ++i)
+                    L[i] = 0;
+                *the_min = -min;
+                return 0.f;
+            }
+            float iscale = nmax / (max - min);
+            float scale = 1 / iscale;
+            float best_error = 0;
+            for (int i = 0; i < n; ++i)
+            {
+                int l = nearest_int(iscale * (x[i] - min));
+                L[i] = static_cast<uint8_t>(std::max(0, std::min(nmax, l)));
+                float diff = scale * L[i] + min - x[i];
+                diff = use_mad ? std::fabs(diff) : diff * diff;
+                best_error += weights[i] * diff;
+            }
+            if (nstep < 1)
+            {
+                *the_min = -min;
+                return scale;
+            }
+            for (int is = 0; is <= nstep; ++is)
+            {
+                iscale = (rmin + rdelta * is + nmax) / (max - min);
+                float sum_l = 0, sum_l2 = 0, sum_xl = 0;
+                for (int i = 0; i < n; ++i)
+                {
+                    int l = nearest_int(iscale * (x[i] - min));
+                    l = std::max(0, std::min(nmax, l));
+                    Laux[i] = static_cast<uint8_t>(l);
+                    float w = weights[i];
+                    sum_l += w * l;
+                    sum_l2 += w * l * l;
+                    sum_xl += w * l * x[i];
+                }
+                float D = sum_w * sum_l2 - sum_l * sum_l;
+                if (D > 0)
+                {
+                    float this_scale = (sum_w * sum_xl - sum_x * sum_l) / D;
+                    float this_min = (sum_l2 * sum_x - sum_l * sum_xl) / D;
+                    if (this_min > 0)
+                    {
+                        this_min = 0;
+                        this_scale = sum_xl / sum_l2;
+                    }
+                    float cur_error = 0;
+                    for (int i = 0; i < n; ++i)
+                    {
+                        float diff = this_scale * Laux[i] + this_min - x[i];
+                        diff = use_mad ? std::fabs(diff) : diff * diff;
+                        cur_error += weights[i] * diff;
+                    }
+                    if (cur_error < best_error)
+                    {
+                        for (int i = 0; i < n; ++i)
+                            L[i] = Laux[i];
+                        best_error = cur_error;
+                        scale = this_scale;
+                        min = this_min;
+                    }
+                }
+            }
+            *the_min = -min;
+            return scale;
+        }
+
+        // 行内方差，用于把 imatrix 转换为逐元素权重 qw * sqrt(sigma2 + x^2)
+        inline float row_sigma2(const float *x, size_t k)
+        {
+            float sum_x2 = 0;
+            for (size_t j = 0; j < k; ++j)
+                sum_x2 += x[j] * x[j];
+            return k ? sum_x2 / k : 0.0f;
+        }
+
+        inline void quantize_row_q4_0(const float *x, BlockQ4_0 *y, size_t k, const float *qw = nullptr)
+        {
+            const size_t nb = k / QK4_0;
+            const float sigma2 = qw ? row_sigma2(x, k) : 0.0f;
+            for (size_t i = 0; i < nb; ++i, x += QK4_0)
+            {
+                if (qw)
+                {
+                    float weight[QK4_0];
+                    int8_t L[QK4_0];
+                    for (size_t j = 0; j < QK4_0; ++j)
+                        weight[j] = qw[i * QK4_0 + j] * std::sqrt(sigma2 + x[j] * x[j]);
+                    const float d = make_qx_quants(QK4_0, 8, x, L, 1, weight);
+                    y[i].d = fp::float_to_half_bits(d);
+                    for (size_t j = 0; j < QK4_0 / 2; ++j)
+                        y[i].qs[j] = static_cast<uint8_t>(L[j] | (L[j + QK4_0 / 2] << 4));
+                    continue;
+                }
+                float amax = 0.0f;
+                float max = 0.0f;
+                for (size_t j = 0; j < QK4_0; ++j)
+                {
+                    if (amax < std::fabs(x[j]))
+                    {
+                        amax = std::fabs(x[j]);
+                        max = x[j];
+                    }
+                }
+                const float d = max / -8;
+                const float id = d ? 1.0f / d : 0.0f;
+                y[i].d = fp::float_to_half_bits(d);
+                for (size_t j = 0; j < QK4_0 / 2; ++j)
+                {
+                    const uint8_t xi0 = static_cast<uint8_t>(std::min<int8_t>(15, static_cast<int8_t>(x[j] * id + 8.5f)));
+                    const uint8_t xi1 = static_cast<uint8_t>(std::min<int8_t>(15, static_cast<int8_t>(x[j + QK4_0 / 2] * id + 8.5f)));
+                    y[i].qs[j] = static_cast<uint8_t>(xi0 | (xi1 << 4));
+                }
+            }
+        }
+
+        inline void quantize_row_q5_0(const float *x, BlockQ5_0 *y, size_t k, const float *qw = nullptr)
+        {
+            const size_t nb = k / QK5_0;
+            const float sigma2 = qw ? row_sigma2(x, k) : 0.0f;
+            for (size_t i = 0; i < nb; ++i, x += QK5_0)
+            {
+                uint32_t qh = 0;
+                if (qw)
+                {
+                    float weight[QK5_0];
+                    int8_t L[QK5_0];
+                    for (size_t j = 0; j < QK5_0; ++j)
+                        weight[j] = qw[i * QK5_0 + j] * std::sqrt(sigma2 + x[j] * x[j]);
+                    const float d = make_qx_quants(QK5_0, 16, x, L, 1, weight);
+                    y[i].d = fp::float_to_half_bits(d);
+                    for (size_t j = 0; j < QK5_0 / 2; ++j)
+                    {
+                        const uint8_t xi0 = static_cast<uint8_t>(L[j]);
+                        const uint8_t xi1 = static_cast<uint8_t>(L[j + QK5_0 / 2]);
+                        y[i].qs[j] = static_cast<uint8_t>((xi0 & 0x0F) | ((xi1 & 0x0F) << 4));
+                        qh |= ((xi0 & 0x10u) >> 4) << (j + 0);
+                        qh |= ((xi1 & 0x10u) >> 4) << (j + QK5_0 / 2);
+                    }
+                    std::memcpy(y[i].qh, &qh, sizeof(qh));
+                    continue;
+                }
+                float amax = 0.0f;
+                float max = 0.0f;
+                for (size_t j = 0; j < QK5_0; ++j)
+                {
+                    if (amax < std::fabs(x[j]))
+                    {
+                        amax = std::fabs(x[j]);
+                        max = x[j];
+                    }
+                }
+                const float d = max / -16;
+                const float id = d ? 1.0f / d : 0.0f;
+                y[i].d = fp::float_to_half_bits(d);
+                for (size_t j = 0; j < QK5_0 / 2; ++j)
+                {
+                    const uint8_t xi0 = static_cast<uint8_t>(std::min<int8_t>(31, static_cast<int8_t>(x[j] * id + 16.5f)));
+                    const uint8_t xi1 = static_cast<uint8_t>(std::min<int8_t>(31, static_cast<int8_t>(x[j + QK5_0 / 2] * id + 16.5f)));
+                    y[i].qs[j] = static_cast<uint8_t>((xi0 & 0x0F) | ((xi1 & 0x0F) << 4));
+                    qh |= ((xi0 & 0x10u) >> 4) << (j + 0);
+                    qh |= ((xi1 & 0x10u) >> 4) << (j + QK5_0 / 2);
+                }
+                std::memcpy(y[i].qh, &qh, sizeof(qh));
+            }
+        }
+
+        // Q4_K / Q5_K 共用：每 32 个元素求 scale/min，再以 6 bit 打包到 12 字节
+        inline void make_k_scales(const float *x, int nmax, float rmin, int nstep, const float *qw, float sigma2,
+                                  uint8_t *packed, uint16_t &d_bits, uint16_t &dmin_bits, uint8_t *L)
+        {
+            uint8_t Laux[32];
+            float weights[32];
+            float mins[QK_K / 32];
+            float scales[QK_K / 32];
+            float max_scale = 0;
+            float max_min = 0;
+            for (size_t j = 0; j < QK_K / 32; ++j)
+            {
+                const float *xb = x + 32 * j;
+                if (qw)
+                {
+                    for (int l = 0; l < 32; ++l)
+                        weights[l] = qw[32 * j + l] * std::sqrt(sigma2 + xb[l] * xb[l]);
+                }
+                else
+                {
+                    float sum_x2 = 0;
+                    for (int l = 0; l < 32; ++l)
+                        sum_x2 += xb[l] * xb[l];
+                    const float av_x = std::sqrt(sum_x2 / 32);
+                    for (int l = 0; l < 32; ++l)
+                        weights[l] = av_x + std::fabs(xb[l]);
+                }
+                scales[j] = make_qkx2_quants(32, nmax, xb, weights, L + 32 * j, &mins[j], Laux, rmin, 0.1f, nstep, false);
+                if (scales[j] > max_scale)
+                    max_scale = scales[j];
+                if (mins[j] > max_min)
+                    max_min = mins[j];
+            }
+
+            const float inv_scale = max_scale > 0 ? 63.f / max_scale : 0.f;
+            const float inv_min = max_min > 0 ? 63.f / max_min : 0.f;
+            std::memset(packed, 0, K_SCALE_SIZE);
+            for (int j = 0; j < static_cast<int>(QK_K / 32); ++j)
+            {
+                uint8_t ls = static_cast<uint8_t>(std::min(63, nearest_int(inv_scale * scales[j])));
+                uint8_t lm = static_cast<uint8_t>(std::min(63, nearest_int(inv_min * mins[j])));
+                if (j < 4)
+                {
+                    packed[j] = ls;
+                    packed[j + 4] = lm;
+                }
+                else
+                {
+                    packed[j + 4] = static_cast<uint8_t>((ls & 0xF) | ((lm & 0xF) << 4));
+                    packed[j - 4] |= static_cast<uint8_t>((ls >> 4) << 6);
+                    packed[j - 0] |= static_cast<uint8_t>((lm >> 4) << 6);
+                }
+            }
+            d_bits = fp::float_to_half_bits(max_scale / 63.f);
+            dmin_bits = fp::float_to_half_bits(max_min / 63.f);
+
+            // 用量化后的 scale/min 重新确定每个元素的量化值
+            for (int j = 0; j < static_cast<int>(QK_K / 32); ++j)
+            {
+                uint8_t sc, m;
+                get_scale_min_k4(j, packed, sc, m);
+                const float d = fp16(d_bits) * sc;
+                if (!d)
+                    continue;
+                const float dm = fp16(dmin_bits) * m;
+                for (int ii = 0; ii < 32; ++ii)
+                {
+                    int l = nearest_int((x[32 * j + ii] + dm) / d);
+                    L[32 * j + ii] = static_cast<uint8_t>(std::max(0, std::min(nmax, l)));
+                }
+            }
+        }
+
+        inline void quantize_row_q4_K(const float *x, BlockQ4_K *y, size_t k, const float *qw = nullptr)
+        {
+            const size_t nb = k / QK_K;
+            const float sigma2 = qw ? 2 * row_sigma2(x, k) : 0.0f;
+            uint8_t L[QK_K];
+            for (size_t i = 0; i < nb; ++i, x += QK_K)
+            {
+                make_k_scales(x, 15, -1.f, 20, qw ? qw + i * QK_K : nullptr, sigma2,
+                              y[i].scales, y[i].d, y[i].dmin, L);
+                uint8_t *q = y[i].qs;
+                for (size_t j = 0; j < QK_K; j += 64)
+                {
+                    for (int l = 0; l < 32; ++l)
+                        q[l] = static_cast<uint8_t>(L[j + l] | (L[j + l + 32] << 4));
+                    q += 32;
+                }
+            }
+        }
+
+        inline void quantize_row_q5_K(const float *x, BlockQ5_K *y, size_t k, const float *qw = nullptr)
+        {
+            const size_t nb = k / QK_K;
+            const float sigma2 = qw ? 2 * row_sigma2(x, k) : 0.0f;
+            uint8_t L[QK_K];
+            for (size_t i = 0; i < nb; ++i, x += QK_K)
+            {
+                make_k_scales(x, 31, -0.5f, 15, qw ? qw + i * QK_K : nullptr, sigma2,
+                              y[i].scales, y[i].d, y[i].dmin, L);
+                uint8_t *qh = y[i].qh;
+                uint8_t *ql = y[i].qs;
+                std::memset(qh, 0, QK_K / 8);
+                uint8_t m1 = 1, m2 = 2;
+                for (size_t n = 0; n < QK_K; n += 64)
+                {
+                    for (int j = 0; j < 32; ++j)
+                    {
+                        int l1 = L[n + j];
+                        if (l1 > 15)
+                        {
+                            l1 -= 16;
+                            qh[j] |= m1;
+                        }
+                        int l2 = L[n + j + 32];
+                        if (l2 > 15)
+                        {
+                            l2 -= 16;
+                            qh[j] |= m2;
+                        }
+                        ql[j] = static_cast<uint8_t>(l1 | (l2 << 4));
+                    }
+                    m1 <<= 2;
+                    m2 <<= 2;
+                    ql += 32;
+                }
+            }
+        }
+
+        inline void quantize_row_q6_K(const float *x, BlockQ6_K *y, size_t k, const float *qw = nullptr)
+        {
+            const size_t nb = k / QK_K;
+            const float sigma2 = qw ? row_sigma2(x, k) : 0.0f;
+            int8_t L[QK_K];
+            float scales[QK_K / 16];
+            float weight[16];
+            for (size_t i = 0; i < nb; ++i, x += QK_K)
+            {
+                float max_scale = 0;
+                float max_abs_scale = 0;
+                for (size_t ib = 0; ib < QK_K / 16; ++ib)
+                {
+                    const float *xb = x + 16 * ib;
+                    if (qw)
+                        for (int l = 0; l < 16; ++l)
+                            weight[l] = qw[i * QK_K + 16 * ib + l] * std::sqrt(sigma2 + xb[l] * xb[l]);
+                    const float scale = make_qx_quants(16, 32, xb, L + 16 * ib, 1, qw ? weight : nullptr);
+                    scales[ib] = scale;
+                    const float abs_scale = std::fabs(scale);
+                    if (abs_scale > max_abs_scale)
+                    {
+                        max_abs_scale = abs_scale;
+                        max_scale = scale;
+                    }
+                }
+
+                if (max_abs_scale < GROUP_MAX_EPS)
+                {
+                    std::memset(&y[i], 0, sizeof(BlockQ6_K));
+                    continue;
+                }
+
+                const float iscale = -128.f / max_scale;
+                y[i].d = fp::float_to_half_bits(1 / iscale);
+                for (size_t ib = 0; ib < QK_K / 16; ++ib)
+                    y[i].scales[ib] = static_cast<int8_t>(std::min(127, nearest_int(iscale * scales[ib])));
+
+                for (size_t j = 0; j < QK_K / 16; ++j)
+                {
+                    const float d = fp16(y[i].d) * y[i].scales[j];
+                    if (!d)
+                        continue;
+                    for (int ii = 0; ii < 16; ++ii)
+                    {
+                        int l = nearest_int(x[16 * j + ii] / d);
+                        l = std::max(-32, std::min(31, l));
+                        L[16 * j + ii] = static_cast<int8_t>(l + 32);
+                    }
+                }
+
+                uint8_t *ql = y[i].ql;
+                uint8_t *qh = y[i].qh;
+                for (size_t j = 0; j < QK_K; j += 128)
+                {
+                    for (int l = 0; l < 32; ++l)
+                    {
+                        const uint8_t q1 = L[j + l + 0] & 0xF;
+                        const uint8_t q2 = L[j + l + 32] & 0xF;
+                        const uint8_t q3 = L[j + l + 64] & 0xF;
+                        const uint8_t q4 = L[j + l + 96] & 0xF;
+                        ql[l + 0] = static_cast<uint8_t>(q1 | (q3 << 4));
+                        ql[l + 32] = static_cast<uint8_t>(q2 | (q4 << 4));
+                        qh[l] = static_cast<uint8_t>((L[j + l] >> 4) | ((L[j + l + 32] >> 4) << 2) |
+                                                     ((L[j + l + 64] >> 4) << 4) | ((L[j + l + 96] >> 4) << 6));
+                    }
+                    ql += 64;
+                    qh += 32;
+                }
+            }
+        }
+
+    } // namespace gguf_quant
+
+} // namespace TensorN
+
+#endif // __GGUF_QUANT_HPP__
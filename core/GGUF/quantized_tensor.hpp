@@ -0,0 +1,187 @@
+#pragma once
+#ifndef __QUANTIZED_TENSOR_HPP__
+#define __QUANTIZED_TENSOR_HPP__
+
+// ============================================================================
+// QuantizedTensor —— 以 ggml block 打包格式存放的权重，以及直接在 block 上
+// 计算的 y = x @ W^T（blas::quantized_matmul）。
+//
+// 权重按行（输出特征）存放，每行 cols / block_size 个 block。Q4_0 / Q8_0
+// 权重先把激活量化为 Q8_0，再做 int8 点积（AVX2 maddubs，VNNI 可用时
+// 使用 dpbusd），fp32 累加；其余类型逐 block 反量化到 L1 缓冲后做 fp32
+// 点积。两条路径都按输出行多线程并行，权重只读一遍。
+// ============================================================================
+
+#include "gguf.hpp"
+#include <memory>
+#include <vector>
+#include <string>
+
+namespace TensorN
+{
+    class QuantizedTensor
+    {
+    private:
+        GGMLType _type = GGMLType::F32;
+        std::vector<size_t> _shape;
+        std::shared_ptr<const uint8_t> _data; // 可能指向映射区（别名 shared_ptr）
+        size_t _rows = 0;
+        size_t _cols = 0;
+
+    public:
+        QuantizedTensor() = default;
+
+        // 接管一段打包好的 block 数据；shape 为行主序形状，最后一维是 block 所在维度
+        QuantizedTensor(GGMLType type, const std::vector<size_t> &shape,
+                        std::shared_ptr<const uint8_t> data)
+            : _type(type), _shape(shape), _data(std::move(data))
+        {
+            if (_shape.empty())
+                TENSOR_THROW("QuantizedTensor requires at least one dimension");
+            _cols = _shape.back();
+            _rows = 1;
+            for (size_t i = 0; i + 1 < _shape.size(); ++i)
+                _rows *= _shape[i];
+            if (_cols % ggml_block_size(_type) != 0)
+                TENSOR_THROW("Row size is not a multiple of the GGML block size");
+        }
+
+        QuantizedTensor(GGMLType type, const std::vector<size_t> &shape, std::vector<uint8_t> bytes)
+            : QuantizedTensor(type, shape, own(std::move(bytes))) {}
+
+        // 零拷贝：引用 GGUF 映射区中的 block
+        static QuantizedTensor from_gguf(const GGUFFile &file, const std::string &name)
+        {
+            GGUFTensorView v = file.view(name);
+            std::shared_ptr<const uint8_t> data(file.mapping(), v.data);
+            return QuantizedTensor(v.info->type, v.info->shape(), std::move(data));
+        }
+
+        // 把 float 张量量化为 type（最后一维为行），imatrix 可选
+        static QuantizedTensor quantize(const Tensor<float> &tensor, GGMLType type,
+                                        const std::vector<float> &imatrix = {})
+        {
+            if (tensor.shape().empty())
+                TENSOR_THROW("QuantizedTensor requires at least one dimension");
+            const size_t cols = tensor.shape().back();
+            if (!imatrix.empty() && imatrix.size() != cols)
+                TENSOR_THROW("imatrix size does not match the row size");
+            return QuantizedTensor(type, tensor.shape(),
+                                   ggml_quantize(type, tensor.data->data(), cols ? tensor.size() / cols : 0, cols,
+                                                 imatrix.empty() ? nullptr : imatrix.data()));
+        }
+
+        GGMLType type() const { return _type; }
+        const std::vector<size_t> &shape() const { return _shape; }
+        size_t rows() const { return _rows; }
+        size_t cols() const { return _cols; }
+        size_t size() const { return _rows * _cols; }
+        size_t row_bytes() const { return _cols / ggml_block_size(_type) * ggml_type_size(_type); }
+        size_t nbytes() const { return _rows * row_bytes(); }
+        const uint8_t *data() const { return _data.get(); }
+        const uint8_t *row(size_t r) const { return _data.get() + r * row_bytes(); }
+
+        template <typename T = float>
+        Tensor<T> dequantize() const
+        {
+            Tensor<T> result(_shape);
+            if (result.size() > 0)
+                ggml_dequantize<T>(_type, _data.get(), result.data->data(), result.size());
+            return result;
+        }
+
+    private:
+        static std::shared_ptr<const uint8_t> own(std::vector<uint8_t> bytes)
+        {
+            auto holder = std::make_shared<std::vector<uint8_t>>(std::move(bytes));
+            return std::shared_ptr<const uint8_t>(holder, holder->data());
+        }
+    };
+
+    namespace blas
+    {
+        // y = x @ W^T：x 形状 [..., K]，W 形状 [N, K]（量化），返回 [..., N]
+        inline Tensor<float> quantized_matmul(const Tensor<float> &x, const QuantizedTensor &W)
+        {
+            using namespace gguf_quant;
+            if (x.shape().empty())
+                TENSOR_THROW("quantized_matmul requires at least 1D input");
+            const size_t K = x.shape().back();
+            if (K != W.cols())
+                TENSOR_THROW("Inner dimensions must match");
+            if (W.shape().size() != 2)
+                TENSOR_THROW("quantized_matmul requires a 2D weight");
+            if (!ggml_can_dequantize(W.type()))
+                TENSOR_THROW("quantized_matmul: unsupported GGML type " +
+                             std::to_string(static_cast<uint32_t>(W.type())));
+
+            size_t M = 1;
+            for (size_t i = 0; i + 1 < x.shape().size(); ++i)
+                M *= x.shape()[i];
+            const size_t N = W.rows();
+            std::vector<size_t> out_shape(x.shape().begin(), x.shape().end() - 1);
+            out_shape.push_back(N);
+            Tensor<float> y(out_shape);
+            if (M == 0 || N == 0 || K == 0)
+                return y; // K == 0 时为空求和，输出全 0
+
+            const float *X = x.data->data();
+            float *Y = y.data->data();
+            const int64_t n_rows = static_cast<int64_t>(N);
+
+            if (W.type() == GGMLType::Q4_0 || W.type() == GGMLType::Q8_0)
+            {
+                // 激活量化为 Q8_0（每个输入行一次），随后纯整数点积
+                const size_t nb = K / QK8_0;
+                std::vector<BlockQ8_0> xq(M * nb);
+                const int64_t n_in = static_cast<int64_t>(M);
+#pragma omp parallel for schedule(static) if (n_in > 1)
+                for (int64_t m = 0; m < n_in; ++m)
+                    quantize_row_q8_0(X + m * K, xq.data() + m * nb, K);
+
+                const bool q4 = W.type() == GGMLType::Q4_0;
+#pragma omp parallel for schedule(static)
+                for (int64_t n = 0; n < n_rows; ++n)
+                {
+                    const uint8_t *w = W.row(static_cast<size_t>(n));
+                    for (size_t m = 0; m < M; ++m)
+                    {
+                        const BlockQ8_0 *a = xq.data() + m * nb;
+                        Y[m * N + n] = q4 ? vec_dot_q4_0_q8_0(reinterpret_cast<const BlockQ4_0 *>(w), a, nb)
+                                          : vec_dot_q8_0_q8_0(reinterpret_cast<const BlockQ8_0 *>(w), a, nb);
+                    }
+                }
+                return y;
+            }
+
+            // 通用路径：逐 block 反量化到栈上缓冲，对所有输入行复用
+            const size_t bs = ggml_block_size(W.type());
+            const size_t ts = ggml_type_size(W.type());
+            const size_t step = bs > 1 ? bs : QK_K; // F32/F16/BF16 按 QK_K 个元素一段
+#pragma omp parallel
+            {
+                std::vector<float> acc(M);
+                float buf[QK_K];
+#pragma omp for schedule(static)
+                for (int64_t n = 0; n < n_rows; ++n)
+                {
+                    const uint8_t *w = W.row(static_cast<size_t>(n));
+                    std::fill(acc.begin(), acc.end(), 0.0f);
+                    for (size_t k0 = 0; k0 < K; k0 += step)
+                    {
+                        const size_t len = std::min(step, K - k0);
+                        ggml_dequantize_row(W.type(), w + k0 / bs * ts, buf, len);
+                        for (size_t m = 0; m < M; ++m)
+                            acc[m] += vec_dot_f32(buf, X + m * K + k0, len);
+                    }
+                    for (size_t m = 0; m < M; ++m)
+                        Y[m * N + n] = acc[m];
+                }
+            }
+            return y;
+        }
+    }
+
+} // namespace TensorN
+
+#endif // __QUANTIZED_TENSOR_HPP__
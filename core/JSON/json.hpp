@@ -0,0 +1,262 @@
+#pragma once
+#ifndef __JSON__H__
+#define __JSON__H__
+
+// ============================================================================
+// 张量 JSON 流式读写：{"shape":[...],"data":[...]}
+//
+//   读：mmap 文件后用 nlohmann 的 SAX 接口解析，不构建 DOM；shape 在 data
+//       之前出现时（save_json 的输出即如此）数值直接写入张量存储，否则先
+//       收集到 std::vector<T>。data 允许嵌套数组，按行主序展平。
+//   写：不经过 DOM，直接输出紧凑 JSON；数值按块并行格式化（to_chars 最短
+//       可往返表示），非有限浮点数写为 null（读回为 NaN）。
+// ============================================================================
+
+#include "../tensor.hpp"
+#include "../mapped_file.hpp"
+#include "../CSV/csv.hpp"
+#include <nlohmann/json.hpp>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace TensorN
+{
+    namespace json_detail
+    {
+        template <typename T>
+        class TensorSax : public nlohmann::json_sax<nlohmann::json>
+        {
+        private:
+            enum class Field
+            {
+                None,
+                Shape,
+                Data
+            };
+
+            Field _field = Field::None;
+            int _depth = 0;
+            bool _has_shape = false;
+            bool _shape_done = false;
+
+        public:
+            std::vector<size_t> shape;
+            Tensor<T> direct;       // shape 已知时直接写入
+            size_t count = 0;       // 已写入 direct 的元素数
+            std::vector<T> pending; // shape 未知时暂存
+            std::string error;
+
+            bool has_shape() const { return _has_shape; }
+
+            bool null() override
+            {
+                if constexpr (std::is_floating_point_v<T>)
+                    return push(std::numeric_limits<T>::quiet_NaN());
+                else
+                    return value_error("null");
+            }
+            bool boolean(bool v) override { return push(static_cast<T>(v)); }
+            bool number_integer(number_integer_t v) override { return push(static_cast<T>(v)); }
+            bool number_unsigned(number_unsigned_t v) override
+            {
+                if (_field == Field::Shape && _depth == 2)
+                {
+                    shape.push_back(static_cast<size_t>(v));
+                    return true;
+                }
+                return push(static_cast<T>(v));
+            }
+            bool number_float(number_float_t v, const string_t &) override { return push(static_cast<T>(v)); }
+            bool string(string_t &) override { return value_error("string"); }
+            bool binary(binary_t &) override { return value_error("binary"); }
+
+            bool start_object(std::size_t) override
+            {
+                if (_field != Field::None)
+                    return value_error("object");
+                ++_depth;
+                return true;
+            }
+            bool end_object() override
+            {
+                --_depth;
+                return true;
+            }
+            bool key(string_t &k) override
+            {
+                if (_depth == 1)
+                    _field = k == "shape" ? Field::Shape : (k == "data" ? Field::Data : Field::None);
+                return true;
+            }
+            bool start_array(std::size_t) override
+            {
+                if (_field == Field::Shape && _depth >= 2)
+                    return fail("'shape' must be a flat array");
+                ++_depth;
+                return true;
+            }
+            bool end_array() override
+            {
+                if (--_depth == 1)
+                    end_value();
+                return true;
+            }
+            bool parse_error(std::size_t pos, const std::string &, const nlohmann::detail::exception &ex) override
+            {
+                error = "JSON parse error at byte " + std::to_string(pos) + ": " + ex.what();
+                return false;
+            }
+
+        private:
+            bool push(T v)
+            {
+                if (_field == Field::Shape)
+                    return fail("'shape' must contain non-negative integers");
+                if (_field != Field::Data)
+                    return true; // 忽略其它字段
+                if (_has_shape)
+                {
+                    if (count >= direct.size())
+                        return fail("'data' has more elements than 'shape' describes");
+                    (*direct.data)[count++] = v;
+                }
+                else
+                    pending.push_back(v);
+                if (_depth == 1)
+                    end_value();
+                return true;
+            }
+
+            // 顶层字段的值结束
+            void end_value()
+            {
+                if (_field == Field::Shape && !_shape_done)
+                {
+                    _shape_done = true;
+                    if (pending.empty())
+                    {
+                        _has_shape = true;
+                        direct = Tensor<T>(shape);
+                    }
+                }
+                _field = Field::None;
+            }
+
+            bool value_error(const char *what)
+            {
+                if (_field == Field::None)
+                    return true;
+                return fail(std::string("unexpected ") + what + " in tensor JSON");
+            }
+
+            bool fail(const std::string &msg)
+            {
+                error = msg;
+                return false;
+            }
+        };
+    }
+
+    // 解析内存中的张量 JSON
+    template <typename T>
+    Tensor<T> parse_json(const char *data, size_t size)
+    {
+        json_detail::TensorSax<T> sax;
+        const bool ok = nlohmann::json::sax_parse(data, data + size, &sax);
+        if (!ok)
+            TENSOR_THROW(sax.error.empty() ? std::string("Invalid tensor JSON") : sax.error);
+        if (sax.has_shape())
+        {
+            if (sax.count != sax.direct.size())
+                TENSOR_THROW("Shape does not match data size.");
+            return std::move(sax.direct);
+        }
+        return Tensor<T>(sax.shape, sax.pending);
+    }
+
+    template <typename T>
+    Tensor<T> read_json(const std::string &filename)
+    {
+        std::error_code ec;
+        const auto bytes = std::filesystem::file_size(filename, ec);
+        if (ec)
+            TENSOR_THROW("Cannot open file: " + filename);
+        if (bytes == 0)
+            TENSOR_THROW("Empty JSON file: " + filename);
+        MappedFile file(filename);
+        file.prefetch(0, file.size());
+        return parse_json<T>(reinterpret_cast<const char *>(file.data()), file.size());
+    }
+
+    template <typename T>
+    void write_json(const Tensor<T> &A, const std::string &filename)
+    {
+        using namespace csv_detail;
+        std::ofstream file(filename, std::ios::binary);
+        if (!file)
+            TENSOR_THROW("Cannot open file for writing: " + filename);
+
+        std::string head = "{\"shape\":[";
+        for (size_t i = 0; i < A.shape().size(); ++i)
+        {
+            if (i)
+                head += ',';
+            head += std::to_string(A.shape()[i]);
+        }
+        head += "],\"data\":[";
+        file.write(head.data(), static_cast<std::streamsize>(head.size()));
+
+        const T *src = A.data->data();
+        const size_t n = A.size();
+        const size_t n_chunks = (n + CHUNK_VALUES - 1) / CHUNK_VALUES;
+        const size_t batch = static_cast<size_t>(num_threads()) * 2;
+        std::vector<std::string> bufs(std::min(batch, n_chunks));
+
+        for (size_t c0 = 0; c0 < n_chunks; c0 += batch)
+        {
+            const int64_t nb = static_cast<int64_t>(std::min(batch, n_chunks - c0));
+#pragma omp parallel for schedule(dynamic) if (nb > 1)
+            for (int64_t b = 0; b < nb; ++b)
+            {
+                const size_t i0 = (c0 + static_cast<size_t>(b)) * CHUNK_VALUES;
+                const size_t i1 = std::min(n, i0 + CHUNK_VALUES);
+                std::string &s = bufs[b];
+                s.resize((i1 - i0) * (MAX_VALUE_CHARS + 1));
+                char *p = s.data();
+                for (size_t i = i0; i < i1; ++i)
+                {
+                    if (i)
+                        *p++ = ',';
+                    const T v = src[i];
+                    if constexpr (std::is_floating_point_v<T>)
+                    {
+                        if (std::isfinite(v))
+                            p = format_value(p, v);
+                        else
+                        {
+                            std::memcpy(p, "null", 4);
+                            p += 4;
+                        }
+                    }
+                    else
+                        p = format_value(p, v);
+                }
+                s.resize(static_cast<size_t>(p - s.data()));
+            }
+            for (int64_t b = 0; b < nb; ++b)
+                file.write(bufs[b].data(), static_cast<std::streamsize>(bufs[b].size()));
+        }
+        file.write("]}", 2);
+        if (!file)
+            TENSOR_THROW("Error writing JSON file: " + filename);
+    }
+
+} // namespace TensorN
+
+#endif // __JSON__H__
@@ -0,0 +1,578 @@
+#pragma once
+#ifndef __NPY__H__
+#define __NPY__H__
+
+// ============================================================================
+// NumPy .npy / .npz 读取：内存映射 + 零拷贝视图。
+//
+//   * NpyFile：mmap 一个 .npy 文件，dtype / 字节序 / C 顺序都匹配时直接返回
+//     指向映射区的 Tensor<T>；Fortran 顺序做一次转置拷贝，大端数据在拷贝时
+//     交换字节序。
+//   * NpzFile：只解析 zip 中央目录，按名字选择成员；未压缩（np.savez）成员
+//     同样零拷贝，压缩（np.savez_compressed）成员直接解压到张量存储中；
+//     load_all 并行解压全部成员。
+// ============================================================================
+
+#include "../tensor.hpp"
+#include "../mapped_file.hpp"
+#include <zlib.h>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace TensorN
+{
+    // NumPy 数组描述：descr 形如 "<f4"，kind 为 'f' / 'i' / 'u' / 'b'
+    struct NpyHeader
+    {
+        char byte_order = '<';
+        char kind = 'f';
+        size_t word_size = 0;
+        bool fortran_order = false;
+        std::vector<size_t> shape;
+        size_t data_offset = 0; // 相对 .npy 起始位置
+
+        size_t numel() const
+        {
+            size_t n = 1;
+            for (auto d : shape)
+                n *= d;
+            return n;
+        }
+
+        size_t nbytes() const { return numel() * word_size; }
+
+        // 小端或单字节数据无需交换字节序
+        bool native_endian() const { return byte_order == '<' || byte_order == '|' || byte_order == '='; }
+    };
+
+    template <typename T>
+    constexpr char npy_kind()
+    {
+        if constexpr (std::is_same_v<T, bool>)
+            return 'b';
+        else if constexpr (std::is_same_v<T, TensorN::half> || std::is_floating_point_v<T>)
+            return 'f';
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+            return 'i';
+        else if constexpr (std::is_integral_v<T>)
+            return 'u';
+        else
+            return '?';
+    }
+
+    namespace npy_detail
+    {
+        constexpr char NPY_MAGIC[] = "\x93NUMPY";
+
+        inline std::string dict_value(const std::string &dict, const std::string &key)
+        {
+            size_t pos = dict.find("'" + key + "'");
+            if (pos == std::string::npos)
+                TENSOR_THROW("Missing '" + key + "' in .npy header");
+            pos = dict.find(':', pos);
+            if (pos == std::string::npos)
+                TENSOR_THROW("Malformed .npy header");
+            ++pos;
+            while (pos < dict.size() && dict[pos] == ' ')
+                ++pos;
+            size_t end;
+            if (dict[pos] == '(')
+                end = dict.find(')', pos) + 1;
+            else if (dict[pos] == '\'')
+                end = dict.find('\'', pos + 1) + 1;
+            else
+                end = dict.find_first_of(",}", pos);
+            return dict.substr(pos, end - pos);
+        }
+
+        // 解析 .npy 头部；p/size 为包含头部的字节区间
+        inline NpyHeader parse_header(const uint8_t *p, size_t size)
+        {
+            if (size < 10 || std::memcmp(p, NPY_MAGIC, 6) != 0)
+                TENSOR_THROW("Not a valid .npy file (bad magic)");
+            const uint8_t major = p[6];
+            size_t header_len, prefix;
+            if (major == 1)
+            {
+                header_len = static_cast<size_t>(p[8]) | (static_cast<size_t>(p[9]) << 8);
+                prefix = 10;
+            }
+            else if (major == 2 || major == 3)
+            {
+                if (size < 12)
+                    TENSOR_THROW("Truncated .npy header");
+                uint32_t len;
+                std::memcpy(&len, p + 8, sizeof(len));
+                header_len = len;
+                prefix = 12;
+            }
+            else
+            {
+                TENSOR_THROW("Unsupported .npy version: " + std::to_string(major));
+            }
+            if (prefix + header_len > size)
+                TENSOR_THROW("Truncated .npy header");
+
+            std::string dict(reinterpret_cast<const char *>(p + prefix), header_len);
+            NpyHeader h;
+            h.data_offset = prefix + header_len;
+
+            std::string descr = dict_value(dict, "descr");
+            if (descr.size() < 5)
+                TENSOR_THROW("Unsupported .npy dtype: " + descr);
+            h.byte_order = descr[1];
+            h.kind = descr[2];
+            h.word_size = static_cast<size_t>(std::stoul(descr.substr(3, descr.size() - 4)));
+
+            h.fortran_order = dict_value(dict, "fortran_order") == "True";
+
+            std::string shape = dict_value(dict, "shape");
+            size_t pos = 1;
+            while (pos < shape.size())
+            {
+                while (pos < shape.size() && (shape[pos] == ' ' || shape[pos] == ','))
+                    ++pos;
+                if (pos >= shape.size() || shape[pos] == ')')
+                    break;
+                size_t end = shape.find_first_of(",)", pos);
+                h.shape.push_back(static_cast<size_t>(std::stoull(shape.substr(pos, end - pos))));
+                pos = end;
+            }
+            return h;
+        }
+
+        template <typename T>
+        void check_dtype(const NpyHeader &h)
+        {
+            const bool match = h.word_size == sizeof(T) &&
+                               (h.kind == npy_kind<T>() ||
+                                (h.kind == 'b' && std::is_same_v<T, uint8_t>));
+            if (!match)
+                TENSOR_THROW("Data type mismatch in .npy: file has '" + std::string(1, h.kind) +
+                             std::to_string(h.word_size) + "', requested '" + std::string(1, npy_kind<T>()) +
+                             std::to_string(sizeof(T)) + "'");
+        }
+
+        inline void byteswap(uint8_t *p, size_t word_size, size_t n)
+        {
+            for (size_t i = 0; i < n; ++i, p += word_size)
+                for (size_t a = 0, b = word_size - 1; a < b; ++a, --b)
+                    std::swap(p[a], p[b]);
+        }
+
+        // 从原始字节构造 C 顺序张量：字节序交换 + Fortran 顺序转置，只拷贝一次
+        template <typename T>
+        Tensor<T> materialize(const NpyHeader &h, const uint8_t *src)
+        {
+            Tensor<T> result(h.shape);
+            const size_t n = result.size();
+            if (n == 0)
+                return result;
+            T *dst = result.data->data();
+
+            if (!h.fortran_order || h.shape.size() < 2)
+            {
+                std::memcpy(dst, src, n * sizeof(T));
+            }
+            else
+            {
+                // Fortran 顺序：源数据按第 0 维变化最快。按输出的 C 顺序遍历，
+                // 对最外层维度并行，内部以"里程表"方式推进源偏移。
+                const size_t nd = h.shape.size();
+                std::vector<size_t> fstride(nd);
+                fstride[0] = 1;
+                for (size_t k = 1; k < nd; ++k)
+                    fstride[k] = fstride[k - 1] * h.shape[k - 1];
+                const T *s = reinterpret_cast<const T *>(src);
+                const size_t inner = n / h.shape[0];
+                const int64_t outer = static_cast<int64_t>(h.shape[0]);
+#pragma omp parallel for schedule(static)
+                for (int64_t i0 = 0; i0 < outer; ++i0)
+                {
+                    std::vector<size_t> idx(nd, 0);
+                    size_t off = static_cast<size_t>(i0) * fstride[0];
+                    T *out = dst + static_cast<size_t>(i0) * inner;
+                    for (size_t e = 0; e < inner; ++e)
+                    {
+                        std::memcpy(out + e, s + off, sizeof(T));
+                        for (size_t k = nd - 1; k >= 1; --k)
+                        {
+                            off += fstride[k];
+                            if (++idx[k] < h.shape[k])
+                                break;
+                            off -= fstride[k] * h.shape[k];
+                            idx[k] = 0;
+                        }
+                    }
+                }
+            }
+            if (!h.native_endian() && sizeof(T) > 1)
+                byteswap(reinterpret_cast<uint8_t *>(dst), sizeof(T), n);
+            return result;
+        }
+
+        // zlib 原始 deflate 流的顺序解压器
+        class Inflater
+        {
+        public:
+            Inflater(const uint8_t *src, size_t size)
+            {
+                std::memset(&_zs, 0, sizeof(_zs));
+                if (inflateInit2(&_zs, -MAX_WBITS) != Z_OK)
+                    TENSOR_THROW("inflateInit2 failed");
+                _zs.next_in = const_cast<Bytef *>(src);
+                _zs.avail_in = 0;
+                _remaining = size;
+            }
+
+            ~Inflater() { inflateEnd(&_zs); }
+
+            Inflater(const Inflater &) = delete;
+            Inflater &operator=(const Inflater &) = delete;
+
+            // 解压恰好 n 个字节到 dst
+            void read(void *dst, size_t n)
+            {
+                uint8_t *out = static_cast<uint8_t *>(dst);
+                while (n > 0)
+                {
+                    const uInt chunk = static_cast<uInt>(std::min<size_t>(n, 1u << 30));
+                    _zs.next_out = out;
+                    _zs.avail_out = chunk;
+                    while (_zs.avail_out > 0)
+                    {
+                        if (_zs.avail_in == 0 && _remaining > 0)
+                        {
+                            const uInt in = static_cast<uInt>(std::min<size_t>(_remaining, 1u << 30));
+                            _zs.avail_in = in;
+                            _remaining -= in;
+                        }
+                        int ret = inflate(&_zs, Z_NO_FLUSH);
+                        if (ret == Z_STREAM_END && _zs.avail_out > 0)
+                            TENSOR_THROW("Unexpected end of compressed .npz member");
+                        if (ret != Z_OK && ret != Z_STREAM_END)
+                            TENSOR_THROW("Corrupt compressed .npz member");
+                    }
+                    out += chunk;
+                    n -= chunk;
+                }
+            }
+
+        private:
+            z_stream _zs;
+            size_t _remaining = 0;
+        };
+
+        inline uint16_t rd16(const uint8_t *p)
+        {
+            uint16_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline uint32_t rd32(const uint8_t *p)
+        {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline uint64_t rd64(const uint8_t *p)
+        {
+            uint64_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+    }
+
+    // ------------------------------------------------------------
+    // NpyFile
+    // ------------------------------------------------------------
+
+    class NpyFile
+    {
+    private:
+        std::shared_ptr<MappedFile> _file;
+        NpyHeader _header;
+
+    public:
+        explicit NpyFile(const std::string &filename) : _file(MappedFile::open(filename))
+        {
+            _header = npy_detail::parse_header(_file->data(), _file->size());
+            if (_header.data_offset + _header.nbytes() > _file->size())
+                TENSOR_THROW("Truncated .npy file: " + filename);
+        }
+
+        const NpyHeader &header() const { return _header; }
+        const std::vector<size_t> &shape() const { return _header.shape; }
+        const std::shared_ptr<MappedFile> &mapping() const { return _file; }
+
+        // 零拷贝视图（dtype 匹配、小端、C 顺序且对齐时），否则退化为 load()
+        template <typename T>
+        Tensor<T> tensor() const
+        {
+            npy_detail::check_dtype<T>(_header);
+            const uint8_t *p = _file->data() + _header.data_offset;
+            const bool contiguous = !_header.fortran_order || _header.shape.size() < 2;
+            if (contiguous && (_header.native_endian() || sizeof(T) == 1) &&
+                reinterpret_cast<uintptr_t>(p) % alignof(T) == 0)
+                return MappedFile::view<T>(_file, _header.shape, _header.data_offset);
+            return load<T>();
+        }
+
+        // 拷贝到独立的 Tensor<T>
+        template <typename T>
+        Tensor<T> load() const
+        {
+            npy_detail::check_dtype<T>(_header);
+            return npy_detail::materialize<T>(_header, _file->data() + _header.data_offset);
+        }
+    };
+
+    // ------------------------------------------------------------
+    // NpzFile
+    // ------------------------------------------------------------
+
+    struct NpzMember
+    {
+        std::string name;         // 去掉 .npy 后缀
+        uint16_t method = 0;      // 0 = stored, 8 = deflate
+        uint64_t compressed_size = 0;
+        uint64_t size = 0;
+        uint64_t data_offset = 0; // 成员数据在 zip 中的位置
+    };
+
+    class NpzFile
+    {
+    private:
+        std::shared_ptr<MappedFile> _file;
+        std::vector<NpzMember> _members;
+        std::unordered_map<std::string, size_t> _index;
+
+    public:
+        explicit NpzFile(const std::string &filename) : _file(MappedFile::open(filename))
+        {
+            using namespace npy_detail;
+            const uint8_t *base = _file->data();
+            const size_t size = _file->size();
+            if (size < 22)
+                TENSOR_THROW("Not a valid .npz file: " + filename);
+
+            // 1. 从文件尾部向前查找 End Of Central Directory
+            size_t eocd = std::string::npos;
+            const size_t stop = size > 22 + 65535 ? size - 22 - 65535 : 0;
+            for (size_t p = size - 22 + 1; p-- > stop;)
+            {
+                if (rd32(base + p) == 0x06054b50)
+                {
+                    eocd = p;
+                    break;
+                }
+            }
+            if (eocd == std::string::npos)
+                TENSOR_THROW("Not a valid .npz file (no zip directory): " + filename);
+
+            uint64_t n_entries = rd16(base + eocd + 10);
+            uint64_t cd_offset = rd32(base + eocd + 16);
+            // Zip64：由 locator 找到 zip64 EOCD
+            if ((n_entries == 0xFFFF || cd_offset == 0xFFFFFFFF) && eocd >= 20 &&
+                rd32(base + eocd - 20) == 0x07064b50)
+            {
+                const uint64_t z64 = rd64(base + eocd - 20 + 8);
+                if (z64 + 56 > size || rd32(base + z64) != 0x06064b50)
+                    TENSOR_THROW("Corrupt zip64 directory in " + filename);
+                n_entries = rd64(base + z64 + 32);
+                cd_offset = rd64(base + z64 + 48);
+            }
+
+            // 2. 中央目录
+            size_t p = static_cast<size_t>(cd_offset);
+            for (uint64_t i = 0; i < n_entries; ++i)
+            {
+                if (p + 46 > size || rd32(base + p) != 0x02014b50)
+                    TENSOR_THROW("Corrupt zip central directory in " + filename);
+                NpzMember m;
+                m.method = rd16(base + p + 10);
+                m.compressed_size = rd32(base + p + 20);
+                m.size = rd32(base + p + 24);
+                const uint16_t name_len = rd16(base + p + 28);
+                const uint16_t extra_len = rd16(base + p + 30);
+                const uint16_t comment_len = rd16(base + p + 32);
+                uint64_t local = rd32(base + p + 42);
+                m.name.assign(reinterpret_cast<const char *>(base + p + 46), name_len);
+
+                // zip64 扩展字段：依次给出被置为 0xFFFFFFFF 的字段
+                const uint8_t *extra = base + p + 46 + name_len;
+                for (size_t e = 0; e + 4 <= extra_len;)
+                {
+                    const uint16_t id = rd16(extra + e);
+                    const uint16_t len = rd16(extra + e + 2);
+                    if (id == 0x0001)
+                    {
+                        size_t q = e + 4;
+                        if (m.size == 0xFFFFFFFF)
+                            m.size = rd64(extra + q), q += 8;
+                        if (m.compressed_size == 0xFFFFFFFF)
+                            m.compressed_size = rd64(extra + q), q += 8;
+                        if (local == 0xFFFFFFFF)
+                            local = rd64(extra + q);
+                    }
+                    e += 4 + len;
+                }
+
+                if (local + 30 > size || rd32(base + local) != 0x04034b50)
+                    TENSOR_THROW("Corrupt zip local header in " + filename);
+                m.data_offset = local + 30 + rd16(base + local + 26) + rd16(base + local + 28);
+                if (m.data_offset + m.compressed_size > size)
+                    TENSOR_THROW("Truncated .npz member '" + m.name + "' in " + filename);
+                if (m.method != 0 && m.method != 8)
+                    TENSOR_THROW("Unsupported zip compression method in " + filename);
+
+                if (m.name.size() > 4 && m.name.compare(m.name.size() - 4, 4, ".npy") == 0)
+                    m.name.resize(m.name.size() - 4);
+                _index[m.name] = _members.size();
+                _members.push_back(std::move(m));
+                p += 46 + name_len + extra_len + comment_len;
+            }
+        }
+
+        const std::vector<NpzMember> &members() const { return _members; }
+        size_t size() const { return _members.size(); }
+
+        std::vector<std::string> names() const
+        {
+            std::vector<std::string> result;
+            result.reserve(_members.size());
+            for (const auto &m : _members)
+                result.push_back(m.name);
+            return result;
+        }
+
+        bool contains(const std::string &name) const { return find(name) != nullptr; }
+
+        const NpzMember &member(const std::string &name) const
+        {
+            const NpzMember *m = find(name);
+            if (!m)
+                TENSOR_THROW("Array '" + name + "' not found in .npz file");
+            return *m;
+        }
+
+        // 未压缩成员：零拷贝视图（条件同 NpyFile::tensor）；压缩成员：解压
+        template <typename T>
+        Tensor<T> tensor(const std::string &name) const
+        {
+            const NpzMember &m = member(name);
+            if (m.method == 0)
+            {
+                const uint8_t *p = _file->data() + m.data_offset;
+                NpyHeader h = npy_detail::parse_header(p, static_cast<size_t>(m.size));
+                npy_detail::check_dtype<T>(h);
+                if (h.data_offset + h.nbytes() > m.size)
+                    TENSOR_THROW("Truncated .npz member '" + name + "'");
+                const size_t offset = static_cast<size_t>(m.data_offset) + h.data_offset;
+                const bool contiguous = !h.fortran_order || h.shape.size() < 2;
+                if (contiguous && (h.native_endian() || sizeof(T) == 1) &&
+                    reinterpret_cast<uintptr_t>(_file->data() + offset) % alignof(T) == 0)
+                    return MappedFile::view<T>(_file, h.shape, offset);
+                return npy_detail::materialize<T>(h, p + h.data_offset);
+            }
+            return load<T>(name);
+        }
+
+        // 拷贝 / 解压到独立的 Tensor<T>；压缩成员直接解压到张量存储
+        template <typename T>
+        Tensor<T> load(const std::string &name) const
+        {
+            const NpzMember &m = member(name);
+            const uint8_t *p = _file->data() + m.data_offset;
+            if (m.method == 0)
+            {
+                NpyHeader h = npy_detail::parse_header(p, static_cast<size_t>(m.size));
+                npy_detail::check_dtype<T>(h);
+                if (h.data_offset + h.nbytes() > m.size)
+                    TENSOR_THROW("Truncated .npz member '" + name + "'");
+                return npy_detail::materialize<T>(h, p + h.data_offset);
+            }
+
+            npy_detail::Inflater inf(p, static_cast<size_t>(m.compressed_size));
+            // 头部长度在前 10/12 字节中给出
+            uint8_t prefix[12];
+            inf.read(prefix, 10);
+            size_t prefix_len = 10;
+            size_t header_len = static_cast<size_t>(prefix[8]) | (static_cast<size_t>(prefix[9]) << 8);
+            if (prefix[6] >= 2)
+            {
+                inf.read(prefix + 10, 2);
+                prefix_len = 12;
+                header_len = npy_detail::rd32(prefix + 8);
+            }
+            std::vector<uint8_t> head(prefix_len + header_len);
+            std::memcpy(head.data(), prefix, prefix_len);
+            inf.read(head.data() + prefix_len, header_len);
+            NpyHeader h = npy_detail::parse_header(head.data(), head.size());
+            npy_detail::check_dtype<T>(h);
+
+            const bool direct = (!h.fortran_order || h.shape.size() < 2) && (h.native_endian() || sizeof(T) == 1);
+            if (direct)
+            {
+                Tensor<T> result(h.shape);
+                if (result.size() > 0)
+                    inf.read(result.data->data(), result.size() * sizeof(T));
+                return result;
+            }
+            std::vector<uint8_t> raw(h.nbytes());
+            inf.read(raw.data(), raw.size());
+            return npy_detail::materialize<T>(h, raw.data());
+        }
+
+        // 并行读取全部（或指定的）成员
+        template <typename T>
+        std::unordered_map<std::string, Tensor<T>> load_all(const std::vector<std::string> &names = {}) const
+        {
+            std::vector<std::string> selected = names.empty() ? this->names() : names;
+            std::vector<Tensor<T>> tensors(selected.size());
+            std::vector<std::exception_ptr> errors(selected.size());
+            const int64_t n = static_cast<int64_t>(selected.size());
+#pragma omp parallel for schedule(dynamic)
+            for (int64_t i = 0; i < n; ++i)
+            {
+                try
+                {
+                    tensors[i] = load<T>(selected[i]);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            }
+            for (const auto &e : errors)
+                if (e)
+                    std::rethrow_exception(e);
+
+            std::unordered_map<std::string, Tensor<T>> result;
+            result.reserve(selected.size());
+            for (size_t i = 0; i < selected.size(); ++i)
+                result[selected[i]] = std::move(tensors[i]);
+            return result;
+        }
+
+    private:
+        const NpzMember *find(const std::string &name) const
+        {
+            auto it = _index.find(name);
+            if (it == _index.end() && name.size() > 4 && name.compare(name.size() - 4, 4, ".npy") == 0)
+                it = _index.find(name.substr(0, name.size() - 4));
+            return it == _index.end() ? nullptr : &_members[it->second];
+        }
+    };
+
+} // namespace TensorN
+
+#endif // !__NPY__H__
@@ -0,0 +1,386 @@
+#pragma once
+#ifndef __COMPRESSION_HPP__
+#define __COMPRESSION_HPP__
+
+// ============================================================================
+// 块压缩：预过滤 + 编解码器
+//
+//   过滤器（压缩前重排字节，不改变大小）：
+//     Shuffle     字节重排：把所有元素的第 0 字节放在一起，然后第 1 字节……
+//                 fp16/bf16/fp32 的指数字节相邻出现，压缩率明显提高
+//     BitShuffle  位重排：在字节重排的基础上再按 8x8 位矩阵转置，
+//                 同一位平面连续存放，适合低熵 / 变化缓慢的数据
+//   编解码器：
+//     Zlib        始终可用
+//     Lz4 / Zstd  编译时找到 <lz4.h> / <zstd.h> 时可用（TENSORN_HAS_LZ4 / TENSORN_HAS_ZSTD），
+//                 否则写出时回退到 Zlib
+//
+// 每个块单独压缩，块之间没有依赖，调用方可以并行压缩 / 解压。
+// 块的标记字节：低 4 位为编解码器，高 4 位为过滤器。
+// ============================================================================
+
+#include "../tensor.hpp"
+#include <zlib.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef TENSORN_HAS_LZ4
+#if __has_include(<lz4.h>)
+#define TENSORN_HAS_LZ4 1
+#else
+#define TENSORN_HAS_LZ4 0
+#endif
+#endif
+
+#ifndef TENSORN_HAS_ZSTD
+#if __has_include(<zstd.h>)
+#define TENSORN_HAS_ZSTD 1
+#else
+#define TENSORN_HAS_ZSTD 0
+#endif
+#endif
+
+#if TENSORN_HAS_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+
+#if TENSORN_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace TensorN
+{
+    enum class ChunkCodec : uint8_t
+    {
+        None = 0,
+        Zlib = 1,
+        Lz4 = 2,
+        Zstd = 3,
+    };
+
+    enum class ChunkFilter : uint8_t
+    {
+        None = 0,
+        Shuffle = 1,
+        BitShuffle = 2,
+    };
+
+    inline bool codec_available(ChunkCodec codec)
+    {
+        switch (codec)
+        {
+        case ChunkCodec::None:
+        case ChunkCodec::Zlib:
+            return true;
+        case ChunkCodec::Lz4:
+            return TENSORN_HAS_LZ4;
+        case ChunkCodec::Zstd:
+            return TENSORN_HAS_ZSTD;
+        }
+        return false;
+    }
+
+    // 最快的可用编解码器：Zstd > Lz4 > Zlib
+    inline ChunkCodec fast_codec()
+    {
+        if (codec_available(ChunkCodec::Zstd))
+            return ChunkCodec::Zstd;
+        if (codec_available(ChunkCodec::Lz4))
+            return ChunkCodec::Lz4;
+        return ChunkCodec::Zlib;
+    }
+
+    inline const char *codec_name(ChunkCodec codec)
+    {
+        switch (codec)
+        {
+        case ChunkCodec::None:
+            return "none";
+        case ChunkCodec::Zlib:
+            return "zlib";
+        case ChunkCodec::Lz4:
+            return "lz4";
+        case ChunkCodec::Zstd:
+            return "zstd";
+        }
+        return "unknown";
+    }
+
+    struct CompressionOptions
+    {
+        ChunkCodec codec = ChunkCodec::None;
+        ChunkFilter filter = ChunkFilter::None;
+        int level = -1; // -1 表示编解码器默认级别；Lz4 的级别 > 1 时使用 LZ4HC
+
+        CompressionOptions() = default;
+        CompressionOptions(ChunkCodec c, ChunkFilter f = ChunkFilter::None, int l = -1)
+            : codec(c), filter(f), level(l) {}
+
+        // 不可用的编解码器回退到 Zlib
+        CompressionOptions resolved() const
+        {
+            CompressionOptions r = *this;
+            if (!codec_available(r.codec))
+                r.codec = ChunkCodec::Zlib;
+            if (r.codec == ChunkCodec::None)
+                r.filter = ChunkFilter::None;
+            return r;
+        }
+    };
+
+    namespace codec_detail
+    {
+        inline uint8_t make_tag(ChunkCodec codec, ChunkFilter filter)
+        {
+            return static_cast<uint8_t>(static_cast<uint8_t>(codec) | (static_cast<uint8_t>(filter) << 4));
+        }
+
+        inline ChunkCodec tag_codec(uint8_t tag) { return static_cast<ChunkCodec>(tag & 0x0F); }
+        inline ChunkFilter tag_filter(uint8_t tag) { return static_cast<ChunkFilter>(tag >> 4); }
+
+        // ---------------- 过滤器 ----------------
+
+        // 字节重排：n 字节中按 elem 字节一个元素，末尾不足一个元素的字节原样保留
+        inline void shuffle(const uint8_t *src, uint8_t *dst, size_t n, size_t elem)
+        {
+            const size_t count = n / elem;
+            for (size_t b = 0; b < elem; ++b)
+            {
+                uint8_t *out = dst + b * count;
+                const uint8_t *in = src + b;
+                for (size_t i = 0; i < count; ++i)
+                    out[i] = in[i * elem];
+            }
+            std::memcpy(dst + count * elem, src + count * elem, n - count * elem);
+        }
+
+        inline void unshuffle(const uint8_t *src, uint8_t *dst, size_t n, size_t elem)
+        {
+            const size_t count = n / elem;
+            for (size_t b = 0; b < elem; ++b)
+            {
+                const uint8_t *in = src + b * count;
+                uint8_t *out = dst + b;
+                for (size_t i = 0; i < count; ++i)
+                    out[i * elem] = in[i];
+            }
+            std::memcpy(dst + count * elem, src + count * elem, n - count * elem);
+        }
+
+        // 8x8 位矩阵转置（第 r 字节的第 c 位 <-> 第 c 字节的第 r 位），自身即逆变换
+        inline uint64_t transpose8x8(uint64_t x)
+        {
+            uint64_t t;
+            t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+            x = x ^ t ^ (t << 7);
+            t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+            x = x ^ t ^ (t << 14);
+            t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+            x = x ^ t ^ (t << 28);
+            return x;
+        }
+
+        // 位重排：先字节重排，再把每个字节平面按 8 个元素一组转置成 8 个位平面。
+        // 只处理 8 的整数倍个元素，其余元素的字节重排结果原样保留。
+        inline void bitshuffle(const uint8_t *src, uint8_t *dst, size_t n, size_t elem, std::vector<uint8_t> &tmp)
+        {
+            const size_t count = n / elem;
+            const size_t groups = count / 8;
+            tmp.resize(n);
+            shuffle(src, tmp.data(), n, elem);
+            std::memcpy(dst, tmp.data(), n);
+            for (size_t b = 0; b < elem; ++b)
+            {
+                const uint8_t *plane = tmp.data() + b * count;
+                uint8_t *out = dst + b * count;
+                for (size_t g = 0; g < groups; ++g)
+                {
+                    uint64_t x;
+                    std::memcpy(&x, plane + g * 8, 8);
+                    x = transpose8x8(x);
+                    for (size_t j = 0; j < 8; ++j)
+                        out[j * groups + g] = static_cast<uint8_t>(x >> (8 * j));
+                }
+            }
+        }
+
+        inline void bitunshuffle(const uint8_t *src, uint8_t *dst, size_t n, size_t elem, std::vector<uint8_t> &tmp)
+        {
+            const size_t count = n / elem;
+            const size_t groups = count / 8;
+            tmp.assign(src, src + n);
+            for (size_t b = 0; b < elem; ++b)
+            {
+                const uint8_t *in = src + b * count;
+                uint8_t *plane = tmp.data() + b * count;
+                for (size_t g = 0; g < groups; ++g)
+                {
+                    uint64_t x = 0;
+                    for (size_t j = 0; j < 8; ++j)
+                        x |= static_cast<uint64_t>(in[j * groups + g]) << (8 * j);
+                    x = transpose8x8(x);
+                    std::memcpy(plane + g * 8, &x, 8);
+                }
+            }
+            unshuffle(tmp.data(), dst, n, elem);
+        }
+
+        // ---------------- 编解码器 ----------------
+
+        // 压缩失败或没有变小时返回 false
+        inline bool compress(ChunkCodec codec, int level, const uint8_t *src, size_t n, std::vector<uint8_t> &out)
+        {
+            switch (codec)
+            {
+            case ChunkCodec::Zlib:
+            {
+                uLongf bound = compressBound(static_cast<uLong>(n));
+                out.resize(bound);
+                if (compress2(out.data(), &bound, src, static_cast<uLong>(n),
+                              level < 0 ? Z_DEFAULT_COMPRESSION : level) != Z_OK)
+                    return false;
+                out.resize(bound);
+                break;
+            }
+            case ChunkCodec::Lz4:
+            {
+#if TENSORN_HAS_LZ4
+                const int bound = LZ4_compressBound(static_cast<int>(n));
+                out.resize(static_cast<size_t>(bound));
+                const int r = level > 1 ? LZ4_compress_HC(reinterpret_cast<const char *>(src),
+                                                          reinterpret_cast<char *>(out.data()),
+                                                          static_cast<int>(n), bound, level)
+                                        : LZ4_compress_default(reinterpret_cast<const char *>(src),
+                                                               reinterpret_cast<char *>(out.data()),
+                                                               static_cast<int>(n), bound);
+                if (r <= 0)
+                    return false;
+                out.resize(static_cast<size_t>(r));
+                break;
+#else
+                return false;
+#endif
+            }
+            case ChunkCodec::Zstd:
+            {
+#if TENSORN_HAS_ZSTD
+                out.resize(ZSTD_compressBound(n));
+                const size_t r = ZSTD_compress(out.data(), out.size(), src, n, level < 0 ? 3 : level);
+                if (ZSTD_isError(r))
+                    return false;
+                out.resize(r);
+                break;
+#else
+                return false;
+#endif
+            }
+            default:
+                return false;
+            }
+            return out.size() < n;
+        }
+
+        inline void decompress(ChunkCodec codec, const uint8_t *src, size_t n, uint8_t *dst, size_t raw)
+        {
+            switch (codec)
+            {
+            case ChunkCodec::Zlib:
+            {
+                uLongf len = static_cast<uLongf>(raw);
+                if (uncompress(dst, &len, src, static_cast<uLong>(n)) != Z_OK || len != raw)
+                    TENSOR_THROW("Corrupt zlib chunk");
+                return;
+            }
+            case ChunkCodec::Lz4:
+            {
+#if TENSORN_HAS_LZ4
+                const int r = LZ4_decompress_safe(reinterpret_cast<const char *>(src), reinterpret_cast<char *>(dst),
+                                                  static_cast<int>(n), static_cast<int>(raw));
+                if (r < 0 || static_cast<size_t>(r) != raw)
+                    TENSOR_THROW("Corrupt lz4 chunk");
+                return;
+#else
+                TENSOR_THROW("Chunk is lz4-compressed but TensorN was built without lz4");
+#endif
+            }
+            case ChunkCodec::Zstd:
+            {
+#if TENSORN_HAS_ZSTD
+                const size_t r = ZSTD_decompress(dst, raw, src, n);
+                if (ZSTD_isError(r) || r != raw)
+                    TENSOR_THROW("Corrupt zstd chunk");
+                return;
+#else
+                TENSOR_THROW("Chunk is zstd-compressed but TensorN was built without zstd");
+#endif
+            }
+            default:
+                TENSOR_THROW("Unknown chunk codec " + std::to_string(static_cast<int>(codec)));
+            }
+        }
+
+        // 过滤 + 压缩一个块；压缩没有收益时 out 为空、返回标记 0（按原样存储）
+        inline uint8_t encode(const CompressionOptions &opts, const uint8_t *src, size_t n, size_t elem,
+                              std::vector<uint8_t> &out)
+        {
+            out.clear();
+            if (opts.codec == ChunkCodec::None || n == 0)
+                return 0;
+            // 单字节元素的字节重排是恒等变换
+            ChunkFilter filter = opts.filter;
+            if (filter == ChunkFilter::Shuffle && elem == 1)
+                filter = ChunkFilter::None;
+            const uint8_t *input = src;
+            std::vector<uint8_t> filtered, tmp;
+            if (filter != ChunkFilter::None)
+            {
+                filtered.resize(n);
+                if (filter == ChunkFilter::Shuffle)
+                    shuffle(src, filtered.data(), n, elem);
+                else
+                    bitshuffle(src, filtered.data(), n, elem, tmp);
+                input = filtered.data();
+            }
+
+            if (!compress(opts.codec, opts.level, input, n, out))
+            {
+                out.clear();
+                return 0;
+            }
+            return make_tag(opts.codec, filter);
+        }
+
+        // 解码一个块到 dst（raw 字节）
+        inline void decode(uint8_t tag, const uint8_t *src, size_t n, uint8_t *dst, size_t raw, size_t elem)
+        {
+            const ChunkCodec codec = tag_codec(tag);
+            const ChunkFilter filter = tag_filter(tag);
+            if (codec == ChunkCodec::None)
+            {
+                if (n != raw)
+                    TENSOR_THROW("Corrupt raw chunk");
+                std::memcpy(dst, src, raw);
+                return;
+            }
+            if (filter == ChunkFilter::None)
+            {
+                decompress(codec, src, n, dst, raw);
+                return;
+            }
+            std::vector<uint8_t> filtered(raw), tmp;
+            decompress(codec, src, n, filtered.data(), raw);
+            if (filter == ChunkFilter::Shuffle)
+                unshuffle(filtered.data(), dst, raw, elem);
+            else if (filter == ChunkFilter::BitShuffle)
+                bitunshuffle(filtered.data(), dst, raw, elem, tmp);
+            else
+                TENSOR_THROW("Unknown chunk filter " + std::to_string(static_cast<int>(filter)));
+        }
+    }
+
+} // namespace TensorN
+
+#endif // __COMPRESSION_HPP__
@@ -0,0 +1,767 @@
+#pragma once
+#ifndef __OUT_OF_CORE_HPP__
+#define __OUT_OF_CORE_HPP__
+
+// ============================================================================
+// 分块的外存张量（大于内存的数组）
+//
+// 文件格式 .tnc（小端）：
+//   0   magic "TENSORNC"          8 B
+//   8   version = 1               u32
+//   12  dtype                     u8   （与 .pt 的 PTDtype 相同）
+//   13  ndim                      u32
+//   17  shape                     u64[ndim]
+//       chunk_shape               u64[ndim]
+//       index_offset              u64  尾部索引的绝对偏移（写完后回填）
+//       n_chunks                  u64
+//   ... 填充到 64 字节；每个块的数据都从 64 字节边界开始
+//   尾部索引：按块网格的行主序，逐块 offset u64, stored_bytes u64, tag u8
+//             （tag 低 4 位为编解码器，高 4 位为过滤器，见 compression.hpp）
+//
+// 边缘块按实际大小存储（不填充）。未写入的块 stored_bytes = 0，读出为全零。
+// 每个块单独压缩（字节 / 位重排 + Zlib / Lz4 / Zstd），压缩后没有变小的块按原样存储。
+//
+// OutOfCoreTensor<T> 通过 mmap 读取，未压缩块直接返回零拷贝视图，压缩块
+// 解压后放入按字节数限制的 LRU 缓存；sum / matmul / map / zip 都逐块流式
+// 计算，内存占用与块大小、线程数相关，与张量总大小无关。
+// ============================================================================
+
+#include "../tensor.hpp"
+#include "../mapped_file.hpp"
+#include "../PT/pt.hpp"
+#include "../BLAS/blas_tensor.hpp"
+#include "compression.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace TensorN
+{
+    constexpr const char OOC_MAGIC[] = "TENSORNC";
+    constexpr uint32_t OOC_VERSION = 1;
+    constexpr size_t OOC_ALIGNMENT = 64;
+
+    struct ChunkEntry
+    {
+        uint64_t offset = 0;
+        uint64_t stored_bytes = 0; // 0 表示块未写入（全零）
+        ChunkCodec codec = ChunkCodec::None;
+        ChunkFilter filter = ChunkFilter::None;
+    };
+
+    namespace ooc_detail
+    {
+        // 块网格几何：块的起点 / 实际大小 / 线性编号
+        struct ChunkGrid
+        {
+            std::vector<size_t> shape;
+            std::vector<size_t> chunk_shape;
+            std::vector<size_t> grid; // 每维的块数
+
+            ChunkGrid() = default;
+            ChunkGrid(std::vector<size_t> s, std::vector<size_t> c) : shape(std::move(s)), chunk_shape(std::move(c))
+            {
+                if (shape.size() != chunk_shape.size())
+                    TENSOR_THROW("Chunk shape rank must match tensor rank");
+                grid.resize(shape.size());
+                for (size_t d = 0; d < shape.size(); ++d)
+                {
+                    if (chunk_shape[d] == 0)
+                        TENSOR_THROW("Chunk dimensions must be positive");
+                    grid[d] = (shape[d] + chunk_shape[d] - 1) / chunk_shape[d];
+                }
+            }
+
+            size_t num_chunks() const
+            {
+                size_t n = 1;
+                for (auto g : grid)
+                    n *= g;
+                return n;
+            }
+
+            std::vector<size_t> coords(size_t idx) const
+            {
+                std::vector<size_t> c(grid.size());
+                for (size_t d = grid.size(); d-- > 0;)
+                {
+                    c[d] = grid[d] ? idx % grid[d] : 0;
+                    idx = grid[d] ? idx / grid[d] : 0;
+                }
+                return c;
+            }
+
+            std::vector<size_t> origin(size_t idx) const
+            {
+                std::vector<size_t> o = coords(idx);
+                for (size_t d = 0; d < o.size(); ++d)
+                    o[d] *= chunk_shape[d];
+                return o;
+            }
+
+            std::vector<size_t> extent(size_t idx) const
+            {
+                std::vector<size_t> o = origin(idx);
+                std::vector<size_t> e(o.size());
+                for (size_t d = 0; d < o.size(); ++d)
+                    e[d] = std::min(chunk_shape[d], shape[d] - o[d]);
+                return e;
+            }
+
+            size_t chunk_numel(size_t idx) const
+            {
+                size_t n = 1;
+                for (auto e : extent(idx))
+                    n *= e;
+                return n;
+            }
+        };
+
+        // 在两个行主序数组之间拷贝一个 N 维子块：src 区域 [src_origin, +extent) -> dst 区域 [dst_origin, +extent)
+        template <typename T>
+        void copy_box(const T *src, const std::vector<size_t> &src_shape, const std::vector<size_t> &src_origin,
+                      T *dst, const std::vector<size_t> &dst_shape, const std::vector<size_t> &dst_origin,
+                      const std::vector<size_t> &extent)
+        {
+            const size_t nd = extent.size();
+            if (nd == 0)
+            {
+                *dst = *src;
+                return;
+            }
+            for (auto e : extent)
+                if (e == 0)
+                    return;
+            std::vector<size_t> src_stride(nd, 1), dst_stride(nd, 1);
+            for (size_t d = nd - 1; d-- > 0;)
+            {
+                src_stride[d] = src_stride[d + 1] * src_shape[d + 1];
+                dst_stride[d] = dst_stride[d + 1] * dst_shape[d + 1];
+            }
+            const size_t inner = extent[nd - 1];
+            std::vector<size_t> idx(nd, 0);
+            for (;;)
+            {
+                size_t so = 0, doff = 0;
+                for (size_t d = 0; d < nd; ++d)
+                {
+                    so += (src_origin[d] + idx[d]) * src_stride[d];
+                    doff += (dst_origin[d] + idx[d]) * dst_stride[d];
+                }
+                std::memcpy(dst + doff, src + so, inner * sizeof(T));
+                size_t d = nd - 1;
+                for (;;)
+                {
+                    if (d == 0)
+                        return;
+                    --d;
+                    if (++idx[d] < extent[d])
+                        break;
+                    idx[d] = 0;
+                }
+            }
+        }
+
+        template <typename T>
+        using acc_t = std::conditional_t<std::is_integral_v<T>,
+                                         std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>, double>;
+
+        // C[rows, N] += A[rows, K] @ B[K, N]（A 行距 lda，B 行距 N）
+        template <typename T>
+        void gemm_acc(const T *A, size_t rows, size_t K, size_t lda, const T *B, size_t N, T *C)
+        {
+#if TENSORN_HAS_OPENBLAS
+            if constexpr (std::is_same_v<T, float>)
+            {
+                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, static_cast<int>(rows), static_cast<int>(N),
+                            static_cast<int>(K), 1.0f, A, static_cast<int>(lda), B, static_cast<int>(N), 1.0f, C,
+                            static_cast<int>(N));
+                return;
+            }
+            else if constexpr (std::is_same_v<T, double>)
+            {
+                cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, static_cast<int>(rows), static_cast<int>(N),
+                            static_cast<int>(K), 1.0, A, static_cast<int>(lda), B, static_cast<int>(N), 1.0, C,
+                            static_cast<int>(N));
+                return;
+            }
+#endif
+            for (size_t i = 0; i < rows; ++i)
+            {
+                T *c = C + i * N;
+                for (size_t k = 0; k < K; ++k)
+                {
+                    const T a = A[i * lda + k];
+                    const T *b = B + k * N;
+                    for (size_t j = 0; j < N; ++j)
+                        c[j] = static_cast<T>(c[j] + a * b[j]);
+                }
+            }
+        }
+
+        template <typename T>
+        void put(std::ostream &os, T v)
+        {
+            os.write(reinterpret_cast<const char *>(&v), sizeof(T));
+        }
+    }
+
+    // ------------------------------------------------------------
+    // OutOfCoreWriter：按块写出 .tnc；write_chunk 线程安全
+    // ------------------------------------------------------------
+
+    template <typename T>
+    class OutOfCoreWriter
+    {
+    private:
+        std::ofstream _file;
+        std::string _filename;
+        ooc_detail::ChunkGrid _grid;
+        CompressionOptions _compression;
+        std::vector<ChunkEntry> _index;
+        uint64_t _index_field = 0; // 头部中 index_offset 字段的位置
+        std::mutex _mutex;
+        bool _finished = false;
+
+    public:
+        OutOfCoreWriter(const std::string &filename, const std::vector<size_t> &shape,
+                        const std::vector<size_t> &chunk_shape, CompressionOptions compression = {})
+            : _file(filename, std::ios::binary), _filename(filename), _grid(shape, chunk_shape),
+              _compression(compression.resolved())
+        {
+            if (!is_supported_pt_type<T>())
+                TENSOR_THROW("Type not supported for out-of-core storage");
+            if (!_file)
+                TENSOR_THROW("Cannot open file for writing: " + filename);
+            _index.resize(_grid.num_chunks());
+
+            using ooc_detail::put;
+            _file.write(OOC_MAGIC, 8);
+            put<uint32_t>(_file, OOC_VERSION);
+            put<uint8_t>(_file, static_cast<uint8_t>(get_pt_dtype<T>()));
+            put<uint32_t>(_file, static_cast<uint32_t>(shape.size()));
+            for (auto d : shape)
+                put<uint64_t>(_file, d);
+            for (auto d : chunk_shape)
+                put<uint64_t>(_file, d);
+            _index_field = static_cast<uint64_t>(_file.tellp());
+            put<uint64_t>(_file, 0);
+            put<uint64_t>(_file, _index.size());
+        }
+
+        OutOfCoreWriter(const OutOfCoreWriter &) = delete;
+        OutOfCoreWriter &operator=(const OutOfCoreWriter &) = delete;
+
+        ~OutOfCoreWriter()
+        {
+            if (!_finished)
+            {
+                try
+                {
+                    finish();
+                }
+                catch (...)
+                {
+                }
+            }
+        }
+
+        size_t num_chunks() const { return _index.size(); }
+        std::vector<size_t> chunk_origin(size_t idx) const { return _grid.origin(idx); }
+        std::vector<size_t> chunk_extent(size_t idx) const { return _grid.extent(idx); }
+
+        // chunk 的形状必须等于该块的实际大小（边缘块更小）
+        void write_chunk(size_t idx, const Tensor<T> &chunk)
+        {
+            if (idx >= _index.size())
+                TENSOR_THROW("Chunk index out of range");
+            if (chunk.shape() != _grid.extent(idx))
+                TENSOR_THROW("Chunk shape does not match the chunk extent");
+            write_chunk(idx, chunk.data->data());
+        }
+
+        void write_chunk(size_t idx, const T *values)
+        {
+            const size_t raw = _grid.chunk_numel(idx) * sizeof(T);
+            const auto *bytes = reinterpret_cast<const uint8_t *>(values);
+
+            // 过滤和压缩在锁外进行，多个线程可以并行写不同的块
+            std::vector<uint8_t> packed;
+            const uint8_t tag = codec_detail::encode(_compression, bytes, raw, sizeof(T), packed);
+            if (tag != 0)
+                bytes = packed.data();
+            const size_t stored = tag != 0 ? packed.size() : raw;
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_finished)
+                TENSOR_THROW("OutOfCoreWriter is already finished");
+            pad();
+            ChunkEntry &e = _index[idx];
+            e.offset = static_cast<uint64_t>(_file.tellp());
+            e.stored_bytes = stored;
+            e.codec = codec_detail::tag_codec(tag);
+            e.filter = codec_detail::tag_filter(tag);
+            _file.write(reinterpret_cast<const char *>(bytes), static_cast<std::streamsize>(stored));
+            if (!_file)
+                TENSOR_THROW("Error writing out-of-core file: " + _filename);
+        }
+
+        void finish()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_finished)
+                return;
+            _finished = true;
+            using ooc_detail::put;
+            const uint64_t index_offset = static_cast<uint64_t>(_file.tellp());
+            for (const auto &e : _index)
+            {
+                put<uint64_t>(_file, e.offset);
+                put<uint64_t>(_file, e.stored_bytes);
+                put<uint8_t>(_file, codec_detail::make_tag(e.codec, e.filter));
+            }
+            _file.seekp(static_cast<std::streamoff>(_index_field));
+            put<uint64_t>(_file, index_offset);
+            _file.close();
+            if (!_file)
+                TENSOR_THROW("Error writing out-of-core file: " + _filename);
+        }
+
+    private:
+        void pad()
+        {
+            static const char zeros[OOC_ALIGNMENT] = {};
+            const size_t pos = static_cast<size_t>(_file.tellp());
+            const size_t rem = (OOC_ALIGNMENT - pos % OOC_ALIGNMENT) % OOC_ALIGNMENT;
+            _file.write(zeros, static_cast<std::streamsize>(rem));
+        }
+    };
+
+    // ------------------------------------------------------------
+    // OutOfCoreTensor：mmap + LRU 块缓存
+    // ------------------------------------------------------------
+
+    template <typename T>
+    class OutOfCoreTensor
+    {
+    private:
+        struct CacheEntry
+        {
+            Tensor<T> chunk;
+            std::list<size_t>::iterator lru;
+        };
+
+        std::shared_ptr<MappedFile> _file;
+        ooc_detail::ChunkGrid _grid;
+        std::vector<ChunkEntry> _index;
+
+        // 缓存是可变状态：chunk() 在 const 接口下也要更新它
+        size_t _cache_capacity;
+        mutable size_t _cache_bytes = 0;
+        mutable std::list<size_t> _lru; // 最近使用的在前
+        mutable std::unordered_map<size_t, CacheEntry> _cache;
+        std::unique_ptr<std::mutex> _mutex = std::make_unique<std::mutex>();
+
+    public:
+        static constexpr size_t DEFAULT_CACHE_BYTES = size_t(256) << 20;
+
+        explicit OutOfCoreTensor(const std::string &filename, size_t cache_bytes = DEFAULT_CACHE_BYTES)
+            : _file(MappedFile::open(filename)), _cache_capacity(cache_bytes)
+        {
+            pt_detail::Cursor c(_file->data(), _file->size());
+            if (std::memcmp(c.take(8), OOC_MAGIC, 8) != 0)
+                TENSOR_THROW("Not a TensorN out-of-core file (bad magic): " + filename);
+            const uint32_t version = c.get<uint32_t>();
+            if (version != OOC_VERSION)
+                TENSOR_THROW("Unsupported out-of-core file version: " + std::to_string(version));
+            const auto dtype = static_cast<PTDtype>(c.get<uint8_t>());
+            if (!is_supported_pt_type<T>() || dtype != get_pt_dtype<T>())
+                TENSOR_THROW("Type mismatch in out-of-core file: " + filename);
+            const uint32_t ndim = c.get<uint32_t>();
+            std::vector<size_t> shape(ndim), chunk_shape(ndim);
+            for (auto &d : shape)
+                d = static_cast<size_t>(c.get<uint64_t>());
+            for (auto &d : chunk_shape)
+                d = static_cast<size_t>(c.get<uint64_t>());
+            _grid = ooc_detail::ChunkGrid(shape, chunk_shape);
+            const uint64_t index_offset = c.get<uint64_t>();
+            const uint64_t n_chunks = c.get<uint64_t>();
+            if (n_chunks != _grid.num_chunks())
+                TENSOR_THROW("Corrupt out-of-core index in " + filename);
+
+            pt_detail::Cursor ic(_file->data(), _file->size(), static_cast<size_t>(index_offset));
+            _index.resize(static_cast<size_t>(n_chunks));
+            for (size_t i = 0; i < _index.size(); ++i)
+            {
+                auto &e = _index[i];
+                e.offset = ic.get<uint64_t>();
+                e.stored_bytes = ic.get<uint64_t>();
+                const uint8_t tag = ic.get<uint8_t>();
+                e.codec = codec_detail::tag_codec(tag);
+                e.filter = codec_detail::tag_filter(tag);
+                if (e.offset > _file->size() || e.stored_bytes > _file->size() - e.offset)
+                    TENSOR_THROW("Truncated out-of-core file: " + filename);
+                if (e.codec == ChunkCodec::None && e.stored_bytes != 0 &&
+                    e.stored_bytes != _grid.chunk_numel(i) * sizeof(T))
+                    TENSOR_THROW("Corrupt out-of-core chunk entry in " + filename);
+            }
+        }
+
+        OutOfCoreTensor(OutOfCoreTensor &&) = default;
+        OutOfCoreTensor &operator=(OutOfCoreTensor &&) = default;
+
+        const std::vector<size_t> &shape() const { return _grid.shape; }
+        const std::vector<size_t> &chunk_shape() const { return _grid.chunk_shape; }
+        const std::vector<size_t> &grid() const { return _grid.grid; }
+        size_t num_chunks() const { return _index.size(); }
+        const ChunkEntry &chunk_entry(size_t idx) const { return _index.at(idx); }
+        std::vector<size_t> chunk_origin(size_t idx) const { return _grid.origin(idx); }
+        std::vector<size_t> chunk_extent(size_t idx) const { return _grid.extent(idx); }
+        const std::string &filename() const { return _file->filename(); }
+
+        size_t size() const
+        {
+            size_t n = 1;
+            for (auto d : _grid.shape)
+                n *= d;
+            return n;
+        }
+
+        size_t cache_bytes() const { return _cache_bytes; }
+        size_t cache_capacity() const { return _cache_capacity; }
+
+        void set_cache_capacity(size_t bytes)
+        {
+            std::lock_guard<std::mutex> lock(*_mutex);
+            _cache_capacity = bytes;
+            evict();
+        }
+
+        void clear_cache()
+        {
+            std::lock_guard<std::mutex> lock(*_mutex);
+            _cache.clear();
+            _lru.clear();
+            _cache_bytes = 0;
+        }
+
+        // 取一个块（形状为该块的实际大小）；返回的张量与缓存共享存储，应只读。线程安全。
+        Tensor<T> chunk(size_t idx) const
+        {
+            const ChunkEntry &e = _index.at(idx);
+            if (e.stored_bytes != 0 && e.codec == ChunkCodec::None)
+                return MappedFile::view<T>(_file, _grid.extent(idx), static_cast<size_t>(e.offset));
+
+            {
+                std::lock_guard<std::mutex> lock(*_mutex);
+                auto it = _cache.find(idx);
+                if (it != _cache.end())
+                {
+                    _lru.splice(_lru.begin(), _lru, it->second.lru);
+                    return it->second.chunk.view();
+                }
+            }
+
+            Tensor<T> t(_grid.extent(idx)); // 未写入的块为全零
+            decode_into(idx, t.data->data());
+
+            std::lock_guard<std::mutex> lock(*_mutex);
+            if (_cache.count(idx) == 0)
+            {
+                _lru.push_front(idx);
+                _cache.emplace(idx, CacheEntry{t.view(), _lru.begin()});
+                _cache_bytes += t.size() * sizeof(T);
+                evict();
+            }
+            return t;
+        }
+
+        // 读出任意矩形区域 [origin, origin + extent)
+        Tensor<T> read(const std::vector<size_t> &origin, const std::vector<size_t> &extent) const
+        {
+            const size_t nd = _grid.shape.size();
+            if (origin.size() != nd || extent.size() != nd)
+                TENSOR_THROW("Region rank must match tensor rank");
+            for (size_t d = 0; d < nd; ++d)
+                if (origin[d] + extent[d] > _grid.shape[d])
+                    TENSOR_THROW("Region exceeds tensor bounds");
+            Tensor<T> out(extent);
+            if (out.size() == 0)
+                return out;
+
+            // 区域覆盖的块坐标范围
+            std::vector<size_t> lo(nd), hi(nd), c(nd);
+            for (size_t d = 0; d < nd; ++d)
+            {
+                lo[d] = origin[d] / _grid.chunk_shape[d];
+                hi[d] = (origin[d] + extent[d] - 1) / _grid.chunk_shape[d];
+            }
+            c = lo;
+            for (;;)
+            {
+                size_t idx = 0;
+                for (size_t d = 0; d < nd; ++d)
+                    idx = idx * _grid.grid[d] + c[d];
+                const Tensor<T> ch = chunk(idx);
+                std::vector<size_t> cs(nd), ds(nd), ext(nd);
+                const std::vector<size_t> co = _grid.origin(idx);
+                for (size_t d = 0; d < nd; ++d)
+                {
+                    const size_t b = std::max(origin[d], co[d]);
+                    const size_t e = std::min(origin[d] + extent[d], co[d] + ch.shape()[d]);
+                    cs[d] = b - co[d];
+                    ds[d] = b - origin[d];
+                    ext[d] = e - b;
+                }
+                ooc_detail::copy_box(ch.data->data(), ch.shape(), cs, out.data->data(), extent, ds, ext);
+
+                size_t d = nd;
+                for (;;)
+                {
+                    if (d == 0)
+                        return out;
+                    --d;
+                    if (++c[d] <= hi[d])
+                        break;
+                    c[d] = lo[d];
+                }
+            }
+        }
+
+        // 全部读入内存（张量能放进内存时使用）；各块并行解码，不经过块缓存
+        Tensor<T> load() const
+        {
+            Tensor<T> out(_grid.shape);
+            const int64_t n = static_cast<int64_t>(_index.size());
+            const std::vector<size_t> zero(_grid.shape.size(), 0);
+#pragma omp parallel for schedule(dynamic)
+            for (int64_t i = 0; i < n; ++i)
+            {
+                const size_t idx = static_cast<size_t>(i);
+                const std::vector<size_t> ext = _grid.extent(idx);
+                const ChunkEntry &e = _index[idx];
+                Tensor<T> ch = e.stored_bytes != 0 && e.codec == ChunkCodec::None
+                                   ? MappedFile::view<T>(_file, ext, static_cast<size_t>(e.offset))
+                                   : Tensor<T>(ext);
+                if (e.codec != ChunkCodec::None)
+                    decode_into(idx, ch.data->data());
+                ooc_detail::copy_box(ch.data->data(), ext, zero, out.data->data(), _grid.shape, _grid.origin(idx),
+                                     ext);
+            }
+            return out;
+        }
+
+        // 逐块并行求和；整数用 64 位累加，浮点用 double 累加
+        T sum() const
+        {
+            using A = ooc_detail::acc_t<T>;
+            A total = 0;
+            const int64_t n = static_cast<int64_t>(_index.size());
+#pragma omp parallel for schedule(dynamic) reduction(+ : total)
+            for (int64_t i = 0; i < n; ++i)
+            {
+                const Tensor<T> ch = chunk(static_cast<size_t>(i));
+                const T *p = ch.data->data();
+                A s = 0;
+                for (size_t k = 0; k < ch.size(); ++k)
+                    s += static_cast<A>(p[k]);
+                total += s;
+            }
+            return static_cast<T>(total);
+        }
+
+        // y = this @ B：this 为 [M, K]（外存），B 为 [K, N]（内存），结果在内存中
+        Tensor<T> matmul(const Tensor<T> &B) const
+        {
+            check_matmul(B);
+            const size_t M = _grid.shape[0], N = B.shape()[1];
+            Tensor<T> C({M, N});
+            const int64_t rows = static_cast<int64_t>(_grid.grid[0]);
+            // 按块行并行：不同块行写 C 的不同行
+#pragma omp parallel for schedule(dynamic)
+            for (int64_t r = 0; r < rows; ++r)
+                matmul_chunk_row(static_cast<size_t>(r), B, C.data->data());
+            return C;
+        }
+
+        // 结果太大时逐块行写入新的外存文件（块形状为 [chunk_rows, N]）
+        OutOfCoreTensor<T> matmul(const Tensor<T> &B, const std::string &out_filename,
+                                  CompressionOptions compression = {}) const
+        {
+            check_matmul(B);
+            const size_t M = _grid.shape[0], N = B.shape()[1], cr = _grid.chunk_shape[0];
+            {
+                OutOfCoreWriter<T> writer(out_filename, {M, N}, {cr, N}, compression);
+                const int64_t rows = static_cast<int64_t>(_grid.grid[0]);
+#pragma omp parallel for schedule(dynamic)
+                for (int64_t r = 0; r < rows; ++r)
+                {
+                    const size_t r0 = static_cast<size_t>(r) * cr;
+                    Tensor<T> block({std::min(cr, M - r0), N});
+                    matmul_chunk_row(static_cast<size_t>(r), B, block.data->data(), r0);
+                    writer.write_chunk(static_cast<size_t>(r), block);
+                }
+                writer.finish();
+            }
+            return OutOfCoreTensor<T>(out_filename, _cache_capacity);
+        }
+
+        // 逐块应用 fn(x)，结果写入新的外存文件（同样的分块）
+        template <typename F>
+        OutOfCoreTensor<T> map(F fn, const std::string &out_filename, CompressionOptions compression = {}) const
+        {
+            {
+                OutOfCoreWriter<T> writer(out_filename, _grid.shape, _grid.chunk_shape, compression);
+                const int64_t n = static_cast<int64_t>(_index.size());
+#pragma omp parallel for schedule(dynamic)
+                for (int64_t i = 0; i < n; ++i)
+                {
+                    const Tensor<T> ch = chunk(static_cast<size_t>(i));
+                    Tensor<T> out(ch.shape());
+                    const T *src = ch.data->data();
+                    T *dst = out.data->data();
+                    for (size_t k = 0; k < ch.size(); ++k)
+                        dst[k] = static_cast<T>(fn(src[k]));
+                    writer.write_chunk(static_cast<size_t>(i), out);
+                }
+                writer.finish();
+            }
+            return OutOfCoreTensor<T>(out_filename, _cache_capacity);
+        }
+
+        // 逐块应用 fn(x, y)；other 的形状和分块必须相同
+        template <typename F>
+        OutOfCoreTensor<T> zip(const OutOfCoreTensor<T> &other, F fn, const std::string &out_filename,
+                               CompressionOptions compression = {}) const
+        {
+            if (other.shape() != shape() || other.chunk_shape() != chunk_shape())
+                TENSOR_THROW("zip requires identical shape and chunk shape");
+            {
+                OutOfCoreWriter<T> writer(out_filename, _grid.shape, _grid.chunk_shape, compression);
+                const int64_t n = static_cast<int64_t>(_index.size());
+#pragma omp parallel for schedule(dynamic)
+                for (int64_t i = 0; i < n; ++i)
+                {
+                    const Tensor<T> a = chunk(static_cast<size_t>(i));
+                    const Tensor<T> b = other.chunk(static_cast<size_t>(i));
+                    Tensor<T> out(a.shape());
+                    const T *pa = a.data->data();
+                    const T *pb = b.data->data();
+                    T *dst = out.data->data();
+                    for (size_t k = 0; k < a.size(); ++k)
+                        dst[k] = static_cast<T>(fn(pa[k], pb[k]));
+                    writer.write_chunk(static_cast<size_t>(i), out);
+                }
+                writer.finish();
+            }
+            return OutOfCoreTensor<T>(out_filename, _cache_capacity);
+        }
+
+    private:
+        // 解码一个压缩块到 dst（块的实际元素数）；未写入的块不做任何事
+        void decode_into(size_t idx, T *dst) const
+        {
+            const ChunkEntry &e = _index[idx];
+            if (e.stored_bytes == 0)
+                return;
+            codec_detail::decode(codec_detail::make_tag(e.codec, e.filter), _file->data() + e.offset,
+                                 static_cast<size_t>(e.stored_bytes), reinterpret_cast<uint8_t *>(dst),
+                                 _grid.chunk_numel(idx) * sizeof(T), sizeof(T));
+        }
+
+        // 超出容量时从尾部淘汰（调用方持有锁）；至少保留最近一个块
+        void evict() const
+        {
+            while (_cache_bytes > _cache_capacity && _lru.size() > 1)
+            {
+                const size_t victim = _lru.back();
+                _lru.pop_back();
+                auto it = _cache.find(victim);
+                _cache_bytes -= it->second.chunk.size() * sizeof(T);
+                _cache.erase(it);
+            }
+        }
+
+        void check_matmul(const Tensor<T> &B) const
+        {
+            if (_grid.shape.size() != 2 || B.shape().size() != 2)
+                TENSOR_THROW("Out-of-core matmul requires 2D tensors");
+            if (B.shape()[0] != _grid.shape[1])
+                TENSOR_THROW("Inner dimensions must match");
+        }
+
+        // 第 r 个块行：C[rows, N] += Σ_j chunk(r, j) @ B[k0:k1, :]；C 指向输出的 row_base 行
+        void matmul_chunk_row(size_t r, const Tensor<T> &B, T *C, size_t row_base = 0) const
+        {
+            const size_t N = B.shape()[1];
+            const size_t r0 = r * _grid.chunk_shape[0];
+            for (size_t j = 0; j < _grid.grid[1]; ++j)
+            {
+                const size_t idx = r * _grid.grid[1] + j;
+                const Tensor<T> ch = chunk(idx);
+                const size_t rows = ch.shape()[0], kc = ch.shape()[1];
+                const size_t k0 = j * _grid.chunk_shape[1];
+                ooc_detail::gemm_acc(ch.data->data(), rows, kc, kc, B.data->data() + k0 * N, N,
+                                     C + (r0 - row_base) * N);
+            }
+        }
+    };
+
+    // 把内存中的张量按块写成外存文件
+    template <typename T>
+    void save_chunked(const Tensor<T> &tensor, const std::string &filename, const std::vector<size_t> &chunk_shape,
+                      CompressionOptions compression = {})
+    {
+        OutOfCoreWriter<T> writer(filename, tensor.shape(), chunk_shape, compression);
+        ooc_detail::ChunkGrid grid(tensor.shape(), chunk_shape);
+        const int64_t n = static_cast<int64_t>(writer.num_chunks());
+        const std::vector<size_t> zero(chunk_shape.size(), 0);
+#pragma omp parallel for schedule(dynamic)
+        for (int64_t i = 0; i < n; ++i)
+        {
+            Tensor<T> ch(grid.extent(static_cast<size_t>(i)));
+            ooc_detail::copy_box(tensor.data->data(), tensor.shape(), grid.origin(static_cast<size_t>(i)),
+                                 ch.data->data(), ch.shape(), zero, ch.shape());
+            writer.write_chunk(static_cast<size_t>(i), ch);
+        }
+        writer.finish();
+    }
+
+    // 压缩保存单个张量：沿第 0 维切成约 1 MB 的块，各块并行过滤 + 压缩
+    template <typename T>
+    void save_compressed(const Tensor<T> &tensor, const std::string &filename,
+                         CompressionOptions compression = {fast_codec(), ChunkFilter::Shuffle})
+    {
+        constexpr size_t CHUNK_BYTES = size_t(1) << 20;
+        std::vector<size_t> chunk_shape = tensor.shape();
+        if (!chunk_shape.empty())
+        {
+            size_t row = sizeof(T);
+            for (size_t d = 1; d < chunk_shape.size(); ++d)
+            {
+                chunk_shape[d] = std::max<size_t>(1, chunk_shape[d]);
+                row *= chunk_shape[d];
+            }
+            chunk_shape[0] = std::max<size_t>(1, std::min(chunk_shape[0], CHUNK_BYTES / std::max<size_t>(1, row)));
+        }
+        save_chunked(tensor, filename, chunk_shape, compression);
+    }
+
+    template <typename T>
+    Tensor<T> load_compressed(const std::string &filename)
+    {
+        return OutOfCoreTensor<T>(filename, 0).load();
+    }
+
+} // namespace TensorN
+
+#endif // __OUT_OF_CORE_HPP__
@@ -0,0 +1,522 @@
+#pragma once
+#ifndef __PT__H__
+#define __PT__H__
+
+// ============================================================================
+// TensorN .pt 容器
+//
+//   v1：单张量，头部后紧跟数据
+//   v2：多张量，头部索引 + 紧密排列的数据（无对齐）
+//   v3：可 mmap 的对齐容器（当前写出格式）
+//
+// v3 布局（小端）：
+//   0   magic "TENSORPT!"    9 B
+//   9   version = 3          u32
+//   13  flags                u32   bit0 = 含 CRC32 校验
+//   17  alignment            u32   数据对齐（默认 64，2 的幂）
+//   21  tensor_count         u64
+//   29  index_offset         u64   尾部索引的绝对偏移
+//   37  index_size           u64
+//   ... 填充到 alignment
+//   数据区：每个张量的起始偏移都是 alignment 的整数倍
+//   尾部索引：逐张量 name_len u32, name, dtype u8, ndims u32, shape u64[ndims],
+//            offset u64（绝对偏移）, nbytes u64, crc32 u32
+//
+// 索引放在尾部，写出时可以边写数据边记录，不需要预先知道所有张量大小。
+// PtFile 通过 mmap 读取 v1/v2/v3，按名字随机访问；对齐时返回零拷贝视图。
+// ============================================================================
+
+#include "../tensor.hpp"
+#include "../mapped_file.hpp"
+#include <zlib.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+template <typename T>
+constexpr bool is_supported_pt_type()
+{
+    return std::is_same_v<T, float> ||
+           std::is_same_v<T, double> ||
+           std::is_same_v<T, int32_t> ||
+           std::is_same_v<T, int64_t> ||
+           std::is_same_v<T, uint8_t> ||
+           std::is_same_v<T, int16_t> ||
+           std::is_same_v<T, TensorN::half> ||
+           std::is_same_v<T, TensorN::bfloat16> ||
+           std::is_same_v<T, TensorN::tf32> ||
+           std::is_same_v<T, TensorN::fp8_e4m3> ||
+           std::is_same_v<T, TensorN::fp8_e5m2>;
+}
+
+enum class PTDtype : uint8_t {
+    FLOAT32 = 0,
+    FLOAT64 = 1,
+    INT32   = 2,
+    INT64   = 3,
+    UINT8   = 4,
+    INT16   = 5,
+    FLOAT16 = 6,
+    BFLOAT16 = 7,
+    TF32    = 8,
+    FP8_E4M3 = 9,
+    FP8_E5M2 = 10,
+};
+
+constexpr const char PT_MAGIC[] = "TENSORPT!";
+constexpr uint32_t PT_VERSION = 1;
+constexpr uint32_t PT_VERSION_MULTI = 2;
+constexpr uint32_t PT_VERSION_MAPPED = 3;
+constexpr uint32_t PT_FLAG_CHECKSUM = 1u << 0;
+constexpr uint32_t PT_DEFAULT_ALIGNMENT = 64;
+
+template <typename T>
+PTDtype get_pt_dtype()
+{
+    if constexpr (std::is_same_v<T, float>)       return PTDtype::FLOAT32;
+    if constexpr (std::is_same_v<T, double>)      return PTDtype::FLOAT64;
+    if constexpr (std::is_same_v<T, int32_t>)     return PTDtype::INT32;
+    if constexpr (std::is_same_v<T, int64_t>)     return PTDtype::INT64;
+    if constexpr (std::is_same_v<T, uint8_t>)     return PTDtype::UINT8;
+    if constexpr (std::is_same_v<T, int16_t>)     return PTDtype::INT16;
+    if constexpr (std::is_same_v<T, TensorN::half>)      return PTDtype::FLOAT16;
+    if constexpr (std::is_same_v<T, TensorN::bfloat16>)  return PTDtype::BFLOAT16;
+    if constexpr (std::is_same_v<T, TensorN::tf32>)      return PTDtype::TF32;
+    if constexpr (std::is_same_v<T, TensorN::fp8_e4m3>)  return PTDtype::FP8_E4M3;
+    if constexpr (std::is_same_v<T, TensorN::fp8_e5m2>)  return PTDtype::FP8_E5M2;
+    TENSOR_THROW("Unsupported type for .pt format");
+}
+
+inline size_t pt_dtype_size(PTDtype dtype)
+{
+    switch (dtype)
+    {
+    case PTDtype::FLOAT32:  return 4;
+    case PTDtype::FLOAT64:  return 8;
+    case PTDtype::INT32:    return 4;
+    case PTDtype::INT64:    return 8;
+    case PTDtype::UINT8:    return 1;
+    case PTDtype::INT16:    return 2;
+    case PTDtype::FLOAT16:  return 2;
+    case PTDtype::BFLOAT16: return 2;
+    case PTDtype::TF32:     return sizeof(TensorN::tf32);
+    case PTDtype::FP8_E4M3: return 1;
+    case PTDtype::FP8_E5M2: return 1;
+    }
+    TENSOR_THROW("Unknown .pt dtype: " + std::to_string(static_cast<int>(dtype)));
+}
+
+namespace TensorN
+{
+    namespace pt_detail
+    {
+        template <typename T>
+        void put(std::ostream &os, T v)
+        {
+            os.write(reinterpret_cast<const char *>(&v), sizeof(T));
+        }
+
+        // zlib 的 crc32 长度参数是 uInt，大张量分段累加
+        inline uint32_t crc32_bytes(const uint8_t *p, size_t n, uint32_t crc = 0)
+        {
+            uLong c = crc;
+            while (n > 0)
+            {
+                const uInt len = static_cast<uInt>(std::min<size_t>(n, 1u << 30));
+                c = ::crc32(c, p, len);
+                p += len;
+                n -= len;
+            }
+            return static_cast<uint32_t>(c);
+        }
+
+        // 越界检查的顺序读取器，用于解析映射区中的头部和索引
+        class Cursor
+        {
+        private:
+            const uint8_t *_base;
+            size_t _size;
+            size_t _pos;
+
+        public:
+            Cursor(const uint8_t *base, size_t size, size_t pos = 0) : _base(base), _size(size), _pos(pos) {}
+
+            size_t pos() const { return _pos; }
+
+            const uint8_t *take(size_t n)
+            {
+                if (n > _size - std::min(_pos, _size))
+                    TENSOR_THROW("Truncated .pt file");
+                const uint8_t *p = _base + _pos;
+                _pos += n;
+                return p;
+            }
+
+            template <typename T>
+            T get()
+            {
+                T v;
+                std::memcpy(&v, take(sizeof(T)), sizeof(T));
+                return v;
+            }
+
+            std::string str(size_t n)
+            {
+                const uint8_t *p = take(n);
+                return std::string(reinterpret_cast<const char *>(p), n);
+            }
+        };
+    }
+
+    struct PTTensorInfo
+    {
+        std::string name;
+        PTDtype dtype = PTDtype::FLOAT32;
+        std::vector<size_t> shape;
+        uint64_t offset = 0; // 数据在文件中的绝对偏移
+        uint64_t nbytes = 0;
+        uint32_t crc32 = 0;
+
+        size_t numel() const
+        {
+            size_t n = 1;
+            for (auto d : shape)
+                n *= d;
+            return n;
+        }
+    };
+
+    // ------------------------------------------------------------
+    // PtFile：mmap 读取 v1 / v2 / v3，按名字随机访问
+    // ------------------------------------------------------------
+
+    class PtFile
+    {
+    private:
+        std::shared_ptr<MappedFile> _file;
+        uint32_t _version = 0;
+        uint32_t _flags = 0;
+        uint32_t _alignment = 1;
+        std::vector<PTTensorInfo> _infos;
+        std::unordered_map<std::string, size_t> _index;
+
+    public:
+        explicit PtFile(const std::string &filename) : _file(MappedFile::open(filename))
+        {
+            pt_detail::Cursor c(_file->data(), _file->size());
+            if (std::memcmp(c.take(9), PT_MAGIC, 9) != 0)
+                TENSOR_THROW("Not a valid TensorN .pt file (bad magic)");
+            _version = c.get<uint32_t>();
+
+            if (_version == PT_VERSION)
+                parse_v1(c);
+            else if (_version == PT_VERSION_MULTI)
+                parse_v2(c);
+            else if (_version == PT_VERSION_MAPPED)
+                parse_v3(c);
+            else
+                TENSOR_THROW("Unsupported .pt version: " + std::to_string(_version));
+
+            for (size_t i = 0; i < _infos.size(); ++i)
+            {
+                const auto &info = _infos[i];
+                if (info.nbytes != info.numel() * pt_dtype_size(info.dtype))
+                    TENSOR_THROW("Corrupt .pt index entry for tensor '" + info.name + "'");
+                if (info.offset > _file->size() || info.nbytes > _file->size() - info.offset)
+                    TENSOR_THROW("Truncated .pt file: " + filename);
+                _index[info.name] = i;
+            }
+        }
+
+        uint32_t version() const { return _version; }
+        uint32_t alignment() const { return _alignment; }
+        bool has_checksums() const { return (_flags & PT_FLAG_CHECKSUM) != 0; }
+        size_t size() const { return _infos.size(); }
+        const std::vector<PTTensorInfo> &tensor_infos() const { return _infos; }
+        const std::shared_ptr<MappedFile> &mapping() const { return _file; }
+        bool contains(const std::string &name) const { return _index.count(name) != 0; }
+
+        std::vector<std::string> names() const
+        {
+            std::vector<std::string> result;
+            result.reserve(_infos.size());
+            for (const auto &info : _infos)
+                result.push_back(info.name);
+            return result;
+        }
+
+        const PTTensorInfo &info(const std::string &name) const
+        {
+            auto it = _index.find(name);
+            if (it == _index.end())
+                TENSOR_THROW("Tensor '" + name + "' not found in .pt file");
+            return _infos[it->second];
+        }
+
+        // 零拷贝视图；v1/v2 文件的数据可能未对齐，此时退化为 load()
+        template <typename T>
+        Tensor<T> tensor(const std::string &name) const
+        {
+            const auto &i = checked<T>(name);
+            if (reinterpret_cast<uintptr_t>(_file->data() + i.offset) % alignof(T) == 0)
+                return MappedFile::view<T>(_file, i.shape, static_cast<size_t>(i.offset));
+            return load<T>(name);
+        }
+
+        // 拷贝到独立的 Tensor<T>
+        template <typename T>
+        Tensor<T> load(const std::string &name) const
+        {
+            const auto &i = checked<T>(name);
+            Tensor<T> result(i.shape);
+            if (i.nbytes > 0)
+                std::memcpy(result.data->data(), _file->data() + i.offset, static_cast<size_t>(i.nbytes));
+            return result;
+        }
+
+        // 重新计算 CRC32；文件未写校验时返回 true
+        bool verify(const std::string &name) const
+        {
+            if (!has_checksums())
+                return true;
+            const auto &i = info(name);
+            return pt_detail::crc32_bytes(_file->data() + i.offset, static_cast<size_t>(i.nbytes)) == i.crc32;
+        }
+
+        // 并行校验全部张量，失败时抛出第一个不匹配的名字
+        void verify_all() const
+        {
+            if (!has_checksums())
+                return;
+            std::vector<char> ok(_infos.size(), 1);
+            const int64_t n = static_cast<int64_t>(_infos.size());
+#pragma omp parallel for schedule(dynamic)
+            for (int64_t k = 0; k < n; ++k)
+                ok[k] = verify(_infos[k].name) ? 1 : 0;
+            for (size_t k = 0; k < _infos.size(); ++k)
+                if (!ok[k])
+                    TENSOR_THROW("Checksum mismatch for tensor '" + _infos[k].name + "' in .pt file");
+        }
+
+    private:
+        template <typename T>
+        const PTTensorInfo &checked(const std::string &name) const
+        {
+            if (!is_supported_pt_type<T>())
+                TENSOR_THROW("Type not supported for .pt format");
+            const auto &i = info(name);
+            if (i.dtype != get_pt_dtype<T>())
+                TENSOR_THROW("Type mismatch for tensor '" + name + "' in .pt file");
+            return i;
+        }
+
+        static void read_shape(pt_detail::Cursor &c, PTTensorInfo &info)
+        {
+            const uint32_t ndims = c.get<uint32_t>();
+            info.shape.resize(ndims);
+            for (uint32_t d = 0; d < ndims; ++d)
+                info.shape[d] = static_cast<size_t>(c.get<uint64_t>());
+        }
+
+        void parse_v1(pt_detail::Cursor &c)
+        {
+            PTTensorInfo info;
+            info.name = "tensor";
+            info.dtype = static_cast<PTDtype>(c.get<uint8_t>());
+            read_shape(c, info);
+            info.offset = c.pos();
+            info.nbytes = info.numel() * pt_dtype_size(info.dtype);
+            _infos.push_back(std::move(info));
+        }
+
+        void parse_v2(pt_detail::Cursor &c)
+        {
+            const uint64_t count = c.get<uint64_t>();
+            _infos.reserve(static_cast<size_t>(std::min<uint64_t>(count, _file->size())));
+            for (uint64_t k = 0; k < count; ++k)
+            {
+                PTTensorInfo info;
+                info.name = c.str(c.get<uint32_t>());
+                info.dtype = static_cast<PTDtype>(c.get<uint8_t>());
+                read_shape(c, info);
+                info.offset = c.get<uint64_t>(); // 相对数据区，下面统一加上基址
+                info.nbytes = c.get<uint64_t>();
+                _infos.push_back(std::move(info));
+            }
+            for (auto &info : _infos)
+                info.offset += c.pos();
+        }
+
+        void parse_v3(pt_detail::Cursor &c)
+        {
+            _flags = c.get<uint32_t>();
+            _alignment = c.get<uint32_t>();
+            const uint64_t count = c.get<uint64_t>();
+            const uint64_t index_offset = c.get<uint64_t>();
+            const uint64_t index_size = c.get<uint64_t>();
+            if (_alignment == 0 || (_alignment & (_alignment - 1)) != 0)
+                TENSOR_THROW("Invalid .pt alignment: " + std::to_string(_alignment));
+            if (index_offset > _file->size() || index_size > _file->size() - index_offset)
+                TENSOR_THROW("Truncated .pt index in " + _file->filename());
+
+            pt_detail::Cursor ic(_file->data() + index_offset, static_cast<size_t>(index_size));
+            _infos.reserve(static_cast<size_t>(std::min<uint64_t>(count, index_size)));
+            for (uint64_t k = 0; k < count; ++k)
+            {
+                PTTensorInfo info;
+                info.name = ic.str(ic.get<uint32_t>());
+                info.dtype = static_cast<PTDtype>(ic.get<uint8_t>());
+                read_shape(ic, info);
+                info.offset = ic.get<uint64_t>();
+                info.nbytes = ic.get<uint64_t>();
+                info.crc32 = ic.get<uint32_t>();
+                _infos.push_back(std::move(info));
+            }
+        }
+    };
+
+    // ------------------------------------------------------------
+    // PtWriter：流式写出 v3，每个张量可以是不同 dtype
+    // ------------------------------------------------------------
+
+    class PtWriter
+    {
+    private:
+        std::ofstream _file;
+        std::string _filename;
+        uint32_t _alignment;
+        uint32_t _flags;
+        std::vector<PTTensorInfo> _infos;
+        std::unordered_map<std::string, size_t> _names;
+        bool _finished = false;
+
+    public:
+        explicit PtWriter(const std::string &filename, bool checksum = true,
+                          uint32_t alignment = PT_DEFAULT_ALIGNMENT)
+            : _file(filename, std::ios::binary), _filename(filename), _alignment(alignment),
+              _flags(checksum ? PT_FLAG_CHECKSUM : 0)
+        {
+            if (!_file)
+                TENSOR_THROW("Cannot open file for writing: " + filename);
+            if (_alignment < 8 || (_alignment & (_alignment - 1)) != 0)
+                TENSOR_THROW("PtWriter alignment must be a power of two >= 8");
+            write_header(0, 0);
+        }
+
+        PtWriter(const PtWriter &) = delete;
+        PtWriter &operator=(const PtWriter &) = delete;
+
+        ~PtWriter()
+        {
+            if (!_finished)
+            {
+                try
+                {
+                    finish();
+                }
+                catch (...)
+                {
+                }
+            }
+        }
+
+        template <typename T>
+        void add(const std::string &name, const Tensor<T> &tensor)
+        {
+            if (!is_supported_pt_type<T>())
+                TENSOR_THROW("Type not supported for .pt format");
+            add_raw(name, get_pt_dtype<T>(), tensor.shape(), tensor.data->data(), tensor.size() * sizeof(T));
+        }
+
+        // 写入已打包好的数据（nbytes 必须等于 numel * dtype 大小）
+        void add_raw(const std::string &name, PTDtype dtype, const std::vector<size_t> &shape,
+                     const void *data, size_t nbytes)
+        {
+            if (_finished)
+                TENSOR_THROW("PtWriter is already finished");
+            if (!_names.emplace(name, _infos.size()).second)
+                TENSOR_THROW("Duplicate tensor name in .pt file: " + name);
+
+            PTTensorInfo info;
+            info.name = name;
+            info.dtype = dtype;
+            info.shape = shape;
+            if (nbytes != info.numel() * pt_dtype_size(dtype))
+                TENSOR_THROW("Tensor '" + name + "' byte size does not match its shape and dtype");
+
+            pad();
+            info.offset = static_cast<uint64_t>(_file.tellp());
+            info.nbytes = nbytes;
+            const auto *bytes = static_cast<const uint8_t *>(data);
+            if (_flags & PT_FLAG_CHECKSUM)
+                info.crc32 = pt_detail::crc32_bytes(bytes, nbytes);
+            _file.write(reinterpret_cast<const char *>(bytes), static_cast<std::streamsize>(nbytes));
+            if (!_file)
+                TENSOR_THROW("Error writing .pt file: " + _filename);
+            _infos.push_back(std::move(info));
+        }
+
+        // 写出尾部索引并回填头部
+        void finish()
+        {
+            if (_finished)
+                return;
+            _finished = true;
+
+            const uint64_t index_offset = static_cast<uint64_t>(_file.tellp());
+            for (const auto &info : _infos)
+            {
+                pt_detail::put<uint32_t>(_file, static_cast<uint32_t>(info.name.size()));
+                _file.write(info.name.data(), static_cast<std::streamsize>(info.name.size()));
+                pt_detail::put<uint8_t>(_file, static_cast<uint8_t>(info.dtype));
+                pt_detail::put<uint32_t>(_file, static_cast<uint32_t>(info.shape.size()));
+                for (auto d : info.shape)
+                    pt_detail::put<uint64_t>(_file, static_cast<uint64_t>(d));
+                pt_detail::put<uint64_t>(_file, info.offset);
+                pt_detail::put<uint64_t>(_file, info.nbytes);
+                pt_detail::put<uint32_t>(_file, info.crc32);
+            }
+            const uint64_t index_size = static_cast<uint64_t>(_file.tellp()) - index_offset;
+
+            _file.seekp(0);
+            write_header(index_offset, index_size);
+            _file.close();
+            if (!_file)
+                TENSOR_THROW("Error writing .pt file: " + _filename);
+        }
+
+    private:
+        void write_header(uint64_t index_offset, uint64_t index_size)
+        {
+            _file.write(PT_MAGIC, 9);
+            pt_detail::put<uint32_t>(_file, PT_VERSION_MAPPED);
+            pt_detail::put<uint32_t>(_file, _flags);
+            pt_detail::put<uint32_t>(_file, _alignment);
+            pt_detail::put<uint64_t>(_file, static_cast<uint64_t>(_infos.size()));
+            pt_detail::put<uint64_t>(_file, index_offset);
+            pt_detail::put<uint64_t>(_file, index_size);
+        }
+
+        void pad()
+        {
+            static const char zeros[256] = {};
+            size_t pos = static_cast<size_t>(_file.tellp());
+            size_t rem = (_alignment - pos % _alignment) % _alignment;
+            while (rem > 0)
+            {
+                const size_t n = std::min(rem, sizeof(zeros));
+                _file.write(zeros, static_cast<std::streamsize>(n));
+                rem -= n;
+            }
+        }
+    };
+
+} // namespace TensorN
+
+#endif // __PT__H__
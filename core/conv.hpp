@@ -0,0 +1,744 @@
+#pragma once
+#ifndef __CONV_HPP__
+#define __CONV_HPP__
+
+// ============================================================================
+// 原生卷积、转置卷积与池化内核（BLAS 后端复用这里的几何计算与深度卷积内核）
+//
+//   * conv1d / conv2d / conv3d：输入 [N, C, L] / [N, C, H, W] / [N, C, D, H, W]，
+//     权重 [K, C / groups, k...]。ConvParams 按维给出步长、膨胀、两侧填充和分组数，
+//     输出尺寸为 (in + pad_begin + pad_end - dilation * (k - 1) - 1) / stride + 1。
+//     内部统一按 3 个空间维 (D, H, W) 处理，低维卷积在前面补 1。
+//   * 通用内核按 (n, k) 输出平面并行，逐卷积核位置把一个权重乘到整行上，
+//     有效输出区间预先算出，内层循环没有边界判断。
+//   * 深度卷积（每组一个输入通道，即 groups == C，可带通道倍增）不展开 im2col：
+//     按 (n, k) 平面并行，输入平面先拷进补零缓冲，内层是无边界判断的 omp simd；
+//     步长为 1 时每个卷积核位置对整个平面只做一次长循环。
+//   * 4D 输入带 NHWC 标记时 conv2d 使用通道在最内层的内核，沿输出通道向量化；
+//     深度卷积沿通道向量化。
+// ============================================================================
+
+#include "tensor.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace TensorN
+{
+    // 卷积参数。各数组的前 nd 项按空间维顺序给出：conv1d 为 {L}，conv2d 为 {H, W}，
+    // conv3d 为 {D, H, W}；pad_begin / pad_end 分别是每一维起始侧与末尾侧的填充
+    struct ConvParams
+    {
+        std::array<int, 3> stride{{1, 1, 1}};
+        std::array<int, 3> dilation{{1, 1, 1}};
+        std::array<int, 3> pad_begin{{0, 0, 0}};
+        std::array<int, 3> pad_end{{0, 0, 0}};
+        int groups = 1;
+
+        static ConvParams uniform(int stride, int padding, int dilation = 1, int groups = 1)
+        {
+            ConvParams p;
+            p.stride = {{stride, stride, stride}};
+            p.dilation = {{dilation, dilation, dilation}};
+            p.pad_begin = {{padding, padding, padding}};
+            p.pad_end = p.pad_begin;
+            p.groups = groups;
+            return p;
+        }
+    };
+
+    // ================================================================
+    // Convolution (Native)
+    // ================================================================
+
+    namespace detail
+    {
+        // 输出下标 o 满足 0 <= o * stride + k - padding < extent 的区间 [lo, hi)
+        inline void valid_range(size_t out, size_t extent, size_t k, int stride, int padding,
+                                size_t &lo, size_t &hi)
+        {
+            const int64_t s = stride, off = static_cast<int64_t>(k) - padding;
+            const int64_t first = off >= 0 ? 0 : (-off + s - 1) / s;
+            const int64_t rem = static_cast<int64_t>(extent) - 1 - off;
+            const int64_t last = rem < 0 ? 0 : rem / s + 1; // 除法向零取整，off >= extent 时单独处理
+            lo = static_cast<size_t>(std::min<int64_t>(first, static_cast<int64_t>(out)));
+            hi = static_cast<size_t>(std::max<int64_t>(static_cast<int64_t>(lo),
+                                                       std::min<int64_t>(last, static_cast<int64_t>(out))));
+        }
+
+        // [N, A, B] -> [N, B, A]，按 32x32 块转置
+        template <typename T>
+        void transpose_planes(const T* __restrict src, T* __restrict dst, size_t N, size_t A, size_t B)
+        {
+            constexpr size_t TILE = 32;
+            const size_t ta = (A + TILE - 1) / TILE, tb = (B + TILE - 1) / TILE;
+            #pragma omp parallel for schedule(static)
+            for (int64_t t = 0; t < static_cast<int64_t>(N * ta * tb); ++t) {
+                const size_t n = static_cast<size_t>(t) / (ta * tb);
+                const size_t a0 = static_cast<size_t>(t) / tb % ta * TILE, b0 = static_cast<size_t>(t) % tb * TILE;
+                const size_t a1 = std::min(A, a0 + TILE), b1 = std::min(B, b0 + TILE);
+                const T* sp = src + n * A * B;
+                T* dp = dst + n * A * B;
+                for (size_t a = a0; a < a1; ++a)
+                    for (size_t b = b0; b < b1; ++b)
+                        dp[b * A + a] = sp[a * B + b];
+            }
+        }
+
+        // 权重 [K, C, kH, kW] -> [kH, kW, C, K]：NHWC 内核按输出通道连续访问
+        template <typename T>
+        std::vector<T> pack_hwck(const Tensor<T>& weight)
+        {
+            const size_t K = weight.shape()[0], C = weight.shape()[1];
+            const size_t kk = weight.shape()[2] * weight.shape()[3];
+            const T* w = weight.data->data();
+            std::vector<T> packed(K * C * kk);
+            for (size_t k = 0; k < K; ++k)
+                for (size_t c = 0; c < C; ++c)
+                    for (size_t r = 0; r < kk; ++r)
+                        packed[(r * C + c) * K + k] = w[(k * C + c) * kk + r];
+            return packed;
+        }
+
+        // o[0:K] += a * w[0:K]
+        template <typename T>
+        inline void axpy_channels(T* __restrict o, const T* __restrict w, T a, size_t K)
+        {
+            #pragma omp simd
+            for (size_t k = 0; k < K; ++k)
+                o[k] += a * w[k];
+        }
+
+        // o[0:K] += x[0:K] * w[0:K]
+        template <typename T>
+        inline void mul_add_channels(T* __restrict o, const T* __restrict x, const T* __restrict w, size_t K)
+        {
+            #pragma omp simd
+            for (size_t k = 0; k < K; ++k)
+                o[k] += x[k] * w[k];
+        }
+
+        // 卷积几何，空间维统一为 (D, H, W)
+        struct ConvGeom
+        {
+            size_t N, C, K, groups;
+            std::array<size_t, 3> in, ker, out;
+            std::array<int, 3> stride, dilation, pad; // pad 为起始侧填充
+
+            size_t Cg() const { return C / groups; }
+            size_t Kg() const { return K / groups; }
+            bool depthwise() const { return C == groups; }
+        };
+
+        // 校验参数并计算输出尺寸；4D 输入按其布局标记解释
+        template <typename T>
+        ConvGeom make_conv_geom(const Tensor<T>& input, const Tensor<T>& weight, const Tensor<T>& bias,
+                                const ConvParams& p, size_t nd, const char* name)
+        {
+            const std::string fn(name);
+            if (input.shape().size() != nd + 2 || weight.shape().size() != nd + 2)
+                TENSOR_THROW(fn + ": input and weight must be " + std::to_string(nd + 2) + "D");
+            if (bias.shape().size() != 1)
+                TENSOR_THROW(fn + ": bias must be 1D");
+            if (p.groups <= 0)
+                TENSOR_THROW(fn + ": groups must be positive");
+
+            const bool nhwc = nd == 2 && input.layout() == Layout::NHWC;
+            const auto& sh = input.shape();
+            ConvGeom g;
+            g.N = sh[0];
+            g.C = nhwc ? sh[3] : sh[1];
+            g.K = weight.shape()[0];
+            g.groups = static_cast<size_t>(p.groups);
+            if (g.C % g.groups != 0 || g.K % g.groups != 0)
+                TENSOR_THROW(fn + ": channels must be divisible by groups");
+            if (weight.shape()[1] * g.groups != g.C)
+                TENSOR_THROW(fn + ": weight input channels must match input");
+            if (bias.shape()[0] != g.K)
+                TENSOR_THROW(fn + ": bias size must match output channels");
+
+            g.in = g.ker = g.out = {{1, 1, 1}};
+            g.stride = g.dilation = {{1, 1, 1}};
+            g.pad = {{0, 0, 0}};
+            for (size_t i = 0; i < nd; ++i) {
+                const size_t d = 3 - nd + i;
+                if (p.stride[i] <= 0 || p.dilation[i] <= 0 || p.pad_begin[i] < 0 || p.pad_end[i] < 0)
+                    TENSOR_THROW(fn + ": stride and dilation must be positive and padding non-negative");
+                g.in[d] = nhwc ? sh[1 + i] : sh[2 + i];
+                g.ker[d] = weight.shape()[2 + i];
+                g.stride[d] = p.stride[i];
+                g.dilation[d] = p.dilation[i];
+                g.pad[d] = p.pad_begin[i];
+                const size_t padded = g.in[d] + p.pad_begin[i] + p.pad_end[i];
+                const size_t span = static_cast<size_t>(p.dilation[i]) * (g.ker[d] - 1) + 1;
+                if (g.ker[d] == 0 || padded < span)
+                    TENSOR_THROW(fn + ": invalid output dimensions");
+                g.out[d] = (padded - span) / p.stride[i] + 1;
+            }
+            return g;
+        }
+
+        // 通用直接卷积（NCL / NCHW / NCDHW）：每个 (n, k) 输出平面独立；
+        // 逐 (c, kd, kh, kw) 把一个权重乘到整行上
+        template <typename T>
+        void conv_direct(const T* __restrict in, const T* __restrict wt, const T* __restrict b,
+                         const ConvGeom& g, T* __restrict out)
+        {
+            const size_t Cg = g.Cg(), Kg = g.Kg();
+            const size_t iD = g.in[0], iH = g.in[1], iW = g.in[2];
+            const size_t kD = g.ker[0], kH = g.ker[1], kW = g.ker[2];
+            const size_t oD = g.out[0], oH = g.out[1], oW = g.out[2];
+            const int sd = g.stride[0], sh = g.stride[1], sw = g.stride[2];
+            const size_t in_plane = iD * iH * iW, out_plane = oD * oH * oW, kvol = kD * kH * kW;
+
+            #pragma omp parallel for schedule(static)
+            for (int64_t nk = 0; nk < static_cast<int64_t>(g.N * g.K); ++nk) {
+                const size_t n = static_cast<size_t>(nk) / g.K, k = static_cast<size_t>(nk) % g.K;
+                T* o = out + static_cast<size_t>(nk) * out_plane;
+                std::fill(o, o + out_plane, b[k]);
+                for (size_t cg = 0; cg < Cg; ++cg) {
+                    const T* ip = in + (n * g.C + k / Kg * Cg + cg) * in_plane;
+                    const T* wp = wt + (k * Cg + cg) * kvol;
+                    for (size_t kd = 0; kd < kD; ++kd) {
+                        size_t od0, od1;
+                        valid_range(oD, iD, kd * g.dilation[0], sd, g.pad[0], od0, od1);
+                        for (size_t kh = 0; kh < kH; ++kh) {
+                            size_t oh0, oh1;
+                            valid_range(oH, iH, kh * g.dilation[1], sh, g.pad[1], oh0, oh1);
+                            for (size_t kw = 0; kw < kW; ++kw) {
+                                const T w = wp[(kd * kH + kh) * kW + kw];
+                                size_t ow0, ow1;
+                                valid_range(oW, iW, kw * g.dilation[2], sw, g.pad[2], ow0, ow1);
+                                const int64_t xoff = static_cast<int64_t>(kw * g.dilation[2]) - g.pad[2];
+                                for (size_t od = od0; od < od1; ++od)
+                                    for (size_t oh = oh0; oh < oh1; ++oh) {
+                                        const T* irow = ip + ((od * sd + kd * g.dilation[0] - g.pad[0]) * iH
+                                                              + oh * sh + kh * g.dilation[1] - g.pad[1]) * iW;
+                                        T* orow = o + (od * oH + oh) * oW;
+                                        for (size_t ow = ow0; ow < ow1; ++ow)
+                                            orow[ow] += irow[static_cast<int64_t>(ow * sw) + xoff] * w;
+                                    }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // 深度卷积（每个输出通道只读一个输入通道 c = k / Kg）：按 (n, k) 平面并行。
+        // 输入平面先拷进线程私有的补零缓冲（边框只在开始时清零一次），之后每个输出行
+        // 只写一次，所有卷积核位置在它驻留缓存时以整行、无边界判断的 simd 循环累加
+        template <typename T>
+        void conv_depthwise(const T* __restrict in, const T* __restrict wt, const T* __restrict b,
+                            const ConvGeom& g, T* __restrict out)
+        {
+            const size_t Kg = g.Kg();
+            const size_t iD = g.in[0], iH = g.in[1], iW = g.in[2];
+            const size_t kD = g.ker[0], kH = g.ker[1], kW = g.ker[2];
+            const size_t oD = g.out[0], oH = g.out[1], oW = g.out[2];
+            const size_t sd = g.stride[0], sh = g.stride[1], sw = g.stride[2];
+            const size_t dd = g.dilation[0], dh = g.dilation[1], dw = g.dilation[2];
+            const size_t in_plane = iD * iH * iW, out_plane = oD * oH * oW, kvol = kD * kH * kW;
+
+            // 补零后只保留输出用得到的范围 [0, (o - 1) * s + d * (k - 1) + 1)
+            const size_t pD = (oD - 1) * sd + dd * (kD - 1) + 1;
+            const size_t pH = (oH - 1) * sh + dh * (kH - 1) + 1;
+            const size_t pW = (oW - 1) * sw + dw * (kW - 1) + 1;
+            const size_t cD = std::min(iD, pD - std::min<size_t>(pD, g.pad[0]));
+            const size_t cH = std::min(iH, pH - std::min<size_t>(pH, g.pad[1]));
+            const size_t cW = std::min(iW, pW - std::min<size_t>(pW, g.pad[2]));
+
+            const bool flat = sh == 1 && sw == 1;
+            const size_t flat_len = (oH - 1) * pW + oW;
+
+            #pragma omp parallel
+            {
+                std::vector<T> padded(pD * pH * pW, T(0));
+                std::vector<T> rows(flat ? flat_len : 0);
+                T* __restrict pp = padded.data() + (g.pad[0] * pH + g.pad[1]) * pW + g.pad[2];
+
+                #pragma omp for schedule(static)
+                for (int64_t nk = 0; nk < static_cast<int64_t>(g.N * g.K); ++nk) {
+                    const size_t n = static_cast<size_t>(nk) / g.K, k = static_cast<size_t>(nk) % g.K;
+                    const T* ip = in + (n * g.C + k / Kg) * in_plane;
+                    for (size_t z = 0; z < cD; ++z)
+                        for (size_t y = 0; y < cH; ++y)
+                            std::copy_n(ip + (z * iH + y) * iW, cW, pp + (z * pH + y) * pW);
+
+                    const T* wp = wt + k * kvol;
+                    T* o = out + static_cast<size_t>(nk) * out_plane;
+                    if (flat) {
+                        // 步长为 1：在补零宽度 pW 的网格上算整个 [oH, pW] 块，每个卷积核
+                        // 位置只是一次长 simd 循环，最后丢掉每行多出的 pW - oW 列
+                        T* __restrict acc = rows.data();
+                        for (size_t od = 0; od < oD; ++od) {
+                            std::fill(acc, acc + flat_len, b[k]);
+                            for (size_t kd = 0; kd < kD; ++kd)
+                                for (size_t kh = 0; kh < kH; ++kh)
+                                    for (size_t kw = 0; kw < kW; ++kw) {
+                                        const T w = wp[(kd * kH + kh) * kW + kw];
+                                        const T* __restrict x = padded.data()
+                                            + ((od * sd + kd * dd) * pH + kh * dh) * pW + kw * dw;
+                                        #pragma omp simd
+                                        for (size_t i = 0; i < flat_len; ++i)
+                                            acc[i] += x[i] * w;
+                                    }
+                            for (size_t oh = 0; oh < oH; ++oh)
+                                std::copy_n(acc + oh * pW, oW, o + (od * oH + oh) * oW);
+                        }
+                        continue;
+                    }
+                    for (size_t od = 0; od < oD; ++od)
+                        for (size_t oh = 0; oh < oH; ++oh) {
+                            T* __restrict orow = o + (od * oH + oh) * oW;
+                            std::fill(orow, orow + oW, b[k]);
+                            for (size_t kd = 0; kd < kD; ++kd)
+                                for (size_t kh = 0; kh < kH; ++kh) {
+                                    const T* prow = padded.data() + ((od * sd + kd * dd) * pH + oh * sh + kh * dh) * pW;
+                                    const T* wk = wp + (kd * kH + kh) * kW;
+                                    for (size_t kw = 0; kw < kW; ++kw) {
+                                        const T w = wk[kw];
+                                        const T* __restrict x = prow + kw * dw;
+                                        #pragma omp simd
+                                        for (size_t ow = 0; ow < oW; ++ow)
+                                            orow[ow] += x[ow * sw] * w;
+                                    }
+                                }
+                        }
+                }
+            }
+        }
+
+        // NHWC 直接卷积：每个线程负责若干输出行 (n, oh)，最内层沿输出通道向量化；
+        // 逐通道的深度卷积（Cg == Kg == 1）沿通道向量化。hwck 为预先排好的
+        // pack_hwck(weight)，为空时现场重排
+        template <typename T>
+        Tensor<T> conv2d_nhwc(const Tensor<T>& input, const Tensor<T>& weight,
+                              const Tensor<T>& bias, const ConvGeom& g, const T* hwck = nullptr)
+        {
+            const size_t N = g.N, H = g.in[1], W = g.in[2], C = g.C, K = g.K;
+            const size_t kH = g.ker[1], kW = g.ker[2], oH = g.out[1], oW = g.out[2];
+            const size_t G = g.groups, Cg = g.Cg(), Kg = g.Kg();
+            const int sh = g.stride[1], sw = g.stride[2], dh = g.dilation[1], dw = g.dilation[2];
+            const int ph = g.pad[1], pw = g.pad[2];
+            const bool per_channel = Cg == 1 && Kg == 1;
+
+            Tensor<T> output({N, oH, oW, K});
+            output.set_layout(Layout::NHWC);
+            std::vector<T> local;
+            if (hwck == nullptr) {
+                local = pack_hwck(weight); // [kH, kW, Cg, K]
+                hwck = local.data();
+            }
+            const T* __restrict in = input.data->data();
+            const T* __restrict b = bias.data->data();
+            T* __restrict out = output.data->data();
+
+            #pragma omp parallel for schedule(static)
+            for (int64_t nh = 0; nh < static_cast<int64_t>(N * oH); ++nh) {
+                const size_t n = static_cast<size_t>(nh) / oH, oh = static_cast<size_t>(nh) % oH;
+                T* orow = out + static_cast<size_t>(nh) * oW * K;
+                for (size_t ow = 0; ow < oW; ++ow)
+                    std::copy(b, b + K, orow + ow * K);
+                for (size_t kh = 0; kh < kH; ++kh) {
+                    const int64_t ih = static_cast<int64_t>(oh * sh + kh * dh) - ph;
+                    if (ih < 0 || ih >= static_cast<int64_t>(H))
+                        continue;
+                    const T* irow = in + (n * H + static_cast<size_t>(ih)) * W * C;
+                    for (size_t kw = 0; kw < kW; ++kw) {
+                        size_t ow0, ow1;
+                        valid_range(oW, W, kw * dw, sw, pw, ow0, ow1);
+                        const T* wk = hwck + (kh * kW + kw) * Cg * K;
+                        for (size_t ow = ow0; ow < ow1; ++ow) {
+                            const T* px = irow + (ow * sw + kw * dw - pw) * C;
+                            T* o = orow + ow * K;
+                            if (per_channel)
+                                mul_add_channels(o, px, wk, K);
+                            else
+                                for (size_t grp = 0; grp < G; ++grp)
+                                    for (size_t cg = 0; cg < Cg; ++cg)
+                                        axpy_channels(o + grp * Kg, wk + cg * K + grp * Kg, px[grp * Cg + cg], Kg);
+                        }
+                    }
+                }
+            }
+            return output;
+        }
+
+        struct TransposeConvShape
+        {
+            size_t N, C, H, W, K, kH, kW, oH, oW;
+            int stride, padding, output_padding, dilation, groups;
+        };
+
+        // 校验转置卷积参数并计算输出尺寸；输入按其布局标记解释
+        template <typename T>
+        TransposeConvShape make_transpose_shape(const Tensor<T>& input, const Tensor<T>& weight,
+                                                const Tensor<T>& bias, int stride, int padding,
+                                                int output_padding, int dilation, int groups)
+        {
+            if (input.shape().size() != 4 || weight.shape().size() != 4)
+                TENSOR_THROW("conv_transpose2d: input and weight must be 4D");
+            if (bias.shape().size() != 1)
+                TENSOR_THROW("conv_transpose2d: bias must be 1D");
+            if (stride <= 0 || dilation <= 0 || groups <= 0 || padding < 0 || output_padding < 0)
+                TENSOR_THROW("conv_transpose2d: stride, dilation and groups must be positive");
+            if (output_padding >= std::max(stride, dilation))
+                TENSOR_THROW("conv_transpose2d: output_padding must be smaller than stride or dilation");
+
+            const bool nhwc = input.layout() == Layout::NHWC;
+            const auto& sh = input.shape();
+            TransposeConvShape s;
+            s.N = sh[0];
+            s.C = nhwc ? sh[3] : sh[1];
+            s.H = nhwc ? sh[1] : sh[2];
+            s.W = nhwc ? sh[2] : sh[3];
+            s.K = weight.shape()[0];
+            s.kH = weight.shape()[2];
+            s.kW = weight.shape()[3];
+            s.stride = stride;
+            s.padding = padding;
+            s.output_padding = output_padding;
+            s.dilation = dilation;
+            s.groups = groups;
+            if (s.C % groups != 0 || s.K % groups != 0)
+                TENSOR_THROW("conv_transpose2d: channels must be divisible by groups");
+            if (weight.shape()[1] * groups != s.C)
+                TENSOR_THROW("conv_transpose2d: weight input channels must match input");
+            if (bias.shape()[0] != s.K)
+                TENSOR_THROW("conv_transpose2d: bias size must match output channels");
+
+            const int64_t oH = (static_cast<int64_t>(s.H) - 1) * stride - 2 * padding
+                               + static_cast<int64_t>(dilation) * (static_cast<int64_t>(s.kH) - 1) + output_padding + 1;
+            const int64_t oW = (static_cast<int64_t>(s.W) - 1) * stride - 2 * padding
+                               + static_cast<int64_t>(dilation) * (static_cast<int64_t>(s.kW) - 1) + output_padding + 1;
+            if (s.H == 0 || s.W == 0 || oH <= 0 || oW <= 0)
+                TENSOR_THROW("conv_transpose2d: invalid output dimensions");
+            s.oH = static_cast<size_t>(oH);
+            s.oW = static_cast<size_t>(oW);
+            return s;
+        }
+
+        // NHWC 转置卷积：按输出行收集（而不是按输入散射），线程之间没有写冲突
+        template <typename T>
+        Tensor<T> conv_transpose2d_nhwc(const Tensor<T>& input, const Tensor<T>& weight,
+                                        const Tensor<T>& bias, const TransposeConvShape& s)
+        {
+            const size_t C = s.C, K = s.K, Cg = C / s.groups, Kg = K / s.groups;
+            Tensor<T> output({s.N, s.oH, s.oW, K});
+            output.set_layout(Layout::NHWC);
+            const std::vector<T> wp = pack_hwck(weight); // [kH, kW, Cg, K]
+            const T* __restrict in = input.data->data();
+            const T* __restrict b = bias.data->data();
+            T* __restrict out = output.data->data();
+
+            #pragma omp parallel for schedule(static)
+            for (int64_t nh = 0; nh < static_cast<int64_t>(s.N * s.oH); ++nh) {
+                const size_t n = static_cast<size_t>(nh) / s.oH, oh = static_cast<size_t>(nh) % s.oH;
+                T* orow = out + static_cast<size_t>(nh) * s.oW * K;
+                for (size_t ow = 0; ow < s.oW; ++ow)
+                    std::copy(b, b + K, orow + ow * K);
+                for (size_t kh = 0; kh < s.kH; ++kh) {
+                    // 输出行 oh = ih * stride + kh * dilation - padding
+                    const int64_t t = static_cast<int64_t>(oh + s.padding) - static_cast<int64_t>(kh * s.dilation);
+                    if (t < 0 || t % s.stride != 0 || t / s.stride >= static_cast<int64_t>(s.H))
+                        continue;
+                    const T* irow = in + (n * s.H + static_cast<size_t>(t / s.stride)) * s.W * C;
+                    for (size_t kw = 0; kw < s.kW; ++kw) {
+                        size_t iw0, iw1;
+                        valid_range(s.W, s.oW, kw * s.dilation, s.stride, s.padding, iw0, iw1);
+                        const T* wk = wp.data() + (kh * s.kW + kw) * Cg * K;
+                        for (size_t iw = iw0; iw < iw1; ++iw) {
+                            const T* px = irow + iw * C;
+                            T* o = orow + (iw * s.stride + kw * s.dilation - s.padding) * K;
+                            for (size_t g = 0; g < static_cast<size_t>(s.groups); ++g)
+                                for (size_t cg = 0; cg < Cg; ++cg)
+                                    axpy_channels(o + g * Kg, wk + cg * K + g * Kg, px[g * Cg + cg], Kg);
+                        }
+                    }
+                }
+            }
+            return output;
+        }
+
+        template <typename T>
+        Tensor<T> conv_nd(const Tensor<T>& input, const Tensor<T>& weight, const Tensor<T>& bias,
+                          const ConvParams& p, size_t nd, const char* name)
+        {
+            const ConvGeom g = make_conv_geom(input, weight, bias, p, nd, name);
+            if (nd == 2 && input.layout() == Layout::NHWC)
+                return conv2d_nhwc(input, weight, bias, g);
+
+            std::vector<size_t> shape{g.N, g.K};
+            for (size_t i = 0; i < nd; ++i)
+                shape.push_back(g.out[3 - nd + i]);
+            Tensor<T> output(shape);
+            if (g.depthwise())
+                conv_depthwise(input.data->data(), weight.data->data(), bias.data->data(), g, output.data->data());
+            else
+                conv_direct(input.data->data(), weight.data->data(), bias.data->data(), g, output.data->data());
+            return output;
+        }
+    }
+
+    // ================================================================
+    // Layout conversion
+    // ================================================================
+
+    // [N, C, H, W] -> [N, H, W, C]，结果标记为 NHWC；已是 NHWC 时共享数据直接返回
+    template <typename T>
+    Tensor<T> to_nhwc(const Tensor<T>& A)
+    {
+        if (A.layout() == Layout::NHWC)
+            return A.shallow_copy();
+        if (A.shape().size() != 4)
+            TENSOR_THROW("to_nhwc: tensor must be 4D");
+        const size_t N = A.shape()[0], C = A.shape()[1], H = A.shape()[2], W = A.shape()[3];
+        Tensor<T> result({N, H, W, C});
+        detail::transpose_planes(A.data->data(), result.data->data(), N, C, H * W);
+        result.set_layout(Layout::NHWC);
+        return result;
+    }
+
+    // [N, H, W, C] -> [N, C, H, W]；已是 NCHW 时共享数据直接返回
+    template <typename T>
+    Tensor<T> to_nchw(const Tensor<T>& A)
+    {
+        if (A.layout() == Layout::NCHW)
+            return A.shallow_copy();
+        if (A.shape().size() != 4)
+            TENSOR_THROW("to_nchw: tensor must be 4D");
+        const size_t N = A.shape()[0], H = A.shape()[1], W = A.shape()[2], C = A.shape()[3];
+        Tensor<T> result({N, C, H, W});
+        detail::transpose_planes(A.data->data(), result.data->data(), N, H * W, C);
+        return result;
+    }
+
+    template <typename T>
+    Tensor<T> to_layout(const Tensor<T>& A, Layout layout)
+    {
+        return layout == Layout::NHWC ? to_nhwc(A) : to_nchw(A);
+    }
+
+    // ================================================================
+    // conv1d / conv2d / conv3d
+    // ================================================================
+
+    // 输入 [N, C, L]，权重 [K, C / groups, kL]
+    template <typename T>
+    Tensor<T> conv1d(const Tensor<T>& input, const Tensor<T>& weight,
+                     const Tensor<T>& bias, const ConvParams& params)
+    {
+        return detail::conv_nd(input, weight, bias, params, 1, "conv1d");
+    }
+
+    template <typename T>
+    Tensor<T> conv1d(const Tensor<T>& input, const Tensor<T>& weight, const Tensor<T>& bias,
+                     int stride = 1, int padding = 0, int dilation = 1, int groups = 1)
+    {
+        return conv1d(input, weight, bias, ConvParams::uniform(stride, padding, dilation, groups));
+    }
+
+    // 输入 [N, C, H, W]（或带 NHWC 标记的 [N, H, W, C]），权重 [K, C / groups, kH, kW]
+    template <typename T>
+    Tensor<T> conv2d(const Tensor<T>& input, const Tensor<T>& weight,
+                     const Tensor<T>& bias, const ConvParams& params)
+    {
+        return detail::conv_nd(input, weight, bias, params, 2, "conv2d");
+    }
+
+    template <typename T>
+    Tensor<T> conv2d(const Tensor<T>& input, const Tensor<T>& weight, const Tensor<T>& bias,
+                     int stride = 1, int padding = 0, int dilation = 1, int groups = 1)
+    {
+        return conv2d(input, weight, bias, ConvParams::uniform(stride, padding, dilation, groups));
+    }
+
+    // 输入 [N, C, D, H, W]，权重 [K, C / groups, kD, kH, kW]
+    template <typename T>
+    Tensor<T> conv3d(const Tensor<T>& input, const Tensor<T>& weight,
+                     const Tensor<T>& bias, const ConvParams& params)
+    {
+        return detail::conv_nd(input, weight, bias, params, 3, "conv3d");
+    }
+
+    template <typename T>
+    Tensor<T> conv3d(const Tensor<T>& input, const Tensor<T>& weight, const Tensor<T>& bias,
+                     int stride = 1, int padding = 0, int dilation = 1, int groups = 1)
+    {
+        return conv3d(input, weight, bias, ConvParams::uniform(stride, padding, dilation, groups));
+    }
+
+
+    // ================================================================
+    // Transposed 2D Convolution (Native)
+    // ================================================================
+
+    // 权重为 [K, C / groups, kH, kW]（K 为输出通道），输出尺寸
+    //   (H - 1) * stride - 2 * padding + dilation * (kH - 1) + output_padding + 1
+    template <typename T>
+    Tensor<T> conv_transpose2d(const Tensor<T>& input, const Tensor<T>& weight,
+                               const Tensor<T>& bias, int stride = 1, int padding = 0,
+                               int output_padding = 0, int dilation = 1, int groups = 1)
+    {
+        const detail::TransposeConvShape s =
+            detail::make_transpose_shape(input, weight, bias, stride, padding, output_padding, dilation, groups);
+        if (input.layout() == Layout::NHWC)
+            return detail::conv_transpose2d_nhwc(input, weight, bias, s);
+
+        const size_t Cg = s.C / s.groups, Kg = s.K / s.groups;
+        Tensor<T> output({s.N, s.K, s.oH, s.oW});
+        const T* __restrict in = input.data->data();
+        const T* __restrict wt = weight.data->data();
+        const T* __restrict b = bias.data->data();
+        T* __restrict out = output.data->data();
+
+        // 每个 (n, k) 输出平面独立；输入像素 (h, w) 散射到
+        // (h*stride + kh*dilation - padding, w*stride + kw*dilation - padding)，有效区间预先算出
+        #pragma omp parallel for schedule(static)
+        for (int64_t nk = 0; nk < static_cast<int64_t>(s.N * s.K); ++nk) {
+            const size_t n = static_cast<size_t>(nk) / s.K, k = static_cast<size_t>(nk) % s.K;
+            const size_t g = k / Kg;
+            T* o = out + static_cast<size_t>(nk) * s.oH * s.oW;
+            std::fill(o, o + s.oH * s.oW, b[k]);
+            for (size_t cg = 0; cg < Cg; ++cg) {
+                const T* ip = in + (n * s.C + g * Cg + cg) * s.H * s.W;
+                const T* wp = wt + (k * Cg + cg) * s.kH * s.kW;
+                for (size_t kh = 0; kh < s.kH; ++kh) {
+                    size_t h0, h1;
+                    detail::valid_range(s.H, s.oH, kh * s.dilation, s.stride, s.padding, h0, h1);
+                    for (size_t kw = 0; kw < s.kW; ++kw) {
+                        const T w = wp[kh * s.kW + kw];
+                        size_t w0, w1;
+                        detail::valid_range(s.W, s.oW, kw * s.dilation, s.stride, s.padding, w0, w1);
+                        for (size_t h = h0; h < h1; ++h) {
+                            const T* irow = ip + h * s.W;
+                            T* orow = o + (h * s.stride + kh * s.dilation - s.padding) * s.oW
+                                      + kw * s.dilation - s.padding;
+                            for (size_t iw = w0; iw < w1; ++iw)
+                                orow[iw * s.stride] += irow[iw] * w;
+                        }
+                    }
+                }
+            }
+        }
+
+        return output;
+    }
+
+    // ================================================================
+    // 2D Pooling（NCHW / NHWC，按输入的布局标记）
+    // ================================================================
+
+    namespace detail
+    {
+        enum class PoolKind { Max, Avg };
+
+        // 平均池化按 kH*kW 归一化（填充位置计为 0），与 PyTorch 默认的 count_include_pad 相同
+        template <typename T>
+        Tensor<T> pool2d(const Tensor<T>& input, int kernel, int stride, int padding,
+                         PoolKind kind, const char* name)
+        {
+            if (input.shape().size() != 4)
+                TENSOR_THROW(std::string(name) + ": input must be 4D");
+            if (stride == 0)
+                stride = kernel;
+            if (kernel <= 0 || stride <= 0 || padding < 0 || 2 * padding > kernel)
+                TENSOR_THROW(std::string(name) + ": invalid kernel, stride or padding");
+
+            const bool nhwc = input.layout() == Layout::NHWC;
+            const auto& sh = input.shape();
+            const size_t N = sh[0], C = nhwc ? sh[3] : sh[1];
+            const size_t H = nhwc ? sh[1] : sh[2], W = nhwc ? sh[2] : sh[3];
+            const size_t k = static_cast<size_t>(kernel);
+            if (H + 2 * padding < k || W + 2 * padding < k)
+                TENSOR_THROW(std::string(name) + ": invalid output dimensions");
+            const size_t oH = (H + 2 * padding - k) / stride + 1;
+            const size_t oW = (W + 2 * padding - k) / stride + 1;
+
+            Tensor<T> output(nhwc ? std::vector<size_t>{N, oH, oW, C} : std::vector<size_t>{N, C, oH, oW});
+            output.set_layout(input.layout());
+            const T* __restrict in = input.data->data();
+            T* __restrict out = output.data->data();
+            const bool is_max = kind == PoolKind::Max;
+            const T init = is_max ? std::numeric_limits<T>::lowest() : T(0);
+            const T scale = T(1) / static_cast<T>(k * k);
+
+            if (!nhwc) {
+                #pragma omp parallel for schedule(static)
+                for (int64_t nc = 0; nc < static_cast<int64_t>(N * C); ++nc) {
+                    const T* ip = in + static_cast<size_t>(nc) * H * W;
+                    T* op = out + static_cast<size_t>(nc) * oH * oW;
+                    for (size_t oh = 0; oh < oH; ++oh) {
+                        size_t h0, h1;
+                        valid_range(k, H, oh * stride, 1, padding, h0, h1);
+                        for (size_t ow = 0; ow < oW; ++ow) {
+                            size_t w0, w1;
+                            valid_range(k, W, ow * stride, 1, padding, w0, w1);
+                            T acc = init;
+                            for (size_t kh = h0; kh < h1; ++kh) {
+                                const T* irow = ip + (oh * stride + kh - padding) * W + ow * stride - padding;
+                                for (size_t kw = w0; kw < w1; ++kw)
+                                    acc = is_max ? (irow[kw] > acc ? irow[kw] : acc) : acc + irow[kw];
+                            }
+                            op[oh * oW + ow] = is_max ? acc : acc * scale;
+                        }
+                    }
+                }
+                return output;
+            }
+
+            // NHWC：窗口内逐像素处理整段通道，沿通道向量化
+            #pragma omp parallel for schedule(static)
+            for (int64_t nh = 0; nh < static_cast<int64_t>(N * oH); ++nh) {
+                const size_t n = static_cast<size_t>(nh) / oH, oh = static_cast<size_t>(nh) % oH;
+                size_t h0, h1;
+                valid_range(k, H, oh * stride, 1, padding, h0, h1);
+                for (size_t ow = 0; ow < oW; ++ow) {
+                    T* o = out + (static_cast<size_t>(nh) * oW + ow) * C;
+                    std::fill(o, o + C, init);
+                    size_t w0, w1;
+                    valid_range(k, W, ow * stride, 1, padding, w0, w1);
+                    for (size_t kh = h0; kh < h1; ++kh)
+                        for (size_t kw = w0; kw < w1; ++kw) {
+                            const T* px = in + ((n * H + oh * stride + kh - padding) * W
+                                                + ow * stride + kw - padding) * C;
+                            if (is_max) {
+                                #pragma omp simd
+                                for (size_t c = 0; c < C; ++c)
+                                    o[c] = px[c] > o[c] ? px[c] : o[c];
+                            } else {
+                                #pragma omp simd
+                                for (size_t c = 0; c < C; ++c)
+                                    o[c] += px[c];
+                            }
+                        }
+                    if (!is_max)
+                        for (size_t c = 0; c < C; ++c)
+                            o[c] *= scale;
+                }
+            }
+            return output;
+        }
+    }
+
+    // stride = 0 表示与 kernel 相同
+    template <typename T>
+    Tensor<T> max_pool2d(const Tensor<T>& input, int kernel, int stride = 0, int padding = 0)
+    {
+        return detail::pool2d(input, kernel, stride, padding, detail::PoolKind::Max, "max_pool2d");
+    }
+
+    template <typename T>
+    Tensor<T> avg_pool2d(const Tensor<T>& input, int kernel, int stride = 0, int padding = 0)
+    {
+        return detail::pool2d(input, kernel, stride, padding, detail::PoolKind::Avg, "avg_pool2d");
+    }
+
+
+} // namespace TensorN
+
+#endif // __CONV_HPP__
@@ -7,9 +7,17 @@
 #include "einsum.hpp"
 #include "operations.hpp"
 #include "static.hpp"
+#include "linear_attn_state.hpp"
 #include "BLAS/blas_tensor.hpp"
+#include "BLAS/convolution.hpp"
+#include "BLAS/packed_weight.hpp"
+#include "BLAS/fused.hpp"
+#include "BLAS/attention.hpp"
 #include "GGUF/gguf.hpp"
+#include "GGUF/quantized_tensor.hpp"
 #include "HF/safetensors.hpp"
+#include "prefetcher.hpp"
+#include "OOC/out_of_core.hpp"
 
 #ifndef TENSORN_CUDA_AVAILABLE
 #if __has_include(<cuda_runtime.h>)
@@ -0,0 +1,238 @@
+#pragma once
+#ifndef __LINEAR_ATTN_STATE__H__
+#define __LINEAR_ATTN_STATE__H__
+
+// ============================================================================
+// 线性注意力的增量解码状态
+//
+//   causal 线性注意力第 t 步的输出只依赖两个累加量：
+//     S = Σ_{s<=t} psi_s ⊗ v_s   [D, d_v]
+//     C = Σ_{s<=t} psi_s         [D]
+//     out_t = (phi_t S) / max(phi_t · C, 1e-8)
+//   LinearAttnState 为每条序列（batch_shape 展平后的每个下标）保存一份 S / C，
+//   step() 每个 token 只做 O(D * d_v) 的工作，与已生成的长度无关。
+//   extend() 一次推进多步（prefill），复用 linear_kernels_attn_causal 的分块
+//   实现并从当前状态接着算；两者的结果与对整段序列调用
+//   linear_kernels_attn_causal 一致。
+//
+//   状态用累加类型保存（half / bfloat16 等为 float），可以通过 S() / C()
+//   取出，或用 save() / load() 存成 .pt 文件（张量名 "S"、"C"）。
+// ============================================================================
+
+#include "operations.hpp"
+#include "PT/pt.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace TensorN
+{
+    template <typename T>
+    class LinearAttnState
+    {
+    public:
+        using acc_type = linear_attn_detail::acc_t<T>;
+
+        LinearAttnState() = default;
+
+        // batch_shape 为 (...)，可以为空（单条序列）
+        LinearAttnState(const std::vector<size_t> &batch_shape, size_t D, size_t d_v)
+            : batch_shape_(batch_shape), D_(D), dv_(d_v)
+        {
+            if (D == 0 || d_v == 0)
+                TENSOR_THROW("LinearAttnState: D and d_v must be positive");
+            batch_ = 1;
+            for (size_t n : batch_shape_)
+                batch_ *= n;
+            state_.assign(batch_ * slot(), acc_type(0));
+        }
+
+        // 从已有状态恢复：S 为 (..., D, d_v)，C 为 (..., D)
+        LinearAttnState(const Tensor<acc_type> &S, const Tensor<acc_type> &C)
+        {
+            const auto &ss = S.shape(), &cs = C.shape();
+            if (ss.size() < 2 || cs.size() != ss.size() - 1)
+                TENSOR_THROW("LinearAttnState: S must be (..., D, d_v) and C must be (..., D)");
+            for (size_t i = 0; i < cs.size(); ++i)
+                if (ss[i] != cs[i])
+                    TENSOR_THROW("LinearAttnState: S and C shape mismatch");
+            *this = LinearAttnState(std::vector<size_t>(ss.begin(), ss.end() - 2), ss[ss.size() - 2], ss.back());
+            const acc_type *s = S.data->data(), *c = C.data->data();
+            for (size_t b = 0; b < batch_; ++b)
+            {
+                acc_type *dst = state_.data() + b * slot();
+                std::copy(s + b * D_ * dv_, s + (b + 1) * D_ * dv_, dst);
+                std::copy(c + b * D_, c + (b + 1) * D_, dst + D_ * dv_);
+            }
+        }
+
+        const std::vector<size_t> &batch_shape() const { return batch_shape_; }
+        size_t batch() const { return batch_; }
+        size_t feature_dim() const { return D_; }
+        size_t value_dim() const { return dv_; }
+
+        // 全部序列清零
+        void reset() { std::fill(state_.begin(), state_.end(), acc_type(0)); }
+
+        // 清零第 b 条序列（batch_shape 展平后的下标），用于连续批处理中替换已结束的序列
+        void reset(size_t b)
+        {
+            if (b >= batch_)
+                TENSOR_THROW("LinearAttnState::reset: index out of range");
+            std::fill(state_.begin() + b * slot(), state_.begin() + (b + 1) * slot(), acc_type(0));
+        }
+
+        // 状态的拷贝：S 为 (..., D, d_v)，C 为 (..., D)
+        Tensor<acc_type> S() const
+        {
+            Tensor<acc_type> out(with(batch_shape_, {D_, dv_}));
+            for (size_t b = 0; b < batch_; ++b)
+                std::copy_n(state_.data() + b * slot(), D_ * dv_, out.data->data() + b * D_ * dv_);
+            return out;
+        }
+
+        Tensor<acc_type> C() const
+        {
+            Tensor<acc_type> out(with(batch_shape_, {D_}));
+            for (size_t b = 0; b < batch_; ++b)
+                std::copy_n(state_.data() + b * slot() + D_ * dv_, D_, out.data->data() + b * D_);
+            return out;
+        }
+
+        // ================================================================
+        // 单步解码：phi_t / psi_t (..., D)，v_t (..., d_v)
+        // 先并入 psi_t ⊗ v_t 再输出，返回 (..., d_v)
+        // ================================================================
+        opt<T> step(const Tensor<T> &phi_t, const Tensor<T> &psi_t, const Tensor<T> &v_t)
+        {
+            check(phi_t, with(batch_shape_, {D_}), "phi_t");
+            check(psi_t, with(batch_shape_, {D_}), "psi_t");
+            check(v_t, with(batch_shape_, {dv_}), "v_t");
+            opt<T> result(with(batch_shape_, {dv_}));
+            advance(nullptr, batch_, phi_t.data->data(), psi_t.data->data(), v_t.data->data(),
+                    result.tensor.data->data());
+            return result;
+        }
+
+        // 只推进 rows 中的序列（展平下标，互不相同），其余保持不变：
+        // phi_t / psi_t [n, D]，v_t [n, d_v]，第 i 行属于序列 rows[i]；返回 [n, d_v]
+        opt<T> step(const std::vector<size_t> &rows, const Tensor<T> &phi_t, const Tensor<T> &psi_t,
+                    const Tensor<T> &v_t)
+        {
+            const size_t n = rows.size();
+            check(phi_t, {n, D_}, "phi_t");
+            check(psi_t, {n, D_}, "psi_t");
+            check(v_t, {n, dv_}, "v_t");
+            std::vector<char> seen(batch_, 0);
+            for (size_t r : rows)
+            {
+                if (r >= batch_)
+                    TENSOR_THROW("LinearAttnState::step: row index out of range");
+                if (seen[r])
+                    TENSOR_THROW("LinearAttnState::step: duplicate row index");
+                seen[r] = 1;
+            }
+            opt<T> result(std::vector<size_t>{n, dv_});
+            advance(rows.data(), n, phi_t.data->data(), psi_t.data->data(), v_t.data->data(),
+                    result.tensor.data->data());
+            return result;
+        }
+
+        // ================================================================
+        // 多步推进（prefill）：phi / psi (..., L, D)，V (..., L, d_v)
+        // 接在当前状态之后计算，返回 (..., L, d_v)
+        // ================================================================
+        opt<T> extend(const Tensor<T> &phi, const Tensor<T> &psi, const Tensor<T> &V)
+        {
+            const size_t nb = batch_shape_.size();
+            if (phi.shape().size() != nb + 2)
+                TENSOR_THROW("LinearAttnState::extend: phi must be (..., L, D)");
+            const size_t L = phi.shape()[nb];
+            check(phi, with(batch_shape_, {L, D_}), "phi");
+            check(psi, with(batch_shape_, {L, D_}), "psi");
+            check(V, with(batch_shape_, {L, dv_}), "V");
+            opt<T> result(with(batch_shape_, {L, dv_}));
+            if (batch_ != 0 && L != 0)
+                linear_attn_detail::run(phi.data->data(), psi.data->data(), V.data->data(),
+                                        result.tensor.data->data(), batch_, L, D_, dv_, true, state_.data());
+            return result;
+        }
+
+        // 存成 .pt 文件，张量名 "S"、"C"
+        void save(const std::string &filename) const
+        {
+            PtWriter writer(filename);
+            writer.add("S", S());
+            writer.add("C", C());
+            writer.finish();
+        }
+
+        static LinearAttnState load(const std::string &filename)
+        {
+            PtFile pt(filename);
+            return LinearAttnState(pt.load<acc_type>("S"), pt.load<acc_type>("C"));
+        }
+
+    private:
+        std::vector<size_t> batch_shape_;
+        size_t batch_ = 0, D_ = 0, dv_ = 0;
+        std::vector<acc_type> state_; // [batch, D * d_v + D]：每条序列 S 后接 C
+
+        size_t slot() const { return D_ * dv_ + D_; }
+
+        static std::vector<size_t> with(std::vector<size_t> shape, std::initializer_list<size_t> tail)
+        {
+            shape.insert(shape.end(), tail);
+            return shape;
+        }
+
+        static void check(const Tensor<T> &t, const std::vector<size_t> &expected, const char *name)
+        {
+            if (t.shape() != expected)
+                TENSOR_THROW(std::string("LinearAttnState: ") + name + " shape mismatch");
+        }
+
+        // 第 i 行输入推进序列 rows[i]（rows 为空时为 i）；S 的每一行更新后立即参与输出
+        void advance(const size_t *rows, size_t n, const T *phi, const T *psi, const T *v, T *out)
+        {
+            using A = acc_type;
+            const int64_t count = static_cast<int64_t>(n);
+#pragma omp parallel if (count > 1 && n * D_ * dv_ >= (size_t(1) << 15))
+            {
+                std::vector<A> vv(dv_), num(dv_);
+#pragma omp for schedule(static)
+                for (int64_t i = 0; i < count; ++i)
+                {
+                    const size_t r = static_cast<size_t>(i);
+                    A *S = state_.data() + (rows ? rows[r] : r) * slot();
+                    A *C = S + D_ * dv_;
+                    const T *f = phi + r * D_, *p = psi + r * D_;
+                    std::transform(v + r * dv_, v + (r + 1) * dv_, vv.begin(), [](T x) { return static_cast<A>(x); });
+                    std::fill(num.begin(), num.end(), A(0));
+                    A den = 0;
+                    for (size_t k = 0; k < D_; ++k)
+                    {
+                        const A pk = static_cast<A>(p[k]), fk = static_cast<A>(f[k]);
+                        C[k] += pk;
+                        den += fk * C[k];
+                        A *row = S + k * dv_;
+#pragma omp simd
+                        for (size_t x = 0; x < dv_; ++x)
+                        {
+                            row[x] += pk * vv[x];
+                            num[x] += fk * row[x];
+                        }
+                    }
+                    if (den < A(1e-8))
+                        den = A(1e-8);
+                    const A inv = A(1) / den;
+                    T *dst = out + r * dv_;
+                    for (size_t x = 0; x < dv_; ++x)
+                        dst[x] = static_cast<T>(num[x] * inv);
+                }
+            }
+        }
+    };
+}
+
+#endif // !__LINEAR_ATTN_STATE__H__
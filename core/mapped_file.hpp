@@ -0,0 +1,168 @@
+#pragma once
+#ifndef __MAPPED_FILE_HPP__
+#define __MAPPED_FILE_HPP__
+
+// ============================================================================
+// MappedFile —— 只读文件的内存映射（POSIX mmap / Win32 MapViewOfFile）。
+//
+// 映射以写时复制（MAP_PRIVATE / FILE_MAP_COPY）方式建立：基于映射构造的
+// 零拷贝 Tensor 视图可以被原地修改，修改只影响本进程，不会写回文件。
+// 通过 std::shared_ptr 共享，任何引用映射的张量视图都会延长其生命周期。
+// ============================================================================
+
+#include "tensor.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace TensorN
+{
+    class MappedFile
+    {
+    private:
+        std::string _filename;
+        uint8_t *_data = nullptr;
+        size_t _size = 0;
+#ifdef _WIN32
+        HANDLE _file = INVALID_HANDLE_VALUE;
+        HANDLE _mapping = nullptr;
+#endif
+
+    public:
+        explicit MappedFile(const std::string &filename) : _filename(filename)
+        {
+#ifdef _WIN32
+            _file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (_file == INVALID_HANDLE_VALUE)
+                TENSOR_THROW("Cannot open file: " + filename);
+
+            LARGE_INTEGER file_size;
+            if (!GetFileSizeEx(_file, &file_size))
+            {
+                CloseHandle(_file);
+                TENSOR_THROW("Cannot stat file: " + filename);
+            }
+            _size = static_cast<size_t>(file_size.QuadPart);
+            if (_size == 0)
+                return;
+
+            _mapping = CreateFileMappingA(_file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+            if (_mapping == nullptr)
+            {
+                CloseHandle(_file);
+                TENSOR_THROW("Cannot map file: " + filename);
+            }
+            _data = static_cast<uint8_t *>(MapViewOfFile(_mapping, FILE_MAP_COPY, 0, 0, 0));
+            if (_data == nullptr)
+            {
+                CloseHandle(_mapping);
+                CloseHandle(_file);
+                TENSOR_THROW("Cannot map file: " + filename);
+            }
+#else
+            int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0)
+                TENSOR_THROW("Cannot open file: " + filename);
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+            {
+                ::close(fd);
+                TENSOR_THROW("Cannot stat file: " + filename);
+            }
+            _size = static_cast<size_t>(st.st_size);
+            if (_size == 0)
+            {
+                ::close(fd);
+                return;
+            }
+
+            void *ptr = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (ptr == MAP_FAILED)
+                TENSOR_THROW("Cannot map file: " + filename);
+            _data = static_cast<uint8_t *>(ptr);
+#endif
+        }
+
+        ~MappedFile()
+        {
+#ifdef _WIN32
+            if (_data)
+                UnmapViewOfFile(_data);
+            if (_mapping)
+                CloseHandle(_mapping);
+            if (_file != INVALID_HANDLE_VALUE)
+                CloseHandle(_file);
+#else
+            if (_data)
+                ::munmap(_data, _size);
+#endif
+        }
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        static std::shared_ptr<MappedFile> open(const std::string &filename)
+        {
+            return std::make_shared<MappedFile>(filename);
+        }
+
+        const uint8_t *data() const { return _data; }
+        uint8_t *data() { return _data; }
+        size_t size() const { return _size; }
+        const std::string &filename() const { return _filename; }
+
+        // 提示内核即将顺序读取 [offset, offset + length)，用于预取张量数据
+        void prefetch(size_t offset, size_t length) const
+        {
+            if (_data == nullptr || offset >= _size)
+                return;
+            if (length > _size - offset)
+                length = _size - offset;
+#ifdef _WIN32
+            WIN32_MEMORY_RANGE_ENTRY range;
+            range.VirtualAddress = _data + offset;
+            range.NumberOfBytes = length;
+            PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+            size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            size_t begin = offset / page * page;
+            ::madvise(_data + begin, length + (offset - begin), MADV_WILLNEED);
+#endif
+        }
+
+        // 零拷贝张量视图：ptr 必须指向本映射内部且满足 T 的对齐要求
+        template <typename T>
+        static Tensor<T> view(const std::shared_ptr<MappedFile> &file,
+                              const std::vector<size_t> &shape, size_t offset)
+        {
+            size_t numel = 1;
+            for (auto d : shape)
+                numel *= d;
+            if (offset > file->size() || numel * sizeof(T) > file->size() - offset)
+                TENSOR_THROW("Mapped view exceeds file size: " + file->filename());
+            return Tensor<T>::from_external(shape, reinterpret_cast<T *>(file->data() + offset), file);
+        }
+    };
+
+} // namespace TensorN
+
+#endif // __MAPPED_FILE_HPP__
@@ -8,6 +8,8 @@
 #include <memory>
 #include <algorithm>
 #include <cstddef>
+#include <new>
+#include <utility>
 
 namespace TensorN
 {
@@ -145,6 +147,92 @@ namespace TensorN
     template <typename T>
     using PooledVector = std::vector<T, PooledAllocator<T>>;
 
+    // 从内存池借用的临时缓冲（内容未初始化），析构时归还。
+    // 用于内核的工作区：重复调用时复用同一块内存，且不做清零
+    template <typename T>
+    class PooledBuffer
+    {
+    public:
+        PooledBuffer() noexcept = default;
+
+        explicit PooledBuffer(size_t n)
+            : ptr_(static_cast<T*>(MemoryPool::instance().acquire(n * sizeof(T)))), size_(n) {}
+
+        PooledBuffer(PooledBuffer&& other) noexcept
+            : ptr_(std::exchange(other.ptr_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+        PooledBuffer& operator=(PooledBuffer&& other) noexcept
+        {
+            if (this != &other)
+            {
+                MemoryPool::instance().release(ptr_);
+                ptr_ = std::exchange(other.ptr_, nullptr);
+                size_ = std::exchange(other.size_, 0);
+            }
+            return *this;
+        }
+
+        PooledBuffer(const PooledBuffer&) = delete;
+        PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+        ~PooledBuffer() { MemoryPool::instance().release(ptr_); }
+
+        T* data() noexcept { return ptr_; }
+        const T* data() const noexcept { return ptr_; }
+        size_t size() const noexcept { return size_; }
+        T& operator[](size_t i) noexcept { return ptr_[i]; }
+        const T& operator[](size_t i) const noexcept { return ptr_[i]; }
+
+    private:
+        T* ptr_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    // 把一段外部内存（例如内存映射文件）"借给" std::vector：
+    // allocate() 交出预先登记的指针，默认构造与析构均为空操作，因而不会
+    // 覆写或释放外部数据。与 PooledAllocator 一样无状态，保证容器布局与
+    // std::vector<T> 一致。
+    template <typename T>
+    class ExternalAllocator
+    {
+    public:
+        using value_type = T;
+
+        ExternalAllocator() noexcept = default;
+
+        template <typename U>
+        ExternalAllocator(const ExternalAllocator<U>&) noexcept {}
+
+        static T*& pending()
+        {
+            thread_local T* ptr = nullptr;
+            return ptr;
+        }
+
+        T* allocate(size_t)
+        {
+            T* p = pending();
+            pending() = nullptr;
+            if (!p) throw std::bad_alloc();
+            return p;
+        }
+
+        void deallocate(T*, size_t) noexcept {}
+
+        template <typename U, typename... Args>
+        void construct(U* p, Args&&... args)
+        {
+            if constexpr (sizeof...(Args) > 0)
+                ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+        }
+
+        template <typename U>
+        void destroy(U*) noexcept {}
+
+        bool operator==(const ExternalAllocator&) const noexcept { return true; }
+        bool operator!=(const ExternalAllocator&) const noexcept { return false; }
+    };
+
 } // namespace TensorN
 
 #endif // __MEMORY_POOL_HPP__
@@ -4,8 +4,14 @@
 
 #include "tensor.hpp"
 #include "einsum.hpp"
+#include "softmax.hpp"
+#include "reduce.hpp"
+#include "conv.hpp"
+#include "tile_gemm.hpp"
 #include <cmath>
 #include <functional>
+#include <string>
+#include <vector>
 
 namespace TensorN
 {
@@ -156,47 +162,70 @@ namespace TensorN
         return result[0];
     }
 
-    // 求和所有元素
+    // 求和所有元素（宽类型累加，见 reduce.hpp）
     template <typename T>
     T sum(const Tensor<T> &A)
     {
-        auto result = einsum<T>("...->", A).tensor;
-        return result[0];
+        return reduce(A, {}, false, reducers::Sum{})[0];
     }
 
-    // 按轴求和
+    // 按轴求和（axis 可为负数）
     template <typename T>
-    opt<T> sum(const Tensor<T> &A, size_t axis)
+    opt<T> sum(const Tensor<T> &A, int axis)
     {
-        if (axis >= A.shape().size())
-        {
-            TENSOR_THROW("Axis out of range");
-        }
+        return opt<T>(reduce(A, {axis}, false, reducers::Sum{}));
+    }
 
-        // 构建表达式
-        std::string expr;
-        std::string out_labels;
+    // 多轴求和；axes 为空表示全部维度，keepdims 保留被规约的维度（长度为 1）
+    template <typename T>
+    opt<T> sum(const Tensor<T> &A, const std::vector<int> &axes, bool keepdims = false)
+    {
+        return opt<T>(reduce(A, axes, keepdims, reducers::Sum{}));
+    }
 
-        char current_label = 'a';
-        for (size_t i = 0; i < A.shape().size(); ++i)
-        {
-            if (i == axis)
-            {
-                expr += current_label;
-                // 不在输出中包含这个标签
-            }
-            else
-            {
-                expr += current_label;
-                out_labels += current_label;
-            }
-            current_label++;
-        }
+    // 连乘
+    template <typename T>
+    T prod(const Tensor<T> &A)
+    {
+        return reduce(A, {}, false, reducers::Prod{})[0];
+    }
 
-        expr += "->";
-        expr += out_labels.empty() ? "" : out_labels;
+    template <typename T>
+    opt<T> prod(const Tensor<T> &A, const std::vector<int> &axes, bool keepdims = false)
+    {
+        return opt<T>(reduce(A, axes, keepdims, reducers::Prod{}));
+    }
 
-        return einsum<T>(expr, A);
+    // 最大值 / 最小值（NaN 会传播）
+    template <typename T>
+    T max(const Tensor<T> &A)
+    {
+        return reduce(A, {}, false, reducers::Max{})[0];
+    }
+
+    template <typename T>
+    opt<T> max(const Tensor<T> &A, const std::vector<int> &axes, bool keepdims = false)
+    {
+        return opt<T>(reduce(A, axes, keepdims, reducers::Max{}));
+    }
+
+    template <typename T>
+    T min(const Tensor<T> &A)
+    {
+        return reduce(A, {}, false, reducers::Min{})[0];
+    }
+
+    template <typename T>
+    opt<T> min(const Tensor<T> &A, const std::vector<int> &axes, bool keepdims = false)
+    {
+        return opt<T>(reduce(A, axes, keepdims, reducers::Min{}));
+    }
+
+    // log(sum(exp(A)))，沿给定轴
+    template <typename T>
+    opt<T> logsumexp(const Tensor<T> &A, const std::vector<int> &axes, bool keepdims = false)
+    {
+        return opt<T>(reduce(A, axes, keepdims, reducers::LogSumExp{}));
     }
 
     // 累加和 (Cumulative sum)
@@ -315,10 +344,13 @@ namespace TensorN
             TENSOR_THROW("diag_matrix requires a 1D tensor");
         }
 
-        opt<T> oper({v.shape()[0], v.shape()[0]});
-        for (size_t i = 0; i < v.shape()[0]; ++i)
+        const size_t n = v.shape()[0];
+        opt<T> oper({n, n});
+        T *dst = oper.tensor.data->data();
+        const T *src = v.data->data();
+        for (size_t i = 0; i < n; ++i)
         {
-            oper.tensor[{i, i}] = v[i];
+            dst[i * n + i] = src[i];
         }
         return oper;
     }
@@ -330,6 +362,7 @@ namespace TensorN
         opt<T> apply(const Tensor<T> &A, Func func)
         {
             Tensor<T> result(A.shape());
+            result.set_layout(A.layout());
             std::transform(A.begin(), A.end(), result.begin(), func);
             return result;
         }
@@ -381,13 +414,24 @@ namespace TensorN
             return sum(A) / static_cast<T>(A.size());
         }
 
-        // 方差
+        template <typename T>
+        opt<T> mean(const Tensor<T> &A, const std::vector<int> &axes, bool keepdims = false)
+        {
+            return opt<T>(reduce(A, axes, keepdims, reducers::Mean{}));
+        }
+
+        // 方差（总体方差，单遍 Welford / Chan 合并，不产生临时张量）
         template <typename T>
         T var(const Tensor<T> &A)
         {
-            T m = mean(A);
-            Tensor<T> centered = A - m;
-            return sum(hadamard(centered, centered).tensor) / static_cast<T>(A.size());
+            return reduce(A, {}, false, reducers::Variance{})[0];
+        }
+
+        // 沿给定轴的方差，除数为 n - ddof
+        template <typename T>
+        opt<T> var(const Tensor<T> &A, const std::vector<int> &axes, bool keepdims = false, double ddof = 0)
+        {
+            return opt<T>(reduce(A, axes, keepdims, reducers::Variance(ddof)));
         }
 
         // 标准差
@@ -397,6 +441,26 @@ namespace TensorN
             return std::sqrt(var(A));
         }
 
+        template <typename T>
+        opt<T> stddev(const Tensor<T> &A, const std::vector<int> &axes, bool keepdims = false, double ddof = 0)
+        {
+            return opt<T>(reduce(A, axes, keepdims, reducers::StdDev(ddof)));
+        }
+
+        // 偏度（有偏估计）
+        template <typename T>
+        opt<T> skew(const Tensor<T> &A, const std::vector<int> &axes = {}, bool keepdims = false)
+        {
+            return opt<T>(reduce(A, axes, keepdims, reducers::Skewness{}));
+        }
+
+        // 超额峰度（有偏估计，正态分布为 0）
+        template <typename T>
+        opt<T> kurtosis(const Tensor<T> &A, const std::vector<int> &axes = {}, bool keepdims = false)
+        {
+            return opt<T>(reduce(A, axes, keepdims, reducers::Kurtosis{}));
+        }
+
         // 向量范数 (L2 norm)
         template <typename T>
         T norm(const Tensor<T> &v)
@@ -408,6 +472,13 @@ namespace TensorN
             return std::sqrt(dot(v, v)[0]);
         }
 
+        // 沿给定轴的 p 范数（p = 1 / 2 / inf 或任意正数）
+        template <typename T>
+        opt<T> norm(const Tensor<T> &A, const std::vector<int> &axes, bool keepdims = false, double p = 2)
+        {
+            return opt<T>(reduce_norm(A, axes, keepdims, p));
+        }
+
         // 矩阵范数 (Frobenius norm)
         template <typename T>
         T frobenius_norm(const Tensor<T> &A)
@@ -424,62 +495,22 @@ namespace TensorN
     // Softmax
     // ================================================================
 
+    // 任意维度、任意轴；内核见 softmax.hpp
     template <typename T>
     opt<T> softmax(const Tensor<T>& A, int axis = -1)
     {
-        size_t ndim = A.shape().size();
-        if (axis < 0) axis = static_cast<int>(ndim) + axis;
-        if (axis < 0 || static_cast<size_t>(axis) >= ndim)
-            TENSOR_THROW("Softmax axis out of range");
-
         Tensor<T> result(A.shape());
+        softmax_detail::softmax_nd(A, axis, false, result);
+        return opt<T>(result);
+    }
 
-        if (ndim == 1) {
-            T max_val = *std::max_element(A.begin(), A.end());
-            T sum = T(0);
-            for (size_t i = 0; i < A.size(); ++i) {
-                result[i] = std::exp(A[i] - max_val);
-                sum += result[i];
-            }
-            for (size_t i = 0; i < A.size(); ++i)
-                result[i] /= sum;
-            return opt<T>(result);
-        }
-
-        if (ndim == 2) {
-            size_t rows = A.shape()[0], cols = A.shape()[1];
-            if (axis == 1) {
-                for (size_t r = 0; r < rows; ++r) {
-                    T max_val = A[{r, 0}];
-                    for (size_t c = 1; c < cols; ++c)
-                        if (A[{r, c}] > max_val) max_val = A[{r, c}];
-                    T sum = T(0);
-                    for (size_t c = 0; c < cols; ++c) {
-                        result[{r, c}] = std::exp(A[{r, c}] - max_val);
-                        sum += result[{r, c}];
-                    }
-                    for (size_t c = 0; c < cols; ++c)
-                        result[{r, c}] /= sum;
-                }
-                return opt<T>(result);
-            }
-            if (axis == 0) {
-                for (size_t c = 0; c < cols; ++c) {
-                    T max_val = A[{0, c}];
-                    for (size_t r = 1; r < rows; ++r)
-                        if (A[{r, c}] > max_val) max_val = A[{r, c}];
-                    T sum = T(0);
-                    for (size_t r = 0; r < rows; ++r) {
-                        result[{r, c}] = std::exp(A[{r, c}] - max_val);
-                        sum += result[{r, c}];
-                    }
-                    for (size_t r = 0; r < rows; ++r)
-                        result[{r, c}] /= sum;
-                }
-                return opt<T>(result);
-            }
-        }
-        TENSOR_THROW("Softmax: only 1D/2D supported");
+    // log(softmax(A))，按 x - max - log(sum(exp(x - max))) 计算，不会下溢为 -inf
+    template <typename T>
+    opt<T> log_softmax(const Tensor<T>& A, int axis = -1)
+    {
+        Tensor<T> result(A.shape());
+        softmax_detail::softmax_nd(A, axis, true, result);
+        return opt<T>(result);
     }
 
     // ================================================================
@@ -487,7 +518,7 @@ namespace TensorN
     // ================================================================
 
     template <typename T>
-    opt<int64_t> argmax(const Tensor<T>& A, int axis = -1)
+    opt<int64_t> argmax(const Tensor<T>& A, int axis = -1, bool keepdims = false)
     {
         const auto& shape = A.shape();
         size_t ndim = shape.size();
@@ -502,6 +533,7 @@ namespace TensorN
         std::vector<size_t> out_shape;
         for (size_t d = 0; d < ndim; ++d)
             if (d != static_cast<size_t>(axis)) out_shape.push_back(shape[d]);
+            else if (keepdims) out_shape.push_back(1);
 
         Tensor<int64_t> result(out_shape);
         for (size_t o = 0; o < outer; ++o) {
@@ -519,7 +551,7 @@ namespace TensorN
     }
 
     template <typename T>
-    opt<int64_t> argmin(const Tensor<T>& A, int axis = -1)
+    opt<int64_t> argmin(const Tensor<T>& A, int axis = -1, bool keepdims = false)
     {
         const auto& shape = A.shape();
         size_t ndim = shape.size();
@@ -534,6 +566,7 @@ namespace TensorN
         std::vector<size_t> out_shape;
         for (size_t d = 0; d < ndim; ++d)
             if (d != static_cast<size_t>(axis)) out_shape.push_back(shape[d]);
+            else if (keepdims) out_shape.push_back(1);
 
         Tensor<int64_t> result(out_shape);
         for (size_t o = 0; o < outer; ++o) {
@@ -577,95 +610,222 @@ namespace TensorN
     }
 
     // ================================================================
-    // 2D Convolution (Native)
+    // Linear Kernel Attention（分块实现）
+    //
+    //   out_t = phi_t S / (phi_t · z)，S = Σ psi_s ⊗ v_s，z = Σ psi_s：
+    //     * 非 causal：s 取全部时间步；causal：s <= t
+    //   时间轴按 64 步分块，只保留 [D, d_v] 的状态，不生成 (L, D, d_v) 的外积：
+    //     * 块内：num = phi_c S_prev + tril(phi_c psi_c^T) V_c，den 同理取行和
+    //     * 块间：S += psi_c^T V_c，z += Σ psi_c
+    //   块内乘法用 tile_gemm；batch 少于线程数时把每条序列再切成若干段，
+    //   先并行求各段的状态，再取前缀（causal）或总和（非 causal）后并行输出。
     // ================================================================
 
-    template <typename T>
-    Tensor<T> conv2d(const Tensor<T>& input, const Tensor<T>& weight,
-                     const Tensor<T>& bias, int stride = 1, int padding = 0)
-    {
-        if (input.shape().size() != 4 || weight.shape().size() != 4)
-            TENSOR_THROW("conv2d: input and weight must be 4D");
-        if (bias.shape().size() != 1)
-            TENSOR_THROW("conv2d: bias must be 1D");
-
-        size_t N = input.shape()[0], C = input.shape()[1];
-        size_t H = input.shape()[2], W = input.shape()[3];
-        size_t K = weight.shape()[0];
-        size_t kH = weight.shape()[2], kW = weight.shape()[3];
-
-        int64_t oH = static_cast<int64_t>((H + 2 * padding - kH) / stride) + 1;
-        int64_t oW = static_cast<int64_t>((W + 2 * padding - kW) / stride) + 1;
-
-        Tensor<T> output({N, K, static_cast<size_t>(oH), static_cast<size_t>(oW)});
-
-        for (size_t n = 0; n < N; ++n)
-            for (size_t k = 0; k < K; ++k)
-                for (size_t oh = 0; oh < static_cast<size_t>(oH); ++oh)
-                    for (size_t ow = 0; ow < static_cast<size_t>(oW); ++ow) {
-                        T val = bias[k];
-                        for (size_t c = 0; c < C; ++c)
-                            for (size_t kh = 0; kh < kH; ++kh)
-                                for (size_t kw = 0; kw < kW; ++kw) {
-                                    int64_t ih = static_cast<int64_t>(oh * stride + kh) - padding;
-                                    int64_t iw = static_cast<int64_t>(ow * stride + kw) - padding;
-                                    if (ih >= 0 && ih < static_cast<int64_t>(H) &&
-                                        iw >= 0 && iw < static_cast<int64_t>(W))
-                                        val += input[{n, c, static_cast<size_t>(ih), static_cast<size_t>(iw)}]
-                                             * weight[{k, c, kh, kw}];
-                                }
-                        output[{n, k, oh, ow}] = val;
+    namespace linear_attn_detail
+    {
+        constexpr size_t CHUNK = 64;
+
+        template <typename T>
+        using acc_t = softmax_detail::acc_t<T>;
+
+        // 每个线程一份的块缓冲区；输入块先转成累加类型，psi 转置成 [D, CHUNK]
+        template <typename T>
+        struct Workspace
+        {
+            using A = acc_t<T>;
+            size_t D, dv;
+            std::vector<A> phi, psit, v, p, num, den;
+
+            Workspace(size_t D_, size_t dv_)
+                : D(D_), dv(dv_), phi(CHUNK * D_), psit(D_ * CHUNK), v(CHUNK * dv_),
+                  p(CHUNK * CHUNK), num(CHUNK * dv_), den(CHUNK) {}
+
+            void load(const T *phi_, const T *psi_, const T *v_, size_t n)
+            {
+                std::transform(phi_, phi_ + n * D, phi.begin(), [](T x) { return static_cast<A>(x); });
+                std::transform(v_, v_ + n * dv, v.begin(), [](T x) { return static_cast<A>(x); });
+                for (size_t j = 0; j < n; ++j)
+                    for (size_t k = 0; k < D; ++k)
+                        psit[k * CHUNK + j] = static_cast<A>(psi_[j * D + k]);
+            }
+
+            // 当前块并入状态：S[D, dv] += psi^T V，z[D] += Σ psi
+            void absorb(size_t n, A *S, A *z) const
+            {
+                tile_detail::tile_gemm(D, dv, n, psit.data(), CHUNK, v.data(), dv, S, dv, true);
+                for (size_t k = 0; k < D; ++k)
+                {
+                    A s = 0;
+                    const A *row = psit.data() + k * CHUNK;
+#pragma omp simd reduction(+ : s)
+                    for (size_t j = 0; j < n; ++j)
+                        s += row[j];
+                    z[k] += s;
+                }
+            }
+
+            // 写出当前块的 n 行；S / z 为块之前（causal）或全部（非 causal）的状态
+            void emit(size_t n, const A *S, const A *z, bool causal, T *out)
+            {
+                tile_detail::tile_gemm(n, dv, D, phi.data(), D, S, dv, num.data(), dv, false);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    A s = 0;
+                    const A *row = phi.data() + i * D;
+#pragma omp simd reduction(+ : s)
+                    for (size_t k = 0; k < D; ++k)
+                        s += row[k] * z[k];
+                    den[i] = s;
+                }
+                if (causal)
+                {
+                    // 块内：P = tril(phi psi^T)，num += P V，den += 行和
+                    tile_detail::tile_gemm(n, n, D, phi.data(), D, psit.data(), CHUNK, p.data(), CHUNK, false);
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        A *row = p.data() + i * CHUNK;
+                        std::fill(row + i + 1, row + n, A(0));
+                        A s = 0;
+                        for (size_t j = 0; j <= i; ++j)
+                            s += row[j];
+                        den[i] += s;
                     }
-        return output;
-    }
+                    tile_detail::tile_gemm(n, dv, n, p.data(), CHUNK, v.data(), dv, num.data(), dv, true);
+                }
+                for (size_t i = 0; i < n; ++i)
+                {
+                    A d = den[i];
+                    if (d < A(1e-8))
+                        d = A(1e-8);
+                    const A inv = A(1) / d;
+                    const A *src = num.data() + i * dv;
+                    T *dst = out + i * dv;
+                    for (size_t x = 0; x < dv; ++x)
+                        dst[x] = static_cast<T>(src[x] * inv);
+                }
+            }
+        };
 
-    // ================================================================
-    // Transposed 2D Convolution (Native)
-    // ================================================================
+        // phi / psi: [batch, L, D]，V / out: [batch, L, dv]
+        // carry: [batch, D * dv + D]，causal 时作为初始状态，结束后写回最终状态
+        template <typename T>
+        void run(const T *phi, const T *psi, const T *V, T *out,
+                 size_t batch, size_t L, size_t D, size_t dv, bool causal, acc_t<T> *carry = nullptr)
+        {
+            using A = acc_t<T>;
+            if (batch == 0 || L == 0)
+                return;
+            const size_t chunks = (L + CHUNK - 1) / CHUNK;
+            const size_t threads = static_cast<size_t>(softmax_detail::num_threads());
+            const size_t segs = batch >= threads ? 1 : std::max<size_t>(1, std::min(chunks, (threads + batch - 1) / batch));
+            const size_t span = (chunks + segs - 1) / segs * CHUNK; // 每段的时间步数
+            const size_t SZ = D * dv + D;                           // 一份状态：S 后接 z
+            const int64_t units = static_cast<int64_t>(batch * segs);
+            // causal 且不分段时直接在 carry 上推进
+            const bool in_place = causal && carry && segs == 1;
+            std::vector<A> state(in_place ? 0 : batch * segs * SZ, A(0));
+            A *base = in_place ? carry : state.data();
+
+            // 1. 各段自己的状态（causal 且不分段时不需要）
+            if (!causal || segs > 1)
+            {
+#pragma omp parallel if (units > 1)
+                {
+                    Workspace<T> w(D, dv);
+#pragma omp for schedule(static)
+                    for (int64_t u = 0; u < units; ++u)
+                    {
+                        const size_t b = static_cast<size_t>(u) / segs, t0 = static_cast<size_t>(u) % segs * span;
+                        A *S = state.data() + static_cast<size_t>(u) * SZ;
+                        for (size_t c0 = t0; c0 < std::min(L, t0 + span); c0 += CHUNK)
+                        {
+                            const size_t n = std::min(CHUNK, L - c0), off = b * L + c0;
+                            w.load(phi + off * D, psi + off * D, V + off * dv, n);
+                            w.absorb(n, S, S + D * dv);
+                        }
+                    }
+                }
 
-    template <typename T>
-    Tensor<T> conv_transpose2d(const Tensor<T>& input, const Tensor<T>& weight,
-                               const Tensor<T>& bias, int stride = 1, int padding = 0)
-    {
-        if (input.shape().size() != 4 || weight.shape().size() != 4)
-            TENSOR_THROW("conv_transpose2d: input and weight must be 4D");
-        if (bias.shape().size() != 1)
-            TENSOR_THROW("conv_transpose2d: bias must be 1D");
-
-        size_t N = input.shape()[0], C = input.shape()[1];
-        size_t H = input.shape()[2], W = input.shape()[3];
-        size_t K = weight.shape()[0];
-        size_t kH = weight.shape()[2], kW = weight.shape()[3];
-
-        size_t oH = (H - 1) * stride + kH - 2 * padding;
-        size_t oW = (W - 1) * stride + kW - 2 * padding;
-
-        Tensor<T> output({N, K, oH, oW});
-
-        for (size_t n = 0; n < N; ++n)
-            for (size_t c = 0; c < C; ++c)
-                for (size_t h = 0; h < H; ++h)
-                    for (size_t w = 0; w < W; ++w) {
-                        T in_val = input[{n, c, h, w}];
-                        for (size_t k = 0; k < K; ++k)
-                            for (size_t kh = 0; kh < kH; ++kh)
-                                for (size_t kw = 0; kw < kW; ++kw) {
-                                    int64_t oh = static_cast<int64_t>(h * stride + kh) - padding;
-                                    int64_t ow = static_cast<int64_t>(w * stride + kw) - padding;
-                                    if (oh >= 0 && oh < static_cast<int64_t>(oH) &&
-                                        ow >= 0 && ow < static_cast<int64_t>(oW))
-                                        output[{n, k, static_cast<size_t>(oh), static_cast<size_t>(ow)}]
-                                            += in_val * weight[{k, c, kh, kw}];
-                                }
+                // 2. 段间合并：causal 换成不含本段的前缀，非 causal 的总和放在第 0 段
+#pragma omp parallel for schedule(static) if (batch > 1)
+                for (int64_t b = 0; b < static_cast<int64_t>(batch); ++b)
+                {
+                    A *first = state.data() + static_cast<size_t>(b) * segs * SZ;
+                    if (causal)
+                    {
+                        A *init = carry ? carry + static_cast<size_t>(b) * SZ : nullptr;
+                        std::vector<A> prefix(SZ, A(0));
+                        if (init)
+                            std::copy(init, init + SZ, prefix.begin());
+                        for (size_t s = 0; s < segs; ++s)
+                        {
+                            A *cur = first + s * SZ;
+                            for (size_t i = 0; i < SZ; ++i)
+                            {
+                                const A own = cur[i];
+                                cur[i] = prefix[i];
+                                prefix[i] += own;
+                            }
+                        }
+                        if (init)
+                            std::copy(prefix.begin(), prefix.end(), init);
                     }
+                    else
+                        for (size_t s = 1; s < segs; ++s)
+                            for (size_t i = 0; i < SZ; ++i)
+                                first[i] += first[s * SZ + i];
+                }
+            }
 
-        for (size_t n = 0; n < N; ++n)
-            for (size_t k = 0; k < K; ++k)
-                for (size_t oh = 0; oh < oH; ++oh)
-                    for (size_t ow = 0; ow < oW; ++ow)
-                        output[{n, k, oh, ow}] += bias[k];
+            // 3. 输出：causal 逐块先输出再并入状态
+#pragma omp parallel if (units > 1)
+            {
+                Workspace<T> w(D, dv);
+#pragma omp for schedule(static)
+                for (int64_t u = 0; u < units; ++u)
+                {
+                    const size_t b = static_cast<size_t>(u) / segs, t0 = static_cast<size_t>(u) % segs * span;
+                    A *S = base + (causal ? static_cast<size_t>(u) : b * segs) * SZ;
+                    for (size_t c0 = t0; c0 < std::min(L, t0 + span); c0 += CHUNK)
+                    {
+                        const size_t n = std::min(CHUNK, L - c0), off = b * L + c0;
+                        w.load(phi + off * D, psi + off * D, V + off * dv, n);
+                        w.emit(n, S, S + D * dv, causal, out + off * dv);
+                        if (causal)
+                            w.absorb(n, S, S + D * dv);
+                    }
+                }
+            }
+        }
 
-        return output;
+        template <typename T>
+        opt<T> linear_attn(const Tensor<T> &phi, const Tensor<T> &psi, const Tensor<T> &V, bool causal, const char *name)
+        {
+            size_t ndim = phi.shape().size();
+            if (ndim < 2)
+                TENSOR_THROW(std::string(name) + ": tensors must have at least 2 dimensions");
+            if (!phi.is_isomorphic(psi))
+                TENSOR_THROW(std::string(name) + ": phi and psi must have same shape");
+
+            const auto &pshape = phi.shape();
+            const auto &vshape = V.shape();
+            if (pshape.size() != vshape.size())
+                TENSOR_THROW(std::string(name) + ": phi and V must have same number of dimensions");
+            for (size_t i = 0; i < pshape.size() - 1; ++i)
+                if (pshape[i] != vshape[i])
+                    TENSOR_THROW(std::string(name) + ": phi and V shape mismatch in batch+L dimensions");
+
+            const size_t L = pshape[ndim - 2], D = pshape[ndim - 1], d_v = vshape[ndim - 1];
+            size_t batch_size = 1;
+            for (size_t i = 0; i + 2 < ndim; ++i)
+                batch_size *= pshape[i];
+
+            opt<T> result(vshape);
+            if (result.tensor.size() != 0)
+                run(phi.data->data(), psi.data->data(), V.data->data(), result.tensor.data->data(),
+                    batch_size, L, D, d_v, causal);
+            return result;
+        }
     }
 
     // ================================================================
@@ -677,49 +837,7 @@ namespace TensorN
     template <typename T>
     opt<T> linear_kernels_attn(const Tensor<T> &phi, const Tensor<T> &psi, const Tensor<T> &V)
     {
-        size_t ndim = phi.shape().size();
-        if (ndim < 2)
-            TENSOR_THROW("linear_kernels_attn: tensors must have at least 2 dimensions");
-        if (!phi.is_isomorphic(psi))
-            TENSOR_THROW("linear_kernels_attn: phi and psi must have same shape");
-
-        const auto &pshape = phi.shape();
-        const auto &vshape = V.shape();
-        if (pshape.size() != vshape.size())
-            TENSOR_THROW("linear_kernels_attn: phi and V must have same number of dimensions");
-        for (size_t i = 0; i < pshape.size() - 1; ++i)
-            if (pshape[i] != vshape[i])
-                TENSOR_THROW("linear_kernels_attn: phi and V shape mismatch in batch+L dimensions");
-
-        size_t time_axis = ndim - 2;
-        size_t L = pshape[time_axis];
-        size_t d_v = vshape[ndim - 1];
-
-        auto C = sum(psi, time_axis).tensor;
-        auto outer_psi_V = einsum<T>("...ld,...lv->...ldv", psi, V).tensor;
-        auto S = sum(outer_psi_V, time_axis).tensor;
-        auto numerator = einsum<T>("...ld,...dv->...lv", phi, S).tensor;
-        auto denominator = einsum<T>("...ld,...d->...l", phi, C).tensor;
-
-        Tensor<T> result = numerator;
-
-        size_t batch_size = 1;
-        for (size_t i = 0; i < time_axis; ++i)
-            batch_size *= pshape[i];
-
-        for (size_t b = 0; b < batch_size; ++b)
-        {
-            for (size_t l = 0; l < L; ++l)
-            {
-                T denom = denominator[b * L + l];
-                if (denom < T(1e-8))
-                    denom = T(1e-8);
-                for (size_t v = 0; v < d_v; ++v)
-                    result[b * L * d_v + l * d_v + v] /= denom;
-            }
-        }
-
-        return opt<T>(result);
+        return linear_attn_detail::linear_attn(phi, psi, V, false, "linear_kernels_attn");
     }
 
     // ================================================================
@@ -731,51 +849,9 @@ namespace TensorN
     template <typename T>
     opt<T> linear_kernels_attn_causal(const Tensor<T> &phi, const Tensor<T> &psi, const Tensor<T> &V)
     {
-        size_t ndim = phi.shape().size();
-        if (ndim < 2)
-            TENSOR_THROW("linear_kernels_attn_causal: tensors must have at least 2 dimensions");
-        if (!phi.is_isomorphic(psi))
-            TENSOR_THROW("linear_kernels_attn_causal: phi and psi must have same shape");
-
-        const auto &pshape = phi.shape();
-        const auto &vshape = V.shape();
-        if (pshape.size() != vshape.size())
-            TENSOR_THROW("linear_kernels_attn_causal: phi and V must have same number of dimensions");
-        for (size_t i = 0; i < pshape.size() - 1; ++i)
-            if (pshape[i] != vshape[i])
-                TENSOR_THROW("linear_kernels_attn_causal: phi and V shape mismatch in batch+L dimensions");
-
-        size_t time_axis = ndim - 2;
-        size_t L = pshape[time_axis];
-        size_t d_v = vshape[ndim - 1];
-
-        auto C = cumsum(psi, time_axis).tensor;
-        auto outer_psi_V = einsum<T>("...ld,...lv->...ldv", psi, V).tensor;
-        auto S = cumsum(outer_psi_V, time_axis).tensor;
-        auto numerator = einsum<T>("...ld,...ldv->...lv", phi, S).tensor;
-        auto denominator = sum(hadamard(phi, C).tensor, ndim - 1).tensor;
-
-        Tensor<T> result = numerator;
-
-        size_t batch_size = 1;
-        for (size_t i = 0; i < time_axis; ++i)
-            batch_size *= pshape[i];
-
-        for (size_t b = 0; b < batch_size; ++b)
-        {
-            for (size_t l = 0; l < L; ++l)
-            {
-                T denom = denominator[b * L + l];
-                if (denom < T(1e-8))
-                    denom = T(1e-8);
-                for (size_t v = 0; v < d_v; ++v)
-                    result[b * L * d_v + l * d_v + v] /= denom;
-            }
-        }
-
-        return opt<T>(result);
+        return linear_attn_detail::linear_attn(phi, psi, V, true, "linear_kernels_attn_causal");
     }
 
 }
 
-#endif // !__OPERATIONS_H__
\ No newline at end of file
+#endif // !__OPERATIONS_H__
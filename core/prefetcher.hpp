@@ -0,0 +1,257 @@
+#pragma once
+#ifndef __PREFETCHER_HPP__
+#define __PREFETCHER_HPP__
+
+// ============================================================================
+// 异步加载与预取
+//
+//   * IOThreadPool：后台 I/O 线程池（进程内共享），任务以 std::future 返回。
+//   * load_async / load_multi_async：把同步加载器放到 I/O 线程上执行。
+//   * TensorPrefetcher：按顺序遍历文件列表，后台同时保持最多 depth 个文件
+//     在加载中，且已提交未取走的文件总大小不超过 memory_budget；调用方
+//     在计算第 k 个批次时，第 k+1.. 个文件已在后台读取。
+//
+// 加载器本身已经是 mmap + 多线程解析，I/O 线程只负责把阻塞的读 / 缺页
+// 从计算线程上移走，因此使用普通线程池而不是 io_uring。
+// ============================================================================
+
+#include "static.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace TensorN
+{
+    class IOThreadPool
+    {
+    private:
+        std::vector<std::thread> workers_;
+        std::queue<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stop_ = false;
+
+    public:
+        explicit IOThreadPool(size_t threads = default_threads())
+        {
+            if (threads == 0)
+                threads = 1;
+            workers_.reserve(threads);
+            for (size_t i = 0; i < threads; ++i)
+                workers_.emplace_back([this] { run(); });
+        }
+
+        ~IOThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            for (auto &w : workers_)
+                w.join();
+        }
+
+        IOThreadPool(const IOThreadPool &) = delete;
+        IOThreadPool &operator=(const IOThreadPool &) = delete;
+
+        static IOThreadPool &instance()
+        {
+            static IOThreadPool pool;
+            return pool;
+        }
+
+        // I/O 受限任务：线程数略多于核数的一半即可让磁盘保持忙碌
+        static size_t default_threads()
+        {
+            const size_t hw = std::thread::hardware_concurrency();
+            return std::min<size_t>(8, std::max<size_t>(2, hw / 2));
+        }
+
+        size_t size() const { return workers_.size(); }
+
+        template <typename F>
+        auto submit(F &&fn) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+        {
+            using R = std::invoke_result_t<std::decay_t<F>>;
+            auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+            std::future<R> result = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stop_)
+                    TENSOR_THROW("IOThreadPool is shutting down");
+                tasks_.emplace([task] { (*task)(); });
+            }
+            cv_.notify_one();
+            return result;
+        }
+
+    private:
+        void run()
+        {
+            for (;;)
+            {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                    if (tasks_.empty())
+                        return;
+                    task = std::move(tasks_.front());
+                    tasks_.pop();
+                }
+                task();
+            }
+        }
+    };
+
+    // 异步版本的 load<T>()，异常通过 future 传回
+    template <typename T>
+    std::future<Tensor<T>> load_async(const std::string &filename, const std::string &format = "auto")
+    {
+        return IOThreadPool::instance().submit([filename, format] { return load<T>(filename, format); });
+    }
+
+    // 按扩展名读取多张量文件（.safetensors / .gguf / .pt / .pth / .npz）
+    template <typename T>
+    std::unordered_map<std::string, Tensor<T>> load_multi(const std::string &filename)
+    {
+        auto ends_with = [&](const char *ext)
+        {
+            const size_t n = std::strlen(ext);
+            return filename.size() >= n && filename.compare(filename.size() - n, n, ext) == 0;
+        };
+        if (ends_with(".safetensors"))
+            return load_safetensors_multi<T>(filename);
+        if (ends_with(".gguf"))
+            return load_gguf_multi<T>(filename);
+        if (ends_with(".pt") || ends_with(".pth"))
+            return load_pt_multi<T>(filename);
+        if (ends_with(".npz"))
+            return load_npz_multi<T>(filename);
+        TENSOR_THROW("Cannot infer multi-tensor format from filename: " + filename);
+    }
+
+    template <typename T>
+    std::future<std::unordered_map<std::string, Tensor<T>>> load_multi_async(const std::string &filename)
+    {
+        return IOThreadPool::instance().submit([filename] { return load_multi<T>(filename); });
+    }
+
+    struct PrefetchOptions
+    {
+        size_t depth = 2;          // 同时在加载中的文件数上限
+        size_t memory_budget = 0;  // 已提交未取走的文件字节数上限，0 表示不限
+        IOThreadPool *pool = nullptr; // 为空时使用 IOThreadPool::instance()
+    };
+
+    // 顺序预取文件列表；Item 默认是 Tensor<T>，也可以是自定义加载器的返回值
+    template <typename T, typename Item = Tensor<T>>
+    class TensorPrefetcher
+    {
+    public:
+        using Loader = std::function<Item(const std::string &)>;
+
+    private:
+        struct Pending
+        {
+            std::future<Item> future;
+            size_t bytes;
+        };
+
+        std::vector<std::string> files_;
+        Loader loader_;
+        PrefetchOptions options_;
+        std::deque<Pending> pending_;
+        size_t issued_ = 0;   // 已提交的文件数
+        size_t consumed_ = 0; // 已被 next() 取走的文件数
+        size_t inflight_bytes_ = 0;
+
+    public:
+        TensorPrefetcher(std::vector<std::string> files, PrefetchOptions options = {},
+                         Loader loader = default_loader())
+            : files_(std::move(files)), loader_(std::move(loader)), options_(options)
+        {
+            if (options_.depth == 0)
+                options_.depth = 1;
+            fill();
+        }
+
+        // 析构时不等待：已提交的任务持有自己的文件名和加载器副本
+        ~TensorPrefetcher() = default;
+
+        TensorPrefetcher(const TensorPrefetcher &) = delete;
+        TensorPrefetcher &operator=(const TensorPrefetcher &) = delete;
+
+        size_t size() const { return files_.size(); }
+        size_t index() const { return consumed_; } // 下一次 next() 返回的文件序号
+        size_t in_flight() const { return pending_.size(); }
+        size_t in_flight_bytes() const { return inflight_bytes_; }
+        bool has_next() const { return consumed_ < files_.size(); }
+        const std::string &next_file() const { return files_.at(consumed_); }
+
+        // 阻塞直到下一个文件就绪；加载异常在这里重新抛出
+        Item next()
+        {
+            if (!has_next())
+                TENSOR_THROW("TensorPrefetcher: no more files");
+            Pending p = std::move(pending_.front());
+            pending_.pop_front();
+            inflight_bytes_ -= p.bytes;
+            ++consumed_;
+            fill(); // 先补充队列，等待期间后续文件已经开始读取
+            return p.future.get();
+        }
+
+    private:
+        static Loader default_loader()
+        {
+            if constexpr (std::is_same_v<Item, Tensor<T>>)
+                return [](const std::string &f) { return load<T>(f); };
+            else
+                return Loader();
+        }
+
+        static size_t file_bytes(const std::string &f)
+        {
+            std::error_code ec;
+            const auto n = std::filesystem::file_size(f, ec);
+            return ec ? 0 : static_cast<size_t>(n);
+        }
+
+        // 在 depth 和 memory_budget 允许的范围内继续提交；队列为空时至少提交一个
+        void fill()
+        {
+            if (!loader_)
+                TENSOR_THROW("TensorPrefetcher requires a loader");
+            IOThreadPool &pool = options_.pool ? *options_.pool : IOThreadPool::instance();
+            while (issued_ < files_.size() && pending_.size() < options_.depth)
+            {
+                const size_t bytes = file_bytes(files_[issued_]);
+                if (!pending_.empty() && options_.memory_budget != 0 &&
+                    inflight_bytes_ + bytes > options_.memory_budget)
+                    break;
+                Loader loader = loader_;
+                std::string file = files_[issued_];
+                pending_.push_back({pool.submit([loader, file] { return loader(file); }), bytes});
+                inflight_bytes_ += bytes;
+                ++issued_;
+            }
+        }
+    };
+
+} // namespace TensorN
+
+#endif // __PREFETCHER_HPP__
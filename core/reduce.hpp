@@ -0,0 +1,855 @@
+#pragma once
+#ifndef __REDUCE_HPP__
+#define __REDUCE_HPP__
+
+// ============================================================================
+// 通用规约引擎（原生与 BLAS 后端共用）
+//
+//   reduce<Acc, Out>(A, axes, keepdims, op)
+//     * axes 可含多个轴、可为负数；为空表示规约全部维度。
+//     * keepdims 为 true 时被规约的维度保留为 1。
+//     * Acc 为累加类型（默认由规约器决定，如求和用 double / int64_t），
+//       Out 为输出类型（默认与输入相同）。
+//     * op 是规约器对象：init / step / merge / finish 四个成员模板，
+//       可以带参数（例如 reducers::Lp 的 p）。
+//
+//   执行策略：先去掉长度为 1 的维度并合并相邻的同类维度，得到交替的
+//   “保留 / 规约”维度序列，然后：
+//     * 最内层维度被规约（连续规约）：每个输出沿连续内存规约，使用 8 路
+//       独立部分结果，内层循环可以向量化；
+//     * 最内层维度被保留（跨步规约）：每次处理 256 列，逐行把整行加到
+//       列累加器上，内层循环连续访问内存；
+//     * 输出足够多时按输出（或输出行 x 列块）并行；输出很少时（全局规约、
+//       按列统计）把规约维度切给各线程，最后按线程顺序合并部分结果，
+//       结果与线程调度无关。
+//
+//   矩统计（均值 / 方差 / 偏度 / 峰度 / 极值）只读一遍输入：连续输入按
+//   256 个元素分块，块内先求均值再求中心矩（块在 L1 中），块间以及线程间
+//   用 Chan 公式合并；跨步输入逐元素 Welford 更新。
+// ============================================================================
+
+#include "tensor.hpp"
+#include "softmax.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace TensorN
+{
+    namespace reduce_detail
+    {
+        constexpr size_t LANES = 8;                // 连续规约的独立部分结果数
+        constexpr size_t TILE = 256;               // 跨步规约每次处理的列数
+        constexpr size_t PARALLEL_MIN = 1 << 15;   // 元素数少于此值时不并行
+
+        // half / bfloat16 等按 float 计算
+        template <typename T>
+        using value_t = std::conditional_t<std::is_arithmetic_v<T>, T, float>;
+
+        // 求和类规约的默认累加类型
+        template <typename T>
+        using wide_t = std::conditional_t<
+            std::is_integral_v<T>,
+            std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>,
+            std::conditional_t<std::is_same_v<T, long double>, long double, double>>;
+
+        template <typename Out, typename V>
+        inline Out cast(const V &v)
+        {
+            if constexpr (std::is_same_v<Out, V> || std::is_arithmetic_v<Out>)
+                return static_cast<Out>(v);
+            else
+                return static_cast<Out>(static_cast<float>(v));
+        }
+
+        // 规约器声明 static constexpr bool nonempty = true 时，空规约报错
+        template <typename Op, typename = void>
+        struct requires_nonempty : std::false_type
+        {
+        };
+        template <typename Op>
+        struct requires_nonempty<Op, std::void_t<decltype(Op::nonempty)>> : std::bool_constant<Op::nonempty>
+        {
+        };
+
+        // 规约器可以提供 step_span(s, p, n) 处理一段连续输入（例如分块的在线 logsumexp）
+        template <typename Op, typename S, typename T, typename = void>
+        struct has_step_span : std::false_type
+        {
+        };
+        template <typename Op, typename S, typename T>
+        struct has_step_span<Op, S, T,
+                             std::void_t<decltype(std::declval<const Op &>().step_span(
+                                 std::declval<S &>(), std::declval<const T *>(), size_t()))>> : std::true_type
+        {
+        };
+
+        struct Dims
+        {
+            std::vector<size_t> size, stride;
+
+            size_t count() const
+            {
+                size_t n = 1;
+                for (size_t s : size)
+                    n *= s;
+                return n;
+            }
+        };
+
+        // 线性下标 -> 元素偏移
+        inline size_t offset_of(size_t linear, const Dims &d)
+        {
+            size_t off = 0;
+            for (size_t i = d.size.size(); i-- > 0;)
+            {
+                off += (linear % d.size[i]) * d.stride[i];
+                linear /= d.size[i];
+            }
+            return off;
+        }
+
+        // 按行主序遍历一组维度，增量维护偏移
+        class Odometer
+        {
+        private:
+            const Dims &_d;
+            std::vector<size_t> _idx;
+
+        public:
+            size_t offset = 0;
+
+            explicit Odometer(const Dims &d) : _d(d), _idx(d.size.size(), 0) {}
+
+            void seek(size_t linear)
+            {
+                offset = 0;
+                for (size_t i = _idx.size(); i-- > 0;)
+                {
+                    _idx[i] = linear % _d.size[i];
+                    offset += _idx[i] * _d.stride[i];
+                    linear /= _d.size[i];
+                }
+            }
+
+            void next()
+            {
+                for (size_t i = _idx.size(); i-- > 0;)
+                {
+                    offset += _d.stride[i];
+                    if (++_idx[i] < _d.size[i])
+                        return;
+                    offset -= _d.stride[i] * _d.size[i];
+                    _idx[i] = 0;
+                }
+            }
+        };
+
+        struct Plan
+        {
+            std::vector<size_t> out_shape;
+            Dims kept, red;             // 合并后的保留维度 / 规约维度（按原顺序）
+            bool inner_reduced = true;  // 最内层（步长为 1）的维度是否被规约
+            size_t n_out = 1, n_red = 1;
+        };
+
+        inline Plan make_plan(const std::vector<size_t> &shape, const std::vector<int> &axes, bool keepdims)
+        {
+            const size_t ndim = shape.size();
+            std::vector<bool> reduced(ndim, axes.empty());
+            for (int a : axes)
+            {
+                const int64_t d = a < 0 ? a + static_cast<int64_t>(ndim) : a;
+                if (d < 0 || d >= static_cast<int64_t>(ndim))
+                    TENSOR_THROW("reduce: axis out of range");
+                if (reduced[d])
+                    TENSOR_THROW("reduce: duplicate axis");
+                reduced[d] = true;
+            }
+
+            Plan plan;
+            std::vector<size_t> stride(ndim, 1);
+            for (size_t d = ndim; d-- > 1;)
+                stride[d - 1] = stride[d] * shape[d];
+
+            int last = -1; // 上一个合并组的类别：0 保留，1 规约
+            for (size_t d = 0; d < ndim; ++d)
+            {
+                if (reduced[d])
+                {
+                    plan.n_red *= shape[d];
+                    if (keepdims)
+                        plan.out_shape.push_back(1);
+                }
+                else
+                {
+                    plan.n_out *= shape[d];
+                    plan.out_shape.push_back(shape[d]);
+                }
+                if (shape[d] == 1)
+                    continue;
+                Dims &g = reduced[d] ? plan.red : plan.kept;
+                if (last == static_cast<int>(reduced[d]))
+                {
+                    g.size.back() *= shape[d];
+                    g.stride.back() = stride[d];
+                }
+                else
+                {
+                    g.size.push_back(shape[d]);
+                    g.stride.push_back(stride[d]);
+                }
+                last = static_cast<int>(reduced[d]);
+            }
+            plan.inner_reduced = last != 0;
+            return plan;
+        }
+
+        // 连续内存上的规约：LANES 路独立部分结果，最后合并
+        template <typename Acc, typename S, typename T, typename Op>
+        inline void reduce_span(const Op &op, S &s, const T *p, size_t n)
+        {
+            if constexpr (has_step_span<Op, S, T>::value)
+            {
+                op.step_span(s, p, n);
+                return;
+            }
+            if (n < 2 * LANES)
+            {
+                for (size_t j = 0; j < n; ++j)
+                    op.step(s, static_cast<Acc>(p[j]));
+                return;
+            }
+            S lane[LANES];
+            for (size_t k = 0; k < LANES; ++k)
+                lane[k] = op.template init<Acc>();
+            size_t j = 0;
+            for (; j + LANES <= n; j += LANES)
+            {
+#pragma omp simd
+                for (size_t k = 0; k < LANES; ++k)
+                    op.step(lane[k], static_cast<Acc>(p[j + k]));
+            }
+            for (; j < n; ++j)
+                op.step(lane[0], static_cast<Acc>(p[j]));
+            for (size_t k = 1; k < LANES; ++k)
+                op.merge(lane[0], lane[k]);
+            op.merge(s, lane[0]);
+        }
+
+        // 最内层维度被规约
+        template <typename Acc, typename Out, typename T, typename Op>
+        void reduce_contiguous(const T *src, const Plan &plan, const Op &op, Out *dst, int nt)
+        {
+            using S = decltype(op.template init<Acc>());
+            Dims outer = plan.red;
+            size_t L = 1;
+            if (!outer.size.empty())
+            {
+                L = outer.size.back();
+                outer.size.pop_back();
+                outer.stride.pop_back();
+            }
+            const size_t n_red = plan.n_red;
+
+            // 规约该输出的 [lo, hi) 号元素（按规约维度的行主序编号）
+            auto run = [&](size_t base, size_t lo, size_t hi, S &s)
+            {
+                Odometer od(outer);
+                od.seek(lo / L);
+                size_t j = lo % L;
+                for (size_t pos = lo; pos < hi; j = 0, od.next())
+                {
+                    const size_t len = std::min(L - j, hi - pos);
+                    reduce_span<Acc>(op, s, src + base + od.offset + j, len);
+                    pos += len;
+                }
+            };
+
+            if (nt == 1 || plan.n_out >= static_cast<size_t>(nt))
+            {
+#pragma omp parallel for schedule(static) if (nt > 1)
+                for (int64_t o = 0; o < static_cast<int64_t>(plan.n_out); ++o)
+                {
+                    S s = op.template init<Acc>();
+                    run(offset_of(static_cast<size_t>(o), plan.kept), 0, n_red, s);
+                    dst[o] = cast<Out>(op.finish(s, n_red));
+                }
+                return;
+            }
+
+            // 输出少于线程数：每个输出的规约区间切成 nt 段
+            std::vector<S> part(static_cast<size_t>(nt));
+            for (size_t o = 0; o < plan.n_out; ++o)
+            {
+                const size_t base = offset_of(o, plan.kept);
+#pragma omp parallel for schedule(static)
+                for (int64_t t = 0; t < nt; ++t)
+                {
+                    S s = op.template init<Acc>();
+                    run(base, n_red * t / nt, n_red * (t + 1) / nt, s);
+                    part[t] = s;
+                }
+                for (int t = 1; t < nt; ++t)
+                    op.merge(part[0], part[t]);
+                dst[o] = cast<Out>(op.finish(part[0], n_red));
+            }
+        }
+
+        // 最内层维度被保留：列方向连续，沿规约维度逐行累加
+        template <typename Acc, typename Out, typename T, typename Op>
+        void reduce_strided(const T *src, const Plan &plan, const Op &op, Out *dst, int nt)
+        {
+            using S = decltype(op.template init<Acc>());
+            Dims rows = plan.kept;
+            const size_t L = rows.size.back();
+            rows.size.pop_back();
+            rows.stride.pop_back();
+            const size_t P = rows.count();
+            const size_t tiles = (L + TILE - 1) / TILE;
+            const size_t units = P * tiles;
+            const size_t n_red = plan.n_red;
+
+            // 对第 [r_lo, r_hi) 个规约行累加 w 列
+            auto run = [&](size_t base, size_t w, size_t r_lo, size_t r_hi, S *acc)
+            {
+                Odometer od(plan.red);
+                od.seek(r_lo);
+                for (size_t r = r_lo; r < r_hi; ++r, od.next())
+                {
+                    const T *row = src + base + od.offset;
+#pragma omp simd
+                    for (size_t c = 0; c < w; ++c)
+                        op.step(acc[c], static_cast<Acc>(row[c]));
+                }
+            };
+
+            if (nt == 1 || units >= static_cast<size_t>(nt))
+            {
+#pragma omp parallel for schedule(static) if (nt > 1)
+                for (int64_t u = 0; u < static_cast<int64_t>(units); ++u)
+                {
+                    const size_t p = static_cast<size_t>(u) / tiles;
+                    const size_t c0 = static_cast<size_t>(u) % tiles * TILE;
+                    const size_t w = std::min(TILE, L - c0);
+                    S acc[TILE];
+                    for (size_t c = 0; c < w; ++c)
+                        acc[c] = op.template init<Acc>();
+                    run(offset_of(p, rows) + c0, w, 0, n_red, acc);
+                    Out *o = dst + p * L + c0;
+                    for (size_t c = 0; c < w; ++c)
+                        o[c] = cast<Out>(op.finish(acc[c], n_red));
+                }
+                return;
+            }
+
+            // 输出很少（例如按列统计）：把规约行切给各线程，每个线程保存全部输出的部分结果
+            const size_t n_out = plan.n_out;
+            std::vector<S> part(static_cast<size_t>(nt) * n_out, op.template init<Acc>());
+#pragma omp parallel for schedule(static)
+            for (int64_t t = 0; t < nt; ++t)
+            {
+                const size_t lo = n_red * t / nt, hi = n_red * (t + 1) / nt;
+                S *acc = part.data() + static_cast<size_t>(t) * n_out;
+                for (size_t p = 0; p < P; ++p)
+                    for (size_t c0 = 0; c0 < L; c0 += TILE)
+                        run(offset_of(p, rows) + c0, std::min(TILE, L - c0), lo, hi, acc + p * L + c0);
+            }
+            for (size_t i = 0; i < n_out; ++i)
+            {
+                for (int t = 1; t < nt; ++t)
+                    op.merge(part[i], part[static_cast<size_t>(t) * n_out + i]);
+                dst[i] = cast<Out>(op.finish(part[i], n_red));
+            }
+        }
+    }
+
+    // ================================================================
+    // 规约器
+    //   init<Acc>()        初始状态（通常是 Acc，也可以是结构体）
+    //   step(s, x)         累加一个元素（x 已转换为 Acc）
+    //   merge(s, other)    合并两个部分结果
+    //   finish(s, n)       n 为被规约的元素数
+    //   acc<T>             输入为 T 时的默认累加类型
+    // ================================================================
+    namespace reducers
+    {
+        struct Sum
+        {
+            template <typename T>
+            using acc = reduce_detail::wide_t<T>;
+            template <typename A>
+            A init() const { return A(0); }
+            template <typename A>
+            void step(A &s, A x) const { s += x; }
+            template <typename A>
+            void merge(A &s, const A &o) const { s += o; }
+            template <typename A>
+            A finish(const A &s, size_t) const { return s; }
+        };
+
+        struct Mean : Sum
+        {
+            template <typename T>
+            using acc = std::conditional_t<std::is_integral_v<T>, double, reduce_detail::wide_t<T>>;
+            template <typename A>
+            A finish(const A &s, size_t n) const { return s / static_cast<A>(n); }
+        };
+
+        struct Prod
+        {
+            template <typename T>
+            using acc = reduce_detail::wide_t<T>;
+            template <typename A>
+            A init() const { return A(1); }
+            template <typename A>
+            void step(A &s, A x) const { s *= x; }
+            template <typename A>
+            void merge(A &s, const A &o) const { s *= o; }
+            template <typename A>
+            A finish(const A &s, size_t) const { return s; }
+        };
+
+        // 最大值 / 最小值：NaN 会传播到结果
+        struct Max
+        {
+            static constexpr bool nonempty = true;
+            template <typename T>
+            using acc = reduce_detail::value_t<T>;
+            template <typename A>
+            A init() const
+            {
+                return std::numeric_limits<A>::has_infinity ? -std::numeric_limits<A>::infinity()
+                                                            : std::numeric_limits<A>::lowest();
+            }
+            template <typename A>
+            void step(A &s, A x) const { s = (x > s || x != x) ? x : s; }
+            template <typename A>
+            void merge(A &s, const A &o) const { step(s, o); }
+            template <typename A>
+            A finish(const A &s, size_t) const { return s; }
+        };
+
+        struct Min
+        {
+            static constexpr bool nonempty = true;
+            template <typename T>
+            using acc = reduce_detail::value_t<T>;
+            template <typename A>
+            A init() const
+            {
+                return std::numeric_limits<A>::has_infinity ? std::numeric_limits<A>::infinity()
+                                                            : std::numeric_limits<A>::max();
+            }
+            template <typename A>
+            void step(A &s, A x) const { s = (x < s || x != x) ? x : s; }
+            template <typename A>
+            void merge(A &s, const A &o) const { step(s, o); }
+            template <typename A>
+            A finish(const A &s, size_t) const { return s; }
+        };
+
+        // sum(|x|)，即 L1 范数
+        struct SumAbs : Sum
+        {
+            template <typename A>
+            void step(A &s, A x) const { s += x < A(0) ? -x : x; }
+        };
+
+        // sqrt(sum(x^2))，即 L2 范数
+        struct L2 : Sum
+        {
+            template <typename T>
+            using acc = std::conditional_t<std::is_integral_v<T>, double, reduce_detail::wide_t<T>>;
+            template <typename A>
+            void step(A &s, A x) const { s += x * x; }
+            template <typename A>
+            A finish(const A &s, size_t) const { return std::sqrt(s); }
+        };
+
+        // max(|x|)，即 L-inf 范数
+        struct MaxAbs : Max
+        {
+            template <typename A>
+            A init() const { return A(0); }
+            template <typename A>
+            void step(A &s, A x) const { Max::step(s, x < A(0) ? -x : x); }
+            template <typename A>
+            void merge(A &s, const A &o) const { Max::step(s, o); }
+        };
+
+        // (sum |x|^p)^(1/p)
+        struct Lp : L2
+        {
+            double p = 2;
+            Lp() = default;
+            explicit Lp(double p_) : p(p_) {}
+            template <typename A>
+            void step(A &s, A x) const { s += static_cast<A>(std::pow(std::abs(x), static_cast<A>(p))); }
+            template <typename A>
+            A finish(const A &s, size_t) const { return static_cast<A>(std::pow(s, static_cast<A>(1.0 / p))); }
+        };
+
+        // log(sum(exp(x)))，按在线 (max, sum) 统计，不会上溢
+        struct LogSumExp
+        {
+            template <typename T>
+            using acc = softmax_detail::acc_t<reduce_detail::value_t<T>>;
+            template <typename A>
+            OnlineSoftmax<A> init() const { return {}; }
+            // 无分支的在线更新（跨步规约时按列向量化）；相等时差值取 0，避免 inf - inf
+            template <typename A>
+            void step(OnlineSoftmax<A> &s, A x) const
+            {
+                const A m = x > s.max_value ? x : s.max_value;
+                const A d_old = s.max_value == m ? A(0) : s.max_value - m;
+                const A d_new = x == m ? A(0) : x - m;
+                s.sum = s.sum * softmax_detail::vexp<A>(d_old) + softmax_detail::vexp<A>(d_new);
+                s.max_value = m;
+            }
+            // 连续输入：分块统计，每块只缩放一次已有的和
+            template <typename A, typename T>
+            void step_span(OnlineSoftmax<A> &s, const T *p, size_t n) const
+            {
+                if constexpr (std::is_same_v<A, T>)
+                    s.update(p, n);
+                else
+                    for (size_t j = 0; j < n; ++j)
+                        step(s, static_cast<A>(p[j]));
+            }
+            template <typename A>
+            void merge(OnlineSoftmax<A> &s, const OnlineSoftmax<A> &o) const { s.merge(o); }
+            template <typename A>
+            A finish(const OnlineSoftmax<A> &s, size_t) const { return s.log_sum_exp(); }
+        };
+
+        // 补偿求和（Kahan）：按输入精度累加，误差不随元素数增长
+        template <typename A>
+        struct KahanState
+        {
+            A sum = 0;
+            A c = 0; // 已丢失的低位
+        };
+
+        struct KahanSum
+        {
+            template <typename T>
+            using acc = reduce_detail::value_t<T>;
+            template <typename A>
+            KahanState<A> init() const { return {}; }
+            template <typename A>
+            void step(KahanState<A> &s, A x) const
+            {
+                const A y = x - s.c;
+                const A t = s.sum + y;
+                s.c = (t - s.sum) - y;
+                s.sum = t;
+            }
+            template <typename A>
+            void merge(KahanState<A> &s, const KahanState<A> &o) const
+            {
+                step(s, o.sum);
+                step(s, -o.c);
+            }
+            template <typename A>
+            A finish(const KahanState<A> &s, size_t) const { return s.sum - s.c; }
+        };
+
+        // 成对求和：按输入精度累加，连续规约时误差为 O(log n)；跨步规约退化为顺序累加
+        struct PairwiseSum : Sum
+        {
+            template <typename T>
+            using acc = reduce_detail::value_t<T>;
+
+            template <typename A, typename T>
+            void step_span(A &s, const T *p, size_t n) const { s += pairwise<A>(p, n); }
+
+            template <typename A, typename T>
+            static A pairwise(const T *p, size_t n)
+            {
+                using reduce_detail::LANES;
+                if (n <= 16 * LANES)
+                {
+                    A lane[LANES] = {};
+                    size_t j = 0;
+                    for (; j + LANES <= n; j += LANES)
+                    {
+#pragma omp simd
+                        for (size_t k = 0; k < LANES; ++k)
+                            lane[k] += static_cast<A>(p[j + k]);
+                    }
+                    for (; j < n; ++j)
+                        lane[0] += static_cast<A>(p[j]);
+                    for (size_t w = LANES / 2; w > 0; w /= 2)
+                        for (size_t k = 0; k < w; ++k)
+                            lane[k] += lane[k + w];
+                    return lane[0];
+                }
+                const size_t h = n / 2 / LANES * LANES;
+                return pairwise<A>(p, h) + pairwise<A>(p + h, n - h);
+            }
+        };
+
+        // 矩统计的部分结果：m2..m4 为中心矩之和 sum((x - mean)^k)
+        template <typename A>
+        struct MomentState
+        {
+            A n = 0;
+            A mean = 0, m2 = 0, m3 = 0, m4 = 0;
+            A min = std::numeric_limits<A>::infinity();
+            A max = -std::numeric_limits<A>::infinity();
+        };
+
+        // 单遍矩统计，Order 为需要的最高阶矩（2..4），Extrema 同时记录最小 / 最大值；
+        // finish 返回 MomentState，派生的规约器再换算成方差等
+        template <int Order = 2, bool Extrema = false>
+        struct Moments
+        {
+            static_assert(Order >= 2 && Order <= 4, "Moments: Order must be 2, 3 or 4");
+            static constexpr size_t BLOCK = 256;
+
+            template <typename T>
+            using acc = std::conditional_t<std::is_integral_v<T>, double, reduce_detail::wide_t<T>>;
+            template <typename A>
+            MomentState<A> init() const { return {}; }
+
+            // Welford 逐元素更新
+            template <typename A>
+            void step(MomentState<A> &s, A x) const
+            {
+                const A n1 = s.n;
+                s.n = n1 + A(1);
+                const A delta = x - s.mean;
+                const A dn = delta / s.n;
+                const A term = delta * dn * n1;
+                if constexpr (Order >= 4)
+                    s.m4 += term * dn * dn * (s.n * s.n - A(3) * s.n + A(3)) + A(6) * dn * dn * s.m2 - A(4) * dn * s.m3;
+                if constexpr (Order >= 3)
+                    s.m3 += term * dn * (s.n - A(2)) - A(3) * dn * s.m2;
+                s.m2 += term;
+                s.mean += dn;
+                if constexpr (Extrema)
+                {
+                    s.min = x < s.min ? x : s.min;
+                    s.max = x > s.max ? x : s.max;
+                }
+            }
+
+            // 连续输入：每块先求块均值，再求块内中心矩，然后与已有结果合并
+            template <typename A, typename T>
+            void step_span(MomentState<A> &s, const T *p, size_t n) const
+            {
+                for (size_t j0 = 0; j0 < n; j0 += BLOCK)
+                {
+                    const size_t len = std::min(BLOCK, n - j0);
+                    const T *x = p + j0;
+                    A sum = 0;
+#pragma omp simd reduction(+ : sum)
+                    for (size_t j = 0; j < len; ++j)
+                        sum += static_cast<A>(x[j]);
+                    MomentState<A> b;
+                    b.n = static_cast<A>(len);
+                    b.mean = sum / b.n;
+                    A s2 = 0, s3 = 0, s4 = 0, lo = b.min, hi = b.max;
+                    const A m = b.mean;
+#pragma omp simd reduction(+ : s2, s3, s4) reduction(min : lo) reduction(max : hi)
+                    for (size_t j = 0; j < len; ++j)
+                    {
+                        const A v = static_cast<A>(x[j]);
+                        const A d = v - m;
+                        const A d2 = d * d;
+                        s2 += d2;
+                        if constexpr (Order >= 3)
+                            s3 += d2 * d;
+                        if constexpr (Order >= 4)
+                            s4 += d2 * d2;
+                        if constexpr (Extrema)
+                        {
+                            lo = v < lo ? v : lo;
+                            hi = v > hi ? v : hi;
+                        }
+                    }
+                    b.m2 = s2;
+                    b.m3 = s3;
+                    b.m4 = s4;
+                    b.min = lo;
+                    b.max = hi;
+                    merge(s, b);
+                }
+            }
+
+            // Chan / Pébay 合并公式
+            template <typename A>
+            void merge(MomentState<A> &s, const MomentState<A> &o) const
+            {
+                if (o.n == A(0))
+                    return;
+                if (s.n == A(0))
+                {
+                    s = o;
+                    return;
+                }
+                const A na = s.n, nb = o.n, n = na + nb;
+                const A delta = o.mean - s.mean;
+                const A dn = delta / n;
+                if constexpr (Order >= 4)
+                    s.m4 += o.m4 + delta * dn * dn * dn * na * nb * (na * na - na * nb + nb * nb) +
+                            A(6) * dn * dn * (na * na * o.m2 + nb * nb * s.m2) + A(4) * dn * (na * o.m3 - nb * s.m3);
+                if constexpr (Order >= 3)
+                    s.m3 += o.m3 + delta * dn * dn * na * nb * (na - nb) + A(3) * dn * (na * o.m2 - nb * s.m2);
+                s.m2 += o.m2 + delta * dn * na * nb;
+                s.mean += dn * nb;
+                s.n = n;
+                if constexpr (Extrema)
+                {
+                    s.min = o.min < s.min ? o.min : s.min;
+                    s.max = o.max > s.max ? o.max : s.max;
+                }
+            }
+
+            template <typename A>
+            MomentState<A> finish(const MomentState<A> &s, size_t) const { return s; }
+        };
+
+        // 方差，除数为 n - ddof（ddof = 0 为总体方差，1 为样本方差）
+        struct Variance : Moments<2>
+        {
+            double ddof = 0;
+            Variance() = default;
+            explicit Variance(double ddof_) : ddof(ddof_) {}
+            template <typename A>
+            A finish(const MomentState<A> &s, size_t) const
+            {
+                const A d = s.n - static_cast<A>(ddof);
+                return d > A(0) ? s.m2 / d : std::numeric_limits<A>::quiet_NaN();
+            }
+        };
+
+        struct StdDev : Variance
+        {
+            using Variance::Variance;
+            template <typename A>
+            A finish(const MomentState<A> &s, size_t n) const { return std::sqrt(Variance::finish(s, n)); }
+        };
+
+        // 偏度 g1 = sqrt(n) * m3 / m2^1.5（有偏估计，与 scipy.stats.skew 默认一致）
+        struct Skewness : Moments<3>
+        {
+            template <typename A>
+            A finish(const MomentState<A> &s, size_t) const
+            {
+                return std::sqrt(s.n) * s.m3 / (s.m2 * std::sqrt(s.m2));
+            }
+        };
+
+        // 超额峰度 g2 = n * m4 / m2^2 - 3（有偏估计，与 scipy.stats.kurtosis 默认一致）
+        struct Kurtosis : Moments<4>
+        {
+            template <typename A>
+            A finish(const MomentState<A> &s, size_t) const { return s.n * s.m4 / (s.m2 * s.m2) - A(3); }
+        };
+    } // namespace reducers
+
+    // 多轴规约；Acc / Out 为 void 时分别取规约器默认累加类型和输入类型
+    template <typename Acc = void, typename Out = void, typename T, typename Op>
+    Tensor<std::conditional_t<std::is_void_v<Out>, T, Out>>
+    reduce(const Tensor<T> &A, const std::vector<int> &axes, bool keepdims, const Op &op)
+    {
+        using acc_type = std::conditional_t<std::is_void_v<Acc>, typename Op::template acc<T>, Acc>;
+        using out_type = std::conditional_t<std::is_void_v<Out>, T, Out>;
+
+        const reduce_detail::Plan plan = reduce_detail::make_plan(A.shape(), axes, keepdims);
+        Tensor<out_type> result(plan.out_shape);
+        if (plan.n_out == 0)
+            return result;
+        out_type *dst = result.data->data();
+        if (plan.n_red == 0)
+        {
+            if constexpr (reduce_detail::requires_nonempty<Op>::value)
+                TENSOR_THROW("reduce: zero-size reduction has no identity");
+            else
+            {
+                const auto s = op.template init<acc_type>();
+                std::fill(dst, dst + plan.n_out, reduce_detail::cast<out_type>(op.finish(s, 0)));
+                return result;
+            }
+        }
+
+        const int nt = A.size() >= reduce_detail::PARALLEL_MIN ? softmax_detail::num_threads() : 1;
+        if (plan.inner_reduced)
+            reduce_detail::reduce_contiguous<acc_type>(A.data->data(), plan, op, dst, nt);
+        else
+            reduce_detail::reduce_strided<acc_type>(A.data->data(), plan, op, dst, nt);
+        return result;
+    }
+
+    // 一次遍历得到的全部统计量，形状与 reduce(A, axes, keepdims, ...) 的输出相同
+    template <typename T>
+    struct MomentStats
+    {
+        size_t count = 0; // 每个输出规约的元素数
+        Tensor<T> mean, var, stddev, skew, kurtosis, min, max;
+    };
+
+    // var / stddev 的除数为 count - ddof；skew / kurtosis 为有偏估计（超额峰度）；
+    // 整数输入默认输出 double
+    template <typename Acc = void, typename Out = void, typename T>
+    auto moments(const Tensor<T> &A, const std::vector<int> &axes = {}, bool keepdims = false, double ddof = 0)
+    {
+        using op_t = reducers::Moments<4, true>;
+        using acc_type = std::conditional_t<std::is_void_v<Acc>, typename op_t::template acc<T>, Acc>;
+        using state_t = reducers::MomentState<acc_type>;
+        using out_type = std::conditional_t<std::is_void_v<Out>,
+                                            std::conditional_t<std::is_integral_v<T>, double, T>, Out>;
+
+        const Tensor<state_t> st = reduce<acc_type, state_t>(A, axes, keepdims, op_t{});
+        MomentStats<out_type> r;
+        const auto &shape = st.shape();
+        r.count = st.size() ? static_cast<size_t>(st[0].n) : 0;
+        r.mean = Tensor<out_type>(shape);
+        r.var = Tensor<out_type>(shape);
+        r.stddev = Tensor<out_type>(shape);
+        r.skew = Tensor<out_type>(shape);
+        r.kurtosis = Tensor<out_type>(shape);
+        r.min = Tensor<out_type>(shape);
+        r.max = Tensor<out_type>(shape);
+
+        const reducers::Variance var_op(ddof);
+        const reducers::Skewness skew_op;
+        const reducers::Kurtosis kurt_op;
+        for (size_t i = 0; i < st.size(); ++i)
+        {
+            const state_t &s = st[i];
+            const acc_type v = var_op.finish(s, 0);
+            (*r.mean.data)[i] = reduce_detail::cast<out_type>(s.n > 0 ? s.mean : std::numeric_limits<acc_type>::quiet_NaN());
+            (*r.var.data)[i] = reduce_detail::cast<out_type>(v);
+            (*r.stddev.data)[i] = reduce_detail::cast<out_type>(std::sqrt(v));
+            (*r.skew.data)[i] = reduce_detail::cast<out_type>(skew_op.finish(s, 0));
+            (*r.kurtosis.data)[i] = reduce_detail::cast<out_type>(kurt_op.finish(s, 0));
+            (*r.min.data)[i] = reduce_detail::cast<out_type>(s.min);
+            (*r.max.data)[i] = reduce_detail::cast<out_type>(s.max);
+        }
+        return r;
+    }
+
+    // p = 1 / 2 / inf 使用专门的规约器，其余走 reducers::Lp
+    template <typename T>
+    Tensor<T> reduce_norm(const Tensor<T> &A, const std::vector<int> &axes, bool keepdims, double p)
+    {
+        if (p == 2)
+            return reduce(A, axes, keepdims, reducers::L2{});
+        if (p == 1)
+            return reduce(A, axes, keepdims, reducers::SumAbs{});
+        if (std::isinf(p) && p > 0)
+            return reduce(A, axes, keepdims, reducers::MaxAbs{});
+        if (!(p > 0))
+            TENSOR_THROW("norm: p must be positive");
+        return reduce(A, axes, keepdims, reducers::Lp(p));
+    }
+
+} // namespace TensorN
+
+#endif // __REDUCE_HPP__
@@ -0,0 +1,343 @@
+#pragma once
+#ifndef __SOFTMAX_HPP__
+#define __SOFTMAX_HPP__
+
+// ============================================================================
+// N 维 softmax / log_softmax 内核（原生与 BLAS 后端共用）
+//
+//   * 任意轴：把张量看作 [outer, n, inner]，n 为 softmax 轴的长度。
+//   * inner == 1（最后一维）：逐行在线（online）统计最大值与指数和，
+//     按 256 个元素分块：先求块内最大值，必要时把已有的和按 exp(m_old - m_new)
+//     缩放一次，再累加块内 exp；统计只读一遍输入，第二遍写出结果。
+//   * inner > 1（非最后一维）：按 inner 方向每次处理 64 列，沿轴逐行做在线
+//     更新，内层循环连续访问内存，不需要转置或拷贝。
+//   * float（以及 half / bfloat16 等，按 float 累加）使用无分支的多项式 exp，
+//     热循环标注 omp simd（-O2 下也会向量化）；double 使用 std::exp。
+//   * OpenMP 按外层行（或 outer x 列块）并行；只有一行且很长时（1D），
+//     把行切成若干段分别统计，再合并各段的 (max, sum)。
+// ============================================================================
+
+#include "tensor.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_bit_cast)
+#define TENSORN_HAS_BUILTIN_BIT_CAST 1
+#endif
+#endif
+
+namespace TensorN
+{
+    namespace softmax_detail
+    {
+        constexpr size_t BLOCK = 256;          // 在线统计的分块长度
+        constexpr size_t TILE = 64;            // 非最后一维时每次处理的列数
+        constexpr size_t SPLIT_MIN = 1 << 15;  // 单行长度超过此值时按段并行
+
+        template <typename T>
+        using acc_t = std::conditional_t<std::is_same_v<T, double> || std::is_same_v<T, long double>, T, float>;
+
+        inline int num_threads()
+        {
+#ifdef _OPENMP
+            return omp_get_max_threads();
+#else
+            return 1;
+#endif
+        }
+
+        template <typename To, typename From>
+        inline To bit_cast(From v)
+        {
+#ifdef TENSORN_HAS_BUILTIN_BIT_CAST
+            return __builtin_bit_cast(To, v); // memcpy 会阻止 GCC 向量化
+#else
+            To r;
+            std::memcpy(&r, &v, sizeof(r));
+            return r;
+#endif
+        }
+
+        // Cephes 风格的 expf：x = n ln2 + g，|g| <= ln2 / 2，6 阶多项式，误差约 1 ulp。
+        // 全部是算术和选择（取整用 1.5 * 2^23 加减，不用 floor / 浮点转整数），
+        // 在 omp simd 循环中可以向量化；x < -88.37 返回 0，NaN 保持 NaN。
+        inline float exp_approx(float x)
+        {
+            constexpr float hi = 88.3762626647949f;
+            constexpr float lo = -88.3762626647949f;
+            constexpr float round = 12582912.0f; // 1.5 * 2^23
+            float xc = x > hi ? hi : x;
+            xc = xc < lo ? lo : xc;
+            const float z = xc * 1.44269504088896341f + round;
+            const float fx = z - round; // round(x / ln2)
+            const float g = xc - fx * 0.693359375f + fx * 2.12194440e-4f;
+            float y = 1.9875691500e-4f;
+            y = y * g + 1.3981999507e-3f;
+            y = y * g + 8.3334519073e-3f;
+            y = y * g + 4.1665795894e-2f;
+            y = y * g + 1.6666665459e-1f;
+            y = y * g + 5.0000001201e-1f;
+            y = y * g * g + g + 1.0f;
+            // z 的低位就是 n：2^n 的位模式为 (n + 127) << 23
+            const int32_t bits = (bit_cast<int32_t>(z) - bit_cast<int32_t>(round) + 127) << 23;
+            const float r = y * bit_cast<float>(bits);
+            return x < lo ? 0.0f : r;
+        }
+
+        template <typename A>
+        inline A vexp(A x)
+        {
+            if constexpr (std::is_same_v<A, float>)
+                return exp_approx(x);
+            else
+                return std::exp(x);
+        }
+    }
+
+    // 在线 softmax 统计量：流式输入 logits，随时得到 max 与 sum(exp(x - max))；
+    // 两个分段的统计量可以合并（用于按段并行或分块注意力）。
+    template <typename T>
+    struct OnlineSoftmax
+    {
+        using acc_type = softmax_detail::acc_t<T>;
+
+        acc_type max_value = -std::numeric_limits<acc_type>::infinity();
+        acc_type sum = 0;
+
+        void update(acc_type x)
+        {
+            if (x > max_value)
+            {
+                sum = sum * softmax_detail::vexp<acc_type>(max_value - x) + acc_type(1);
+                max_value = x;
+            }
+            else if (max_value != -std::numeric_limits<acc_type>::infinity() || x != x)
+                sum += softmax_detail::vexp<acc_type>(x - max_value);
+        }
+
+        // 连续输入：每块只缩放一次已有的和，块内 exp 可以向量化
+        void update(const T *x, size_t n)
+        {
+            using softmax_detail::BLOCK;
+            constexpr acc_type neg_inf = -std::numeric_limits<acc_type>::infinity();
+            for (size_t j0 = 0; j0 < n; j0 += BLOCK)
+            {
+                const size_t j1 = std::min(n, j0 + BLOCK);
+                acc_type bm = neg_inf;
+#pragma omp simd reduction(max : bm)
+                for (size_t j = j0; j < j1; ++j)
+                {
+                    const acc_type v = static_cast<acc_type>(x[j]);
+                    bm = v > bm ? v : bm;
+                }
+                if (bm > max_value)
+                {
+                    sum *= softmax_detail::vexp<acc_type>(max_value - bm);
+                    max_value = bm;
+                }
+                if (max_value == neg_inf)
+                {
+                    // 全是 -inf 的块不贡献；NaN 仍需要传播
+                    for (size_t j = j0; j < j1; ++j)
+                        if (x[j] != x[j])
+                            sum = static_cast<acc_type>(x[j]);
+                    continue;
+                }
+                const acc_type m = max_value;
+                acc_type bs = 0;
+#pragma omp simd reduction(+ : bs)
+                for (size_t j = j0; j < j1; ++j)
+                    bs += softmax_detail::vexp<acc_type>(static_cast<acc_type>(x[j]) - m);
+                sum += bs;
+            }
+        }
+
+        void merge(const OnlineSoftmax &other)
+        {
+            if (other.max_value > max_value)
+            {
+                sum = sum * softmax_detail::vexp<acc_type>(max_value - other.max_value) + other.sum;
+                max_value = other.max_value;
+            }
+            else if (other.max_value != -std::numeric_limits<acc_type>::infinity())
+                sum += other.sum * softmax_detail::vexp<acc_type>(other.max_value - max_value);
+            else
+                sum += other.sum; // 只有 NaN 时会走到这里
+        }
+
+        acc_type log_sum_exp() const { return max_value + std::log(sum); }
+    };
+
+    namespace softmax_detail
+    {
+        // 按统计量写出一行（连续）
+        template <typename T>
+        void write_row(const T *src, T *dst, size_t n, const OnlineSoftmax<T> &st, bool log)
+        {
+            using A = acc_t<T>;
+            if (log)
+            {
+                const A lse = st.log_sum_exp();
+#pragma omp simd
+                for (size_t j = 0; j < n; ++j)
+                    dst[j] = static_cast<T>(static_cast<A>(src[j]) - lse);
+            }
+            else
+            {
+                const A m = st.max_value;
+                const A inv = A(1) / st.sum;
+#pragma omp simd
+                for (size_t j = 0; j < n; ++j)
+                    dst[j] = static_cast<T>(vexp<A>(static_cast<A>(src[j]) - m) * inv);
+            }
+        }
+
+        // 最后一维：[rows, n]
+        template <typename T>
+        void softmax_rows(const T *src, T *dst, size_t rows, size_t n, bool log)
+        {
+            const int threads = num_threads();
+            if (rows == 1 && n >= SPLIT_MIN && threads > 1)
+            {
+                // 单个长行：各段分别统计后合并，再并行写出
+                const int64_t parts = threads;
+                const size_t seg = (n + static_cast<size_t>(parts) - 1) / static_cast<size_t>(parts);
+                std::vector<OnlineSoftmax<T>> partial(static_cast<size_t>(parts));
+#pragma omp parallel for schedule(static)
+                for (int64_t p = 0; p < parts; ++p)
+                {
+                    const size_t j0 = std::min(n, static_cast<size_t>(p) * seg);
+                    partial[static_cast<size_t>(p)].update(src + j0, std::min(n, j0 + seg) - j0);
+                }
+                OnlineSoftmax<T> st;
+                for (const auto &p : partial)
+                    st.merge(p);
+#pragma omp parallel for schedule(static)
+                for (int64_t p = 0; p < parts; ++p)
+                {
+                    const size_t j0 = std::min(n, static_cast<size_t>(p) * seg);
+                    write_row(src + j0, dst + j0, std::min(n, j0 + seg) - j0, st, log);
+                }
+                return;
+            }
+
+#pragma omp parallel for schedule(static) if (rows > 1 && rows * n >= 4096)
+            for (int64_t r = 0; r < static_cast<int64_t>(rows); ++r)
+            {
+                const T *x = src + static_cast<size_t>(r) * n;
+                OnlineSoftmax<T> st;
+                st.update(x, n);
+                write_row(x, dst + static_cast<size_t>(r) * n, n, st, log);
+            }
+        }
+
+        // 非最后一维：[outer, n, inner]，沿 n 归一化；每个任务处理 TILE 列
+        template <typename T>
+        void softmax_strided(const T *src, T *dst, size_t outer, size_t n, size_t inner, bool log)
+        {
+            using A = acc_t<T>;
+            constexpr A neg_inf = -std::numeric_limits<A>::infinity();
+            const size_t tiles = (inner + TILE - 1) / TILE;
+            const int64_t tasks = static_cast<int64_t>(outer * tiles);
+
+#pragma omp parallel for schedule(static) if (tasks > 1 && outer * n * inner >= 4096)
+            for (int64_t t = 0; t < tasks; ++t)
+            {
+                const size_t o = static_cast<size_t>(t) / tiles;
+                const size_t i0 = static_cast<size_t>(t) % tiles * TILE;
+                const size_t w = std::min(TILE, inner - i0);
+                const T *base = src + o * n * inner + i0;
+                T *out = dst + o * n * inner + i0;
+
+                A m[TILE], s[TILE];
+                for (size_t i = 0; i < w; ++i)
+                {
+                    m[i] = neg_inf;
+                    s[i] = 0;
+                }
+                // 在线统计：每行一次 max 更新、一次缩放
+                for (size_t r = 0; r < n; ++r)
+                {
+                    const T *x = base + r * inner;
+#pragma omp simd
+                    for (size_t i = 0; i < w; ++i)
+                    {
+                        const A v = static_cast<A>(x[i]);
+                        const A nm = v > m[i] ? v : m[i];
+                        const A scale = nm == neg_inf ? A(1) : vexp<A>(m[i] - nm);
+                        const A e = nm == neg_inf ? A(0) : vexp<A>(v - nm);
+                        s[i] = s[i] * scale + e;
+                        m[i] = nm;
+                    }
+                }
+                if (log)
+                {
+                    for (size_t i = 0; i < w; ++i)
+                        m[i] += std::log(s[i]);
+                    for (size_t r = 0; r < n; ++r)
+                    {
+                        const T *x = base + r * inner;
+                        T *y = out + r * inner;
+#pragma omp simd
+                        for (size_t i = 0; i < w; ++i)
+                            y[i] = static_cast<T>(static_cast<A>(x[i]) - m[i]);
+                    }
+                }
+                else
+                {
+                    for (size_t i = 0; i < w; ++i)
+                        s[i] = A(1) / s[i];
+                    for (size_t r = 0; r < n; ++r)
+                    {
+                        const T *x = base + r * inner;
+                        T *y = out + r * inner;
+#pragma omp simd
+                        for (size_t i = 0; i < w; ++i)
+                            y[i] = static_cast<T>(vexp<A>(static_cast<A>(x[i]) - m[i]) * s[i]);
+                    }
+                }
+            }
+        }
+
+        // 检查 axis 并写出 softmax / log_softmax 到 result（形状与 A 相同）
+        template <typename T>
+        void softmax_nd(const Tensor<T> &A, int axis, bool log, Tensor<T> &result)
+        {
+            const auto &shape = A.shape();
+            const size_t ndim = shape.size();
+            if (axis < 0)
+                axis += static_cast<int>(ndim);
+            if (axis < 0 || static_cast<size_t>(axis) >= ndim)
+                TENSOR_THROW(log ? "Log-softmax axis out of range" : "Softmax axis out of range");
+
+            size_t outer = 1, inner = 1;
+            const size_t n = shape[static_cast<size_t>(axis)];
+            for (size_t d = 0; d < static_cast<size_t>(axis); ++d)
+                outer *= shape[d];
+            for (size_t d = static_cast<size_t>(axis) + 1; d < ndim; ++d)
+                inner *= shape[d];
+            if (outer * n * inner == 0)
+                return;
+
+            const T *src = A.data->data();
+            T *dst = result.data->data();
+            if (inner == 1)
+                softmax_rows(src, dst, outer, n, log);
+            else
+                softmax_strided(src, dst, outer, n, inner, log);
+        }
+    }
+
+} // namespace TensorN
+
+#endif // __SOFTMAX_HPP__
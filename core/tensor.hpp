@@ -13,6 +13,8 @@
 #include <numeric>
 #include <cassert>
 #include <functional>
+#include <array>
+#include <type_traits>
 #include "dtypes.hpp"
 #include "memory_pool.hpp"
 
@@ -29,6 +31,11 @@
 #define TENSOR_THROW(msg) \
     throw TensorN::TensorException(msg, __FILE__, __FUNCTION__, __LINE__)
 
+// 多维下标访问 A(i, j, ...) 的边界检查：默认关闭（热循环使用），调试时定义为 1
+#ifndef TENSORN_BOUNDS_CHECK
+#define TENSORN_BOUNDS_CHECK 0
+#endif
+
 namespace TensorN
 {
     class TensorException : public std::runtime_error
@@ -56,12 +63,21 @@ namespace TensorN
     template <typename T>
     class opt;
 
+    // 4D 张量的通道布局。数据始终按 shape 行主序存放，标记只决定卷积 / 池化
+    // 如何解释 shape：NCHW 为 [N, C, H, W]，NHWC（channels-last）为 [N, H, W, C]
+    enum class Layout : uint8_t
+    {
+        NCHW,
+        NHWC
+    };
+
     template <typename T>
     class Tensor
     {
     private:
         size_t _size = 0;
         std::vector<size_t> _shape;
+        Layout _layout = Layout::NCHW;
 
         void format_recursive(std::ostream &os, const std::vector<T> &data,
                               const std::vector<size_t> &shape,
@@ -127,8 +143,8 @@ namespace TensorN
         std::shared_ptr<std::vector<T>> data;
 
         Tensor() = default;
-        Tensor(const Tensor<T> &other) : _size(other._size), _shape(other._shape), data(std::make_shared<std::vector<T>>(*other.data)) {}
-        Tensor(Tensor<T> &&other) noexcept : _size(other._size), _shape(std::move(other._shape)), data(std::move(other.data))
+        Tensor(const Tensor<T> &other) : _size(other._size), _shape(other._shape), _layout(other._layout), data(std::make_shared<std::vector<T>>(*other.data)) {}
+        Tensor(Tensor<T> &&other) noexcept : _size(other._size), _shape(std::move(other._shape)), _layout(other._layout), data(std::move(other.data))
         {
             other._size = 0;
             other._shape.clear();
@@ -161,6 +177,7 @@ namespace TensorN
             {
                 _size = other._size;
                 _shape = other._shape;
+                _layout = other._layout;
                 data = std::make_shared<std::vector<T>>(*other.data);
             }
             return *this;
@@ -172,6 +189,7 @@ namespace TensorN
             {
                 _size = other._size;
                 _shape = std::move(other._shape);
+                _layout = other._layout;
                 data = std::move(other.data);
                 other._size = 0;
                 other._shape.clear();
@@ -189,10 +207,23 @@ namespace TensorN
             Tensor<T> result;
             result._size = _size;
             result._shape = _shape;
+            result._layout = _layout;
             result.data = data;
             return result;
         }
 
+        Layout layout() const
+        {
+            return _layout;
+        }
+
+        // 只改标记，不移动数据；布局转换见 to_nhwc / to_nchw
+        Tensor<T> &set_layout(Layout layout)
+        {
+            _layout = layout;
+            return *this;
+        }
+
         size_t size() const
         {
             return _size;
@@ -405,6 +436,58 @@ namespace TensorN
         {
             return (*data)[index];
         }
+
+        // 多维下标访问 A(i, j, k)：不分配内存，默认不检查边界；
+        // TENSORN_BOUNDS_CHECK=1 时检查维数与范围（与 A[{i, j, k}] 相同的异常）
+        template <typename... Idx>
+        T &operator()(Idx... idx)
+        {
+            return (*data)[offset(idx...)];
+        }
+        template <typename... Idx>
+        const T &operator()(Idx... idx) const
+        {
+            return (*data)[offset(idx...)];
+        }
+
+        // 多维下标对应的行主序线性偏移
+        template <typename... Idx>
+        size_t offset(Idx... idx) const
+        {
+            static_assert((std::is_integral_v<Idx> && ...), "Tensor indices must be integers");
+            const std::array<size_t, sizeof...(Idx)> ix = {static_cast<size_t>(idx)...};
+#if TENSORN_BOUNDS_CHECK
+            if (ix.size() != _shape.size())
+            {
+                TENSOR_THROW("Number of indices must match tensor dimension.");
+            }
+            for (size_t d = 0; d < ix.size(); ++d)
+            {
+                if (ix[d] >= _shape[d])
+                {
+                    TENSOR_THROW("Index out of range.");
+                }
+            }
+#endif
+            size_t off = 0;
+            for (size_t d = 0; d < ix.size(); ++d)
+            {
+                off = off * _shape[d] + ix[d];
+            }
+            return off;
+        }
+
+        // 行主序步长（以元素计），用于原始指针遍历
+        std::vector<size_t> strides() const
+        {
+            std::vector<size_t> st(_shape.size(), 1);
+            for (size_t d = _shape.size(); d-- > 1;)
+            {
+                st[d - 1] = st[d] * _shape[d];
+            }
+            return st;
+        }
+
         friend std::ostream &operator<<(std::ostream &os, const Tensor<T> &tensor)
         {
             if (tensor._size == 0)
@@ -531,6 +614,37 @@ namespace TensorN
             return t;
         }
 
+        // 零拷贝包装外部内存（如 mmap 映射区）；owner 随张量及其浅拷贝存活。
+        // 不可对 data 做 resize/push_back 等会重新分配的操作。
+        static Tensor<T> from_external(const std::vector<size_t>& shape, T* ptr,
+                                       std::shared_ptr<void> owner)
+        {
+            struct Holder
+            {
+                std::shared_ptr<void> owner;
+                std::vector<T, ExternalAllocator<T>> vec;
+
+                Holder(std::shared_ptr<void> o, T* p, size_t n)
+                    : owner(std::move(o)), vec(arm(p, n)) {}
+
+                // vector(n) 构造时 allocate() 取走登记的外部指针
+                static size_t arm(T* p, size_t n)
+                {
+                    ExternalAllocator<T>::pending() = n ? p : nullptr;
+                    return n;
+                }
+            };
+
+            Tensor<T> t;
+            t._shape = shape;
+            t._size = 1;
+            for (auto& e : shape) t._size *= e;
+            auto holder = std::make_shared<Holder>(std::move(owner), ptr, t._size);
+            t.data = std::shared_ptr<std::vector<T>>(
+                holder, reinterpret_cast<std::vector<T>*>(&holder->vec));
+            return t;
+        }
+
         Tensor<T> view() const
         {
             return shallow_copy();
@@ -544,6 +658,7 @@ namespace TensorN
                 TENSOR_THROW("Reshape: total size must match");
             Tensor<T> result = shallow_copy();
             result._shape = new_shape;
+            result._layout = Layout::NCHW;
             return result;
         }
     };
@@ -620,6 +735,16 @@ namespace TensorN
         {
             return tensor[index];
         }
+        template <typename... Idx>
+        T &operator()(Idx... idx)
+        {
+            return tensor(idx...);
+        }
+        template <typename... Idx>
+        const T &operator()(Idx... idx) const
+        {
+            return tensor(idx...);
+        }
 
         friend std::ostream &operator<<(std::ostream &os, const opt<T> &opt_tensor)
         {
@@ -647,12 +772,10 @@ namespace TensorN
     Tensor<T> eye(size_t n)
     {
         Tensor<T> tensor({n, n});
+        T *p = tensor.data->data();
         for (size_t i = 0; i < n; ++i)
         {
-            for (size_t j = 0; j < n; ++j)
-            {
-                tensor[{i, j}] = (i == j) ? T(1) : T(0);
-            }
+            p[i * n + i] = T(1);
         }
         return tensor;
     }
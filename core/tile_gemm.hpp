@@ -0,0 +1,169 @@
+#pragma once
+#ifndef __TILE_GEMM_HPP__
+#define __TILE_GEMM_HPP__
+
+// ============================================================================
+// 缓存内小块 GEMM（分块注意力、分块线性注意力共用）
+//
+//   C[M, N] (+)= A[M, K] · B[K, N]，三者都是行主序、块已经在 L1 / L2 里，不做打包：
+//     * 4 行一组，列方向每次两个 64 字节向量宽（float 32 列，double 16 列）
+//     * AVX2 + FMA 下 float / double 走 ymm 内核，8 个累加器在整个 K 循环里留在寄存器中；
+//       其它类型或列尾退回 omp simd 循环
+//   不依赖 BLAS，原生后端与 BLAS 后端都可以使用。
+// ============================================================================
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace TensorN
+{
+    namespace tile_detail
+    {
+        // 微内核列宽：两个 64 字节向量
+        template <typename A>
+        constexpr size_t tile_width() { return 128 / sizeof(A); }
+
+#if defined(__AVX2__) && defined(__FMA__)
+        template <typename A>
+        struct Ymm;
+
+        template <>
+        struct Ymm<float>
+        {
+            using type = __m256;
+            static constexpr size_t width = 8;
+            static type zero() { return _mm256_setzero_ps(); }
+            static type load(const float* p) { return _mm256_loadu_ps(p); }
+            static type bcast(const float* p) { return _mm256_broadcast_ss(p); }
+            static type fma(type x, type y, type z) { return _mm256_fmadd_ps(x, y, z); }
+            static void store(float* p, type v) { _mm256_storeu_ps(p, v); }
+        };
+
+        template <>
+        struct Ymm<double>
+        {
+            using type = __m256d;
+            static constexpr size_t width = 4;
+            static type zero() { return _mm256_setzero_pd(); }
+            static type load(const double* p) { return _mm256_loadu_pd(p); }
+            static type bcast(const double* p) { return _mm256_broadcast_sd(p); }
+            static type fma(type x, type y, type z) { return _mm256_fmadd_pd(x, y, z); }
+            static void store(double* p, type v) { _mm256_storeu_pd(p, v); }
+        };
+
+        // 4 行 x 两个 ymm 宽的寄存器块：8 个累加器在整个 K 循环里不落回内存
+        // （写成具名变量：数组形式在 -O2 下会被放到栈上）
+        template <typename A>
+        inline void micro_ymm(size_t K, const A* a, size_t lda, const A* b, size_t ldb,
+                              A* c, size_t ldc, bool accumulate)
+        {
+            using V = Ymm<A>;
+            constexpr size_t W = V::width;
+            typename V::type c00 = V::zero(), c01 = c00, c10 = c00, c11 = c00;
+            typename V::type c20 = c00, c21 = c00, c30 = c00, c31 = c00;
+            if (accumulate)
+            {
+                c00 = V::load(c), c01 = V::load(c + W);
+                c10 = V::load(c + ldc), c11 = V::load(c + ldc + W);
+                c20 = V::load(c + 2 * ldc), c21 = V::load(c + 2 * ldc + W);
+                c30 = V::load(c + 3 * ldc), c31 = V::load(c + 3 * ldc + W);
+            }
+            const A* a1 = a + lda;
+            const A* a2 = a1 + lda;
+            const A* a3 = a2 + lda;
+            for (size_t k = 0; k < K; ++k)
+            {
+                const auto b0 = V::load(b + k * ldb);
+                const auto b1 = V::load(b + k * ldb + W);
+                auto x = V::bcast(a + k);
+                c00 = V::fma(x, b0, c00);
+                c01 = V::fma(x, b1, c01);
+                x = V::bcast(a1 + k);
+                c10 = V::fma(x, b0, c10);
+                c11 = V::fma(x, b1, c11);
+                x = V::bcast(a2 + k);
+                c20 = V::fma(x, b0, c20);
+                c21 = V::fma(x, b1, c21);
+                x = V::bcast(a3 + k);
+                c30 = V::fma(x, b0, c30);
+                c31 = V::fma(x, b1, c31);
+            }
+            V::store(c, c00), V::store(c + W, c01);
+            V::store(c + ldc, c10), V::store(c + ldc + W, c11);
+            V::store(c + 2 * ldc, c20), V::store(c + 2 * ldc + W, c21);
+            V::store(c + 3 * ldc, c30), V::store(c + 3 * ldc + W, c31);
+        }
+#endif
+
+        // c[MR, nc] (+)= a[MR, K] · b[K, nc]；nc 取满时内层为定长循环
+        template <size_t MR, typename A>
+        inline void micro(size_t K, const A* __restrict a, size_t lda, const A* __restrict b, size_t ldb,
+                          A* __restrict c, size_t ldc, size_t nc, bool accumulate)
+        {
+            constexpr size_t NR = tile_width<A>();
+#if defined(__AVX2__) && defined(__FMA__)
+            if constexpr (MR == 4 && (std::is_same_v<A, float> || std::is_same_v<A, double>))
+                if (nc == NR)
+                {
+                    for (size_t j = 0; j < NR; j += 2 * Ymm<A>::width)
+                        micro_ymm(K, a, lda, b + j, ldb, c + j, ldc, accumulate);
+                    return;
+                }
+#endif
+            A acc[MR][NR];
+            for (size_t r = 0; r < MR; ++r)
+                for (size_t j = 0; j < NR; ++j)
+                    acc[r][j] = (accumulate && j < nc) ? c[r * ldc + j] : A(0);
+            if (nc == NR)
+                for (size_t k = 0; k < K; ++k)
+                {
+                    const A* br = b + k * ldb;
+                    for (size_t r = 0; r < MR; ++r)
+                    {
+                        const A x = a[r * lda + k];
+#pragma omp simd
+                        for (size_t j = 0; j < NR; ++j)
+                            acc[r][j] += x * br[j];
+                    }
+                }
+            else
+                for (size_t k = 0; k < K; ++k)
+                {
+                    const A* br = b + k * ldb;
+                    for (size_t r = 0; r < MR; ++r)
+                    {
+                        const A x = a[r * lda + k];
+                        for (size_t j = 0; j < nc; ++j)
+                            acc[r][j] += x * br[j];
+                    }
+                }
+            for (size_t r = 0; r < MR; ++r)
+                for (size_t j = 0; j < nc; ++j)
+                    c[r * ldc + j] = acc[r][j];
+        }
+
+        // 块内 C[M, N] (+)= A[M, K] · B[K, N]（行主序，块都在 L1 / L2 里，不再打包）
+        template <typename A>
+        void tile_gemm(size_t M, size_t N, size_t K, const A* a, size_t lda, const A* b, size_t ldb,
+                       A* c, size_t ldc, bool accumulate)
+        {
+            constexpr size_t NR = tile_width<A>();
+            for (size_t j0 = 0; j0 < N; j0 += NR)
+            {
+                const size_t nc = std::min(NR, N - j0);
+                size_t i = 0;
+                for (; i + 4 <= M; i += 4)
+                    micro<4>(K, a + i * lda, lda, b + j0, ldb, c + i * ldc + j0, ldc, nc, accumulate);
+                for (; i < M; ++i)
+                    micro<1>(K, a + i * lda, lda, b + j0, ldb, c + i * ldc + j0, ldc, nc, accumulate);
+            }
+        }
+    }
+} // namespace TensorN
+
+#endif // __TILE_GEMM_HPP__
@@ -35,6 +35,7 @@ int main()
     std::cout << "  M = " << M << std::endl;
     std::cout << "  M[{0,0}] = " << M[{0, 0}] << std::endl;
     std::cout << "  M[{1,2}] = " << M[{1, 2}] << std::endl;
+    std::cout << "  M(2,1) (unchecked) = " << M(2, 1) << std::endl;
     std::cout << "  M[4] (flat) = " << M[4] << std::endl;
 
     // 4. Shape and size
@@ -42,6 +43,9 @@ int main()
     std::cout << "  M.shape() = {";
     for (auto s : M.shape()) std::cout << s << " ";
     std::cout << "}" << std::endl;
+    std::cout << "  M.strides() = {";
+    for (auto s : M.strides()) std::cout << s << " ";
+    std::cout << "}" << std::endl;
     std::cout << "  M.size() = " << M.size() << std::endl;
 
     // 5. Clone, view, shallow_copy
@@ -0,0 +1,286 @@
+#include "TensorN.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace TensorN;
+using namespace TensorN::gguf_quant;
+
+// ============================================================================
+// exp12: GGUF 反量化逐位校验
+//
+// 每种 block 类型随机生成若干 block，分别用
+//   * ggml_dequantize_row（AVX2 可用时走 SIMD 路径）
+//   * *_ref 标量版本（只有带 SIMD 路径的类型才有）
+//   * 本文件按 ggml 参考实现逐元素写出的解码公式
+// 解码后逐位比较。任一类型不一致时返回 1。
+// ============================================================================
+
+// fp16 位模式 -> float，不经过库里的转换函数
+static float half_ref(uint16_t h)
+{
+    const int e = (h >> 10) & 0x1F, m = h & 0x3FF;
+    const float v = e == 0 ? std::ldexp(static_cast<float>(m), -24)
+                           : std::ldexp(static_cast<float>(m | 0x400), e - 25);
+    return (h & 0x8000) ? -v : v;
+}
+
+static std::mt19937 rng(12345);
+
+// 有限的 fp16：多数为正规数，偶尔为次正规数
+static uint16_t random_half()
+{
+    const uint16_t sign = (rng() & 1) ? 0x8000 : 0;
+    const uint16_t exp = (rng() % 8 == 0) ? 0 : static_cast<uint16_t>(5 + rng() % 16);
+    return static_cast<uint16_t>(sign | (exp << 10) | (rng() & 0x3FF));
+}
+
+template <typename B>
+static std::vector<B> random_blocks(size_t nb)
+{
+    std::vector<B> blocks(nb);
+    auto *bytes = reinterpret_cast<uint8_t *>(blocks.data());
+    for (size_t i = 0; i < nb * sizeof(B); ++i)
+        bytes[i] = static_cast<uint8_t>(rng());
+    return blocks;
+}
+
+static int failures = 0;
+
+// elem(block, i) 给出 block 内第 i 个元素的参考值
+template <typename B, typename Elem>
+static void check(const char *name, GGMLType type, std::vector<B> blocks, Elem elem,
+                  void (*scalar)(const B *, float *, size_t) = nullptr)
+{
+    const size_t qk = ggml_block_size(type), n = blocks.size() * qk;
+    std::vector<float> expected(n), got(n), ref(n);
+    for (size_t b = 0; b < blocks.size(); ++b)
+        for (size_t i = 0; i < qk; ++i)
+            expected[b * qk + i] = elem(blocks[b], i);
+
+    ggml_dequantize_row(type, blocks.data(), got.data(), n);
+    bool ok = std::memcmp(got.data(), expected.data(), n * sizeof(float)) == 0;
+    if (scalar)
+    {
+        scalar(blocks.data(), ref.data(), blocks.size());
+        ok = ok && std::memcmp(ref.data(), expected.data(), n * sizeof(float)) == 0;
+    }
+    std::printf("  %-7s %5zu values  %s%s\n", name, n, ok ? "bit-exact" : "MISMATCH",
+                scalar ? "  (simd + scalar)" : "");
+    failures += ok ? 0 : 1;
+}
+
+// K-quant 的 6-bit scale / min（与 ggml get_scale_min_k4 相同的布局）
+static void scale_min_k4(const uint8_t *q, int j, int &sc, int &m)
+{
+    if (j < 4)
+    {
+        sc = q[j] & 63;
+        m = q[j + 4] & 63;
+    }
+    else
+    {
+        sc = (q[j + 4] & 0xF) | ((q[j - 4] >> 6) << 4);
+        m = (q[j + 4] >> 4) | ((q[j] >> 6) << 4);
+    }
+}
+
+int main()
+{
+    std::cout << "=== exp12: GGUF dequantization bit-exactness ===\n" << std::endl;
+
+    // 1. 手工构造的 Q4_0 block：d = 0.5，低半字节 j，高半字节 15 - j
+    std::cout << "1. Known Q4_0 block:" << std::endl;
+    BlockQ4_0 known;
+    known.d = 0x3800;
+    for (int j = 0; j < 16; ++j)
+        known.qs[j] = static_cast<uint8_t>(j | ((15 - j) << 4));
+    float kv[32];
+    ggml_dequantize_row(GGMLType::Q4_0, &known, kv, 32);
+    std::cout << "  y[0..3] = " << kv[0] << " " << kv[1] << " " << kv[2] << " " << kv[3]
+              << "  (expected -4 -3.5 -3 -2.5)" << std::endl;
+    std::cout << "  y[16..19] = " << kv[16] << " " << kv[17] << " " << kv[18] << " " << kv[19]
+              << "  (expected 3.5 3 2.5 2)" << std::endl;
+
+    // 2. 全部类型：库解码 vs 逐元素参考公式
+    std::cout << "\n2. Random blocks vs reference decode:" << std::endl;
+    const size_t NB = 64;
+
+    {
+        auto blocks = random_blocks<BlockQ4_0>(NB);
+        for (auto &b : blocks) b.d = random_half();
+        check("q4_0", GGMLType::Q4_0, blocks, [](const BlockQ4_0 &b, size_t i) {
+            const int q = i < 16 ? (b.qs[i] & 0xF) : (b.qs[i - 16] >> 4);
+            return static_cast<float>(q - 8) * half_ref(b.d);
+        }, dequantize_row_q4_0_ref);
+    }
+    {
+        auto blocks = random_blocks<BlockQ4_1>(NB);
+        for (auto &b : blocks) { b.d = random_half(); b.m = random_half(); }
+        check("q4_1", GGMLType::Q4_1, blocks, [](const BlockQ4_1 &b, size_t i) {
+            const int q = i < 16 ? (b.qs[i] & 0xF) : (b.qs[i - 16] >> 4);
+            return static_cast<float>(q) * half_ref(b.d) + half_ref(b.m);
+        });
+    }
+    {
+        auto blocks = random_blocks<BlockQ5_0>(NB);
+        for (auto &b : blocks) b.d = random_half();
+        check("q5_0", GGMLType::Q5_0, blocks, [](const BlockQ5_0 &b, size_t i) {
+            uint32_t qh;
+            std::memcpy(&qh, b.qh, 4);
+            const int lo = i < 16 ? (b.qs[i] & 0xF) : (b.qs[i - 16] >> 4);
+            const int q = lo | static_cast<int>(((qh >> i) & 1) << 4);
+            return static_cast<float>(q - 16) * half_ref(b.d);
+        });
+    }
+    {
+        auto blocks = random_blocks<BlockQ5_1>(NB);
+        for (auto &b : blocks) { b.d = random_half(); b.m = random_half(); }
+        check("q5_1", GGMLType::Q5_1, blocks, [](const BlockQ5_1 &b, size_t i) {
+            uint32_t qh;
+            std::memcpy(&qh, b.qh, 4);
+            const int lo = i < 16 ? (b.qs[i] & 0xF) : (b.qs[i - 16] >> 4);
+            const int q = lo | static_cast<int>(((qh >> i) & 1) << 4);
+            return static_cast<float>(q) * half_ref(b.d) + half_ref(b.m);
+        });
+    }
+    {
+        auto blocks = random_blocks<BlockQ8_0>(NB);
+        for (auto &b : blocks) b.d = random_half();
+        check("q8_0", GGMLType::Q8_0, blocks, [](const BlockQ8_0 &b, size_t i) {
+            return static_cast<float>(b.qs[i]) * half_ref(b.d);
+        }, dequantize_row_q8_0_ref);
+    }
+    {
+        auto blocks = random_blocks<BlockQ8_1>(NB);
+        for (auto &b : blocks) { b.d = random_half(); b.s = random_half(); }
+        check("q8_1", GGMLType::Q8_1, blocks, [](const BlockQ8_1 &b, size_t i) {
+            return static_cast<float>(b.qs[i]) * half_ref(b.d);
+        });
+    }
+    {
+        auto blocks = random_blocks<BlockIQ4_NL>(NB);
+        for (auto &b : blocks) b.d = random_half();
+        check("iq4_nl", GGMLType::IQ4_NL, blocks, [](const BlockIQ4_NL &b, size_t i) {
+            const int q = i < 16 ? (b.qs[i] & 0xF) : (b.qs[i - 16] >> 4);
+            return half_ref(b.d) * static_cast<float>(kvalues_iq4nl[q]);
+        });
+    }
+    {
+        auto blocks = random_blocks<BlockMXFP4>(NB);
+        check("mxfp4", GGMLType::MXFP4, blocks, [](const BlockMXFP4 &b, size_t i) {
+            const int q = i < 16 ? (b.qs[i] & 0xF) : (b.qs[i - 16] >> 4);
+            return static_cast<float>(kvalues_mxfp4[q]) * std::ldexp(1.0f, static_cast<int>(b.e) - 128);
+        });
+    }
+    {
+        auto blocks = random_blocks<BlockQ2_K>(NB);
+        for (auto &b : blocks) { b.d = random_half(); b.dmin = random_half(); }
+        check("q2_K", GGMLType::Q2_K, blocks, [](const BlockQ2_K &b, size_t i) {
+            const size_t n = i / 128, j = i % 128 / 32, half = i % 32 / 16, l = i % 16;
+            const uint8_t sc = b.scales[n * 8 + j * 2 + half];
+            const int q = (b.qs[n * 32 + half * 16 + l] >> (2 * j)) & 3;
+            return half_ref(b.d) * static_cast<float>(sc & 0xF) * static_cast<float>(q) -
+                   half_ref(b.dmin) * static_cast<float>(sc >> 4);
+        });
+    }
+    {
+        auto blocks = random_blocks<BlockQ3_K>(NB);
+        for (auto &b : blocks) b.d = random_half();
+        check("q3_K", GGMLType::Q3_K, blocks, [](const BlockQ3_K &b, size_t i) {
+            const size_t n = i / 128, j = i % 128 / 32, half = i % 32 / 16, l = i % 16;
+            const size_t s = n * 8 + j * 2 + half;
+            const int lo = s < 8 ? (b.scales[s] & 0xF) : (b.scales[s - 8] >> 4);
+            const int hi = (b.scales[8 + s % 4] >> (2 * (s / 4))) & 3;
+            const int q = (b.qs[n * 32 + half * 16 + l] >> (2 * j)) & 3;
+            const int h = (b.hmask[half * 16 + l] >> (n * 4 + j)) & 1 ? 0 : 4;
+            return half_ref(b.d) * static_cast<float>((lo | (hi << 4)) - 32) * static_cast<float>(q - h);
+        });
+    }
+    {
+        auto blocks = random_blocks<BlockQ4_K>(NB);
+        for (auto &b : blocks) { b.d = random_half(); b.dmin = random_half(); }
+        check("q4_K", GGMLType::Q4_K, blocks, [](const BlockQ4_K &b, size_t i) {
+            const size_t j = i / 64, r = i % 64;
+            int sc, m;
+            scale_min_k4(b.scales, static_cast<int>(2 * j + r / 32), sc, m);
+            const uint8_t byte = b.qs[j * 32 + r % 32];
+            const int q = r < 32 ? (byte & 0xF) : (byte >> 4);
+            return half_ref(b.d) * static_cast<float>(sc) * static_cast<float>(q) -
+                   half_ref(b.dmin) * static_cast<float>(m);
+        }, dequantize_row_q4_K_ref);
+    }
+    {
+        auto blocks = random_blocks<BlockQ5_K>(NB);
+        for (auto &b : blocks) { b.d = random_half(); b.dmin = random_half(); }
+        check("q5_K", GGMLType::Q5_K, blocks, [](const BlockQ5_K &b, size_t i) {
+            const size_t j = i / 64, r = i % 64, is = 2 * j + r / 32;
+            int sc, m;
+            scale_min_k4(b.scales, static_cast<int>(is), sc, m);
+            const uint8_t byte = b.qs[j * 32 + r % 32];
+            const int q = (r < 32 ? (byte & 0xF) : (byte >> 4)) + ((b.qh[r % 32] >> is) & 1) * 16;
+            return half_ref(b.d) * static_cast<float>(sc) * static_cast<float>(q) -
+                   half_ref(b.dmin) * static_cast<float>(m);
+        });
+    }
+    {
+        auto blocks = random_blocks<BlockQ6_K>(NB);
+        for (auto &b : blocks) b.d = random_half();
+        check("q6_K", GGMLType::Q6_K, blocks, [](const BlockQ6_K &b, size_t i) {
+            const size_t n = i / 128, quarter = i % 128 / 32, l = i % 32;
+            const uint8_t lbyte = b.ql[n * 64 + l + (quarter & 1) * 32];
+            const int lo = quarter < 2 ? (lbyte & 0xF) : (lbyte >> 4);
+            const int hi = (b.qh[n * 32 + l] >> (2 * quarter)) & 3;
+            const int sc = b.scales[n * 8 + l / 16 + 2 * quarter];
+            return half_ref(b.d) * static_cast<float>(sc) * static_cast<float>((lo | (hi << 4)) - 32);
+        });
+    }
+    {
+        auto blocks = random_blocks<BlockQ8_K>(NB);
+        for (auto &b : blocks) b.d = half_ref(random_half());
+        check("q8_K", GGMLType::Q8_K, blocks, [](const BlockQ8_K &b, size_t i) {
+            return b.d * static_cast<float>(b.qs[i]);
+        });
+    }
+    {
+        auto blocks = random_blocks<BlockIQ4_XS>(NB);
+        for (auto &b : blocks) b.d = random_half();
+        check("iq4_xs", GGMLType::IQ4_XS, blocks, [](const BlockIQ4_XS &b, size_t i) {
+            const size_t ib = i / 32, r = i % 32;
+            const int ls = ((b.scales_l[ib / 2] >> (4 * (ib % 2))) & 0xF) | (((b.scales_h >> (2 * ib)) & 3) << 4);
+            const uint8_t byte = b.qs[ib * 16 + r % 16];
+            const int q = r < 16 ? (byte & 0xF) : (byte >> 4);
+            return half_ref(b.d) * static_cast<float>(ls - 32) * static_cast<float>(kvalues_iq4nl[q]);
+        });
+    }
+    {
+        // 每字节存 5 个三进制位：第 n 位为 (uint8(byte * 3^n) * 3) >> 8
+        auto blocks = random_blocks<BlockTQ1_0>(NB);
+        for (auto &b : blocks) b.d = random_half();
+        check("tq1_0", GGMLType::TQ1_0, blocks, [](const BlockTQ1_0 &b, size_t i) {
+            static const int pow3[5] = {1, 3, 9, 27, 81};
+            uint8_t byte;
+            int n;
+            if (i < 160) { byte = b.qs[i % 32]; n = static_cast<int>(i / 32); }
+            else if (i < 240) { byte = b.qs[32 + (i - 160) % 16]; n = static_cast<int>((i - 160) / 16); }
+            else { byte = b.qh[(i - 240) % 4]; n = static_cast<int>((i - 240) / 4); }
+            const uint8_t q = static_cast<uint8_t>(byte * pow3[n]);
+            return static_cast<float>(((q * 3) >> 8) - 1) * half_ref(b.d);
+        });
+    }
+    {
+        auto blocks = random_blocks<BlockTQ2_0>(NB);
+        for (auto &b : blocks) b.d = random_half();
+        check("tq2_0", GGMLType::TQ2_0, blocks, [](const BlockTQ2_0 &b, size_t i) {
+            const size_t c = i / 128, l = i % 128 / 32, m = i % 32;
+            const int q = (b.qs[c * 32 + m] >> (2 * l)) & 3;
+            return static_cast<float>(q - 1) * half_ref(b.d);
+        });
+    }
+
+    std::cout << "\n" << (failures == 0 ? "All types bit-exact." : "Mismatches found.") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
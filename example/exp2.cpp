@@ -73,6 +73,12 @@ int main()
     Tensor<double> M2d({2, 3}, {1.0, 2.0, 3.0, 1.0, 2.0, 3.0});
     auto sm2d = softmax(M2d, 1);
     std::cout << "  softmax(axis=1) = " << sm2d << std::endl;
+    std::cout << "  log_softmax(axis=1) = " << log_softmax(M2d, 1) << std::endl;
+
+    // N-D softmax：(batch, heads, L, L) 注意力分数，任意轴
+    Tensor<double> scores({1, 2, 2, 3}, {1, 2, 3, 3, 2, 1, 0, 0, 0, 1, 1, 4});
+    std::cout << "  softmax(4D, axis=-1) = " << softmax(scores, -1) << std::endl;
+    std::cout << "  softmax(4D, axis=1)  = " << softmax(scores, 1) << std::endl;
 
     // 8. Comparison ops
     std::cout << "\n8. Comparison:" << std::endl;
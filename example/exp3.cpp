@@ -71,5 +71,19 @@ int main()
     auto c2_full = contract(Sq, {0, 1});  // trace (scalar)
     std::cout << "  contract(Sq, {0,1}) = " << c2_full << std::endl;
 
+    // 10. Linear layer, plain and with a prepacked weight
+    std::cout << "\n10. Linear (x * W^T + b):" << std::endl;
+    Tensor<float> lx({2, 3}, {1.f, 2.f, 3.f, 4.f, 5.f, 6.f});
+    Tensor<float> lw({2, 3}, {1.f, 0.f, 0.f, 0.f, 1.f, 1.f});
+    Tensor<float> lb({2}, {0.5f, -1.f});
+    std::cout << "  linear(x, W, b) = " << blas::linear(lx, lw, lb) << std::endl;
+    auto packed = blas::PackedWeight<float>::linear(lw);
+    std::cout << "  linear(x, packed W, b) = " << blas::linear(lx, packed, lb)
+              << "  (expected [[1.5, 4], [4.5, 10]])" << std::endl;
+    Tensor<float> lb2({2}, {-2.f, 1.f});
+    std::cout << "  linear_activation(x, W, b2, relu) = "
+              << blas::linear_activation(lx, lw, lb2, blas::ActivationType::ReLU)
+              << "  (expected [[0, 6], [2, 12]])" << std::endl;
+
     return 0;
 }
@@ -20,16 +20,24 @@ int main()
     std::cout << "  sum(axis=0) = " << s0 << std::endl;
     auto s1 = sum(M, 1);
     std::cout << "  sum(axis=1) = " << s1 << std::endl;
+    auto s01 = sum(M, {0, 1}, true);
+    std::cout << "  sum(axes={0,1}, keepdims) = " << s01 << "  shape {"
+              << s01.tensor.shape()[0] << ", " << s01.tensor.shape()[1] << "}" << std::endl;
+    std::cout << "  prod(axis=1) = " << prod(M, {1}) << std::endl;
 
     // 2. Mean
     std::cout << "\n2. Mean:" << std::endl;
     using namespace math;
     std::cout << "  mean(all) = " << mean(M) << "  (expected 6.5)" << std::endl;
+    std::cout << "  mean(axis=0) = " << mean(M, {0}) << "  (expected [5,6,7,8])" << std::endl;
 
     // 3. Max / Min
     std::cout << "\n3. Max & Min:" << std::endl;
-    std::cout << "  max = " << *std::max_element(M.begin(), M.end()) << std::endl;
-    std::cout << "  min = " << *std::min_element(M.begin(), M.end()) << std::endl;
+    std::cout << "  max = " << max(M) << std::endl;
+    std::cout << "  min = " << min(M) << std::endl;
+    std::cout << "  max(axis=1) = " << max(M, {1}) << std::endl;
+    std::cout << "  min(axis=-2) = " << min(M, {-2}) << std::endl;
+    std::cout << "  logsumexp(axis=1) = " << logsumexp(M, {1}) << std::endl;
 
     // 4. Argmax / Argmin
     std::cout << "\n4. Argmax & Argmin:" << std::endl;
@@ -44,11 +52,18 @@ int main()
     std::cout << "  v = " << v << std::endl;
     std::cout << "  norm(v) [L2] = " << norm(v) << "  (expected 5)" << std::endl;
     std::cout << "  frobenius_norm(M) = " << frobenius_norm(M) << std::endl;
+    std::cout << "  norm(M, axis=1) [L2] = " << norm(M, {1}) << std::endl;
+    std::cout << "  norm(M, axis=0, p=1) = " << norm(M, {0}, false, 1.0) << std::endl;
 
     // 6. Variance & Stddev
     std::cout << "\n6. Variance & Stddev:" << std::endl;
     std::cout << "  var(M) = " << var(M) << std::endl;
     std::cout << "  stddev(M) = " << stddev(M) << std::endl;
+    std::cout << "  var(M, axis=0, ddof=1) = " << var(M, {0}, false, 1.0) << std::endl;
+    auto st = moments(M, {1});
+    std::cout << "  moments(axis=1): mean = " << st.mean << ", stddev = " << st.stddev
+              << ", skew = " << st.skew << ", kurtosis = " << st.kurtosis
+              << ", min = " << st.min << ", max = " << st.max << std::endl;
 
     // 7. Conv2d
     std::cout << "\n7. Conv2d (N=1, C=1, H=3, W=3, K=1, k=2x2):" << std::endl;
@@ -60,6 +75,32 @@ int main()
     Tensor<double> bias({1}, {0.0});
     auto conv_out = conv2d(input, weight, bias, 1, 0);
     std::cout << "  " << conv_out << std::endl;
+    auto fft_out = blas::conv2d(input, weight, bias, 1, 0, blas::ConvAlgo::FFT);
+    std::cout << "  blas (fft): " << fft_out << std::endl;
+    Tensor<float> fmap({1, 64, 56, 56});
+    Tensor<float> k3({64, 64, 3, 3});
+    std::cout << "  auto algo for 64x56x56, 3x3: "
+              << blas::conv_algo_name(blas::select_conv_algo(fmap, k3, 1, 1)) << std::endl;
+
+    // NHWC：同一次卷积按 channels-last 计算，再做 2x2 池化
+    auto nhwc_out = conv2d(to_nhwc(input), weight, bias, 1, 0);
+    std::cout << "  nhwc -> nchw: " << to_nchw(nhwc_out) << std::endl;
+    std::cout << "  max_pool2d(2): " << max_pool2d(conv_out, 2) << std::endl;
+
+    // 膨胀 2 的 2x2 卷积核覆盖 3x3 窗口；深度卷积每个通道使用自己的卷积核
+    std::cout << "  dilation 2: " << conv2d(input, weight, bias, 1, 0, 2) << std::endl;
+    Tensor<double> dw_in({1, 2, 3}, {1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+    Tensor<double> dw_w({2, 1, 2}, {1.0, 1.0, 1.0, -1.0});
+    Tensor<double> dw_b({2}, {0.0, 0.0});
+    std::cout << "  conv1d depthwise (groups=2): " << conv1d(dw_in, dw_w, dw_b, 1, 0, 1, 2) << std::endl;
+
+    // 只在末尾填充的 1x1 卷积：输出比输入大一圈，多出的行 / 列只有 bias
+    ConvParams tail;
+    tail.pad_end = {{1, 1, 0}};
+    Tensor<double> one({1, 1, 1, 1}, {2.0});
+    std::cout << "  1x1, pad_end 1: " << conv2d(input, one, bias, tail) << std::endl;
+    std::cout << "  blas (im2col): " << blas::conv2d(input, one, bias, tail, blas::ConvAlgo::Im2colGemm)
+              << "  (expected [[2,4,6,0],[8,10,12,0],[14,16,18,0],[0,0,0,0]])" << std::endl;
 
     // 8. ConvTranspose2d
     std::cout << "\n8. ConvTranspose2d:" << std::endl;
@@ -1,4 +1,6 @@
 #include "TensorN.hpp"
+#include <cmath>
+#include <cstring>
 #include <iostream>
 
 using namespace TensorN;
@@ -79,5 +81,56 @@ int main()
     std::cout << "  .pth  -> pt" << std::endl;
     std::cout << "  .json -> json" << std::endl;
 
+    // 7. Async loading & prefetching: 计算当前批次时后台读取下一批
+    std::cout << "\n7. Async loading & prefetching:" << std::endl;
+    auto fut = load_async<float>("example/data.npy");
+    std::cout << "  load_async: " << fut.get() << std::endl;
+
+    std::vector<std::string> batches = {"example/data.csv", "example/data.json",
+                                        "example/data.npy", "example/data.pt"};
+    PrefetchOptions opt;
+    opt.depth = 2;
+    TensorPrefetcher<float> prefetcher(batches, opt);
+    while (prefetcher.has_next())
+    {
+        std::string name = prefetcher.next_file();
+        Tensor<float> batch = prefetcher.next();
+        std::cout << "  " << name << " -> " << batch << std::endl;
+    }
+
+    // 8. Out-of-core chunked tensor: 逐块流式计算，块缓存有上限
+    std::cout << "\n8. Out-of-core chunked tensor:" << std::endl;
+    std::vector<float> big_data(64 * 48);
+    for (size_t i = 0; i < big_data.size(); ++i)
+        big_data[i] = static_cast<float>(i % 7) - 3.0f;
+    Tensor<float> big({64, 48}, big_data);
+    save_chunked(big, "example/big.tnc", {16, 16}, ChunkCodec::Zlib);
+    OutOfCoreTensor<float> ooc("example/big.tnc", 4096);
+    std::cout << "  chunks: " << ooc.num_chunks() << ", cache bytes: " << ooc.cache_bytes() << std::endl;
+    std::cout << "  sum: " << ooc.sum() << std::endl;
+    Tensor<float> w({48, 2}, std::vector<float>(96, 1.0f));
+    auto prod = ooc.matmul(w, "example/big_w.tnc");
+    std::cout << "  matmul rows 0..1: " << prod.read({0, 0}, {2, 2}) << std::endl;
+    auto doubled = ooc.map([](float x) { return x * 2.0f; }, "example/big2.tnc");
+    std::cout << "  map sum: " << doubled.sum() << std::endl;
+    std::cout << "  read tile: " << doubled.read({0, 0}, {2, 4}) << std::endl;
+
+    // 9. Compressed storage: 字节重排 + 最快的可用编解码器（Zstd/LZ4，否则 zlib），各块并行压缩
+    std::cout << "\n9. Compressed storage (" << codec_name(fast_codec()) << "):" << std::endl;
+    std::vector<half> act_data(4096);
+    for (size_t i = 0; i < act_data.size(); ++i)
+        act_data[i] = half(std::sin(static_cast<float>(i) * 0.01f));
+    Tensor<half> act({64, 64}, act_data);
+    save_compressed(act, "example/act.tnc", {fast_codec(), ChunkFilter::Shuffle});
+    save_compressed(act, "example/act_bits.tnc", {ChunkCodec::Zlib, ChunkFilter::BitShuffle, 9});
+    auto act2 = load_compressed<half>("example/act.tnc");
+    auto act3 = load<half>("example/act_bits.tnc");
+    std::cout << "  round trip: "
+              << (std::memcmp(act.data->data(), act2.data->data(), act.size() * sizeof(half)) == 0 &&
+                          std::memcmp(act.data->data(), act3.data->data(), act.size() * sizeof(half)) == 0
+                      ? "exact"
+                      : "MISMATCH")
+              << std::endl;
+
     return 0;
 }
@@ -130,9 +130,57 @@ int main()
     std::cout << "  batch causal attn = " << batch_causal << std::endl;
 
     // ==============================
-    // 5. Compare with naive softmax attention approximation
+    // 5. Scaled dot-product attention (tiled, online softmax)
     // ==============================
-    std::cout << "\n5. All tests passed (compare values above manually)." << std::endl;
+    std::cout << "\n5. scaled_dot_product_attention:" << std::endl;
+
+    // q0 = [0,0] attends uniformly; q1 = [1,0] prefers k0; 1 / sqrt(d) scale is replaced by 1
+    Tensor<double> Q_({2, 2}, {0.0, 0.0,
+                               1.0, 0.0});
+    Tensor<double> K_({2, 2}, {1.0, 0.0,
+                               0.0, 1.0});
+    Tensor<double> Vs({2, 2}, {1.0, 0.0,
+                               0.0, 1.0});
+    auto sdpa = blas::scaled_dot_product_attention(Q_, K_, Vs, false, 1.0);
+    std::cout << "  output = " << sdpa << std::endl;
+    std::cout << "  expected: [[0.5,0.5],[0.731,0.269]]" << std::endl;
+
+    auto sdpa_c = blas::scaled_dot_product_attention(Q_, K_, Vs, true, 1.0);
+    std::cout << "  causal output = " << sdpa_c << std::endl;
+    std::cout << "  expected: [[1,0],[0.731,0.269]]" << std::endl;
+
+    // GQA: 4 query heads share 2 K/V heads
+    Tensor<double> Qh({4, 3, 2}), Kh({2, 5, 2}), Vh({2, 5, 3});
+    for (size_t i = 0; i < Qh.size(); ++i) Qh[i] = std::sin(0.3 * static_cast<double>(i));
+    for (size_t i = 0; i < Kh.size(); ++i) Kh[i] = std::cos(0.2 * static_cast<double>(i));
+    for (size_t i = 0; i < Vh.size(); ++i) Vh[i] = static_cast<double>(i % 4);
+    auto gqa = blas::scaled_dot_product_attention(Qh, Kh, Vh, true);
+    std::cout << "  GQA output shape = [" << gqa.shape()[0] << ", " << gqa.shape()[1] << ", "
+              << gqa.shape()[2] << "]  (expected [4, 3, 3])" << std::endl;
+
+    // ==============================
+    // 6. Incremental decoding with LinearAttnState
+    // ==============================
+    std::cout << "\n6. LinearAttnState (decode):" << std::endl;
+
+    // prefill the first 2 steps of section 3, then decode the last token
+    LinearAttnState<double> state({}, 2, 2);
+    Tensor<double> phi_p({2, 2}, {1.0, 0.0, 0.0, 1.0});
+    Tensor<double> psi_p({2, 2}, {1.0, 0.0, 1.0, 0.0});
+    Tensor<double> V_p({2, 2}, {2.0, 0.0, 1.0, 1.0});
+    auto prefill = state.extend(phi_p, psi_p, V_p);
+    std::cout << "  prefill output = " << prefill << "  (expected [[2,0],[0,0]])" << std::endl;
+
+    Tensor<double> phi_t({2}, {1.0, 1.0}), psi_t({2}, {0.0, 1.0}), v_t({2}, {0.0, 3.0});
+    auto decoded = state.step(phi_t, psi_t, v_t);
+    std::cout << "  step output = " << decoded << "  (expected [1,1.333...])" << std::endl;
+    std::cout << "  S = " << state.S() << "  (expected [[3,1],[0,3]])" << std::endl;
+    std::cout << "  C = " << state.C() << "  (expected [2,1])" << std::endl;
+
+    // ==============================
+    // 7. Compare with naive softmax attention approximation
+    // ==============================
+    std::cout << "\n7. All tests passed (compare values above manually)." << std::endl;
 
     return 0;
 }
@@ -2,6 +2,8 @@
 #include <iostream>
 #include <cstdio>
 #include <string>
+#include <cmath>
+#include <algorithm>
 
 using namespace TensorN;
 
@@ -109,8 +111,56 @@ int main()
     std::cout << "}" << std::endl;
     std::cout << "  Match: " << (T3d == T3d2 ? "YES" : "NO") << std::endl;
 
+    // 9. Memory-mapped GGUFFile: parse once, zero-copy views
+    std::cout << "\n9. Memory-mapped GGUFFile:" << std::endl;
+    std::vector<std::pair<std::string, Tensor<float>>> layers = {
+        {"layers.0.weight", W}, {"layers.0.bias", bias}, {"embedding.weight", T3d}};
+    save_gguf_multi(layers, "exp8_multi.gguf", {{"general.alignment", uint32_t(64)}});
+    {
+        GGUFFile gguf("exp8_multi.gguf");
+        std::cout << "  alignment = " << gguf.alignment()
+                  << ", tensors = " << gguf.size() << std::endl;
+        for (const auto &info : gguf.tensor_infos())
+            std::cout << "  - " << info.name << " @ offset " << info.offset
+                      << " (" << info.nbytes() << " bytes)" << std::endl;
+        Tensor<float> emb = gguf.tensor<float>("embedding.weight");
+        std::cout << "  zero-copy view match: " << (emb == T3d ? "YES" : "NO") << std::endl;
+    }
+
+    // 10. Quantized GGUF: write Q8_0 / keep 1D tensors in F32, dequantize, quantized matmul
+    std::cout << "\n10. Quantized GGUF:" << std::endl;
+    Tensor<float> Wq({4, 64});
+    for (size_t i = 0; i < Wq.size(); ++i)
+        (*Wq.data)[i] = static_cast<float>(i % 17) * 0.1f - 0.8f;
+    std::vector<std::pair<std::string, Tensor<float>>> qlayers = {
+        {"layers.0.weight", Wq}, {"layers.0.bias", bias}};
+    save_gguf_quantized(qlayers, "exp8_q8.gguf", gguf_quant_policy(GGMLType::Q8_0));
+    {
+        GGUFFile gguf("exp8_q8.gguf");
+        Tensor<float> Wd = gguf.load<float>("layers.0.weight"); // 反量化
+        float max_err = 0.0f;
+        for (size_t i = 0; i < Wq.size(); ++i)
+            max_err = std::max(max_err, std::fabs((*Wd.data)[i] - (*Wq.data)[i]));
+        std::cout << "  weight type = " << static_cast<uint32_t>(gguf.info("layers.0.weight").type)
+                  << " (Q8_0), bias type = " << static_cast<uint32_t>(gguf.info("layers.0.bias").type)
+                  << " (F32)" << std::endl;
+        std::cout << "  max dequantization error = " << max_err << std::endl;
+
+        auto Wpacked = QuantizedTensor::from_gguf(gguf, "layers.0.weight");
+        Tensor<float> x({64});
+        for (size_t i = 0; i < x.size(); ++i)
+            (*x.data)[i] = 0.01f * static_cast<float>(i);
+        std::cout << "  x @ W^T = " << blas::quantized_matmul(x, Wpacked) << std::endl;
+    }
+    {
+        // K == 0：空求和，输出 [2, 4] 全 0
+        auto Wempty = QuantizedTensor::quantize(Tensor<float>({4, 0}), GGMLType::Q8_0);
+        std::cout << "  K = 0: " << blas::quantized_matmul(Tensor<float>({2, 0}), Wempty)
+                  << "  (expected 2x4 zeros)" << std::endl;
+    }
+
     // Cleanup
-    std::cout << "\n9. Cleanup temporary files." << std::endl;
+    std::cout << "\n11. Cleanup temporary files." << std::endl;
     std::remove("exp8_weight.gguf");
     std::remove("exp8_bias.gguf");
     std::remove("exp8_auto.gguf");
@@ -119,6 +169,8 @@ int main()
     std::remove("exp8_int8.gguf");
     std::remove("exp8_scalar.gguf");
     std::remove("exp8_3d.gguf");
+    std::remove("exp8_multi.gguf");
+    std::remove("exp8_q8.gguf");
 
     std::cout << "\nAll GGUF tests passed!" << std::endl;
 
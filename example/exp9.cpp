@@ -90,11 +90,31 @@ int main()
     std::cout << "  Loaded " << pth_loaded.size() << " tensors from .pth" << std::endl;
     std::cout << "  weight match: " << (W == pth_loaded["layers.0.weight"] ? "YES" : "NO") << std::endl;
 
-    std::cout << "\n8. Cleanup temporary files." << std::endl;
+    std::cout << "\n8. Mixed dtypes, mmap random access (PtWriter / PtFile):" << std::endl;
+    {
+        PtWriter writer("exp9_mixed.pt"); // v3：64 字节对齐 + CRC32
+        writer.add("layers.0.weight", W);
+        writer.add("token_ids", Tensor<int64_t>({4}, {3, 1, 4, 1}));
+        writer.add("layers.0.scale", Tensor<half>({3}, {half(0.5f), half(1.0f), half(2.0f)}));
+        writer.finish();
+    }
+    {
+        PtFile pt("exp9_mixed.pt");
+        pt.verify_all();
+        for (const auto &info : pt.tensor_infos())
+            std::cout << "  - " << info.name << " @ offset " << info.offset
+                      << " (" << info.nbytes << " bytes)" << std::endl;
+        Tensor<float> w = pt.tensor<float>("layers.0.weight"); // 零拷贝视图
+        std::cout << "  weight match: " << (W == w ? "YES" : "NO") << std::endl;
+        std::cout << "  token_ids = " << pt.tensor<int64_t>("token_ids") << std::endl;
+    }
+
+    std::cout << "\n9. Cleanup temporary files." << std::endl;
     std::remove("exp9_model.pt");
     std::remove("exp9_model.pth");
     std::remove("exp9_int.pt");
     std::remove("exp9_double.pt");
+    std::remove("exp9_mixed.pt");
 
     std::cout << "\nAll multi-tensor .pt tests passed!" << std::endl;
 
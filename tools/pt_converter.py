@@ -2,15 +2,16 @@
 """
 Bridge between PyTorch tensors and TensorN .pt binary format.
 
-TensorN .pt binary format (Version 1 - single tensor):
+TensorN .pt binary format (Version 1 - single tensor, read-only):
   - Magic:    "TENSORPT!" (9 bytes)
   - Version:  uint32 LE (4 bytes)
-  - Dtype:    uint8        (1 byte):  0=f32, 1=f64, 2=i32, 3=i64, 4=u8, 5=i16
+  - Dtype:    uint8        (1 byte):  0=f32, 1=f64, 2=i32, 3=i64, 4=u8, 5=i16,
+                                      6=f16, 7=bf16, 8=tf32, 9=fp8_e4m3, 10=fp8_e5m2
   - Ndims:    uint32 LE (4 bytes)
   - Shape:    uint64 LE[] (ndims * 8 bytes)
   - Data:     raw binary, row-major, LE
 
-TensorN .pt binary format (Version 2 - multi-tensor):
+TensorN .pt binary format (Version 2 - multi-tensor, read-only):
   - Magic:        "TENSORPT!" (9 bytes)
   - Version:      uint32 LE (=2) (4 bytes)
   - Tensor Count: uint64 LE (8 bytes)
@@ -24,22 +25,46 @@ TensorN .pt binary format (Version 2 - multi-tensor):
       - Data Size:   uint64 LE (8 bytes)
   - Data:          raw binary for all tensors, row-major, LE
 
+TensorN .pt binary format (Version 3 - aligned, mmap-able; written by default):
+  - Magic:        "TENSORPT!" (9 bytes)
+  - Version:      uint32 LE (=3)
+  - Flags:        uint32 LE (bit 0 = CRC32 checksums present)
+  - Alignment:    uint32 LE (default 64)
+  - Tensor Count: uint64 LE
+  - Index Offset: uint64 LE (absolute offset of the trailing index)
+  - Index Size:   uint64 LE
+  - Data:         each payload starts at a multiple of Alignment (zero padding)
+  - Index (at Index Offset), for each tensor:
+      - Name Length: uint32 LE, Name: UTF-8
+      - Dtype:       uint8
+      - Ndims:       uint32 LE, Shape: uint64 LE[]
+      - Offset:      uint64 LE (absolute)
+      - Size:        uint64 LE (bytes)
+      - CRC32:       uint32 LE (zlib.crc32 of the payload, 0 if disabled)
+
 Usage:
   python pt_converter.py np2pt        <input.npy>     <output.pt>
   python pt_converter.py pt2np        <input.pt>      <output.npy>
   python pt_converter.py torch2pt     <input.pth>     <output.pt>
   python pt_converter.py pt2torch     <input.pt>      <output.pth>
   python pt_converter.py torch2pt_multi <input.pth>   <output.pt>
+  python pt_converter.py pt2torch_multi <input.pt>    <output.pth>
   python pt_converter.py pt_list      <input.pt>
+  python pt_converter.py pt_verify    <input.pt>
 """
 
+import mmap
 import struct
 import sys
+import zlib
 import numpy as np
 
 MAGIC = b"TENSORPT!"
 VERSION = 1
 VERSION_MULTI = 2
+VERSION_MAPPED = 3
+FLAG_CHECKSUM = 1
+DEFAULT_ALIGNMENT = 64
 
 def _build_dtype_map():
     m = {
@@ -70,167 +95,143 @@ DTYPE_TO_ENUM = _build_dtype_map()
 ENUM_TO_DTYPE = {v: k for k, v in DTYPE_TO_ENUM.items()}
 
 
-def save_tensorn_pt(filename: str, array: np.ndarray) -> None:
+def _dtype_enum(name: str, array: np.ndarray) -> int:
     dtype_enum = DTYPE_TO_ENUM.get(array.dtype)
     if dtype_enum is None:
         raise ValueError(
-            f"Unsupported dtype: {array.dtype}. "
+            f"Unsupported dtype for tensor '{name}': {array.dtype}. "
             f"Supported: {list(DTYPE_TO_ENUM.keys())}"
         )
-
-    with open(filename, "wb") as f:
-        f.write(MAGIC)
-        f.write(struct.pack("<I", VERSION))
-        f.write(struct.pack("<B", dtype_enum))
-        f.write(struct.pack("<I", array.ndim))
-        for dim in array.shape:
-            f.write(struct.pack("<Q", dim))
-        f.write(array.tobytes())
-
-
-def load_tensorn_pt(filename: str) -> np.ndarray:
-    with open(filename, "rb") as f:
-        magic = f.read(9)
-        if magic != MAGIC:
-            raise ValueError(
-                f"Not a valid TensorN .pt file. "
-                f"Expected magic {MAGIC!r}, got {magic!r}"
-            )
-
-        version = struct.unpack("<I", f.read(4))[0]
-        if version != VERSION:
-            raise ValueError(
-                f"Unsupported version: {version}. Expected {VERSION}"
-            )
-
-        dtype_enum = struct.unpack("<B", f.read(1))[0]
-        ndims = struct.unpack("<I", f.read(4))[0]
-
-        shape = []
-        for _ in range(ndims):
-            shape.append(struct.unpack("<Q", f.read(8))[0])
-
-        dtype = ENUM_TO_DTYPE.get(dtype_enum)
-        if dtype is None:
-            raise ValueError(f"Unknown dtype enum: {dtype_enum}")
-
-        data = f.read()
-        return np.frombuffer(data, dtype=dtype).reshape(shape)
+    return dtype_enum
 
 
-def save_tensorn_pt_multi(filename: str, tensors: dict[str, np.ndarray]) -> None:
+def save_tensorn_pt_multi(filename: str, tensors: dict[str, np.ndarray],
+                          checksum: bool = True,
+                          alignment: int = DEFAULT_ALIGNMENT) -> None:
+    """Write a version 3 container: aligned payloads followed by the index."""
     if not tensors:
         raise ValueError("No tensors to save")
 
+    flags = FLAG_CHECKSUM if checksum else 0
     with open(filename, "wb") as f:
-        f.write(MAGIC)
-        f.write(struct.pack("<I", VERSION_MULTI))
-        f.write(struct.pack("<Q", len(tensors)))
+        header = struct.pack("<9sIIIQQQ", MAGIC, VERSION_MAPPED, flags,
+                             alignment, len(tensors), 0, 0)
+        f.write(header)
 
-        current_offset = 0
         entries = []
         for name, array in tensors.items():
-            dtype_enum = DTYPE_TO_ENUM.get(array.dtype)
-            if dtype_enum is None:
-                raise ValueError(
-                    f"Unsupported dtype for tensor '{name}': {array.dtype}. "
-                    f"Supported: {list(DTYPE_TO_ENUM.keys())}"
-                )
-            raw_size = array.nbytes
-            entries.append((name, array, dtype_enum, current_offset, raw_size))
-            current_offset += raw_size
-
-        for name, array, dtype_enum, offset, size in entries:
+            dtype_enum = _dtype_enum(name, array)
+            data = np.ascontiguousarray(array).astype(array.dtype.newbyteorder("<"), copy=False)
+            f.write(b"\0" * (-f.tell() % alignment))
+            offset = f.tell()
+            payload = data.reshape(-1).view(np.uint8)
+            f.write(payload)
+            crc = zlib.crc32(payload) if checksum else 0
+            entries.append((name, dtype_enum, array.shape, offset, data.nbytes, crc))
+
+        index_offset = f.tell()
+        for name, dtype_enum, shape, offset, size, crc in entries:
             name_bytes = name.encode("utf-8")
             f.write(struct.pack("<I", len(name_bytes)))
             f.write(name_bytes)
-            f.write(struct.pack("<B", dtype_enum))
-            f.write(struct.pack("<I", array.ndim))
-            for dim in array.shape:
+            f.write(struct.pack("<BI", dtype_enum, len(shape)))
+            for dim in shape:
                 f.write(struct.pack("<Q", dim))
-            f.write(struct.pack("<Q", offset))
-            f.write(struct.pack("<Q", size))
+            f.write(struct.pack("<QQI", offset, size, crc))
+        index_size = f.tell() - index_offset
 
-        for _, array, _, _, _ in entries:
-            f.write(array.tobytes())
+        f.seek(0)
+        f.write(struct.pack("<9sIIIQQQ", MAGIC, VERSION_MAPPED, flags,
+                            alignment, len(tensors), index_offset, index_size))
 
 
-def load_tensorn_pt_multi(filename: str) -> dict[str, np.ndarray]:
-    with open(filename, "rb") as f:
-        magic = f.read(9)
-        if magic != MAGIC:
-            raise ValueError(
-                f"Not a valid TensorN .pt file. "
-                f"Expected magic {MAGIC!r}, got {magic!r}"
-            )
-
-        version = struct.unpack("<I", f.read(4))[0]
-        if version != VERSION_MULTI:
-            if version == VERSION:
-                arr = load_tensorn_pt(filename)
-                return {"tensor": arr}
-            raise ValueError(
-                f"Not a multi-tensor .pt file (version={version})"
-            )
-
-        tensor_count = struct.unpack("<Q", f.read(8))[0]
-
-        infos = []
-        for _ in range(tensor_count):
-            name_len = struct.unpack("<I", f.read(4))[0]
-            name = f.read(name_len).decode("utf-8")
-            dtype_enum = struct.unpack("<B", f.read(1))[0]
-            ndims = struct.unpack("<I", f.read(4))[0]
-            shape = []
-            for _ in range(ndims):
-                shape.append(struct.unpack("<Q", f.read(8))[0])
-            offset = struct.unpack("<Q", f.read(8))[0]
-            size = struct.unpack("<Q", f.read(8))[0]
-            infos.append((name, dtype_enum, shape, offset, size))
-
-        data_base = f.tell()
-
-        result = {}
-        for name, dtype_enum, shape, offset, size in infos:
-            dtype = ENUM_TO_DTYPE.get(dtype_enum)
-            if dtype is None:
-                raise ValueError(f"Unknown dtype enum: {dtype_enum}")
-            f.seek(data_base + offset)
-            data = f.read(size)
-            result[name] = np.frombuffer(data, dtype=dtype).reshape(shape)
-
-        return result
+def save_tensorn_pt(filename: str, array: np.ndarray) -> None:
+    save_tensorn_pt_multi(filename, {"tensor": array})
 
 
-def pt_list_tensors(filename: str) -> list[str]:
+def _read_index(buf) -> tuple[int, int, list]:
+    """Parse any container version; returns (version, flags, entries)."""
+    if bytes(buf[:9]) != MAGIC:
+        raise ValueError(
+            f"Not a valid TensorN .pt file. "
+            f"Expected magic {MAGIC!r}, got {bytes(buf[:9])!r}"
+        )
+    version = struct.unpack_from("<I", buf, 9)[0]
+    pos = 13
+
+    def shape_at(p):
+        ndims = struct.unpack_from("<I", buf, p)[0]
+        p += 4
+        shape = list(struct.unpack_from(f"<{ndims}Q", buf, p))
+        return shape, p + 8 * ndims
+
+    entries = []
+    if version == VERSION:
+        dtype_enum = buf[pos]
+        shape, pos = shape_at(pos + 1)
+        entries.append(("tensor", dtype_enum, shape, pos, None, 0))
+        return version, 0, entries
+
+    if version == VERSION_MULTI:
+        count = struct.unpack_from("<Q", buf, pos)[0]
+        pos += 8
+        for _ in range(count):
+            name_len = struct.unpack_from("<I", buf, pos)[0]
+            name = bytes(buf[pos + 4:pos + 4 + name_len]).decode("utf-8")
+            dtype_enum = buf[pos + 4 + name_len]
+            shape, pos = shape_at(pos + 5 + name_len)
+            offset, size = struct.unpack_from("<QQ", buf, pos)
+            pos += 16
+            entries.append((name, dtype_enum, shape, offset, size, 0))
+        entries = [(n, d, s, pos + o, sz, c) for n, d, s, o, sz, c in entries]
+        return version, 0, entries
+
+    if version == VERSION_MAPPED:
+        flags, _alignment, count, index_offset, _index_size = \
+            struct.unpack_from("<IIQQQ", buf, pos)
+        pos = index_offset
+        for _ in range(count):
+            name_len = struct.unpack_from("<I", buf, pos)[0]
+            name = bytes(buf[pos + 4:pos + 4 + name_len]).decode("utf-8")
+            dtype_enum = buf[pos + 4 + name_len]
+            shape, pos = shape_at(pos + 5 + name_len)
+            offset, size, crc = struct.unpack_from("<QQI", buf, pos)
+            pos += 20
+            entries.append((name, dtype_enum, shape, offset, size, crc))
+        return version, flags, entries
+
+    raise ValueError(f"Unsupported .pt version: {version}")
+
+
+def load_tensorn_pt_multi(filename: str, verify: bool = False) -> dict[str, np.ndarray]:
     with open(filename, "rb") as f:
-        magic = f.read(9)
-        if magic != MAGIC:
-            raise ValueError(
-                f"Not a valid TensorN .pt file. "
-                f"Expected magic {MAGIC!r}, got {magic!r}"
-            )
+        buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+    _, flags, entries = _read_index(buf)
 
-        version = struct.unpack("<I", f.read(4))[0]
-        if version == VERSION:
-            return ["tensor"]
-        if version != VERSION_MULTI:
-            raise ValueError(f"Unsupported .pt version: {version}")
+    result = {}
+    for name, dtype_enum, shape, offset, _size, crc in entries:
+        dtype = ENUM_TO_DTYPE.get(dtype_enum)
+        if dtype is None:
+            raise ValueError(f"Unknown dtype enum: {dtype_enum}")
+        count = int(np.prod(shape, dtype=np.int64))
+        arr = np.frombuffer(buf, dtype=dtype, count=count, offset=offset).reshape(shape)
+        if verify and flags & FLAG_CHECKSUM and zlib.crc32(arr.tobytes()) != crc:
+            raise ValueError(f"Checksum mismatch for tensor '{name}'")
+        result[name] = arr
+    return result
 
-        tensor_count = struct.unpack("<Q", f.read(8))[0]
 
-        names = []
-        for _ in range(tensor_count):
-            name_len = struct.unpack("<I", f.read(4))[0]
-            name = f.read(name_len).decode("utf-8")
-            names.append(name)
+def load_tensorn_pt(filename: str) -> np.ndarray:
+    tensors = load_tensorn_pt_multi(filename)
+    if not tensors:
+        raise ValueError("No tensors in .pt file")
+    return next(iter(tensors.values()))
 
-            f.read(1)
-            ndims = struct.unpack("<I", f.read(4))[0]
-            f.read(ndims * 8)
-            f.read(16)
 
-        return names
+def pt_list_tensors(filename: str) -> list[str]:
+    with open(filename, "rb") as f:
+        buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+    return [entry[0] for entry in _read_index(buf)[2]]
 
 
 def np2pt(input_npy: str, output_pt: str) -> None:
@@ -330,6 +331,11 @@ def pt_list(input_pt: str) -> None:
         print(f"  - {name}")
 
 
+def pt_verify(input_pt: str) -> None:
+    tensors = load_tensorn_pt_multi(input_pt, verify=True)
+    print(f"{input_pt}: {len(tensors)} tensors OK")
+
+
 def print_usage():
     print(__doc__)
 
@@ -342,6 +348,7 @@ COMMANDS = {
     "torch2pt_multi": (torch2pt_multi, 2, "<input.pth> <output.pt>"),
     "pt2torch_multi": (pt2torch_multi, 2, "<input.pt> <output.pth>"),
     "pt_list":        (pt_list,        1, "<input.pt>"),
+    "pt_verify":      (pt_verify,      1, "<input.pt>"),
 }
 
 